@@ -97,7 +97,7 @@ kotlin {
             create("date") {
                 val cinteropDir = "$projectDir/nativeMain/cinterop"
                 val dateLibDir = "${project(":").projectDir}/thirdparty/date"
-                headers("$cinteropDir/public/cdate.h")
+                headers("$cinteropDir/public/cdate.h", "$cinteropDir/public/carrow.h")
                 defFile("nativeMain/cinterop/date.def")
                 // common options
                 extraOpts("-Xsource-compiler-option", "-std=c++17")
@@ -112,6 +112,21 @@ kotlin {
                 extraOpts("-Xcompile-source", "$cinteropDir/cpp/apple.mm")
                 // Windows support
                 extraOpts("-Xcompile-source", "$cinteropDir/cpp/windows.cpp")
+                // platform-independent functionality built on top of the above
+                extraOpts("-Xcompile-source", "$cinteropDir/cpp/business.cpp")
+                extraOpts("-Xcompile-source", "$cinteropDir/cpp/schedule.cpp")
+                extraOpts("-Xcompile-source", "$cinteropDir/cpp/leap_seconds.cpp")
+                extraOpts("-Xcompile-source", "$cinteropDir/cpp/day_numbers.cpp")
+                extraOpts("-Xcompile-source", "$cinteropDir/cpp/batch.cpp")
+                extraOpts("-Xcompile-source", "$cinteropDir/cpp/packed.cpp")
+                extraOpts("-Xcompile-source", "$cinteropDir/cpp/arrow_bridge.cpp")
+                extraOpts("-Xcompile-source", "$cinteropDir/cpp/format.cpp")
+                extraOpts("-Xcompile-source", "$cinteropDir/cpp/internet_dates.cpp")
+                extraOpts("-Xcompile-source", "$cinteropDir/cpp/detect.cpp")
+                extraOpts("-Xcompile-source", "$cinteropDir/cpp/periods.cpp")
+                extraOpts("-Xcompile-source", "$cinteropDir/cpp/civil.cpp")
+                extraOpts("-Xcompile-source", "$cinteropDir/cpp/zone_codes.cpp")
+                extraOpts("-Xcompile-source", "$cinteropDir/cpp/windows_names.cpp")
             }
         }
         compilations["main"].defaultSourceSet {
@@ -228,33 +243,388 @@ task("downloadWindowsZonesMapping") {
                 }
             }
         }
+        val regions = mapping.keys.sorted()
+        val windowsNames = mapping.values.distinct().sorted()
+        // CLDR lists the region for the whole world first.
+        val regionOfWindowsName = mutableMapOf<String, String>()
+        for ((usualName, windowsName) in mapping) {
+            regionOfWindowsName.putIfAbsent(windowsName, usualName)
+        }
         File(output).printWriter().use { out ->
-            out.println("""// generated with gradle task `$name`""")
-            out.println("""#include <unordered_map>""")
-            out.println("""#include <string>""")
-            out.println("""static const std::unordered_map<std::string, std::string> standard_to_windows = {""")
-            for ((usualName, windowsName) in mapping) {
-                out.println("\t{ \"$usualName\", \"$windowsName\" },")
+            fun printNumbers(numbers: List<Int>, indent: String) {
+                for (line in numbers.chunked(16)) {
+                    out.println(indent + line.joinToString(", ") + ",")
+                }
             }
+            fun printTable(tableName: String, names: List<String>) {
+                val (displacements, indices) = perfectHash(names)
+                out.println("inline constexpr perfect_hash::table<${names.size}, ${displacements.size}> $tableName = {")
+                out.println("\t{")
+                for (name in names) {
+                    out.println("\t\t\"$name\",")
+                }
+                out.println("\t},")
+                out.println("\t{")
+                printNumbers(indices, "\t\t")
+                out.println("\t},")
+                out.println("\t{")
+                printNumbers(displacements, "\t\t")
+                out.println("\t},")
+                out.println("};")
+            }
+            out.println("""// generated with gradle task `$name`""")
+            out.println("""#pragma once""")
+            out.println("""#include <cstdint>""")
+            out.println("""#include "perfect_hash.hpp"""")
+            out.println()
+            out.println("""namespace windows_zones {""")
+            out.println()
+            out.println("""// The regions that have a Windows time zone; their indices are their IDs.""")
+            printTable("regions", regions)
+            out.println()
+            out.println("""// The names of the Windows time zones.""")
+            printTable("windows_names", windowsNames)
+            out.println()
+            out.println("""// The index in `windows_names` of the Windows time zone of each region.""")
+            out.println("""inline constexpr uint16_t windows_name_of_region[${regions.size}] = {""")
+            printNumbers(regions.map { windowsNames.binarySearch(mapping[it]) }, "\t")
             out.println("};")
-            out.println("""static const std::unordered_map<std::string, std::string> windows_to_standard = {""")
-            val reverseMap = mutableMapOf<String, String>()
-            for ((usualName, windowsName) in mapping) {
-                if (reverseMap[windowsName] == null) {
-                    reverseMap[windowsName] = usualName
+            out.println()
+            out.println("""// The index in `regions` of the region of each Windows time zone.""")
+            out.println("""inline constexpr uint16_t region_of_windows_name[${windowsNames.size}] = {""")
+            printNumbers(windowsNames.map { regions.binarySearch(regionOfWindowsName[it]) }, "\t")
+            out.println("};")
+            out.println()
+            out.println("""static_assert(regions.is_valid(), "the perfect hash of the regions is broken");""")
+            out.println("""static_assert(windows_names.is_valid(), "the perfect hash of the Windows names is broken");""")
+            out.println()
+            out.println("}")
+        }
+    }
+}
+
+/* Builds a minimal perfect hash of the sorted `names`, as described in `nativeMain/cinterop/public/perfect_hash.hpp`.
+   Returns the displacements of the buckets and the index of the name in each slot. */
+fun perfectHash(names: List<String>): Pair<List<Int>, List<Int>> {
+    fun hash(name: String, seed: Int): Long {
+        val mask = 0xFFFFFFFFL
+        var result = 2166136261L xor seed.toLong()
+        for (byte in name.toByteArray()) {
+            result = ((result xor (byte.toLong() and 0xFF)) * 16777619L) and mask
+        }
+        result = result xor (result ushr 16)
+        result = (result * 0x85ebca6bL) and mask
+        result = result xor (result ushr 13)
+        result = (result * 0xc2b2ae35L) and mask
+        return result xor (result ushr 16)
+    }
+    val bucketCount = (names.size + 2) / 3
+    val buckets = List(bucketCount) { mutableListOf<Int>() }
+    names.forEachIndexed { index, name -> buckets[(hash(name, 0) % bucketCount).toInt()].add(index) }
+    val displacements = MutableList(bucketCount) { 0 }
+    val indices = MutableList(names.size) { -1 }
+    // The largest buckets are placed first, while most of the slots are free.
+    for (bucket in buckets.indices.sortedByDescending { buckets[it].size }) {
+        val bucketNames = buckets[bucket]
+        if (bucketNames.size == 1) {
+            val slot = indices.indexOf(-1)
+            indices[slot] = bucketNames[0]
+            displacements[bucket] = -1 - slot
+        } else if (bucketNames.size > 1) {
+            var displacement = 1
+            while (true) {
+                val slots = bucketNames.map { (hash(names[it], displacement) % names.size).toInt() }
+                if (slots.distinct().size == slots.size && slots.all { indices[it] == -1 }) {
+                    slots.zip(bucketNames).forEach { (slot, index) -> indices[slot] = index }
+                    break
                 }
+                ++displacement
             }
-            for ((windowsName, usualName) in reverseMap) {
-                out.println("\t{ \"$windowsName\", \"$usualName\" },")
+            displacements[bucket] = displacement
+        }
+    }
+    return displacements to indices
+}
+
+task("updateZoneCodes") {
+    description = "Gives the permanent zone codes to the time zone names that are new to `java.time`"
+    val output = "$projectDir/nativeMain/cinterop/public/zone_codes.hpp"
+    outputs.file(output)
+    doLast {
+        // the codes are stored by the users, so the existing names are never removed or reordered
+        val entry = Regex("^\t\"(.*)\",$")
+        val names = File(output).readLines().mapNotNull { entry.find(it)?.groupValues?.get(1) }
+        val known = names.toSet()
+        val allNames = names + java.time.ZoneId.getAvailableZoneIds().filter { it !in known }.sorted()
+        if (allNames.size >= 65536) {
+            throw GradleException("The zone codes don't fit into 16 bits")
+        }
+        File(output).printWriter().use { out ->
+            out.println("""// generated with gradle task `$name`, which only ever appends to the list""")
+            out.println("""#pragma once""")
+            out.println("""// The code of a name is its index here; 0 is not the code of any name.""")
+            out.println("""static const char *const zone_code_names[] = {""")
+            out.println("\tnullptr,")
+            for (zoneName in allNames) {
+                out.println("\t\"$zoneName\",")
             }
             out.println("};")
-            out.println("""static const std::unordered_map<std::string, size_t> zone_ids = {""")
-            var i = 0
-            for ((usualName, windowsName) in mapping) {
-                out.println("\t{ \"$usualName\", $i },")
-                ++i
+        }
+    }
+}
+
+/* The zones of the `staticZones` property, separated by commas, compiled into C++ for
+   `nativeMain/cinterop/public/static_zone.hpp`: a header with the rules of each of them, and `static_zones.hpp` that
+   includes them all, are put into the `staticZonesDir` property, by default into the build directory. The rules are
+   those of `java.time` of the JVM that runs gradle. Without the property, the zones are the ones that
+   `checkNativeStaticZones` compares, a zone with the rules of the EU and one with those of the US. */
+val staticZonesDir = project.findProperty("staticZonesDir") as String? ?: "$buildDir/generated/static_zones"
+
+task("generateStaticZones") {
+    description = "Generates the C++ headers with the rules of the time zones from the `staticZones` property"
+    val zoneIds = (project.findProperty("staticZones") as String? ?: "Europe/Berlin,America/New_York").split(',')
+        .map { it.trim() }
+        .filter { it.isNotEmpty() }
+    inputs.property("zones", zoneIds)
+    inputs.property("version", java.time.zone.ZoneRulesProvider.getVersions("UTC").lastKey())
+    outputs.dir(staticZonesDir)
+    doLast {
+        if (zoneIds.isEmpty()) {
+            throw GradleException("No zones to generate: set the property like `-PstaticZones=Europe/Berlin`")
+        }
+        // `Etc/GMT+5` and `Etc/GMT-5` are different zones
+        val identifiers = zoneIds.associateWith {
+            it.replace(Regex("-(?=[0-9])"), "_minus_").replace("+", "_plus_")
+                .replace(Regex("[^A-Za-z0-9]+"), "_").trim('_').toLowerCase()
+        }
+        File(staticZonesDir).mkdirs()
+        for ((zoneId, identifier) in identifiers) {
+            val rules = java.time.ZoneId.of(zoneId).rules
+            val version = java.time.zone.ZoneRulesProvider.getVersions(zoneId).lastKey()
+            val transitions = rules.transitions
+            val offsets = transitions.map { it.offsetBefore } +
+                (transitions.lastOrNull()?.offsetAfter ?: rules.getOffset(java.time.Instant.EPOCH))
+            File("$staticZonesDir/$identifier.hpp").printWriter().use { out ->
+                out.println("""// generated with gradle task `$name` from the time zone database $version""")
+                out.println("""#pragma once""")
+                out.println("""#include "static_zone.hpp"""")
+                out.println()
+                out.println("""namespace zones {""")
+                out.println("""namespace data {""")
+                out.println()
+                out.println("""struct $identifier {""")
+                out.println("""    static constexpr const char name[] = "$zoneId";""")
+                out.println("""    static constexpr std::array<int64_t, ${transitions.size}> transitions{{""")
+                for (transition in transitions) {
+                    out.println("        ${transition.toEpochSecond()},")
+                }
+                out.println("    }};")
+                out.println("""    static constexpr std::array<int, ${offsets.size}> offsets{{""")
+                for (offset in offsets) {
+                    out.println("        ${offset.totalSeconds},")
+                }
+                out.println("    }};")
+                out.println("""    static constexpr std::array<transition_rule, ${rules.transitionRules.size}> rules{{""")
+                for (rule in rules.transitionRules) {
+                    val timeOffset = when (rule.timeDefinition!!) {
+                        java.time.zone.ZoneOffsetTransitionRule.TimeDefinition.UTC -> 0
+                        java.time.zone.ZoneOffsetTransitionRule.TimeDefinition.STANDARD ->
+                            rule.standardOffset.totalSeconds
+                        java.time.zone.ZoneOffsetTransitionRule.TimeDefinition.WALL -> rule.offsetBefore.totalSeconds
+                    }
+                    val secondOfDay = rule.localTime.toSecondOfDay() + if (rule.isMidnightEndOfDay) 86400 else 0
+                    out.println("        {${rule.month.value}, ${rule.dayOfMonthIndicator}, " +
+                        "${rule.dayOfWeek?.value ?: 0}, $secondOfDay, $timeOffset, " +
+                        "${rule.offsetBefore.totalSeconds}, ${rule.offsetAfter.totalSeconds}},")
+                }
+                out.println("    }};")
+                out.println("};")
+                out.println()
+                out.println("}")
+                out.println("}")
+            }
+        }
+        File("$staticZonesDir/static_zones.hpp").printWriter().use { out ->
+            out.println("""// generated with gradle task `$name`""")
+            out.println("""#pragma once""")
+            for (identifier in identifiers.values) {
+                out.println("""#include "$identifier.hpp"""")
+            }
+            out.println()
+            out.println("// X(identifier) for each of the zones, in the namespace `zones::data`.")
+            out.println("#define DATETIME_STATIC_ZONES(X) \\")
+            out.println(identifiers.values.joinToString(" \\\n") { "    X($it)" })
+        }
+    }
+}
+
+/* The command-line tools in `nativeMain/cinterop/tools` are built for the host
+   with its own C++ compiler, which may be overridden with the `nativeToolsCxx`
+   property. They use the same implementation as the Linux and macOS targets,
+   so they don't build on Windows. */
+fun nativeBuild(taskName: String, outputName: String, sources: List<String>, flags: List<String>, libraries: List<String>,
+                withDateLibrary: Boolean = sources.any { it.startsWith("cpp/") }) = task<Exec>(taskName) {
+    group = "native tools"
+    val cinteropDir = "$projectDir/nativeMain/cinterop"
+    val dateLibDir = "${project(":").projectDir}/thirdparty/date"
+    val compiler = project.findProperty("nativeToolsCxx") as String? ?: "c++"
+    val sourceFiles = sources.map { "$cinteropDir/$it" } +
+        if (withDateLibrary) listOf("$dateLibDir/src/tz.cpp") else emptyList()
+    val output = "$buildDir/tools/$outputName"
+    inputs.files(sourceFiles)
+    outputs.file(output)
+    onlyIf { !org.gradle.internal.os.OperatingSystem.current().isWindows }
+    doFirst { File(output).parentFile.mkdirs() }
+    commandLine(listOf(compiler, "-std=c++17", "-O2", "-pthread") + flags + listOf(
+        // what `defines.hpp` sets for Linux and macOS, without the workaround for the old GCC root
+        "-DAUTO_DOWNLOAD=0", "-DHAS_REMOTE_API=0", "-DONLY_C_LOCALE=1", "-DUSE_OS_TZDB=1",
+        "-DDATETIME_TARGET_WIN32=0",
+        "-I$cinteropDir/public", "-I$cinteropDir/cpp", "-I$dateLibDir/include") +
+        sourceFiles + listOf("-o", output) + libraries)
+}
+
+fun nativeTool(taskName: String, toolName: String, vararg sources: String, libraries: List<String> = emptyList()) =
+    nativeBuild(taskName, toolName, sources.toList(), emptyList(), libraries)
+
+// The libraries replacing functions of glibc only make sense on Linux.
+fun nativeSharedLibrary(taskName: String, libraryName: String, vararg sources: String) =
+    nativeBuild(taskName, "lib$libraryName.so", sources.toList(), listOf("-shared", "-fPIC"), emptyList()).apply {
+        onlyIf { org.gradle.internal.os.OperatingSystem.current().isLinux }
+    }
+
+nativeTool("buildTimestampConverter", "tsconv",
+    "tools/tsconv.cpp", "cpp/cdate.cpp", "cpp/batch.cpp")
+
+/* Converts a small CSV file with `tsconv`, from the ISO date-times to another time zone and from the local ones to the
+   seconds, and compares the output to the expected one. Some fields can't be converted, so `tsconv` has to exit with
+   the status 1. */
+task("checkNativeTimestampConverter") {
+    group = "verification"
+    dependsOn("buildTimestampConverter")
+    onlyIf { !org.gradle.internal.os.OperatingSystem.current().isWindows }
+    doLast {
+        val toolsDir = "$projectDir/nativeMain/cinterop/tools"
+        val runs = mapOf(
+            "tsconv_sample_iso.csv" to listOf("-f", "Europe/Berlin", "-t", "America/New_York"),
+            "tsconv_sample_seconds.csv" to listOf("-i", "local", "-o", "s", "-f", "Europe/Berlin"))
+        for ((expected, options) in runs) {
+            val output = File("$buildDir/tools/$expected")
+            val result = exec {
+                commandLine(listOf("$buildDir/tools/tsconv", "-c", "2", "-H", "-O", output.path) + options +
+                    "$toolsDir/tsconv_sample.csv")
+                isIgnoreExitValue = true
+            }
+            if (result.exitValue != 1 || output.readText() != File("$toolsDir/$expected").readText()) {
+                throw GradleException("tsconv_sample.csv is converted into $output instead of $expected")
             }
-            out.println("};")
         }
     }
 }
+
+tasks["check"].dependsOn("checkNativeTimestampConverter")
+
+nativeSharedLibrary("buildTimeShim", "datetime_tzshim",
+    "tools/tzshim.cpp", "cpp/cdate.cpp")
+
+nativeTool("buildTimeShimCheck", "tzshim_check",
+    "tools/tzshim_check.cpp", "cpp/cdate.cpp", libraries = listOf("-ldl"))
+
+// Compares the shim to glibc, so it only runs on Linux, like the shim is only built there.
+task<Exec>("checkNativeTimeShim") {
+    group = "verification"
+    dependsOn("buildTimeShim", "buildTimeShimCheck")
+    onlyIf { org.gradle.internal.os.OperatingSystem.current().isLinux }
+    commandLine("$buildDir/tools/tzshim_check", "$buildDir/tools/libdatetime_tzshim.so")
+}
+
+tasks["check"].dependsOn("checkNativeTimeShim")
+
+nativeTool("buildTimeShimBench", "tzshim_bench", "tools/tzshim_bench.cpp")
+
+nativeBuild("buildStaticZoneCheck", "static_zone_check", listOf("tools/static_zone_check.cpp", "cpp/cdate.cpp"),
+    listOf("-I$staticZonesDir"), emptyList()).dependsOn("generateStaticZones")
+
+task<Exec>("checkNativeStaticZones") {
+    group = "verification"
+    dependsOn("buildStaticZoneCheck")
+    onlyIf { !org.gradle.internal.os.OperatingSystem.current().isWindows }
+    commandLine("$buildDir/tools/static_zone_check")
+}
+
+tasks["check"].dependsOn("checkNativeStaticZones")
+
+/* The backends from `nativeMain/cinterop/cpp/backend.hpp` implement the same functions, so the benchmark is built
+   for each of them separately. The one with <chrono> needs a compiler with the C++20 time zones. */
+nativeTool("buildBackendBenchDate", "backend_bench_date", "tools/backend_bench.cpp", "cpp/cdate.cpp")
+
+nativeBuild("buildBackendBenchChrono", "backend_bench_chrono", listOf("tools/backend_bench.cpp", "cpp/cdate.cpp"),
+    listOf("-std=c++20", "-DDATETIME_BACKEND=DATETIME_BACKEND_STD_CHRONO"), emptyList(), withDateLibrary = false)
+
+/* Checks that the hot paths of `cdate.h` don't allocate once they are warmed up. The allocations are only all
+   counted with glibc, so this is a part of `check` on Linux. `defines.hpp` can't be included here, as the standard
+   library of the host doesn't build with `__cplusplus` lowered to C++11, so the `date` library is given what it infers
+   from that instead: no `std::string_view` and no `std::uncaught_exceptions`. Otherwise, its `locate_zone` would take
+   the names without copying them, unlike in the cinterop build. */
+nativeBuild("buildAllocCheck", "alloc_check", listOf("tools/alloc_check.cpp", "cpp/cdate.cpp", "cpp/batch.cpp"),
+    listOf("-DHAS_STRING_VIEW=0", "-DHAS_UNCAUGHT_EXCEPTIONS=0"), emptyList())
+
+task<Exec>("checkNativeAllocations") {
+    group = "verification"
+    dependsOn("buildAllocCheck")
+    onlyIf { org.gradle.internal.os.OperatingSystem.current().isLinux }
+    commandLine("$buildDir/tools/alloc_check")
+}
+
+tasks["check"].dependsOn("checkNativeAllocations")
+
+/* The checks of the code in `nativeMain/cinterop/cpp` against known results: each is a tool that exits with 1 if
+   something fails, built by `build<name>Check` and run with `arguments` by `checkNative<name>`, which is a part of
+   `check`. Only the ones with `cdate.cpp` need the `date` library. */
+fun nativeCheck(name: String, toolName: String, vararg sources: String, arguments: List<String> = emptyList()) {
+    nativeBuild("build${name}Check", toolName, sources.toList(), emptyList(), emptyList(),
+        withDateLibrary = "cpp/cdate.cpp" in sources)
+    task<Exec>("checkNative$name") {
+        group = "verification"
+        dependsOn("build${name}Check")
+        onlyIf { !org.gradle.internal.os.OperatingSystem.current().isWindows }
+        commandLine(listOf("$buildDir/tools/$toolName") + arguments)
+    }
+    tasks["check"].dependsOn("checkNative$name")
+}
+
+nativeCheck("LeapSeconds", "leap_seconds_check", "tools/leap_seconds_check.cpp", "cpp/leap_seconds.cpp")
+
+nativeCheck("Business", "business_check", "tools/business_check.cpp", "cpp/business.cpp", "cpp/cdate.cpp")
+
+nativeCheck("Schedule", "schedule_check", "tools/schedule_check.cpp", "cpp/schedule.cpp", "cpp/cdate.cpp")
+
+nativeCheck("Detect", "detect_check", "tools/detect_check.cpp", "cpp/detect.cpp", "cpp/internet_dates.cpp",
+    "cpp/civil.cpp", "cpp/cdate.cpp", arguments = listOf("$projectDir/nativeMain/cinterop/tools/detect_fixtures.txt"))
+
+nativeCheck("Periods", "periods_check", "tools/periods_check.cpp", "cpp/periods.cpp")
+
+nativeCheck("ZoneCodes", "zone_codes_check", "tools/zone_codes_check.cpp", "cpp/zone_codes.cpp", "cpp/cdate.cpp")
+
+nativeCheck("FixedFormat", "fixed_format_check", "tools/fixed_format_check.cpp")
+
+nativeCheck("Packed", "packed_check", "tools/packed_check.cpp", "cpp/packed.cpp", "cpp/cdate.cpp")
+
+nativeCheck("Format", "format_check", "tools/format_check.cpp", "cpp/format.cpp", "cpp/cdate.cpp")
+
+nativeCheck("ArrowBridge", "arrow_bridge_check", "tools/arrow_bridge_check.cpp", "cpp/arrow_bridge.cpp",
+    "cpp/batch.cpp", "cpp/cdate.cpp")
+
+// Checks the evaluation of the Windows time zone rules of `windows.cpp` against the time zone database, on Linux and macOS.
+nativeCheck("WindowsRules", "windows_rules_check", "tools/windows_rules_check.cpp", "cpp/cdate.cpp",
+    arguments = listOf("$projectDir/nativeMain/cinterop/tools/windows_time_zones.reg"))
+
+// Checks and measures the snapshot cache of `windows.cpp` with a fake provider of the time zones.
+nativeCheck("SnapshotCache", "snapshot_cache_check", "tools/snapshot_cache_check.cpp")
+
+nativeCheck("InternetDates", "internet_dates_check", "tools/internet_dates_check.cpp", "cpp/internet_dates.cpp")
+
+nativeCheck("DayNumbers", "day_numbers_check", "tools/day_numbers_check.cpp", "cpp/day_numbers.cpp", "cpp/cdate.cpp")
+
+nativeCheck("Batch", "batch_check", "tools/batch_check.cpp", "cpp/batch.cpp", "cpp/cdate.cpp")
+
+nativeCheck("WindowsNames", "windows_names_check", "tools/windows_names_check.cpp", "cpp/windows_names.cpp", "cpp/cdate.cpp")
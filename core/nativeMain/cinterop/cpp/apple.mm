@@ -12,10 +12,12 @@
 #import <Foundation/NSDate.h>
 #import <Foundation/NSCalendar.h>
 #import <limits.h>
+#import <stdio.h>
 #import <vector>
 #import <set>
 #import <string>
 #include "helper_macros.hpp"
+#include "probes.hpp"
 
 static NSTimeZone * zone_by_name(NSString *zone_name)
 {
@@ -44,11 +46,13 @@ extern "C" {
 
 static std::vector<NSTimeZone *> populate()
 {
+    DATETIME_PROBE1(tzdb__load__start, 0);
     std::vector<NSTimeZone *> v;
     auto names = NSTimeZone.knownTimeZoneNames;
     for (size_t i = 0; i < names.count; ++i) {
         v.push_back([NSTimeZone timeZoneWithName: names[i]]);
     }
+    DATETIME_PROBE2(tzdb__load__done, 0, v.size());
     return v;
 }
 
@@ -83,6 +87,7 @@ extern "C" {
 
 char * get_system_timezone(TZID *tzid)
 {
+    probes::call probe(__func__, probes::no_zone, 0);
     /* The framework has its own cache of the system timezone. Calls to
     [NSTimeZone systemTimeZone] do not reflect changes to the system timezone
     and instead just return the cached value. Thus, to acquire the current
@@ -134,11 +139,12 @@ char * get_system_timezone(TZID *tzid)
     NSTimeZone *zone = [NSTimeZone systemTimeZone];
     NSString *name = [zone name];
     *tzid = id_by_name(name);
-    return strdup([name UTF8String]);
+    return probe.returns(strdup([name UTF8String]));
 }
 
 char ** available_zone_ids()
 {
+    probes::call probe(__func__, probes::no_zone, 0);
     std::set<std::string> ids;
     auto zones = NSTimeZone.knownTimeZoneNames;
     for (NSString * zone in zones) {
@@ -157,19 +163,69 @@ char ** available_zone_ids()
     for (auto it = ids.begin(); it != ids.end(); ++i, ++it) {
         zones_copy[i] = check_allocation(strdup(it->c_str()));
     }
-    return zones_copy;
+    return probe.returns(zones_copy);
 }
 
 int offset_at_instant(TZID zone_id, int64_t epoch_sec)
 {
+    probes::call probe(__func__, zone_id, epoch_sec);
     auto zone = timezone_by_id(zone_id);
-    if (zone == nil) { return INT_MAX; }
+    if (zone == nil) { return probe.returns(INT_MAX); }
     auto date = dateWithTimeIntervalSince1970Saturating(epoch_sec);
-    return (int32_t)[zone secondsFromGMTForDate: date];
+    return probe.returns((int32_t)[zone secondsFromGMTForDate: date]);
+}
+
+int offset_interval_at_instant(TZID zone_id, int64_t epoch_sec,
+    int64_t *begin, int64_t *end)
+{
+    probes::call probe(__func__, zone_id, epoch_sec);
+    auto zone = timezone_by_id(zone_id);
+    if (zone == nil) { return probe.returns(INT_MAX); }
+    auto date = dateWithTimeIntervalSince1970Saturating(epoch_sec);
+    /* Darwin can only tell when the next transition happens, so the interval
+       starts at the given instant. */
+    *begin = epoch_sec;
+    NSDate *next = [zone nextDaylightSavingTimeTransitionAfterDate: date];
+    *end = next == nil ? INT64_MAX : (int64_t)[next timeIntervalSince1970];
+    if (*end <= epoch_sec) {
+        *end = epoch_sec + 1;
+    }
+    return probe.returns((int32_t)[zone secondsFromGMTForDate: date]);
+}
+
+int abbreviation_at_instant(TZID zone_id, int64_t epoch_sec,
+    char *abbreviation, size_t size)
+{
+    probes::call probe(__func__, zone_id, epoch_sec);
+    auto zone = timezone_by_id(zone_id);
+    if (zone == nil) { return probe.returns(INT_MAX); }
+    auto date = dateWithTimeIntervalSince1970Saturating(epoch_sec);
+    const int32_t offset = (int32_t)[zone secondsFromGMTForDate: date];
+    NSString *name = [zone abbreviationForDate: date];
+    const char *utf8 = name == nil ? "" : [name UTF8String];
+    if (size == 0) { return probe.returns(offset); }
+    /* Where Darwin knows no abbreviation, it gives the offset like `GMT+1`
+       or `GMT+5:30`, which is written like the offsets on Windows are. */
+    if (strncmp(utf8, "GMT", 3) == 0 && (utf8[3] == '+' || utf8[3] == '-')) {
+        int minutes = (offset < 0 ? -offset : offset) / 60;
+        if (minutes % 60 == 0) {
+            snprintf(abbreviation, size, "%c%02d",
+                offset < 0 ? '-' : '+', minutes / 60);
+        } else {
+            snprintf(abbreviation, size, "%c%02d%02d",
+                offset < 0 ? '-' : '+', minutes / 60, minutes % 60);
+        }
+    } else {
+        strncpy(abbreviation, utf8, size - 1);
+        abbreviation[size - 1] = '\0';
+    }
+    return probe.returns(offset);
 }
 
 TZID timezone_by_name(const char *zone_name) {
-    return id_by_name([NSString stringWithUTF8String: zone_name]);
+    probes::call probe(__func__, probes::no_zone, 0);
+    return probe.returns(
+        id_by_name([NSString stringWithUTF8String: zone_name]));
 }
 
 static NSDate *system_date_by_local_date(NSTimeZone *zone, NSDate *local_date) {
@@ -189,45 +245,47 @@ static NSDate *system_date_by_local_date(NSTimeZone *zone, NSDate *local_date) {
 }
 
 int offset_at_datetime(TZID zone_id, int64_t epoch_sec, int *offset) {
+    probes::call probe(__func__, zone_id, epoch_sec);
     *offset = INT_MAX;
     // timezone
     auto zone = timezone_by_id(zone_id);
-    if (zone == nil) { return 0; }
+    if (zone == nil) { return probe.returns(0); }
     /* a date in an unspecified timezone, defined by the number of seconds since
        the start of the epoch in *that* unspecified timezone */
     NSDate *date = dateWithTimeIntervalSince1970Saturating(epoch_sec);
     NSDate *newDate = system_date_by_local_date(zone, date);
-    if (newDate == nil) { return 0; }
+    if (newDate == nil) { return probe.returns(0); }
     // we now know the offset of that timezone at this time.
     *offset = (int)[zone secondsFromGMTForDate: newDate];
     /* `dateFromComponents` automatically corrects the date to avoid gaps. We
        need to learn which adjustments it performed. */
     int result = (int)((int64_t)[newDate timeIntervalSince1970] +
       (int64_t)*offset - (int64_t)[date timeIntervalSince1970]);
-    return result;
+    return probe.returns(result);
 }
 
 int64_t at_start_of_day(TZID zone_id, int64_t epoch_sec) {
+    probes::call probe(__func__, zone_id, epoch_sec);
     // timezone
     auto zone = timezone_by_id(zone_id);
-    if (zone == nil) { return INT_MAX; }
+    if (zone == nil) { return probe.returns(INT_MAX); }
     NSDate *date = [NSDate dateWithTimeIntervalSince1970: epoch_sec];
     NSDate *newDate = system_date_by_local_date(zone, date);
-    if (newDate == nil) { return INT_MAX; }
+    if (newDate == nil) { return probe.returns(INT_MAX); }
     int offset = (int)[zone secondsFromGMTForDate: newDate];
     /* if `epoch_sec` is not in the range supported by Darwin, assume that it
        is the correct local time for the midnight and just convert it to
        the system time. */
     if ([date timeIntervalSinceDate:[NSDate distantPast]] < 0 ||
         [date timeIntervalSinceDate:[NSDate distantFuture]] > 0)
-        return epoch_sec - offset;
+        return probe.returns(epoch_sec - offset);
     // The ISO-8601 calendar.
     NSCalendar *iso8601 = [NSCalendar
         calendarWithIdentifier: NSCalendarIdentifierISO8601];
     iso8601.timeZone = zone;
     // start of the day denoted by `newDate`
     NSDate *midnight = [iso8601 startOfDayForDate: newDate];
-    return (int64_t)([midnight timeIntervalSince1970]);
+    return probe.returns((int64_t)([midnight timeIntervalSince1970]));
 }
 
 }
@@ -0,0 +1,500 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file implements the processing of Arrow columns specified in
+   `carrow.h`. The time zones are looked up with the batch functions from
+   `cdate.h`, which reuse the offsets between the neighboring timestamps.
+
+   The values are read straight from the buffers of the input columns and
+   written straight into the buffers of the output ones. Only the validity
+   bitmap is copied, as the output can't rely on the input staying alive. */
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <new>
+#include "civil.hpp"
+extern "C" {
+#include "cdate.h"
+#include "carrow.h"
+}
+
+#define MILLIS_PER_DAY (SECS_PER_DAY * 1000LL)
+#define MAX_OFFSET_SECS (18 * 3600)
+// The number of values converted at a time when a temporary buffer is needed.
+#define CHUNK_SIZE 512
+
+enum column_type {
+    COLUMN_TIMESTAMP,
+    COLUMN_DATE32,
+    COLUMN_DATE64,
+};
+
+// An input column, with the offset of the array already applied.
+struct column {
+    column_type type;
+    // only for timestamps.
+    TIME_UNIT unit;
+    int64_t per_second;
+    // the time zone of a timestamp column, or null.
+    const char *timezone;
+    int64_t length;
+    int64_t null_count;
+    // the bitmap may be null if there are no nulls.
+    const uint8_t *validity;
+    int64_t validity_offset;
+    const void *values;
+};
+
+/* The time zone of a column: either an id from `cdate.h` or, if it is
+   TZID_INVALID, a fixed offset. */
+struct zone {
+    TZID id = TZID_INVALID;
+    int fixed_offset = 0;
+};
+
+static bool parse_column(const ArrowSchema *schema, const ArrowArray *array,
+    column& result)
+{
+    if (schema == nullptr || array == nullptr || schema->format == nullptr ||
+        array->release == nullptr || array->n_buffers != 2 ||
+        array->buffers[1] == nullptr)
+        return false;
+    const char *format = schema->format;
+    size_t value_size;
+    result.timezone = nullptr;
+    if (strcmp(format, "tdD") == 0) {
+        result.type = COLUMN_DATE32;
+        value_size = sizeof(int32_t);
+    } else if (strcmp(format, "tdm") == 0) {
+        result.type = COLUMN_DATE64;
+        value_size = sizeof(int64_t);
+    } else if (strncmp(format, "ts", 2) == 0 && format[2] != '\0' &&
+        format[3] == ':')
+    {
+        result.type = COLUMN_TIMESTAMP;
+        value_size = sizeof(int64_t);
+        switch (format[2]) {
+            case 's':
+                result.unit = TIME_UNIT_SECOND;
+                result.per_second = 1;
+                break;
+            case 'm':
+                result.unit = TIME_UNIT_MILLISECOND;
+                result.per_second = 1000;
+                break;
+            case 'u':
+                result.unit = TIME_UNIT_MICROSECOND;
+                result.per_second = 1000000;
+                break;
+            case 'n':
+                result.unit = TIME_UNIT_NANOSECOND;
+                result.per_second = 1000000000;
+                break;
+            default:
+                return false;
+        }
+        result.timezone = format[4] == '\0' ? nullptr : format + 4;
+    } else {
+        return false;
+    }
+    result.length = array->length;
+    result.null_count = array->null_count;
+    result.validity = (const uint8_t *)array->buffers[0];
+    result.validity_offset = array->offset;
+    result.values = (const char *)array->buffers[1] + array->offset * value_size;
+    return true;
+}
+
+/* Parses a time zone name or an offset in the format `+HH:MM`, as accepted
+   by Arrow. */
+static bool resolve_zone(const char *name, zone& result) {
+    if (strcmp(name, "UTC") == 0) {
+        result.fixed_offset = 0;
+        return true;
+    }
+    if (name[0] == '+' || name[0] == '-') {
+        const char *p = name + 1;
+        if (strlen(p) != 5 || p[2] != ':')
+            return false;
+        for (int i : {0, 1, 3, 4}) {
+            if (p[i] < '0' || p[i] > '9')
+                return false;
+        }
+        const int hours = (p[0] - '0') * 10 + (p[1] - '0');
+        const int minutes = (p[3] - '0') * 10 + (p[4] - '0');
+        const int offset = hours * 3600 + minutes * 60;
+        if (minutes >= 60 || offset > MAX_OFFSET_SECS)
+            return false;
+        result.fixed_offset = name[0] == '-' ? -offset : offset;
+        return true;
+    }
+    result.id = timezone_by_name(name);
+    return result.id != TZID_INVALID;
+}
+
+static int64_t shift(int64_t value, int64_t by) {
+    int64_t result;
+    if (__builtin_add_overflow(value, by, &result))
+        return by < 0 ? INT64_MIN : INT64_MAX;
+    return result;
+}
+
+// Converts the instants to the local date-times in place.
+static bool to_local(const zone& zone, const column& column,
+    int64_t *values, size_t count)
+{
+    if (zone.id != TZID_INVALID)
+        return instants_to_local_times(
+            zone.id, column.unit, values, values, count) == 0;
+    const int64_t by = zone.fixed_offset * column.per_second;
+    for (size_t i = 0; i < count; ++i)
+        values[i] = shift(values[i], by);
+    return true;
+}
+
+// Converts the local date-times to the instants in place.
+static bool from_local(const zone& zone, const column& column,
+    int64_t *values, size_t count)
+{
+    if (zone.id != TZID_INVALID)
+        return local_times_to_instants(
+            zone.id, column.unit, values, values, count) == 0;
+    const int64_t by = -zone.fixed_offset * column.per_second;
+    for (size_t i = 0; i < count; ++i)
+        values[i] = shift(values[i], by);
+    return true;
+}
+
+/* Copies the `count` values at `i` of the column into `values`, converting
+   them to local date-times in the units of the column, or in milliseconds
+   for dates. */
+static bool read_local(const column& column, const zone *zone, int64_t i,
+    int64_t *values, size_t count)
+{
+    switch (column.type) {
+        case COLUMN_DATE32: {
+            const int32_t *days = (const int32_t *)column.values + i;
+            for (size_t j = 0; j < count; ++j)
+                values[j] = days[j] * MILLIS_PER_DAY;
+            return true;
+        }
+        case COLUMN_DATE64:
+        case COLUMN_TIMESTAMP:
+            memcpy(values, (const int64_t *)column.values + i,
+                count * sizeof(int64_t));
+            return zone == nullptr || to_local(*zone, column, values, count);
+    }
+    return false;
+}
+
+static int64_t units_per_second(const column& column) {
+    return column.type == COLUMN_TIMESTAMP ? column.per_second : 1000;
+}
+
+static int32_t extract(int64_t local, int64_t per_second, CIVIL_FIELD field) {
+    const int64_t epoch_sec = civil::floor_div(local, per_second);
+    const int64_t epoch_day = civil::floor_div(epoch_sec, SECS_PER_DAY);
+    const int64_t second_of_day = epoch_sec - epoch_day * SECS_PER_DAY;
+    int64_t year;
+    int month, day;
+    switch (field) {
+        case CIVIL_FIELD_YEAR:
+            civil::civil_from_days(epoch_day, year, month, day);
+            return (int32_t)year;
+        case CIVIL_FIELD_MONTH:
+            civil::civil_from_days(epoch_day, year, month, day);
+            return month;
+        case CIVIL_FIELD_DAY:
+            civil::civil_from_days(epoch_day, year, month, day);
+            return day;
+        case CIVIL_FIELD_HOUR:
+            return (int32_t)(second_of_day / 3600);
+        case CIVIL_FIELD_MINUTE:
+            return (int32_t)(second_of_day / 60 % 60);
+        case CIVIL_FIELD_SECOND:
+            return (int32_t)(second_of_day % 60);
+        case CIVIL_FIELD_ISO_DAY_OF_WEEK:
+            return civil::iso_day_of_week(epoch_day);
+        case CIVIL_FIELD_DAY_OF_YEAR:
+            civil::civil_from_days(epoch_day, year, month, day);
+            return civil::day_of_year(year, month, day);
+    }
+    return 0;
+}
+
+static int64_t truncate(int64_t local, int64_t per_second, CIVIL_FIELD field) {
+    const int64_t epoch_sec = civil::floor_div(local, per_second);
+    const int64_t epoch_day = civil::floor_div(epoch_sec, SECS_PER_DAY);
+    const int64_t second_of_day = epoch_sec - epoch_day * SECS_PER_DAY;
+    int64_t year;
+    int month, day;
+    int64_t result_sec;
+    switch (field) {
+        case CIVIL_FIELD_YEAR:
+            civil::civil_from_days(epoch_day, year, month, day);
+            result_sec = civil::days_from_civil(year, 1, 1) * SECS_PER_DAY;
+            break;
+        case CIVIL_FIELD_MONTH:
+            civil::civil_from_days(epoch_day, year, month, day);
+            result_sec = civil::days_from_civil(year, month, 1) * SECS_PER_DAY;
+            break;
+        case CIVIL_FIELD_DAY:
+            result_sec = epoch_day * SECS_PER_DAY;
+            break;
+        case CIVIL_FIELD_HOUR:
+            result_sec = epoch_sec - second_of_day % 3600;
+            break;
+        case CIVIL_FIELD_MINUTE:
+            result_sec = epoch_sec - second_of_day % 60;
+            break;
+        default:
+            result_sec = epoch_sec;
+            break;
+    }
+    /* The start of the year of the smallest timestamp in nanoseconds doesn't
+       fit into them. */
+    int64_t result;
+    if (__builtin_mul_overflow(result_sec, per_second, &result))
+        return INT64_MIN;
+    return result;
+}
+
+// The output column, along with the buffers it owns.
+struct output {
+    char *format = nullptr;
+    void *validity = nullptr;
+    void *values = nullptr;
+    const void *buffers[2] = {nullptr, nullptr};
+
+    ~output() {
+        free(format);
+        free(validity);
+        free(values);
+    }
+};
+
+static void release_schema(ArrowSchema *schema) {
+    free((void *)schema->format);
+    schema->release = nullptr;
+}
+
+static void release_array(ArrowArray *array) {
+    delete (output *)array->private_data;
+    array->release = nullptr;
+}
+
+/* Allocates the output column with the given format, or `prefix` followed by
+   `timezone`, copying the validity bitmap of the input column. */
+static output * create_output(const column& column, const char *prefix,
+    const char *timezone, size_t value_size)
+{
+    auto result = new (std::nothrow) output();
+    if (result == nullptr)
+        return nullptr;
+    const size_t prefix_length = strlen(prefix);
+    const size_t timezone_length = timezone == nullptr ? 0 : strlen(timezone);
+    result->format = (char *)malloc(prefix_length + timezone_length + 1);
+    // `malloc(0)` may return null.
+    result->values = malloc(column.length == 0 ? 1 : column.length * value_size);
+    if (result->format == nullptr || result->values == nullptr) {
+        delete result;
+        return nullptr;
+    }
+    memcpy(result->format, prefix, prefix_length);
+    if (timezone_length != 0)
+        memcpy(result->format + prefix_length, timezone, timezone_length);
+    result->format[prefix_length + timezone_length] = '\0';
+    if (column.validity != nullptr && column.null_count != 0) {
+        const size_t bytes = (size_t)(column.length + 7) / 8;
+        auto validity = (uint8_t *)calloc(bytes == 0 ? 1 : bytes, 1);
+        if (validity == nullptr) {
+            delete result;
+            return nullptr;
+        }
+        const int64_t from = column.validity_offset;
+        if (from % 8 == 0) {
+            memcpy(validity, column.validity + from / 8, bytes);
+        } else {
+            for (int64_t i = 0; i < column.length; ++i) {
+                const int64_t bit = from + i;
+                if (column.validity[bit / 8] >> (bit % 8) & 1)
+                    validity[i / 8] |= (uint8_t)(1 << (i % 8));
+            }
+        }
+        result->validity = validity;
+    }
+    result->buffers[0] = result->validity;
+    result->buffers[1] = result->values;
+    return result;
+}
+
+// Moves the output column into the Arrow structures.
+static void export_output(const column& column, output *data,
+    ArrowSchema *out_schema, ArrowArray *out_array)
+{
+    *out_schema = ArrowSchema();
+    out_schema->format = data->format;
+    // the format is now owned by the schema.
+    data->format = nullptr;
+    out_schema->name = "";
+    out_schema->flags = ARROW_FLAG_NULLABLE;
+    out_schema->release = release_schema;
+    *out_array = ArrowArray();
+    out_array->length = column.length;
+    out_array->null_count = data->validity == nullptr ? 0 : column.null_count;
+    out_array->n_buffers = 2;
+    out_array->buffers = data->buffers;
+    out_array->release = release_array;
+    out_array->private_data = data;
+}
+
+// The format of a timestamp column without the time zone.
+static const char * timestamp_prefix(const column& column) {
+    switch (column.unit) {
+        case TIME_UNIT_SECOND:
+            return "tss:";
+        case TIME_UNIT_MILLISECOND:
+            return "tsm:";
+        case TIME_UNIT_MICROSECOND:
+            return "tsu:";
+        default:
+            return "tsn:";
+    }
+}
+
+static bool is_field(CIVIL_FIELD field) {
+    return field >= CIVIL_FIELD_YEAR && field <= CIVIL_FIELD_DAY_OF_YEAR;
+}
+
+extern "C" {
+
+int arrow_timestamps_to_local(
+    const struct ArrowSchema *schema, const struct ArrowArray *array,
+    struct ArrowSchema *out_schema, struct ArrowArray *out_array)
+{
+    column input;
+    zone zone;
+    if (!parse_column(schema, array, input) ||
+        input.type != COLUMN_TIMESTAMP || input.timezone == nullptr ||
+        !resolve_zone(input.timezone, zone))
+        return -1;
+    output *data = create_output(
+        input, timestamp_prefix(input), nullptr, sizeof(int64_t));
+    if (data == nullptr)
+        return -1;
+    auto values = (int64_t *)data->values;
+    memcpy(values, input.values, input.length * sizeof(int64_t));
+    if (!to_local(zone, input, values, input.length)) {
+        delete data;
+        return -1;
+    }
+    export_output(input, data, out_schema, out_array);
+    return 0;
+}
+
+int arrow_timestamps_from_local(
+    const struct ArrowSchema *schema, const struct ArrowArray *array,
+    const char *timezone,
+    struct ArrowSchema *out_schema, struct ArrowArray *out_array)
+{
+    column input;
+    zone zone;
+    if (!parse_column(schema, array, input) ||
+        input.type != COLUMN_TIMESTAMP || input.timezone != nullptr ||
+        timezone == nullptr || !resolve_zone(timezone, zone))
+        return -1;
+    output *data = create_output(
+        input, timestamp_prefix(input), timezone, sizeof(int64_t));
+    if (data == nullptr)
+        return -1;
+    auto values = (int64_t *)data->values;
+    memcpy(values, input.values, input.length * sizeof(int64_t));
+    if (!from_local(zone, input, values, input.length)) {
+        delete data;
+        return -1;
+    }
+    export_output(input, data, out_schema, out_array);
+    return 0;
+}
+
+int arrow_truncate_timestamps(
+    const struct ArrowSchema *schema, const struct ArrowArray *array,
+    enum CIVIL_FIELD field,
+    struct ArrowSchema *out_schema, struct ArrowArray *out_array)
+{
+    column input;
+    zone zone;
+    if (!parse_column(schema, array, input) ||
+        field > CIVIL_FIELD_SECOND || field < CIVIL_FIELD_YEAR ||
+        (input.timezone != nullptr && !resolve_zone(input.timezone, zone)))
+        return -1;
+    const bool is_date32 = input.type == COLUMN_DATE32;
+    output *data = create_output(input, schema->format, nullptr,
+        is_date32 ? sizeof(int32_t) : sizeof(int64_t));
+    if (data == nullptr)
+        return -1;
+    const int64_t per_second = units_per_second(input);
+    const struct zone *local_zone = input.timezone == nullptr ? nullptr : &zone;
+    int64_t chunk[CHUNK_SIZE];
+    for (int64_t i = 0; i < input.length; i += CHUNK_SIZE) {
+        const size_t count = (size_t)(input.length - i < CHUNK_SIZE ?
+            input.length - i : CHUNK_SIZE);
+        /* The 64-bit columns are processed directly in the output buffer, and
+           the dates of `date32` only go through the chunk. */
+        int64_t *values = is_date32 ? chunk : (int64_t *)data->values + i;
+        if (!read_local(input, local_zone, i, values, count)) {
+            delete data;
+            return -1;
+        }
+        for (size_t j = 0; j < count; ++j)
+            values[j] = truncate(values[j], per_second, field);
+        if (local_zone != nullptr &&
+            !from_local(*local_zone, input, values, count))
+        {
+            delete data;
+            return -1;
+        }
+        if (is_date32) {
+            auto days = (int32_t *)data->values + i;
+            for (size_t j = 0; j < count; ++j)
+                days[j] = (int32_t)(values[j] / MILLIS_PER_DAY);
+        }
+    }
+    export_output(input, data, out_schema, out_array);
+    return 0;
+}
+
+int arrow_extract_field(
+    const struct ArrowSchema *schema, const struct ArrowArray *array,
+    enum CIVIL_FIELD field,
+    struct ArrowSchema *out_schema, struct ArrowArray *out_array)
+{
+    column input;
+    zone zone;
+    if (!parse_column(schema, array, input) || !is_field(field) ||
+        (input.timezone != nullptr && !resolve_zone(input.timezone, zone)))
+        return -1;
+    output *data = create_output(input, "i", nullptr, sizeof(int32_t));
+    if (data == nullptr)
+        return -1;
+    const int64_t per_second = units_per_second(input);
+    const struct zone *local_zone = input.timezone == nullptr ? nullptr : &zone;
+    int64_t chunk[CHUNK_SIZE];
+    for (int64_t i = 0; i < input.length; i += CHUNK_SIZE) {
+        const size_t count = (size_t)(input.length - i < CHUNK_SIZE ?
+            input.length - i : CHUNK_SIZE);
+        if (!read_local(input, local_zone, i, chunk, count)) {
+            delete data;
+            return -1;
+        }
+        auto fields = (int32_t *)data->values + i;
+        for (size_t j = 0; j < count; ++j)
+            fields[j] = extract(chunk[j], per_second, field);
+    }
+    export_output(input, data, out_schema, out_array);
+    return 0;
+}
+
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file selects the implementation of the time zone database that
+   `cdate.cpp` is built on, with the `DATETIME_BACKEND` macro:
+
+   * `DATETIME_BACKEND_DATE`, the default: the `date` library, which
+     implements the C++20 API on top of C++11;
+   * `DATETIME_BACKEND_STD_CHRONO`: `<chrono>` itself, which needs C++20 and
+     a standard library that supports its time zones, like libstdc++ 14.
+
+   Either way, the API is available through the namespace `tz_backend`:
+   `get_tzdb()`, the `tzdb` with its `zones`, `locate_zone` and
+   `current_zone`, and `time_zone::get_info` for both `sys_time` and
+   `local_time`, with `sys_info` and `local_info`. Another backend, for
+   example one based on the tables compiled with `static_zone.hpp`, only
+   needs to provide a namespace with the same things and a new value of the
+   macro here. The tool `backend_bench.cpp` measures `cdate.h` with each of
+   them. */
+#pragma once
+
+#define DATETIME_BACKEND_DATE 1
+#define DATETIME_BACKEND_STD_CHRONO 2
+
+#ifndef DATETIME_BACKEND
+    #define DATETIME_BACKEND DATETIME_BACKEND_DATE
+#endif
+
+#if DATETIME_BACKEND == DATETIME_BACKEND_DATE
+    #include "date/date.h"
+    #include "date/tz.h"
+    namespace tz_backend = date;
+    #define DATETIME_BACKEND_NAME "date"
+#elif DATETIME_BACKEND == DATETIME_BACKEND_STD_CHRONO
+    #include <chrono>
+    #if !defined(__cpp_lib_chrono) || __cpp_lib_chrono < 201907L
+        #error "The standard library doesn't support the time zones of C++20"
+    #endif
+    namespace tz_backend = std::chrono;
+    #define DATETIME_BACKEND_NAME "std::chrono"
+#else
+    #error "Unknown DATETIME_BACKEND"
+#endif
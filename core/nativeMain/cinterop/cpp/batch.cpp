@@ -0,0 +1,110 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file implements the batch functions specified in `cdate.h`.
+
+   Time zone transitions are rare, so most neighboring timestamps share the
+   same offset. The functions are thin wrappers over the cursors from
+   `time_zone.hpp`, which only call into the platform implementation when a
+   timestamp falls outside of the range where the last looked up offset is
+   known to apply. */
+#include <climits>
+#include "civil.hpp"
+#include "time_zone.hpp"
+#include "probes.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+// The number of the given units in a second, or 0 if the unit is unknown.
+static int64_t units_per_second(TIME_UNIT unit) {
+    switch (unit) {
+        case TIME_UNIT_SECOND:
+            return 1;
+        case TIME_UNIT_MILLISECOND:
+            return 1000;
+        case TIME_UNIT_MICROSECOND:
+            return 1000000;
+        case TIME_UNIT_NANOSECOND:
+            return 1000000000;
+        default:
+            return 0;
+    }
+}
+
+/* Returns `seconds * per_second + rest`, saturated to the range of
+   `int64_t`. `rest` is in [0; per_second). */
+static int64_t to_units(int64_t seconds, int64_t per_second, int64_t rest) {
+    /* A negative product can overflow even if the sum fits, as with the
+       seconds of INT64_MIN nanoseconds, so it is taken one second closer to
+       zero, and the rest becomes negative. */
+    if (seconds < 0) {
+        ++seconds;
+        rest -= per_second;
+    }
+    int64_t result;
+    if (__builtin_mul_overflow(seconds, per_second, &result) ||
+        __builtin_add_overflow(result, rest, &result))
+        return seconds < 0 ? INT64_MIN : INT64_MAX;
+    return result;
+}
+
+extern "C" {
+
+int offsets_at_instants(TZID zone, enum TIME_UNIT unit,
+    const int64_t *instants, int *offsets, size_t count)
+{
+    probes::call probe(__func__, zone, count);
+    const int64_t per_second = units_per_second(unit);
+    if (per_second == 0)
+        return probe.returns(-1);
+    zones::cursor cursor(zones::zone::region(zone));
+    for (size_t i = 0; i < count; ++i) {
+        offsets[i] =
+            cursor.offset_at(civil::floor_div(instants[i], per_second));
+        if (offsets[i] == INT_MAX)
+            return probe.returns(-1);
+    }
+    return probe.returns(0);
+}
+
+int instants_to_local_times(TZID zone, enum TIME_UNIT unit,
+    const int64_t *instants, int64_t *local_times, size_t count)
+{
+    probes::call probe(__func__, zone, count);
+    const int64_t per_second = units_per_second(unit);
+    if (per_second == 0)
+        return probe.returns(-1);
+    zones::cursor cursor(zones::zone::region(zone));
+    for (size_t i = 0; i < count; ++i) {
+        const int64_t epoch_sec = civil::floor_div(instants[i], per_second);
+        int64_t local_sec;
+        if (!cursor.to_local(epoch_sec, local_sec))
+            return probe.returns(-1);
+        local_times[i] = to_units(local_sec, per_second,
+            civil::floor_mod(instants[i], per_second));
+    }
+    return probe.returns(0);
+}
+
+int local_times_to_instants(TZID zone, enum TIME_UNIT unit,
+    const int64_t *local_times, int64_t *instants, size_t count)
+{
+    probes::call probe(__func__, zone, count);
+    const int64_t per_second = units_per_second(unit);
+    if (per_second == 0)
+        return probe.returns(-1);
+    zones::cursor cursor(zones::zone::region(zone));
+    for (size_t i = 0; i < count; ++i) {
+        const int64_t local_sec = civil::floor_div(local_times[i], per_second);
+        int64_t epoch_sec;
+        if (!cursor.to_instant(local_sec, epoch_sec))
+            return probe.returns(-1);
+        instants[i] = to_units(epoch_sec, per_second,
+            civil::floor_mod(local_times[i], per_second));
+    }
+    return probe.returns(0);
+}
+
+}
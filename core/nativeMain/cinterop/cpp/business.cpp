@@ -0,0 +1,274 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file implements the business-day calendars specified in `cdate.h`.
+
+   The days of the week that are business days repeat every week, so the
+   number of them in any range of days is computed directly. Holidays are
+   stored as per-year bitsets over the days of the year, where only the
+   holidays that fall on otherwise business days are recorded, so that the
+   number of business days in a range is the number of working weekdays in
+   it minus the population count of the holiday bits in it. */
+#include <cstdio>
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <new>
+#include "civil.hpp"
+#include "helper_macros.hpp"
+#include "probes.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+// The number of 64-bit words needed to hold a bit per day of the longest year.
+#define WORDS_PER_YEAR 6
+
+struct holiday_year {
+    uint64_t bits[WORDS_PER_YEAR];
+};
+
+struct BUSINESS_CALENDAR {
+    // bit `n` is set if ISO day of week `n + 1` is a working day.
+    unsigned int working_weekdays;
+    // the same bits, repeated twice, to avoid wrapping around a week.
+    unsigned int working_fortnight;
+    // the number of working days in a week, never zero.
+    int64_t working_per_week;
+    int open_sec;
+    int close_sec;
+    // holiday bitsets, keyed by the epoch day of January 1 of their year.
+    std::map<int64_t, holiday_year> holidays;
+};
+
+static const int64_t min_holiday_day = civil::days_from_civil(-32767, 1, 1);
+static const int64_t max_holiday_day = civil::days_from_civil(32767, 12, 31);
+
+// ISO day of week minus one, so that Monday is 0.
+static unsigned int weekday_index(int64_t epoch_day) {
+    return (unsigned int)civil::iso_day_of_week(epoch_day) - 1;
+}
+
+static bool is_working_weekday(const BUSINESS_CALENDAR& cal, int64_t day) {
+    return (cal.working_weekdays >> weekday_index(day)) & 1;
+}
+
+// The number of working weekdays in [from; to), `from <= to`.
+static int64_t working_weekdays_between(
+    const BUSINESS_CALENDAR& cal, int64_t from, int64_t to)
+{
+    const int64_t length = to - from;
+    const unsigned int rest = (unsigned int)(length % 7);
+    const unsigned int rest_bits = (cal.working_fortnight >>
+        weekday_index(from)) & ((1u << rest) - 1);
+    return length / 7 * cal.working_per_week + __builtin_popcount(rest_bits);
+}
+
+// The number of bits set in [lo; hi) of a holiday year, `lo < hi`.
+static int64_t count_bits(const holiday_year& year, int64_t lo, int64_t hi) {
+    int64_t result = 0;
+    for (int64_t word = lo / 64; word <= (hi - 1) / 64; ++word) {
+        uint64_t bits = year.bits[word];
+        const int64_t start = word * 64;
+        if (lo > start)
+            bits &= ~uint64_t(0) << (lo - start);
+        if (hi < start + 64)
+            bits &= ~(~uint64_t(0) << (hi - start));
+        result += __builtin_popcountll(bits);
+    }
+    return result;
+}
+
+// The number of holidays in [from; to), `from <= to`.
+static int64_t holidays_between(
+    const BUSINESS_CALENDAR& cal, int64_t from, int64_t to)
+{
+    int64_t result = 0;
+    auto it = cal.holidays.upper_bound(from);
+    if (it != cal.holidays.begin())
+        --it;
+    for (; it != cal.holidays.end() && it->first < to; ++it) {
+        const int64_t lo = std::max(from, it->first) - it->first;
+        const int64_t hi = std::min(to, it->first + 366) - it->first;
+        if (lo < hi)
+            result += count_bits(it->second, lo, hi);
+    }
+    return result;
+}
+
+/* Returns the day `x` such that there are exactly `n` working weekdays in
+   (day; x], with `x` being one of them, for positive `n`, or the day `x`
+   such that there are exactly `-n` working weekdays in [x; day), with `x`
+   being one of them, for negative `n`. If `x` doesn't fit into `int64_t`,
+   returns INT64_MAX or INT64_MIN. */
+static int64_t skip_working_weekdays(
+    const BUSINESS_CALENDAR& cal, int64_t day, int64_t n)
+{
+    const int64_t step = n > 0 ? 1 : -1;
+    const int64_t end = n > 0 ? INT64_MAX : INT64_MIN;
+    // -INT64_MIN doesn't fit into `int64_t`.
+    uint64_t left = n > 0 ? (uint64_t)n : 0 - (uint64_t)n;
+    const uint64_t full_weeks = (left - 1) / (uint64_t)cal.working_per_week;
+    if (full_weeks > (uint64_t)INT64_MAX / 7 ||
+        __builtin_add_overflow(day, (int64_t)full_weeks * 7 * step, &day))
+        return end;
+    left -= full_weeks * (uint64_t)cal.working_per_week;
+    while (day != end) {
+        day += step;
+        if (is_working_weekday(cal, day) && --left == 0)
+            return day;
+    }
+    return end;
+}
+
+extern "C" {
+
+BUSINESS_CALENDAR * business_calendar_create(unsigned int weekend_mask)
+{
+    probes::call probe(__func__, probes::no_zone, 0);
+    const unsigned int working = ~weekend_mask & 0x7f;
+    if (working == 0)
+        return probe.returns(nullptr);
+    auto calendar = check_allocation(new (std::nothrow) BUSINESS_CALENDAR());
+    calendar->working_weekdays = working;
+    calendar->working_fortnight = working | (working << 7);
+    calendar->working_per_week = __builtin_popcount(working);
+    calendar->open_sec = 0;
+    calendar->close_sec = SECS_PER_DAY;
+    return probe.returns(calendar);
+}
+
+void business_calendar_free(BUSINESS_CALENDAR *calendar)
+{
+    probes::call probe(__func__, probes::no_zone, 0);
+    delete calendar;
+}
+
+int business_calendar_add_holidays(BUSINESS_CALENDAR *calendar,
+    const int64_t *epoch_days, size_t count)
+{
+    probes::call probe(__func__, probes::no_zone, count);
+    for (size_t i = 0; i < count; ++i) {
+        const int64_t day = epoch_days[i];
+        if (day < min_holiday_day || day > max_holiday_day)
+            return probe.returns(-1);
+        // holidays on weekends don't change anything.
+        if (!is_working_weekday(*calendar, day))
+            continue;
+        int64_t year_number;
+        int month, day_of_month;
+        civil::civil_from_days(day, year_number, month, day_of_month);
+        const int64_t january_first = civil::days_from_civil(year_number, 1, 1);
+        const int64_t day_of_year = day - january_first;
+        auto& year = calendar->holidays[january_first];
+        year.bits[day_of_year / 64] |= uint64_t(1) << (day_of_year % 64);
+    }
+    return probe.returns(0);
+}
+
+int business_calendar_set_hours(BUSINESS_CALENDAR *calendar,
+    int open_sec, int close_sec)
+{
+    probes::call probe(__func__, probes::no_zone, 0);
+    if (open_sec < 0 || open_sec >= close_sec || close_sec > SECS_PER_DAY)
+        return probe.returns(-1);
+    calendar->open_sec = open_sec;
+    calendar->close_sec = close_sec;
+    return probe.returns(0);
+}
+
+int is_business_day(const BUSINESS_CALENDAR *calendar, int64_t epoch_day)
+{
+    probes::call probe(__func__, probes::no_zone, epoch_day);
+    return probe.returns(is_working_weekday(*calendar, epoch_day) &&
+        holidays_between(*calendar, epoch_day, epoch_day + 1) == 0);
+}
+
+int64_t business_days_between(const BUSINESS_CALENDAR *calendar,
+    int64_t from_day, int64_t to_day)
+{
+    probes::call probe(__func__, probes::no_zone, from_day);
+    if (to_day < from_day)
+        return probe.returns(
+            -business_days_between(calendar, to_day, from_day));
+    return probe.returns(working_weekdays_between(*calendar, from_day, to_day) -
+        holidays_between(*calendar, from_day, to_day));
+}
+
+int64_t add_business_days(const BUSINESS_CALENDAR *calendar,
+    int64_t epoch_day, int64_t n)
+{
+    probes::call probe(__func__, probes::no_zone, epoch_day);
+    /* First, skip the working weekdays as if there were no holidays. Then,
+       for every holiday that was skipped along the way, skip one more day,
+       and so on until no holidays are skipped. */
+    while (n != 0) {
+        const int64_t next = skip_working_weekdays(*calendar, epoch_day, n);
+        if (next == INT64_MAX || next == INT64_MIN)
+            return probe.returns(next);
+        n = n > 0 ?
+            holidays_between(*calendar, epoch_day + 1, next + 1) :
+            -holidays_between(*calendar, next, epoch_day);
+        epoch_day = next;
+    }
+    return probe.returns(epoch_day);
+}
+
+int is_business_instant(const BUSINESS_CALENDAR *calendar, TZID zone,
+    int64_t epoch_sec)
+{
+    probes::call probe(__func__, zone, epoch_sec);
+    const int offset = offset_at_instant(zone, epoch_sec);
+    if (offset == INT_MAX)
+        return probe.returns(-1);
+    const int64_t local = civil::saturating_add(epoch_sec, offset);
+    const int64_t day = civil::floor_div(local, SECS_PER_DAY);
+    const int64_t second_of_day = civil::floor_mod(local, SECS_PER_DAY);
+    return probe.returns(second_of_day >= calendar->open_sec &&
+        second_of_day < calendar->close_sec &&
+        is_business_day(calendar, day));
+}
+
+/* The business time that passed on the given day by the given moment of it,
+   if the day is a business day. */
+static int64_t business_seconds_by(
+    const BUSINESS_CALENDAR& cal, int64_t day, int64_t second_of_day)
+{
+    if (!is_business_day(&cal, day))
+        return 0;
+    const int64_t passed = second_of_day - cal.open_sec;
+    return std::max(int64_t(0),
+        std::min(passed, int64_t(cal.close_sec - cal.open_sec)));
+}
+
+int64_t business_seconds_between(const BUSINESS_CALENDAR *calendar,
+    TZID zone, int64_t from_sec, int64_t to_sec)
+{
+    probes::call probe(__func__, zone, from_sec);
+    if (to_sec < from_sec) {
+        const int64_t result =
+            business_seconds_between(calendar, zone, to_sec, from_sec);
+        return probe.returns(result == INT64_MAX ? result : -result);
+    }
+    const int from_offset = offset_at_instant(zone, from_sec);
+    const int to_offset = offset_at_instant(zone, to_sec);
+    if (from_offset == INT_MAX || to_offset == INT_MAX)
+        return probe.returns(INT64_MAX);
+    const int64_t from_local = civil::saturating_add(from_sec, from_offset);
+    const int64_t to_local = civil::saturating_add(to_sec, to_offset);
+    const int64_t from_day = civil::floor_div(from_local, SECS_PER_DAY);
+    const int64_t to_day = civil::floor_div(to_local, SECS_PER_DAY);
+    const int64_t result =
+        business_days_between(calendar, from_day, to_day) *
+            (calendar->close_sec - calendar->open_sec) +
+        business_seconds_by(*calendar, to_day,
+            civil::floor_mod(to_local, SECS_PER_DAY)) -
+        business_seconds_by(*calendar, from_day,
+            civil::floor_mod(from_local, SECS_PER_DAY));
+    /* The local time could go back during a transition between the two
+       instants; no business time passes then. */
+    return probe.returns(std::max(int64_t(0), result));
+}
+
+}
@@ -3,17 +3,22 @@
  * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
  */
 /* This file implements the functions specified in `cdate.h` using the C++20
-   chrono API. Since this is not yet widely supported, it relies on the `date`
-   library. This implementation is used for MacOS and Linux, but once <chrono>
-   is available for all the target platforms, the dependency on `date` can be
-   removed along with the neighboring implementations. */
+   chrono API. Since this is not yet widely supported, by default it relies on
+   the `date` library, but it can also be built with <chrono> itself: see
+   `backend.hpp`. This implementation is used for MacOS and Linux, but once
+   <chrono> is available for all the target platforms, the dependency on
+   `date` can be removed along with the neighboring implementations. */
 #if !TARGET_OS_IPHONE
 #if !DATETIME_TARGET_WIN32
-#include "date/date.h"
-#include "date/tz.h"
+#include "backend.hpp"
 #include "helper_macros.hpp"
+#include "probes.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cstring>
-using namespace date;
+#include <string>
+#include <vector>
+using namespace tz_backend;
 using namespace std::chrono;
 
 static int64_t first_instant_of_year(const year& yr) {
@@ -49,9 +54,35 @@ extern "C" {
 template <class T>
 static char * timezone_name(const T& zone)
 {
-    return strdup(zone.name().c_str());
+    // `std::string` in the `date` library, `std::string_view` in <chrono>.
+    const std::string name(zone.name());
+    return strdup(name.c_str());
 }
 
+// `get_tzdb()`, with the probes around its first call, which loads it.
+static const tzdb& database()
+{
+    static const tzdb& result = [] () -> const tzdb& {
+        DATETIME_PROBE1(tzdb__load__start, 0);
+        const tzdb& loaded = get_tzdb();
+        DATETIME_PROBE2(tzdb__load__done, 0, loaded.zones.size());
+        return loaded;
+    }();
+    return result;
+}
+
+#if DATETIME_PROBES
+// Fires `zone__init` the first time that each time zone is used.
+static void zone_used(TZID id, const time_zone& zone)
+{
+    static std::vector<std::atomic<bool>> used(database().zones.size());
+    if (used[id].load(std::memory_order_relaxed) || used[id].exchange(true))
+        return;
+    const std::string name(zone.name());
+    DATETIME_PROBE2(zone__init, id, name.c_str());
+}
+#endif
+
 static const time_zone *zone_by_id(TZID id)
 {
     /* The `date` library provides a linked list of `tzdb` objects. `get_tzdb()`
@@ -62,14 +93,37 @@ static const time_zone *zone_by_id(TZID id)
        uses the system timezone database. If we move to C++20 support for this,
        it may be feasible to call `reload_tzdb()` and construct a more elaborate
        ID scheme. */
-    auto& tzdb = get_tzdb();
+    auto& tzdb = database();
     try {
-        return &tzdb.zones.at(id);
+        const time_zone *zone = &tzdb.zones.at(id);
+#if DATETIME_PROBES
+        zone_used(id, *zone);
+#endif
+        return zone;
     } catch (std::out_of_range e) {
         throw std::runtime_error("Invalid timezone id");
     }
 }
 
+/* The zone with the given name among `db.zones`, or `nullptr`. Unlike
+   `locate_zone`, this doesn't allocate: without `HAS_STRING_VIEW`, which the
+   `date` library doesn't set in the C++11 mode forced by `defines.hpp`,
+   `locate_zone` takes an `std::string`, and the names that don't fit into
+   its small buffer, like "America/New_York", are copied to the heap. */
+static const time_zone *find_zone(const tzdb& db, const char *zone_name)
+{
+    const size_t length = strlen(zone_name);
+    auto compare = [=](const time_zone& zone) {
+        auto&& name = zone.name();
+        return name.compare(0, name.size(), zone_name, length);
+    };
+    auto it = std::lower_bound(db.zones.begin(), db.zones.end(), zone_name,
+        [&](const time_zone& zone, const char *) { return compare(zone) < 0; });
+    if (it == db.zones.end() || compare(*it) != 0)
+        return nullptr;
+    return &*it;
+}
+
 static TZID id_by_zone(const tzdb& db, const time_zone* tz)
 {
     size_t id = tz - &db.zones[0];
@@ -83,21 +137,23 @@ extern "C" {
 
 char * get_system_timezone(TZID * id)
 {
+    probes::call probe(__func__, probes::no_zone, 0);
     try {
-        auto& tzdb = get_tzdb();
+        auto& tzdb = database();
         auto zone = tzdb.current_zone();
         *id = id_by_zone(tzdb, zone);
-        return timezone_name(*zone);
+        return probe.returns(timezone_name(*zone));
     } catch (std::runtime_error e) {
         *id = TZID_INVALID;
-        return nullptr;
+        return probe.returns(nullptr);
     }
 }
 
 char ** available_zone_ids()
 {
+    probes::call probe(__func__, probes::no_zone, 0);
     try {
-        auto& tzdb = get_tzdb();
+        auto& tzdb = database();
         auto& zones = tzdb.zones;
         char ** zones_copy = check_allocation(
             (char **)malloc(sizeof(char *) * (zones.size() + 1)));
@@ -105,33 +161,78 @@ char ** available_zone_ids()
         for (unsigned long i = 0; i < zones.size(); ++i) {
             zones_copy[i] = timezone_name(zones[i]);
         }
-        return zones_copy;
+        return probe.returns(zones_copy);
     } catch (std::runtime_error e) {
-        return nullptr;
+        return probe.returns(nullptr);
     }
 }
 
 int offset_at_instant(TZID zone_id, int64_t epoch_sec)
 {
+    probes::call probe(__func__, zone_id, epoch_sec);
     try {
         /* `sys_time` is usually Unix time (UTC, not counting leap seconds).
            Starting from C++20, it is specified in the standard. */
         auto stime = sys_time<std::chrono::seconds>(saturating(epoch_sec));
         auto zone = zone_by_id(zone_id);
         auto info = zone->get_info(stime);
-        return info.offset.count();
+        return probe.returns(info.offset.count());
+    } catch (std::runtime_error e) {
+        return probe.returns(INT_MAX);
+    }
+}
+
+int offset_interval_at_instant(TZID zone_id, int64_t epoch_sec,
+    int64_t *begin, int64_t *end)
+{
+    probes::call probe(__func__, zone_id, epoch_sec);
+    try {
+        auto stime = sys_time<std::chrono::seconds>(saturating(epoch_sec));
+        auto zone = zone_by_id(zone_id);
+        auto info = zone->get_info(stime);
+        /* Outside of the range of instants that we recognize, everything is
+           the same moment, so the first and the last offsets last forever. */
+        int64_t info_begin = info.begin.time_since_epoch().count();
+        int64_t info_end = info.end.time_since_epoch().count();
+        *begin = info_begin <= min_available_instant ? INT64_MIN : info_begin;
+        *end = info_end > max_available_instant ? INT64_MAX : info_end;
+        return probe.returns(info.offset.count());
+    } catch (std::runtime_error e) {
+        return probe.returns(INT_MAX);
+    }
+}
+
+int abbreviation_at_instant(TZID zone_id, int64_t epoch_sec,
+    char *abbreviation, size_t size)
+{
+    probes::call probe(__func__, zone_id, epoch_sec);
+    try {
+        auto stime = sys_time<std::chrono::seconds>(saturating(epoch_sec));
+        auto zone = zone_by_id(zone_id);
+        auto info = zone->get_info(stime);
+        if (size != 0) {
+            size_t length = std::min(info.abbrev.size(), size - 1);
+            memcpy(abbreviation, info.abbrev.data(), length);
+            abbreviation[length] = '\0';
+        }
+        return probe.returns(info.offset.count());
     } catch (std::runtime_error e) {
-        return INT_MAX;
+        return probe.returns(INT_MAX);
     }
 }
 
 TZID timezone_by_name(const char *zone_name)
 {
+    probes::call probe(__func__, probes::no_zone, 0);
     try {
-        auto& tzdb = get_tzdb();
-        return id_by_zone(tzdb, tzdb.locate_zone(zone_name));
+        auto& tzdb = database();
+        // The links and the unknown names are left to `locate_zone`.
+        const time_zone *zone = find_zone(tzdb, zone_name);
+        if (zone == nullptr)
+            zone = tzdb.locate_zone(zone_name);
+        return probe.returns(id_by_zone(tzdb, zone));
     } catch (std::runtime_error e) {
-        return TZID_INVALID;
+        return probe.returns(TZID_INVALID);
     }
 }
 
@@ -180,21 +281,23 @@ GAP_HANDLING gap_handling)
 
 int offset_at_datetime(TZID zone_id, int64_t epoch_sec, int *offset)
 {
-    return offset_at_datetime_impl(zone_id, saturating(epoch_sec), offset,
-        GAP_HANDLING_MOVE_FORWARD);
+    probes::call probe(__func__, zone_id, epoch_sec);
+    return probe.returns(offset_at_datetime_impl(zone_id,
+        saturating(epoch_sec), offset, GAP_HANDLING_MOVE_FORWARD));
 }
 
 int64_t at_start_of_day(TZID zone_id, int64_t epoch_sec)
 {
+    probes::call probe(__func__, zone_id, epoch_sec);
     int offset = 0;
     int trans = offset_at_datetime_impl(zone_id, saturating(epoch_sec), &offset,
         GAP_HANDLING_NEXT_CORRECT);
     if (offset == INT_MAX)
-        return LONG_MAX;
+        return probe.returns(LONG_MAX);
     if (epoch_sec > max_available_instant || epoch_sec < min_available_instant) {
         trans = 0;
     }
-    return epoch_sec - offset + trans;
+    return probe.returns(epoch_sec - offset + trans);
 }
 
 }
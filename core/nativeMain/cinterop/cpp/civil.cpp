@@ -0,0 +1,179 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file implements the conversions between the epoch days and the
+   dates specified in `cdate.h`, and checks the algorithms from `civil.hpp`
+   at compile time.
+
+   The loops only use the algorithms for the years of `LocalDate`, with the
+   out-of-range elements replaced by a valid day and then by the error
+   values, so that there are no branches in them and they are vectorized. */
+#include "civil.hpp"
+#include "probes.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+namespace {
+
+/* Checks the first and the last day of every month of the years in
+   [from; to): the fast algorithms have to give the same epoch days as
+   counting the days of the months from the first day, computed with the
+   wide algorithms, and to convert them back. The dates inside a month are
+   linear in both directions. A 400-year cycle repeats the same months, so
+   checking one of them checks the arithmetic on all the days of a cycle. */
+constexpr bool months_round_trip(int64_t from, int64_t to) {
+    int64_t first = civil::detail::wide_days_from_civil(from, 1, 1);
+    for (int64_t year = from; year < to; ++year) {
+        for (int month = 1; month <= 12; ++month) {
+            const int length = civil::days_in_month(year, month);
+            if (civil::detail::fast_days_from_civil(year, month, 1) != first)
+                return false;
+            for (int day = 1; day <= length; day += length - 1) {
+                const int64_t epoch_day = first + day - 1;
+                int64_t y = 0;
+                int m = 0, d = 0;
+                civil::detail::fast_civil_from_days(epoch_day, y, m, d);
+                if (y != year || m != month || d != day ||
+                    civil::detail::fast_iso_day_of_week(epoch_day) !=
+                    (epoch_day % 7 + 7 + 3) % 7 + 1 ||
+                    civil::day_of_year(year, month, day) !=
+                    epoch_day - civil::detail::wide_days_from_civil(year, 1,
+                        1) + 1)
+                    return false;
+            }
+            first += length;
+        }
+    }
+    return true;
+}
+
+/* Checks the days around March 1, where the leap day is, of every `step`-th
+   year in [from; to), against the wide algorithms. */
+constexpr bool years_agree(int64_t from, int64_t to, int64_t step) {
+    for (int64_t year = from; year < to; year += step) {
+        const int64_t march = civil::detail::wide_days_from_civil(year, 3, 1);
+        if (civil::detail::fast_days_from_civil(year, 3, 1) != march)
+            return false;
+        for (int64_t epoch_day = march - 1; epoch_day <= march; ++epoch_day) {
+            int64_t fast_year = 0, wide_year = 0;
+            int fast_month = 0, fast_day = 0, wide_month = 0, wide_day = 0;
+            civil::detail::fast_civil_from_days(epoch_day, fast_year,
+                fast_month, fast_day);
+            civil::detail::wide_civil_from_days(epoch_day, wide_year,
+                wide_month, wide_day);
+            if (fast_year != wide_year || fast_month != wide_month ||
+                fast_day != wide_day)
+                return false;
+        }
+    }
+    return true;
+}
+
+/* The cycles at both ends of the range and around the epoch, and a sample
+   of the years across the range, with a step that is coprime with 400. Each
+   check is evaluated separately, so that none reaches the limits of the
+   compilers on the evaluation of constant expressions. */
+static_assert(months_round_trip(civil::min_year, civil::min_year + 400), "");
+static_assert(months_round_trip(1600, 2000), "");
+static_assert(months_round_trip(civil::max_year - 399, civil::max_year + 1),
+    "");
+static_assert(years_agree(civil::min_year, 0, 199), "");
+static_assert(years_agree(0, civil::max_year + 1, 199), "");
+static_assert(civil::days_from_civil(1970, 1, 1) == 0, "");
+static_assert(civil::days_from_civil(2000, 3, 1) == 11017, "");
+static_assert(civil::iso_day_of_week(civil::min_epoch_day - 1) ==
+    civil::iso_day_of_week(civil::min_epoch_day + 6), "");
+
+constexpr bool iso_week_is(int64_t year, int month, int day,
+    int64_t week_year, int week)
+{
+    int64_t y = 0;
+    int w = 0;
+    civil::iso_week_date(civil::days_from_civil(year, month, day), y, w);
+    return y == week_year && w == week;
+}
+
+static_assert(iso_week_is(2008, 12, 29, 2009, 1), "");
+static_assert(iso_week_is(2010, 1, 3, 2009, 53), "");
+static_assert(iso_week_is(2020, 12, 31, 2020, 53), "");
+static_assert(iso_week_is(2021, 1, 4, 2021, 1), "");
+
+}
+
+extern "C" {
+
+int epoch_days_to_dates(const int64_t *epoch_days, int32_t *years,
+    int8_t *months, int8_t *days, size_t count)
+{
+    probes::call probe(__func__, probes::no_zone, count);
+    size_t invalid = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const bool in_range = (epoch_days[i] >= civil::min_epoch_day) &
+            (epoch_days[i] <= civil::max_epoch_day);
+        int64_t year = 0;
+        int month = 0, day = 0;
+        civil::detail::fast_civil_from_days(in_range ? epoch_days[i] : 0,
+            year, month, day);
+        years[i] = in_range ? (int32_t)year : 0;
+        months[i] = (int8_t)(in_range ? month : 0);
+        days[i] = (int8_t)(in_range ? day : 0);
+        invalid += !in_range;
+    }
+    return probe.returns(invalid == 0 ? 0 : -1);
+}
+
+int dates_to_epoch_days(const int32_t *years, const int8_t *months,
+    const int8_t *days, int64_t *epoch_days, size_t count)
+{
+    probes::call probe(__func__, probes::no_zone, count);
+    size_t invalid = 0;
+    for (size_t i = 0; i < count; ++i) {
+        // `&` rather than `&&`, so that everything is evaluated.
+        const bool month_in_range = (years[i] >= civil::min_year) &
+            (years[i] <= civil::max_year) & (months[i] >= 1) &
+            (months[i] <= 12);
+        const int64_t year = month_in_range ? years[i] : 1970;
+        const int month = month_in_range ? months[i] : 1;
+        const int64_t first =
+            civil::detail::fast_days_from_civil(year, month, 1);
+        const int64_t length =
+            civil::detail::fast_days_from_civil(year, month + 1, 1) - first;
+        const bool in_range =
+            month_in_range & (days[i] >= 1) & (days[i] <= length);
+        const int64_t epoch_day = first + days[i] - 1;
+        epoch_days[i] = in_range ? epoch_day : INT64_MAX;
+        invalid += !in_range;
+    }
+    return probe.returns(invalid == 0 ? 0 : -1);
+}
+
+int epoch_days_to_iso_week_dates(const int64_t *epoch_days,
+    int32_t *week_years, int8_t *weeks, int8_t *days_of_week, size_t count)
+{
+    probes::call probe(__func__, probes::no_zone, count);
+    size_t invalid = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const bool in_range = (epoch_days[i] >= civil::min_epoch_day) &
+            (epoch_days[i] <= civil::max_epoch_day);
+        const int64_t epoch_day = in_range ? epoch_days[i] : 0;
+        const int day_of_week = civil::detail::fast_iso_day_of_week(epoch_day);
+        /* The Thursdays of the weeks at the ends of the range are only a few
+           days away from it, where the fast algorithms still work. */
+        const int64_t thursday = epoch_day - day_of_week + 4;
+        int64_t year = 0;
+        int month = 0, day = 0;
+        civil::detail::fast_civil_from_days(thursday, year, month, day);
+        const uint32_t days_since_january = (uint32_t)(thursday -
+            civil::detail::fast_days_from_civil(year, 1, 1));
+        const int week = (int)(days_since_january / 7) + 1;
+        week_years[i] = in_range ? (int32_t)year : 0;
+        weeks[i] = (int8_t)(in_range ? week : 0);
+        days_of_week[i] = (int8_t)(in_range ? day_of_week : 0);
+        invalid += !in_range;
+    }
+    return probe.returns(invalid == 0 ? 0 : -1);
+}
+
+}
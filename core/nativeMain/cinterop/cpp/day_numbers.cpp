@@ -0,0 +1,149 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file implements the conversions between the day numbers and instants
+   specified in `cdate.h`. */
+#include <climits>
+#include <cmath>
+#include "civil.hpp"
+#include "time_zone.hpp"
+#include "probes.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+#define MICROS_PER_SEC 1000000LL
+#define MICROS_PER_DAY (SECS_PER_DAY * MICROS_PER_SEC)
+#define NANOS_PER_MICRO 1000
+/* Larger day numbers don't fit into the range of instants in seconds, and,
+   anyway, have no precision left for the time of day. */
+#define MAX_DAY_NUMBER 1e11
+// The epoch day of 1900-03-01, the first day after the fictional 1900-02-29.
+#define SERIAL_1900_MARCH_FIRST (-25508)
+
+// The day number of 1970-01-01T00:00.
+static double epoch_day_number(DAY_NUMBER_SYSTEM system) {
+    switch (system) {
+        case DAY_NUMBER_JULIAN:
+            return 2440587.5;
+        case DAY_NUMBER_MODIFIED_JULIAN:
+            return 40587;
+        case DAY_NUMBER_SERIAL_1900:
+            return 25569;
+        case DAY_NUMBER_SERIAL_1904:
+            return 24107;
+        default:
+            return NAN;
+    }
+}
+
+static bool is_local(DAY_NUMBER_SYSTEM system) {
+    return system == DAY_NUMBER_SERIAL_1900 || system == DAY_NUMBER_SERIAL_1904;
+}
+
+/* Splits the day number into the epoch day and the microsecond of the day.
+   Returns `false` if the day number is out of range. */
+static bool split_day_number(DAY_NUMBER_SYSTEM system, double number,
+    int64_t& epoch_day, int64_t& micro_of_day)
+{
+    // also rejects NaN.
+    if (!(std::fabs(number) < MAX_DAY_NUMBER))
+        return false;
+    double shifted;
+    if (system == DAY_NUMBER_SERIAL_1900 && number < 61) {
+        if (number >= 60) {
+            // 1900-02-29 doesn't exist, so the first moment after it is used.
+            epoch_day = SERIAL_1900_MARCH_FIRST;
+            micro_of_day = 0;
+            return true;
+        }
+        // before the fictional day, the serial dates are off by one.
+        shifted = number - (epoch_day_number(system) - 1);
+    } else {
+        shifted = number - epoch_day_number(system);
+    }
+    const double whole = std::floor(shifted);
+    const int64_t micros = std::llround((shifted - whole) * MICROS_PER_DAY);
+    // the rounding may give a whole day.
+    epoch_day = (int64_t)whole + micros / MICROS_PER_DAY;
+    micro_of_day = micros % MICROS_PER_DAY;
+    return true;
+}
+
+static double to_day_number(DAY_NUMBER_SYSTEM system, int64_t local_sec,
+    int32_t nanos)
+{
+    const int64_t epoch_day = civil::floor_div(local_sec, SECS_PER_DAY);
+    const int64_t second_of_day = local_sec - epoch_day * SECS_PER_DAY;
+    double base = epoch_day_number(system);
+    if (system == DAY_NUMBER_SERIAL_1900 &&
+        epoch_day < SERIAL_1900_MARCH_FIRST)
+        base -= 1;
+    const double fraction = (second_of_day * 1e9 + nanos) /
+        (SECS_PER_DAY * 1e9);
+    return (double)epoch_day + base + fraction;
+}
+
+extern "C" {
+
+int day_numbers_to_instants(enum DAY_NUMBER_SYSTEM system, TZID zone,
+    const double *day_numbers, int64_t *epoch_secs, int32_t *nanos,
+    size_t count)
+{
+    probes::call probe(__func__, zone, count);
+    if (std::isnan(epoch_day_number(system)))
+        return probe.returns(-1);
+    const bool apply_zone = is_local(system) && zone != TZID_INVALID;
+    zones::cursor cursor(zones::zone::region(zone));
+    int result = 0;
+    for (size_t i = 0; i < count; ++i) {
+        int64_t epoch_day, micro_of_day;
+        if (!split_day_number(system, day_numbers[i], epoch_day,
+            micro_of_day))
+        {
+            epoch_secs[i] = INT64_MAX;
+            if (nanos != nullptr)
+                nanos[i] = 0;
+            result = -1;
+            continue;
+        }
+        int64_t epoch_sec =
+            epoch_day * SECS_PER_DAY + micro_of_day / MICROS_PER_SEC;
+        if (apply_zone && !cursor.to_instant(epoch_sec, epoch_sec)) {
+            epoch_sec = INT64_MAX;
+            result = -1;
+        }
+        epoch_secs[i] = epoch_sec;
+        if (nanos != nullptr)
+            nanos[i] = (int32_t)(micro_of_day % MICROS_PER_SEC) *
+                NANOS_PER_MICRO;
+    }
+    return probe.returns(result);
+}
+
+int instants_to_day_numbers(enum DAY_NUMBER_SYSTEM system, TZID zone,
+    const int64_t *epoch_secs, const int32_t *nanos, double *day_numbers,
+    size_t count)
+{
+    probes::call probe(__func__, zone, count);
+    if (std::isnan(epoch_day_number(system)))
+        return probe.returns(-1);
+    const bool apply_zone = is_local(system) && zone != TZID_INVALID;
+    zones::cursor cursor(apply_zone ? zones::zone::region(zone) :
+        zones::zone());
+    int result = 0;
+    for (size_t i = 0; i < count; ++i) {
+        int64_t local_sec;
+        if (!cursor.to_local(epoch_secs[i], local_sec)) {
+            day_numbers[i] = NAN;
+            result = -1;
+            continue;
+        }
+        day_numbers[i] = to_day_number(system, local_sec,
+            nanos == nullptr ? 0 : nanos[i]);
+    }
+    return probe.returns(result);
+}
+
+}
@@ -28,9 +28,16 @@
         has the unfortunate side effect of the `date` library recognizing that
         it deals with C++17, which has a lot of additional features compared to
         C++11. However, many of these features are actually unavailable due to
-        an outdated GCC root used for Linux. */
-        #undef __cplusplus
-        #define __cplusplus 201103
+        an outdated GCC root used for Linux. Only the `<chrono>` backend from
+        `backend.hpp`, which needs C++20, is not affected; its values are
+        repeated here, as this file comes first. */
+        #define DATETIME_BACKEND_DATE 1
+        #define DATETIME_BACKEND_STD_CHRONO 2
+        #if !defined(DATETIME_BACKEND) || \
+            DATETIME_BACKEND == DATETIME_BACKEND_DATE
+            #undef __cplusplus
+            #define __cplusplus 201103
+        #endif
         #define DATETIME_TARGET_WIN32 0
     #endif
 #endif
@@ -0,0 +1,332 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file implements `parse_timestamps` from `cdate.h`.
+
+   A column almost always has one format, so it is detected from a sample of
+   the rows, and the whole column is then parsed by a loop specialized for
+   that format. Only a row that this loop can't parse is looked at again to
+   detect its own format. */
+#include <climits>
+#include <cstring>
+#include "civil.hpp"
+#include "internet_dates.hpp"
+#include "iso8601.hpp"
+#include "time_zone.hpp"
+#include "probes.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+#define NANOS_PER_SEC 1000000000
+// The number of the rows the format of a column is detected from.
+#define SAMPLE_SIZE 64
+
+static bool is_digit(char c) {
+    return (unsigned)(c - '0') <= 9;
+}
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/* Returns the format that the text looks like, judging by its first
+   characters, or TIMESTAMP_FORMAT_NONE. The numbers of units since the
+   epoch are told apart by their number of digits, which places the current
+   date-times of every unit into the same range. */
+static TIMESTAMP_FORMAT detect(const char *p, const char *end) {
+    const char *digits = p;
+    if (*digits == '+' || *digits == '-')
+        ++digits;
+    const char *q = digits;
+    while (q != end && is_digit(*q))
+        ++q;
+    const ptrdiff_t count = q - digits;
+    if (count != 0 && (q == end || *q == '.')) {
+        if (count <= 11)
+            return TIMESTAMP_FORMAT_EPOCH_SECONDS;
+        if (count <= 14)
+            return TIMESTAMP_FORMAT_EPOCH_MILLISECONDS;
+        if (count <= 17)
+            return TIMESTAMP_FORMAT_EPOCH_MICROSECONDS;
+        return TIMESTAMP_FORMAT_EPOCH_NANOSECONDS;
+    }
+    if (count >= 4 && q != end && *q == '-')
+        return TIMESTAMP_FORMAT_ISO8601;
+    if (count == 4 && q != end && *q == '/' && digits == p)
+        return TIMESTAMP_FORMAT_SLASHED;
+    if (digits == p && count <= 2)
+        return TIMESTAMP_FORMAT_RFC2822;
+    return TIMESTAMP_FORMAT_NONE;
+}
+
+/* Sets `epoch_nanos` to `epoch_sec` seconds and `nanos` nanoseconds,
+   unless that doesn't fit. */
+static bool to_epoch_nanos(int64_t epoch_sec, int32_t nanos,
+    int64_t& epoch_nanos)
+{
+    return !__builtin_mul_overflow(epoch_sec, NANOS_PER_SEC, &epoch_nanos) &&
+        !__builtin_add_overflow(epoch_nanos, nanos, &epoch_nanos);
+}
+
+/* The local date-times without an offset are resolved like
+   `local_times_to_instants` does, in the UTC if the zone is TZID_INVALID. */
+static zones::cursor local_resolver(TZID zone) {
+    return zones::cursor(zone == TZID_INVALID ? zones::zone() :
+        zones::zone::region(zone));
+}
+
+/* Parses `[+-]digits[.digits]` as a number of units since the epoch. The
+   digits of the fraction beyond a nanosecond are ignored. */
+static TIMESTAMP_ERROR parse_epoch(const char *p, const char *end,
+    int64_t units_per_second, int64_t& epoch_nanos)
+{
+    const bool negative = *p == '-';
+    if (*p == '+' || *p == '-')
+        ++p;
+    if (p == end || !is_digit(*p))
+        return TIMESTAMP_ERROR_SYNTAX;
+    uint64_t whole = 0;
+    for (; p != end && is_digit(*p); ++p) {
+        if (__builtin_mul_overflow(whole, 10, &whole) ||
+            __builtin_add_overflow(whole, (uint64_t)(*p - '0'), &whole))
+            return TIMESTAMP_ERROR_RANGE;
+    }
+    // The fraction of a unit, in units of 10^-18.
+    uint64_t fraction = 0;
+    if (p != end) {
+        if (*p++ != '.' || p == end)
+            return TIMESTAMP_ERROR_SYNTAX;
+        uint64_t scale = 100000000000000000;
+        for (; p != end && is_digit(*p); ++p, scale /= 10)
+            fraction += (uint64_t)(*p - '0') * scale;
+        if (p != end)
+            return TIMESTAMP_ERROR_SYNTAX;
+    }
+    const int64_t nanos_per_unit = NANOS_PER_SEC / units_per_second;
+    const uint64_t fraction_nanos =
+        fraction / (1000000000000000000 / (uint64_t)nanos_per_unit);
+    uint64_t absolute;
+    if (__builtin_mul_overflow(whole, (uint64_t)nanos_per_unit, &absolute) ||
+        __builtin_add_overflow(absolute, fraction_nanos, &absolute) ||
+        absolute > (uint64_t)INT64_MAX + negative)
+        return TIMESTAMP_ERROR_RANGE;
+    epoch_nanos = negative ? (int64_t)(0 - absolute) : (int64_t)absolute;
+    return TIMESTAMP_ERROR_NONE;
+}
+
+/* Parses `YYYY/MM/DD`, optionally followed by a space or `T` and
+   `HH:MM`, `HH:MM:SS` or `HH:MM:SS.fraction`, as a local date-time. */
+static bool parse_slashed(const char *p, const char *end,
+    iso_datetime& result)
+{
+    int32_t year, month, day, hour = 0, minute = 0, second = 0;
+    int32_t nanosecond = 0;
+    if (!iso_parse_digits(p, end, 4, year) || !iso_skip(p, end, '/') ||
+        !iso_parse_digits(p, end, 2, month) || !iso_skip(p, end, '/') ||
+        !iso_parse_digits(p, end, 2, day))
+        return false;
+    if (p != end) {
+        if (*p != ' ' && *p != 'T')
+            return false;
+        ++p;
+        if (!iso_parse_digits(p, end, 2, hour) || !iso_skip(p, end, ':') ||
+            !iso_parse_digits(p, end, 2, minute))
+            return false;
+        if (iso_skip(p, end, ':')) {
+            if (!iso_parse_digits(p, end, 2, second))
+                return false;
+            if (iso_skip(p, end, '.')) {
+                int digits = 0;
+                for (; p != end && is_digit(*p); ++p, ++digits) {
+                    if (digits < 9)
+                        nanosecond = nanosecond * 10 + (*p - '0');
+                }
+                if (digits == 0)
+                    return false;
+                for (; digits < 9; ++digits)
+                    nanosecond *= 10;
+            }
+        }
+        if (p != end)
+            return false;
+    }
+    if (month < 1 || month > 12 || day < 1 ||
+        day > civil::days_in_month(year, month) ||
+        hour > 23 || minute > 59 || second > 59)
+        return false;
+    result.local_sec =
+        civil::days_from_civil(year, month, day) * SECS_PER_DAY +
+        hour * 3600 + minute * 60 + second;
+    result.nanosecond = nanosecond;
+    result.offset_sec = INT_MAX;
+    return true;
+}
+
+/* Parses the trimmed, non-empty text in the given format. The `switch` is
+   on a template parameter, so every instantiation only has the code of its
+   own format. */
+template <int Format>
+static TIMESTAMP_ERROR parse_as(const char *p, const char *end,
+    zones::cursor& resolver, int64_t& epoch_nanos)
+{
+    iso_datetime datetime;
+    switch (Format) {
+        case TIMESTAMP_FORMAT_EPOCH_SECONDS:
+            return parse_epoch(p, end, 1, epoch_nanos);
+        case TIMESTAMP_FORMAT_EPOCH_MILLISECONDS:
+            return parse_epoch(p, end, 1000, epoch_nanos);
+        case TIMESTAMP_FORMAT_EPOCH_MICROSECONDS:
+            return parse_epoch(p, end, 1000000, epoch_nanos);
+        case TIMESTAMP_FORMAT_EPOCH_NANOSECONDS:
+            return parse_epoch(p, end, NANOS_PER_SEC, epoch_nanos);
+        case TIMESTAMP_FORMAT_ISO8601:
+            if (!parse_iso_datetime(p, end, datetime))
+                return TIMESTAMP_ERROR_SYNTAX;
+            break;
+        case TIMESTAMP_FORMAT_SLASHED:
+            if (!parse_slashed(p, end, datetime))
+                return TIMESTAMP_ERROR_SYNTAX;
+            break;
+        case TIMESTAMP_FORMAT_RFC2822:
+            if (parse_rfc2822(p, end, datetime))
+                break;
+            // The HTTP dates in the formats of RFC 850 and `asctime`.
+            if (!parse_http_date(p, end, datetime.local_sec))
+                return TIMESTAMP_ERROR_SYNTAX;
+            datetime.nanosecond = 0;
+            datetime.offset_sec = 0;
+            break;
+        default:
+            return TIMESTAMP_ERROR_SYNTAX;
+    }
+    int64_t epoch_sec = datetime.local_sec - datetime.offset_sec;
+    if (datetime.offset_sec == INT_MAX &&
+        !resolver.to_instant(datetime.local_sec, epoch_sec))
+        return TIMESTAMP_ERROR_TIME_ZONE;
+    if (!to_epoch_nanos(epoch_sec, datetime.nanosecond, epoch_nanos))
+        return TIMESTAMP_ERROR_RANGE;
+    return TIMESTAMP_ERROR_NONE;
+}
+
+static TIMESTAMP_ERROR parse_as(TIMESTAMP_FORMAT format,
+    const char *p, const char *end, zones::cursor& resolver,
+    int64_t& epoch_nanos)
+{
+    switch (format) {
+#define PARSE_AS(format) \
+        case format: return parse_as<format>(p, end, resolver, epoch_nanos);
+        PARSE_AS(TIMESTAMP_FORMAT_ISO8601)
+        PARSE_AS(TIMESTAMP_FORMAT_EPOCH_SECONDS)
+        PARSE_AS(TIMESTAMP_FORMAT_EPOCH_MILLISECONDS)
+        PARSE_AS(TIMESTAMP_FORMAT_EPOCH_MICROSECONDS)
+        PARSE_AS(TIMESTAMP_FORMAT_EPOCH_NANOSECONDS)
+        PARSE_AS(TIMESTAMP_FORMAT_RFC2822)
+        PARSE_AS(TIMESTAMP_FORMAT_SLASHED)
+#undef PARSE_AS
+        default:
+            return TIMESTAMP_ERROR_SYNTAX;
+    }
+}
+
+// Narrows [p; end) to the text without the surrounding whitespace.
+static void trim(const char *&p, const char *&end) {
+    while (p != end && is_space(*p))
+        ++p;
+    while (end != p && is_space(end[-1]))
+        --end;
+}
+
+// The most common format among up to SAMPLE_SIZE rows spread evenly.
+static TIMESTAMP_FORMAT detect_column(const char *buffer,
+    const int32_t *offsets, size_t count)
+{
+    size_t votes[TIMESTAMP_FORMAT_SLASHED + 1] = {};
+    const size_t step = count > SAMPLE_SIZE ? count / SAMPLE_SIZE : 1;
+    for (size_t i = 0; i < count; i += step) {
+        const char *p = buffer + offsets[i], *end = buffer + offsets[i + 1];
+        trim(p, end);
+        if (p != end)
+            ++votes[detect(p, end)];
+    }
+    /* The numbers that are small for their unit look like those of a larger
+       unit, so the ties between the units go to the smaller ones. */
+    static const TIMESTAMP_FORMAT candidates[] = {
+        TIMESTAMP_FORMAT_ISO8601,
+        TIMESTAMP_FORMAT_EPOCH_NANOSECONDS,
+        TIMESTAMP_FORMAT_EPOCH_MICROSECONDS,
+        TIMESTAMP_FORMAT_EPOCH_MILLISECONDS,
+        TIMESTAMP_FORMAT_EPOCH_SECONDS,
+        TIMESTAMP_FORMAT_RFC2822,
+        TIMESTAMP_FORMAT_SLASHED,
+    };
+    TIMESTAMP_FORMAT result = TIMESTAMP_FORMAT_NONE;
+    for (TIMESTAMP_FORMAT format : candidates) {
+        if (votes[format] > votes[result])
+            result = format;
+    }
+    return result;
+}
+
+template <int Format>
+static int parse_column(TZID zone, const char *buffer,
+    const int32_t *offsets, size_t count, int64_t *epoch_nanos,
+    uint8_t *formats, uint8_t *errors)
+{
+    zones::cursor resolver = local_resolver(zone);
+    int result = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const char *p = buffer + offsets[i], *end = buffer + offsets[i + 1];
+        trim(p, end);
+        TIMESTAMP_FORMAT format = (TIMESTAMP_FORMAT)Format;
+        TIMESTAMP_ERROR error = TIMESTAMP_ERROR_EMPTY;
+        if (p != end) {
+            error = parse_as<Format>(p, end, resolver, epoch_nanos[i]);
+            /* A number too large for the unit of the column may still be
+               right in a smaller unit. */
+            if (error == TIMESTAMP_ERROR_SYNTAX ||
+                error == TIMESTAMP_ERROR_RANGE)
+            {
+                format = detect(p, end);
+                if (format != Format)
+                    error = parse_as(format, p, end, resolver, epoch_nanos[i]);
+            }
+        }
+        if (error != TIMESTAMP_ERROR_NONE) {
+            epoch_nanos[i] = INT64_MAX;
+            format = TIMESTAMP_FORMAT_NONE;
+            result = -1;
+        }
+        if (formats != nullptr)
+            formats[i] = (uint8_t)format;
+        if (errors != nullptr)
+            errors[i] = (uint8_t)error;
+    }
+    return result;
+}
+
+extern "C" {
+
+int parse_timestamps(TZID zone, const char *buffer, const int32_t *offsets,
+    size_t count, int64_t *epoch_nanos, uint8_t *formats, uint8_t *errors)
+{
+    probes::call probe(__func__, zone, count);
+    switch (detect_column(buffer, offsets, count)) {
+#define PARSE_COLUMN(format) \
+        case format: return probe.returns(parse_column<format>(zone, buffer, \
+            offsets, count, epoch_nanos, formats, errors));
+        PARSE_COLUMN(TIMESTAMP_FORMAT_ISO8601)
+        PARSE_COLUMN(TIMESTAMP_FORMAT_EPOCH_SECONDS)
+        PARSE_COLUMN(TIMESTAMP_FORMAT_EPOCH_MILLISECONDS)
+        PARSE_COLUMN(TIMESTAMP_FORMAT_EPOCH_MICROSECONDS)
+        PARSE_COLUMN(TIMESTAMP_FORMAT_EPOCH_NANOSECONDS)
+        PARSE_COLUMN(TIMESTAMP_FORMAT_RFC2822)
+        PARSE_COLUMN(TIMESTAMP_FORMAT_SLASHED)
+        PARSE_COLUMN(TIMESTAMP_FORMAT_NONE)
+#undef PARSE_COLUMN
+    }
+    return probe.returns(-1);
+}
+
+}
@@ -0,0 +1,934 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file implements the compiled patterns specified in `cdate.h`.
+
+   A pattern is compiled into a list of instructions, each either copying a
+   literal string or handling one field, so formatting and parsing are just
+   loops over the instructions, with no interpretation of the pattern. The
+   civil fields of an instant are computed once per instant, and the batch
+   functions reuse the offsets between the neighboring instants. */
+#include <cstdio>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include "civil.hpp"
+#include "helper_macros.hpp"
+#include "probes.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+#define MAX_OFFSET_SECS (18 * 3600)
+#define NANOS_PER_SEC 1000000000
+// The longest abbreviation of a time zone name that is kept, plus the zero.
+#define ABBREVIATION_SIZE 16
+
+enum opcode : uint8_t {
+    OP_LITERAL,
+    // a space when formatting, any amount of whitespace when parsing.
+    OP_WHITESPACE,
+    OP_YEAR,
+    OP_YEAR_OF_CENTURY,
+    OP_MONTH,
+    OP_DAY,
+    OP_DAY_OF_YEAR,
+    OP_HOUR,
+    OP_HOUR_12,
+    OP_AM_PM,
+    OP_MINUTE,
+    OP_SECOND,
+    OP_FRACTION,
+    OP_MONTH_ABBREVIATION,
+    OP_MONTH_NAME,
+    OP_WEEKDAY_ABBREVIATION,
+    OP_WEEKDAY_NAME,
+    OP_ISO_WEEKDAY,
+    OP_WEEKDAY_FROM_SUNDAY,
+    OP_OFFSET,
+    OP_OFFSET_WITH_COLON,
+    OP_ZONE_ABBREVIATION,
+    OP_EPOCH_SECONDS,
+};
+
+enum padding : uint8_t {
+    PAD_ZERO,
+    PAD_SPACE,
+    PAD_NONE,
+};
+
+struct instruction {
+    opcode op;
+    padding pad;
+    // the number of digits of a padded number.
+    uint8_t width;
+    // the range of `literals` copied by OP_LITERAL.
+    uint32_t literal_begin;
+    uint32_t literal_length;
+};
+
+struct DATETIME_PATTERN {
+    TZID zone;
+    std::vector<instruction> program;
+    std::string literals;
+    bool needs_abbreviation;
+    size_t max_length;
+};
+
+static const char *const month_names[] = {
+    "January", "February", "March", "April", "May", "June", "July",
+    "August", "September", "October", "November", "December",
+};
+
+// From Monday.
+static const char *const weekday_names[] = {
+    "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday",
+    "Sunday",
+};
+
+// The fields of an instant in the time zone of a pattern.
+struct civil_fields {
+    int64_t epoch_sec;
+    int64_t year;
+    int month;
+    int day;
+    int day_of_year;
+    int hour;
+    int minute;
+    int second;
+    // ISO, from 1 for Monday.
+    int weekday;
+    int32_t nanos;
+    int offset;
+    const char *abbreviation;
+};
+
+/* Returns false if the local date-time is out of the range of `int64_t`,
+   which is only possible within a day of its ends. */
+static bool to_civil_fields(int64_t epoch_sec, int32_t nanos, int offset,
+    const char *abbreviation, civil_fields& f)
+{
+    int64_t local;
+    if (__builtin_add_overflow(epoch_sec, (int64_t)offset, &local))
+        return false;
+    const int64_t epoch_day = civil::floor_div(local, SECS_PER_DAY);
+    // not `local - epoch_day * SECS_PER_DAY`, which overflows on the first day.
+    const int remainder = (int)(local % SECS_PER_DAY);
+    const int second_of_day =
+        remainder < 0 ? remainder + (int)SECS_PER_DAY : remainder;
+    civil::civil_from_days(epoch_day, f.year, f.month, f.day);
+    f.epoch_sec = epoch_sec;
+    f.day_of_year =
+        (int)(epoch_day - civil::days_from_civil(f.year, 1, 1)) + 1;
+    f.hour = second_of_day / 3600;
+    f.minute = second_of_day / 60 % 60;
+    f.second = second_of_day % 60;
+    f.weekday = civil::iso_day_of_week(epoch_day);
+    f.nanos = nanos;
+    f.offset = offset;
+    f.abbreviation = abbreviation;
+    return true;
+}
+
+/* Compiling */
+
+static size_t max_length(const instruction& i) {
+    switch (i.op) {
+        case OP_LITERAL:
+            return i.literal_length;
+        case OP_WHITESPACE:
+        case OP_ISO_WEEKDAY:
+        case OP_WEEKDAY_FROM_SUNDAY:
+            return 1;
+        case OP_YEAR:
+            // the range of the years of `int64_t` seconds is within 12 digits.
+            return 13;
+        case OP_MONTH_NAME:
+        case OP_WEEKDAY_NAME:
+            // September, Wednesday
+            return 9;
+        case OP_MONTH_ABBREVIATION:
+        case OP_WEEKDAY_ABBREVIATION:
+        case OP_DAY_OF_YEAR:
+            return 3;
+        case OP_OFFSET:
+            return 5;
+        case OP_OFFSET_WITH_COLON:
+            return 6;
+        case OP_ZONE_ABBREVIATION:
+            return ABBREVIATION_SIZE - 1;
+        case OP_EPOCH_SECONDS:
+            return 20;
+        case OP_FRACTION:
+            return i.width;
+        default:
+            return 2;
+    }
+}
+
+static void add_literal(DATETIME_PATTERN& pattern, char c) {
+    if (c == ' ') {
+        if (pattern.program.empty() ||
+            pattern.program.back().op != OP_WHITESPACE)
+            pattern.program.push_back(instruction{OP_WHITESPACE, PAD_NONE, 0, 0, 0});
+        return;
+    }
+    if (pattern.program.empty() || pattern.program.back().op != OP_LITERAL) {
+        pattern.program.push_back(instruction{OP_LITERAL, PAD_NONE, 0,
+            (uint32_t)pattern.literals.size(), 0});
+    }
+    pattern.literals.push_back(c);
+    ++pattern.program.back().literal_length;
+}
+
+static void add_field(DATETIME_PATTERN& pattern, opcode op, padding pad,
+    uint8_t width)
+{
+    pattern.program.push_back(instruction{op, pad, width, 0, 0});
+}
+
+// Compiles a conversion without the `%`. Returns false if it is unknown.
+static bool add_conversion(DATETIME_PATTERN& pattern, char conversion,
+    padding pad, int width, bool colon)
+{
+    if (colon && conversion != 'z')
+        return false;
+    if (width != 0 && conversion != 'N')
+        return false;
+    switch (conversion) {
+        case 'Y': add_field(pattern, OP_YEAR, pad, 4); break;
+        case 'y': add_field(pattern, OP_YEAR_OF_CENTURY, pad, 2); break;
+        case 'm': add_field(pattern, OP_MONTH, pad, 2); break;
+        case 'd': add_field(pattern, OP_DAY, pad, 2); break;
+        case 'e': add_field(pattern, OP_DAY, PAD_SPACE, 2); break;
+        case 'j': add_field(pattern, OP_DAY_OF_YEAR, pad, 3); break;
+        case 'H': add_field(pattern, OP_HOUR, pad, 2); break;
+        case 'k': add_field(pattern, OP_HOUR, PAD_SPACE, 2); break;
+        case 'I': add_field(pattern, OP_HOUR_12, pad, 2); break;
+        case 'l': add_field(pattern, OP_HOUR_12, PAD_SPACE, 2); break;
+        case 'p': add_field(pattern, OP_AM_PM, pad, 0); break;
+        case 'M': add_field(pattern, OP_MINUTE, pad, 2); break;
+        case 'S': add_field(pattern, OP_SECOND, pad, 2); break;
+        case 'N':
+            if (width != 0 && width != 3 && width != 6 && width != 9)
+                return false;
+            add_field(pattern, OP_FRACTION, PAD_ZERO, width == 0 ? 9 : width);
+            break;
+        case 'b':
+        case 'h': add_field(pattern, OP_MONTH_ABBREVIATION, pad, 0); break;
+        case 'B': add_field(pattern, OP_MONTH_NAME, pad, 0); break;
+        case 'a': add_field(pattern, OP_WEEKDAY_ABBREVIATION, pad, 0); break;
+        case 'A': add_field(pattern, OP_WEEKDAY_NAME, pad, 0); break;
+        case 'u': add_field(pattern, OP_ISO_WEEKDAY, pad, 1); break;
+        case 'w': add_field(pattern, OP_WEEKDAY_FROM_SUNDAY, pad, 1); break;
+        case 'z':
+            add_field(pattern, colon ? OP_OFFSET_WITH_COLON : OP_OFFSET, pad, 0);
+            break;
+        case 'Z':
+            add_field(pattern, OP_ZONE_ABBREVIATION, pad, 0);
+            pattern.needs_abbreviation = true;
+            break;
+        case 's': add_field(pattern, OP_EPOCH_SECONDS, pad, 0); break;
+        case 'F':
+            add_conversion(pattern, 'Y', pad, 0, false);
+            add_literal(pattern, '-');
+            add_conversion(pattern, 'm', PAD_ZERO, 0, false);
+            add_literal(pattern, '-');
+            add_conversion(pattern, 'd', PAD_ZERO, 0, false);
+            break;
+        case 'T':
+        case 'R':
+            add_conversion(pattern, 'H', pad, 0, false);
+            add_literal(pattern, ':');
+            add_conversion(pattern, 'M', PAD_ZERO, 0, false);
+            if (conversion == 'T') {
+                add_literal(pattern, ':');
+                add_conversion(pattern, 'S', PAD_ZERO, 0, false);
+            }
+            break;
+        case 'D':
+            add_conversion(pattern, 'm', pad, 0, false);
+            add_literal(pattern, '/');
+            add_conversion(pattern, 'd', PAD_ZERO, 0, false);
+            add_literal(pattern, '/');
+            add_conversion(pattern, 'y', PAD_ZERO, 0, false);
+            break;
+        case '%': add_literal(pattern, '%'); break;
+        case 'n': add_literal(pattern, '\n'); break;
+        case 't': add_literal(pattern, '\t'); break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+static bool compile(DATETIME_PATTERN& pattern, const char *p) {
+    while (*p != '\0') {
+        if (*p != '%') {
+            add_literal(pattern, *p++);
+            continue;
+        }
+        ++p;
+        padding pad = PAD_ZERO;
+        if (*p == '-' || *p == '_' || *p == '0') {
+            pad = *p == '-' ? PAD_NONE : *p == '_' ? PAD_SPACE : PAD_ZERO;
+            ++p;
+        }
+        int width = 0;
+        if (*p >= '1' && *p <= '9')
+            width = *p++ - '0';
+        const bool colon = *p == ':';
+        if (colon)
+            ++p;
+        if (*p == '\0' || !add_conversion(pattern, *p, pad, width, colon))
+            return false;
+        ++p;
+    }
+    return true;
+}
+
+/* Formatting */
+
+// Formats into a buffer that is known to be large enough.
+struct writer {
+    char *p;
+
+    void put(char c) {
+        *p++ = c;
+    }
+
+    void put(const char *s, size_t length) {
+        memcpy(p, s, length);
+        p += length;
+    }
+
+    void number(uint64_t value, int width, padding pad) {
+        char digits[20];
+        int length = 0;
+        do {
+            digits[length++] = (char)('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        if (pad != PAD_NONE) {
+            for (int i = length; i < width; ++i)
+                put(pad == PAD_ZERO ? '0' : ' ');
+        }
+        while (length != 0)
+            put(digits[--length]);
+    }
+
+    void offset(int offset, bool colon) {
+        const int absolute = offset < 0 ? -offset : offset;
+        put(offset < 0 ? '-' : '+');
+        number(absolute / 3600, 2, PAD_ZERO);
+        if (colon)
+            put(':');
+        number(absolute / 60 % 60, 2, PAD_ZERO);
+    }
+};
+
+static void format(const DATETIME_PATTERN& pattern, const civil_fields& f,
+    writer& out)
+{
+    for (const instruction& i : pattern.program) {
+        switch (i.op) {
+            case OP_LITERAL:
+                out.put(pattern.literals.data() + i.literal_begin,
+                    i.literal_length);
+                break;
+            case OP_WHITESPACE:
+                out.put(' ');
+                break;
+            case OP_YEAR:
+                if (f.year < 0 || f.year > 9999)
+                    out.put(f.year < 0 ? '-' : '+');
+                out.number(f.year < 0 ? 0 - (uint64_t)f.year : (uint64_t)f.year,
+                    i.width, i.pad);
+                break;
+            case OP_YEAR_OF_CENTURY:
+                out.number(
+                    (uint64_t)(f.year - civil::floor_div(f.year, 100) * 100),
+                    i.width, i.pad);
+                break;
+            case OP_MONTH:
+                out.number(f.month, i.width, i.pad);
+                break;
+            case OP_DAY:
+                out.number(f.day, i.width, i.pad);
+                break;
+            case OP_DAY_OF_YEAR:
+                out.number(f.day_of_year, i.width, i.pad);
+                break;
+            case OP_HOUR:
+                out.number(f.hour, i.width, i.pad);
+                break;
+            case OP_HOUR_12:
+                out.number(f.hour % 12 == 0 ? 12 : f.hour % 12, i.width, i.pad);
+                break;
+            case OP_AM_PM:
+                out.put(f.hour < 12 ? "AM" : "PM", 2);
+                break;
+            case OP_MINUTE:
+                out.number(f.minute, i.width, i.pad);
+                break;
+            case OP_SECOND:
+                out.number(f.second, i.width, i.pad);
+                break;
+            case OP_FRACTION: {
+                uint32_t value = (uint32_t)f.nanos;
+                for (int digits = 9; digits > i.width; --digits)
+                    value /= 10;
+                out.number(value, i.width, PAD_ZERO);
+                break;
+            }
+            case OP_MONTH_ABBREVIATION:
+                out.put(month_names[f.month - 1], 3);
+                break;
+            case OP_MONTH_NAME:
+                out.put(month_names[f.month - 1],
+                    strlen(month_names[f.month - 1]));
+                break;
+            case OP_WEEKDAY_ABBREVIATION:
+                out.put(weekday_names[f.weekday - 1], 3);
+                break;
+            case OP_WEEKDAY_NAME:
+                out.put(weekday_names[f.weekday - 1],
+                    strlen(weekday_names[f.weekday - 1]));
+                break;
+            case OP_ISO_WEEKDAY:
+                out.put((char)('0' + f.weekday));
+                break;
+            case OP_WEEKDAY_FROM_SUNDAY:
+                out.put((char)('0' + f.weekday % 7));
+                break;
+            case OP_OFFSET:
+            case OP_OFFSET_WITH_COLON:
+                out.offset(f.offset, i.op == OP_OFFSET_WITH_COLON);
+                break;
+            case OP_ZONE_ABBREVIATION:
+                out.put(f.abbreviation, strlen(f.abbreviation));
+                break;
+            case OP_EPOCH_SECONDS:
+                if (f.epoch_sec < 0)
+                    out.put('-');
+                out.number(f.epoch_sec < 0 ?
+                    0 - (uint64_t)f.epoch_sec : (uint64_t)f.epoch_sec,
+                    0, PAD_NONE);
+                break;
+        }
+    }
+}
+
+// The offset and the abbreviation at a range of instants.
+struct zone_cache {
+    int64_t begin = 0;
+    int64_t end = 0;
+    int offset = 0;
+    char abbreviation[ABBREVIATION_SIZE] = "UTC";
+
+    // Returns false if there's a problem with the time zone.
+    bool update(const DATETIME_PATTERN& pattern, int64_t epoch_sec) {
+        if (epoch_sec >= begin && epoch_sec < end)
+            return true;
+        if (pattern.zone == TZID_INVALID) {
+            begin = INT64_MIN;
+            end = INT64_MAX;
+            return true;
+        }
+        offset = offset_interval_at_instant(
+            pattern.zone, epoch_sec, &begin, &end);
+        if (offset != INT_MAX && pattern.needs_abbreviation) {
+            // the abbreviation may change along with the offset only.
+            offset = abbreviation_at_instant(pattern.zone, epoch_sec,
+                abbreviation, sizeof(abbreviation));
+        }
+        if (offset == INT_MAX) {
+            begin = end = 0;
+            return false;
+        }
+        return true;
+    }
+};
+
+/* Parsing */
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' ||
+        c == '\v';
+}
+
+static bool is_letter(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static char to_lower(char c) {
+    return c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+}
+
+// The fields of a parsed date-time, or -1 if they weren't parsed.
+struct parsed_fields {
+    int64_t year = 1970;
+    int year_of_century = -1;
+    int month = -1;
+    int day = -1;
+    int day_of_year = -1;
+    int hour = -1;
+    int hour_12 = -1;
+    int pm = -1;
+    int minute = 0;
+    int second = 0;
+    int weekday = -1;
+    int32_t nanos = 0;
+    int offset = INT_MAX;
+    bool has_epoch_sec = false;
+    int64_t epoch_sec = 0;
+};
+
+struct reader {
+    const char *p;
+    const char *end;
+
+    /* Reads an unsigned number of at most `max_digits` digits, skipping the
+       leading spaces for the space-padded fields. */
+    bool number(padding pad, int max_digits, int64_t& value) {
+        if (pad == PAD_SPACE) {
+            while (p != end && *p == ' ')
+                ++p;
+        }
+        int digits = 0;
+        value = 0;
+        for (; p != end && digits < max_digits &&
+            (unsigned)(*p - '0') <= 9; ++p, ++digits)
+            value = value * 10 + (*p - '0');
+        return digits != 0;
+    }
+
+    bool number(padding pad, int max_digits, int& value) {
+        int64_t result;
+        if (!number(pad, max_digits, result))
+            return false;
+        value = (int)result;
+        return true;
+    }
+
+    /* Matches one of the names, ignoring the case, either in full or by
+       the first three letters. Returns the index or -1. */
+    int name(const char *const *names, int count) {
+        for (int full = 1; full >= 0; --full) {
+            for (int i = 0; i < count; ++i) {
+                const size_t length = full ? strlen(names[i]) : 3;
+                if ((size_t)(end - p) < length)
+                    continue;
+                size_t j = 0;
+                while (j < length && to_lower(p[j]) == to_lower(names[i][j]))
+                    ++j;
+                if (j == length) {
+                    p += length;
+                    return i;
+                }
+            }
+        }
+        return -1;
+    }
+
+    /* Reads the seconds since the epoch, with an optional sign and at most
+       19 digits, which may still be out of the range of `int64_t`. */
+    bool epoch_seconds(int64_t& value) {
+        bool negative = false;
+        sign(negative);
+        uint64_t magnitude = 0;
+        int digits = 0;
+        for (; p != end && digits < 19 && (unsigned)(*p - '0') <= 9;
+            ++p, ++digits)
+            magnitude = magnitude * 10 + (uint64_t)(*p - '0');
+        if (digits == 0 || magnitude > (uint64_t)INT64_MAX + negative)
+            return false;
+        value = negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+        return true;
+    }
+
+    bool sign(bool& negative) {
+        if (p == end || (*p != '+' && *p != '-'))
+            return false;
+        negative = *p++ == '-';
+        return true;
+    }
+
+    // `+HH`, `+HHMM` or `+HH:MM`, or `Z`.
+    bool offset(int& result) {
+        if (p != end && (*p == 'Z' || *p == 'z')) {
+            ++p;
+            result = 0;
+            return true;
+        }
+        bool negative;
+        int hours, minutes = 0;
+        const char *start;
+        if (!sign(negative))
+            return false;
+        start = p;
+        if (!number(PAD_ZERO, 2, hours) || p - start != 2)
+            return false;
+        const char *before_minutes = p;
+        if (p != end && *p == ':')
+            ++p;
+        start = p;
+        if (!number(PAD_ZERO, 2, minutes) || p - start != 2) {
+            p = before_minutes;
+            minutes = 0;
+        }
+        if (minutes > 59 || hours * 3600 + minutes * 60 > MAX_OFFSET_SECS)
+            return false;
+        result = (hours * 3600 + minutes * 60) * (negative ? -1 : 1);
+        return true;
+    }
+};
+
+static bool parse_fields(const DATETIME_PATTERN& pattern, reader& in,
+    parsed_fields& f)
+{
+    for (const instruction& i : pattern.program) {
+        switch (i.op) {
+            case OP_LITERAL:
+                if ((size_t)(in.end - in.p) < i.literal_length ||
+                    memcmp(in.p, pattern.literals.data() + i.literal_begin,
+                        i.literal_length) != 0)
+                    return false;
+                in.p += i.literal_length;
+                break;
+            case OP_WHITESPACE:
+                while (in.p != in.end && is_space(*in.p))
+                    ++in.p;
+                break;
+            case OP_YEAR: {
+                bool negative = false;
+                const bool has_sign = in.sign(negative);
+                if (!in.number(i.pad, has_sign ? 12 : 4, f.year))
+                    return false;
+                if (negative)
+                    f.year = -f.year;
+                break;
+            }
+            case OP_YEAR_OF_CENTURY:
+                if (!in.number(i.pad, 2, f.year_of_century))
+                    return false;
+                break;
+            case OP_MONTH:
+                if (!in.number(i.pad, 2, f.month))
+                    return false;
+                break;
+            case OP_DAY:
+                if (!in.number(i.pad, 2, f.day))
+                    return false;
+                break;
+            case OP_DAY_OF_YEAR:
+                if (!in.number(i.pad, 3, f.day_of_year))
+                    return false;
+                break;
+            case OP_HOUR:
+                if (!in.number(i.pad, 2, f.hour))
+                    return false;
+                break;
+            case OP_HOUR_12:
+                if (!in.number(i.pad, 2, f.hour_12))
+                    return false;
+                break;
+            case OP_AM_PM: {
+                static const char *const am_pm[] = {"AM", "PM"};
+                f.pm = in.name(am_pm, 2);
+                if (f.pm < 0)
+                    return false;
+                break;
+            }
+            case OP_MINUTE:
+                if (!in.number(i.pad, 2, f.minute))
+                    return false;
+                break;
+            case OP_SECOND:
+                if (!in.number(i.pad, 2, f.second))
+                    return false;
+                break;
+            case OP_FRACTION: {
+                const char *start = in.p;
+                int64_t value;
+                if (!in.number(PAD_NONE, i.width, value))
+                    return false;
+                for (auto digits = in.p - start; digits < 9; ++digits)
+                    value *= 10;
+                f.nanos = (int32_t)value;
+                break;
+            }
+            case OP_MONTH_ABBREVIATION:
+            case OP_MONTH_NAME:
+                f.month = in.name(month_names, 12) + 1;
+                if (f.month == 0)
+                    return false;
+                break;
+            case OP_WEEKDAY_ABBREVIATION:
+            case OP_WEEKDAY_NAME:
+                f.weekday = in.name(weekday_names, 7) + 1;
+                if (f.weekday == 0)
+                    return false;
+                break;
+            case OP_ISO_WEEKDAY:
+            case OP_WEEKDAY_FROM_SUNDAY:
+                if (!in.number(i.pad, 1, f.weekday))
+                    return false;
+                if (i.op == OP_WEEKDAY_FROM_SUNDAY ?
+                    f.weekday > 6 : f.weekday < 1 || f.weekday > 7)
+                    return false;
+                if (f.weekday == 0)
+                    f.weekday = 7;
+                break;
+            case OP_OFFSET:
+            case OP_OFFSET_WITH_COLON:
+                if (!in.offset(f.offset))
+                    return false;
+                break;
+            case OP_ZONE_ABBREVIATION: {
+                if (in.p != in.end && (*in.p == '+' || *in.p == '-')) {
+                    // the numeric abbreviations like `+03`.
+                    if (!in.offset(f.offset))
+                        return false;
+                    break;
+                }
+                const char *start = in.p;
+                while (in.p != in.end && is_letter(*in.p))
+                    ++in.p;
+                const size_t length = (size_t)(in.p - start);
+                if (length == 0)
+                    return false;
+                if ((length == 3 && (strncmp(start, "UTC", 3) == 0 ||
+                    strncmp(start, "GMT", 3) == 0)) ||
+                    (length == 1 && *start == 'Z'))
+                    f.offset = 0;
+                break;
+            }
+            case OP_EPOCH_SECONDS:
+                if (!in.epoch_seconds(f.epoch_sec))
+                    return false;
+                f.has_epoch_sec = true;
+                break;
+        }
+    }
+    return in.p == in.end;
+}
+
+// Returns false if the fields are invalid or inconsistent.
+static bool resolve(const DATETIME_PATTERN& pattern, const parsed_fields& f,
+    int64_t& epoch_sec)
+{
+    if (f.has_epoch_sec) {
+        epoch_sec = f.epoch_sec;
+        return true;
+    }
+    int64_t year = f.year;
+    if (f.year_of_century >= 0)
+        year = f.year_of_century < 69 ?
+            2000 + f.year_of_century : 1900 + f.year_of_century;
+    int64_t epoch_day;
+    if (f.day_of_year >= 0 && f.month < 0 && f.day < 0) {
+        if (f.day_of_year < 1 ||
+            f.day_of_year > 365 + civil::is_leap_year(year))
+            return false;
+        epoch_day = civil::days_from_civil(year, 1, 1) + f.day_of_year - 1;
+    } else {
+        const int month = f.month < 0 ? 1 : f.month;
+        const int day = f.day < 0 ? 1 : f.day;
+        if (month < 1 || month > 12 || day < 1 ||
+            day > civil::days_in_month(year, month))
+            return false;
+        epoch_day = civil::days_from_civil(year, month, day);
+        if (f.day_of_year >= 0 &&
+            epoch_day - civil::days_from_civil(year, 1, 1) + 1 != f.day_of_year)
+            return false;
+    }
+    if (f.weekday >= 0 && civil::iso_day_of_week(epoch_day) != f.weekday)
+        return false;
+    int hour = f.hour < 0 ? 0 : f.hour;
+    if (f.hour_12 >= 0) {
+        if (f.hour_12 < 1 || f.hour_12 > 12)
+            return false;
+        const int from_12 = f.hour_12 % 12 + (f.pm == 1 ? 12 : 0);
+        if (f.hour >= 0 && f.hour != from_12)
+            return false;
+        hour = from_12;
+    } else if (f.pm >= 0 && f.hour >= 0 && (f.hour >= 12) != (f.pm == 1)) {
+        return false;
+    }
+    if (hour > 23 || f.minute > 59 || f.second > 59)
+        return false;
+    /* Any year that `%Y` formats is parsed back, so the local date-time
+       may be at the ends of `int64_t`; the negative days are counted from
+       their ends so as not to overflow on the first one. */
+    const bool shift = epoch_day < 0;
+    int64_t local;
+    if (__builtin_mul_overflow(epoch_day + shift, SECS_PER_DAY, &local) ||
+        __builtin_add_overflow(local, hour * 3600 + f.minute * 60 + f.second -
+            (shift ? SECS_PER_DAY : 0), &local))
+        return false;
+    if (f.offset != INT_MAX)
+        return !__builtin_sub_overflow(local, (int64_t)f.offset, &epoch_sec);
+    if (pattern.zone == TZID_INVALID) {
+        epoch_sec = local;
+        return true;
+    }
+    int offset = INT_MAX;
+    const int transition = offset_at_datetime(pattern.zone, local, &offset);
+    if (offset == INT_MAX)
+        return false;
+    return !__builtin_add_overflow(local, (int64_t)(transition - offset),
+        &epoch_sec);
+}
+
+static bool parse(const DATETIME_PATTERN& pattern, const char *text,
+    size_t length, int64_t& epoch_sec, int32_t& nanos)
+{
+    reader in{text, text + length};
+    parsed_fields f;
+    if (!parse_fields(pattern, in, f) || !resolve(pattern, f, epoch_sec))
+        return false;
+    nanos = f.nanos;
+    return true;
+}
+
+extern "C" {
+
+DATETIME_PATTERN * datetime_pattern_compile(const char *pattern, TZID zone)
+{
+    probes::call probe(__func__, zone, 0);
+    auto result = check_allocation(new (std::nothrow) DATETIME_PATTERN());
+    result->zone = zone;
+    result->needs_abbreviation = false;
+    if (!compile(*result, pattern)) {
+        delete result;
+        return probe.returns(nullptr);
+    }
+    result->max_length = 0;
+    for (const instruction& i : result->program)
+        result->max_length += max_length(i);
+    if (result->max_length > DATETIME_PATTERN_MAX_LENGTH) {
+        delete result;
+        return probe.returns(nullptr);
+    }
+    return probe.returns(result);
+}
+
+void datetime_pattern_free(DATETIME_PATTERN *pattern)
+{
+    probes::call probe(__func__, probes::no_zone, 0);
+    delete pattern;
+}
+
+size_t datetime_pattern_max_length(const DATETIME_PATTERN *pattern)
+{
+    probes::call probe(__func__, probes::no_zone, 0);
+    return probe.returns(pattern->max_length);
+}
+
+int datetime_pattern_format(const DATETIME_PATTERN *pattern,
+    int64_t epoch_sec, int32_t nanos, char *buffer, size_t size)
+{
+    probes::call probe(__func__, pattern->zone, epoch_sec);
+    zone_cache zone;
+    civil_fields f;
+    if (nanos < 0 || nanos >= NANOS_PER_SEC ||
+        !zone.update(*pattern, epoch_sec) ||
+        !to_civil_fields(epoch_sec, nanos, zone.offset, zone.abbreviation, f))
+        return probe.returns(-1);
+    if (size > pattern->max_length) {
+        writer out{buffer};
+        format(*pattern, f, out);
+        *out.p = '\0';
+        return probe.returns((int)(out.p - buffer));
+    }
+    // the result may still fit.
+    char temporary[DATETIME_PATTERN_MAX_LENGTH];
+    writer out{temporary};
+    format(*pattern, f, out);
+    const size_t length = (size_t)(out.p - temporary);
+    if (length >= size)
+        return probe.returns(-1);
+    memcpy(buffer, temporary, length);
+    buffer[length] = '\0';
+    return probe.returns((int)length);
+}
+
+int datetime_pattern_parse(const DATETIME_PATTERN *pattern,
+    const char *text, size_t length, int64_t *epoch_sec, int32_t *nanos)
+{
+    probes::call probe(__func__, pattern->zone, length);
+    int64_t sec;
+    int32_t nano;
+    if (!parse(*pattern, text, length, sec, nano))
+        return probe.returns(-1);
+    *epoch_sec = sec;
+    *nanos = nano;
+    return probe.returns(0);
+}
+
+int datetime_pattern_format_batch(const DATETIME_PATTERN *pattern,
+    const int64_t *epoch_secs, const int32_t *nanos, size_t count,
+    char *buffer, size_t size, int32_t *offsets)
+{
+    probes::call probe(__func__, pattern->zone, count);
+    zone_cache zone;
+    size_t written = 0;
+    offsets[0] = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const int32_t nano = nanos == nullptr ? 0 : nanos[i];
+        civil_fields f;
+        if (nano < 0 || nano >= NANOS_PER_SEC ||
+            !zone.update(*pattern, epoch_secs[i]) ||
+            !to_civil_fields(epoch_secs[i], nano, zone.offset,
+                zone.abbreviation, f))
+            return probe.returns(-1);
+        if (size - written >= pattern->max_length) {
+            writer out{buffer + written};
+            format(*pattern, f, out);
+            written = (size_t)(out.p - buffer);
+        } else {
+            // near the end of the buffer, the result may still fit.
+            char temporary[DATETIME_PATTERN_MAX_LENGTH];
+            writer out{temporary};
+            format(*pattern, f, out);
+            const size_t length = (size_t)(out.p - temporary);
+            if (length > size - written)
+                return probe.returns(-1);
+            memcpy(buffer + written, temporary, length);
+            written += length;
+        }
+        if (written > INT32_MAX)
+            return probe.returns(-1);
+        offsets[i + 1] = (int32_t)written;
+    }
+    return probe.returns(0);
+}
+
+int datetime_pattern_parse_batch(const DATETIME_PATTERN *pattern,
+    const char *buffer, const int32_t *offsets, size_t count,
+    int64_t *epoch_secs, int32_t *nanos)
+{
+    probes::call probe(__func__, pattern->zone, count);
+    int result = 0;
+    for (size_t i = 0; i < count; ++i) {
+        int64_t sec;
+        int32_t nano;
+        if (!parse(*pattern, buffer + offsets[i],
+            (size_t)(offsets[i + 1] - offsets[i]), sec, nano))
+        {
+            sec = INT64_MAX;
+            nano = 0;
+            result = -1;
+        }
+        epoch_secs[i] = sec;
+        if (nanos != nullptr)
+            nanos[i] = nano;
+    }
+    return probe.returns(result);
+}
+
+}
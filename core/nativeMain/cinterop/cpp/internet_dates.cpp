@@ -0,0 +1,211 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file implements the RFC 3339, RFC 2822 and HTTP date-times specified
+   in `cdate.h`. The offsets are always given by the callers. */
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include "civil.hpp"
+#include "internet_dates.hpp"
+#include "iso8601.hpp"
+#include "probes.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+#define NANOS_PER_SEC 1000000000
+#define MAX_OFFSET_SECS (18 * 3600)
+
+// The local date-time at an instant, with the offset rounded to minutes.
+struct internet_fields {
+    int64_t year;
+    int month;
+    int day;
+    int weekday;
+    int32_t second_of_day;
+    int32_t offset_sec;
+};
+
+// The local date-times in the years [0; 9999], which all the formats require.
+static constexpr int64_t min_local_sec =
+    civil::days_from_civil(0, 1, 1) * SECS_PER_DAY;
+static constexpr int64_t end_local_sec =
+    civil::days_from_civil(10000, 1, 1) * SECS_PER_DAY;
+
+/* Returns false if the year is outside [0; 9999]. This is checked before
+   the offset is added, so that the instants near the ends of `int64_t`
+   don't overflow. The offset is truncated to whole minutes, so that the
+   formatted date-time, with its offset, still denotes the same instant. */
+static bool to_internet_fields(int64_t epoch_sec, int offset_sec,
+    internet_fields& f)
+{
+    f.offset_sec = offset_sec / 60 * 60;
+    if (epoch_sec < min_local_sec - f.offset_sec ||
+        epoch_sec >= end_local_sec - f.offset_sec)
+        return false;
+    const int64_t local_sec = epoch_sec + f.offset_sec;
+    const int64_t epoch_day = civil::floor_div(local_sec, SECS_PER_DAY);
+    f.second_of_day = (int32_t)(local_sec - epoch_day * SECS_PER_DAY);
+    civil::civil_from_days(epoch_day, f.year, f.month, f.day);
+    f.weekday = civil::iso_day_of_week(epoch_day);
+    return true;
+}
+
+static char * write_time(char *p, int32_t second_of_day) {
+    p = iso_write_digits(p, 2, second_of_day / 3600);
+    *p++ = ':';
+    p = iso_write_digits(p, 2, second_of_day / 60 % 60);
+    *p++ = ':';
+    return iso_write_digits(p, 2, second_of_day % 60);
+}
+
+// Writes `Sun, 30 Aug 2020 18:43:00`, common to RFC 2822 and IMF-fixdate.
+static char * write_rfc2822_datetime(char *p, const internet_fields& f) {
+    memcpy(p, internet_weekday_names[f.weekday - 1], 3);
+    p[3] = ',';
+    p[4] = ' ';
+    p = iso_write_digits(p + 5, 2, f.day);
+    *p++ = ' ';
+    memcpy(p, internet_month_names[f.month - 1], 3);
+    p[3] = ' ';
+    p = iso_write_digits(p + 4, 4, (uint32_t)f.year);
+    *p++ = ' ';
+    return write_time(p, f.second_of_day);
+}
+
+static void write_imf_fixdate(const internet_fields& f, char *out) {
+    char *p = write_rfc2822_datetime(out, f);
+    memcpy(p, " GMT", 4);
+}
+
+// Copies the result, followed by a zero, into the buffer of the caller.
+static int copy_result(const char *text, size_t length, char *buffer,
+    size_t size)
+{
+    if (size <= length)
+        return -1;
+    memcpy(buffer, text, length);
+    buffer[length] = 0;
+    return (int)length;
+}
+
+int format_rfc3339(int64_t epoch_sec, int32_t nanos, int offset_sec,
+    char *buffer, size_t size)
+{
+    probes::call probe(__func__, probes::no_zone, epoch_sec);
+    internet_fields f;
+    if (nanos < 0 || nanos >= NANOS_PER_SEC || offset_sec < -MAX_OFFSET_SECS ||
+        offset_sec > MAX_OFFSET_SECS || !to_internet_fields(epoch_sec,
+        offset_sec, f))
+        return probe.returns(-1);
+    char text[RFC3339_MAX_LENGTH];
+    char *p = iso_write_digits(text, 4, (uint32_t)f.year);
+    *p++ = '-';
+    p = iso_write_digits(p, 2, f.month);
+    *p++ = '-';
+    p = iso_write_digits(p, 2, f.day);
+    *p++ = 'T';
+    p = write_time(p, f.second_of_day);
+    if (nanos != 0) {
+        *p++ = '.';
+        if (nanos % 1000000 == 0)
+            p = iso_write_digits(p, 3, nanos / 1000000);
+        else if (nanos % 1000 == 0)
+            p = iso_write_digits(p, 6, nanos / 1000);
+        else
+            p = iso_write_digits(p, 9, nanos);
+    }
+    if (f.offset_sec == 0) {
+        *p++ = 'Z';
+    } else {
+        const uint32_t absolute =
+            f.offset_sec < 0 ? -f.offset_sec : f.offset_sec;
+        *p++ = f.offset_sec < 0 ? '-' : '+';
+        p = iso_write_digits(p, 2, absolute / 3600);
+        *p++ = ':';
+        p = iso_write_digits(p, 2, absolute / 60 % 60);
+    }
+    return probe.returns(copy_result(text, (size_t)(p - text), buffer, size));
+}
+
+int format_rfc2822(int64_t epoch_sec, int offset_sec,
+    char *buffer, size_t size)
+{
+    probes::call probe(__func__, probes::no_zone, epoch_sec);
+    internet_fields f;
+    if (offset_sec < -MAX_OFFSET_SECS || offset_sec > MAX_OFFSET_SECS ||
+        !to_internet_fields(epoch_sec, offset_sec, f))
+        return probe.returns(-1);
+    char text[RFC2822_MAX_LENGTH];
+    char *p = write_rfc2822_datetime(text, f);
+    const uint32_t absolute = f.offset_sec < 0 ? -f.offset_sec : f.offset_sec;
+    *p++ = ' ';
+    *p++ = f.offset_sec < 0 ? '-' : '+';
+    p = iso_write_digits(p, 2, absolute / 3600);
+    p = iso_write_digits(p, 2, absolute / 60 % 60);
+    return probe.returns(copy_result(text, (size_t)(p - text), buffer, size));
+}
+
+int format_imf_fixdate(int64_t epoch_sec, char *buffer, size_t size) {
+    probes::call probe(__func__, probes::no_zone, epoch_sec);
+    internet_fields f;
+    if (!to_internet_fields(epoch_sec, 0, f))
+        return probe.returns(-1);
+    char text[IMF_FIXDATE_LENGTH];
+    write_imf_fixdate(f, text);
+    return probe.returns(copy_result(text, IMF_FIXDATE_LENGTH, buffer, size));
+}
+
+int format_imf_fixdate_now(char *buffer, size_t size) {
+    probes::call probe(__func__, probes::no_zone, 0);
+    /* The `Date` header of every response needs the current time, which
+       changes once a second, so each thread keeps the last string. */
+    struct cached_now {
+        int64_t epoch_sec = INT64_MIN;
+        char text[IMF_FIXDATE_LENGTH];
+    };
+    static thread_local cached_now cache;
+    const int64_t now = (int64_t)time(nullptr);
+    if (now != cache.epoch_sec) {
+        internet_fields f;
+        if (!to_internet_fields(now, 0, f))
+            return probe.returns(-1);
+        write_imf_fixdate(f, cache.text);
+        cache.epoch_sec = now;
+    }
+    return probe.returns(
+        copy_result(cache.text, IMF_FIXDATE_LENGTH, buffer, size));
+}
+
+int parse_rfc3339(const char *text, size_t length,
+    int64_t *epoch_sec, int32_t *nanos, int *offset_sec)
+{
+    probes::call probe(__func__, probes::no_zone, length);
+    iso_datetime result;
+    if (!parse_rfc3339(text, text + length, result))
+        return probe.returns(-1);
+    *epoch_sec = result.local_sec - result.offset_sec;
+    *nanos = result.nanosecond;
+    *offset_sec = result.offset_sec;
+    return probe.returns(0);
+}
+
+int parse_rfc2822(const char *text, size_t length,
+    int64_t *epoch_sec, int *offset_sec)
+{
+    probes::call probe(__func__, probes::no_zone, length);
+    iso_datetime result;
+    if (!parse_rfc2822(text, text + length, result))
+        return probe.returns(-1);
+    *epoch_sec = result.local_sec - result.offset_sec;
+    *offset_sec = result.offset_sec;
+    return probe.returns(0);
+}
+
+int parse_http_date(const char *text, size_t length, int64_t *epoch_sec) {
+    probes::call probe(__func__, probes::no_zone, length);
+    return probe.returns(
+        parse_http_date(text, text + length, *epoch_sec) ? 0 : -1);
+}
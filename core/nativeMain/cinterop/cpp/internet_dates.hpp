@@ -0,0 +1,385 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file contains the parsing of the date-times used in the Internet
+   protocols: RFC 3339, RFC 2822 with its obsolete syntax, and the three
+   formats that HTTP allows. Like in `iso8601.hpp`, the input is a range of
+   characters, and nothing allocates.
+
+   The names of the months, of the days of the week and of the time zones
+   are found by perfect hashing: the three lowercase letters, as an
+   integer, are multiplied by a constant chosen so that the top bits of the
+   product are different for all the names, and then index a small table,
+   so a name is recognized with one multiplication and one comparison. */
+#pragma once
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include "civil.hpp"
+#include "iso8601.hpp"
+
+static const char *const internet_month_names[] = {
+    "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+    "Jul", "Aug", "Sep", "Oct", "Nov", "Dec",
+};
+
+// From Monday, like the ISO days of the week.
+static const char *const internet_weekday_names[] = {
+    "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday",
+    "Sunday",
+};
+
+struct internet_zone_name {
+    const char *name;
+    int32_t offset_sec;
+};
+
+// The time zone names of RFC 2822, section 4.3.
+static const internet_zone_name internet_zone_names[] = {
+    {"UT", 0}, {"GMT", 0},
+    {"EST", -5 * 3600}, {"EDT", -4 * 3600},
+    {"CST", -6 * 3600}, {"CDT", -5 * 3600},
+    {"MST", -7 * 3600}, {"MDT", -6 * 3600},
+    {"PST", -8 * 3600}, {"PDT", -7 * 3600},
+};
+
+/* The hash tables: the multiplier, and the index of the name for each value
+   of the top bits of the product, or -1. */
+#define INTERNET_MONTH_HASH 0x4dc38505u
+static const int8_t internet_month_slots[16] = {
+    1, 4, -1, 3, 8, 7, 2, 0, 10, 9, 6, 5, -1, -1, -1, 11,
+};
+#define INTERNET_WEEKDAY_HASH 0x60fcf9dfu
+static const int8_t internet_weekday_slots[8] = {
+    -1, 1, 0, 2, 6, 5, 4, 3,
+};
+#define INTERNET_ZONE_HASH 0xb54cda27u
+static const int8_t internet_zone_slots[16] = {
+    -1, 7, -1, 9, -1, -1, 3, 4, 1, 6, 0, 8, -1, -1, 2, 5,
+};
+
+// The first `length` (at most three) letters of `name`, lowercase.
+static inline uint32_t internet_name_key(const char *name, size_t length) {
+    uint32_t key = 0;
+    for (size_t i = 0; i < length && i < 3; ++i)
+        key |= (uint32_t)(uint8_t)(name[i] | 0x20) << (8 * i);
+    return key;
+}
+
+/* Reads a word of ASCII letters at `p`, advancing it. Returns the key of
+   the word if it has one to three letters, or 0. */
+static inline uint32_t internet_read_word(const char *&p, const char *end,
+    size_t& length)
+{
+    const char *begin = p;
+    while (p != end && (unsigned)((*p | 0x20) - 'a') < 26)
+        ++p;
+    length = (size_t)(p - begin);
+    return length >= 1 && length <= 3 ? internet_name_key(begin, length) : 0;
+}
+
+/* Returns the index of the name with the given key, or -1. `Bits` is the
+   logarithm of the size of the table. */
+template <int Bits, typename Name>
+static inline int internet_lookup(uint32_t key, uint32_t multiplier,
+    const int8_t *slots, const Name *names, const char *(*name_of)(Name))
+{
+    const int index = slots[(uint32_t)(key * multiplier) >> (32 - Bits)];
+    if (index < 0)
+        return -1;
+    const char *name = name_of(names[index]);
+    size_t length = 0;
+    while (length < 3 && name[length] != 0)
+        ++length;
+    return internet_name_key(name, length) == key ? index : -1;
+}
+
+static inline const char *internet_plain_name(const char *name) {
+    return name;
+}
+
+static inline const char *internet_zone_name_of(internet_zone_name zone) {
+    return zone.name;
+}
+
+// Returns the month from 1, or 0 if the key is not a month name.
+static inline int internet_month(uint32_t key) {
+    return internet_lookup<4>(key, INTERNET_MONTH_HASH, internet_month_slots,
+        internet_month_names, internet_plain_name) + 1;
+}
+
+/* Returns the ISO day of the week of the name at [begin; end), which is
+   either abbreviated or, if `full` is set, in full, or 0. */
+static inline int internet_weekday(const char *begin, const char *end,
+    bool full)
+{
+    const size_t length = (size_t)(end - begin);
+    if (length < 3 || (!full && length != 3))
+        return 0;
+    const int index = internet_lookup<3>(internet_name_key(begin, 3),
+        INTERNET_WEEKDAY_HASH, internet_weekday_slots,
+        internet_weekday_names, internet_plain_name);
+    if (index < 0)
+        return 0;
+    if (full) {
+        const char *name = internet_weekday_names[index];
+        for (size_t i = 3; i < length; ++i) {
+            if (name[i] == 0 || (begin[i] | 0x20) != name[i])
+                return 0;
+        }
+        if (name[length] != 0)
+            return 0;
+    }
+    return index + 1;
+}
+
+/* Parses `YYYY-MM-DDTHH:MM:SS`, with an optional fraction of a second,
+   followed by `Z` or an offset like `+05:30`, occupying the whole range
+   [p; end). As RFC 3339 allows, `T` may also be `t` or a space, and `Z` may
+   be `z`. The digits of the fraction after the ninth are ignored. A leap
+   second, `60`, is rejected. */
+static inline bool parse_rfc3339(const char *p, const char *end,
+    iso_datetime& result)
+{
+    int32_t year, month, day, hour, minute, second, nanosecond = 0;
+    if (!iso_parse_digits(p, end, 4, year) || !iso_skip(p, end, '-') ||
+        !iso_parse_digits(p, end, 2, month) || !iso_skip(p, end, '-') ||
+        !iso_parse_digits(p, end, 2, day) || p == end ||
+        (*p != 'T' && *p != 't' && *p != ' '))
+        return false;
+    ++p;
+    if (!iso_parse_digits(p, end, 2, hour) || !iso_skip(p, end, ':') ||
+        !iso_parse_digits(p, end, 2, minute) || !iso_skip(p, end, ':') ||
+        !iso_parse_digits(p, end, 2, second))
+        return false;
+    if (month < 1 || month > 12 || day < 1 ||
+        day > civil::days_in_month(year, month) ||
+        hour > 23 || minute > 59 || second > 59)
+        return false;
+    if (iso_skip(p, end, '.')) {
+        int digits = 0;
+        for (; p != end && (unsigned)(*p - '0') <= 9; ++p, ++digits) {
+            if (digits < 9)
+                nanosecond = nanosecond * 10 + (*p - '0');
+        }
+        if (digits == 0)
+            return false;
+        for (; digits < 9; ++digits)
+            nanosecond *= 10;
+    }
+    if (p == end)
+        return false;
+    if (*p == 'Z' || *p == 'z') {
+        if (++p != end)
+            return false;
+        result.offset_sec = 0;
+    } else {
+        int32_t offset_hours, offset_minutes;
+        const char sign = *p++;
+        if ((sign != '+' && sign != '-') ||
+            !iso_parse_digits(p, end, 2, offset_hours) ||
+            !iso_skip(p, end, ':') ||
+            !iso_parse_digits(p, end, 2, offset_minutes) || p != end ||
+            offset_hours > 23 || offset_minutes > 59)
+            return false;
+        result.offset_sec = offset_hours * 3600 + offset_minutes * 60;
+        if (sign == '-')
+            result.offset_sec = -result.offset_sec;
+    }
+    result.local_sec =
+        civil::days_from_civil(year, month, day) * SECS_PER_DAY +
+        hour * 3600 + minute * 60 + second;
+    result.nanosecond = nanosecond;
+    return true;
+}
+
+/* Skips the whitespace and the comments in parentheses, which may be
+   nested and have escaped characters. Returns false if a comment is not
+   closed. */
+static inline bool internet_skip_cfws(const char *&p, const char *end) {
+    int depth = 0;
+    for (; p != end; ++p) {
+        if (*p == '(') {
+            ++depth;
+        } else if (depth != 0 && *p == ')') {
+            --depth;
+        } else if (depth != 0 && *p == '\\') {
+            if (++p == end)
+                return false;
+        } else if (depth == 0 && *p != ' ' && *p != '\t' && *p != '\r' &&
+            *p != '\n') {
+            break;
+        }
+    }
+    return depth == 0;
+}
+
+/* Reads from `min` to `max` digits at `p`, advancing it, and sets `count`
+   to their number. */
+static inline bool internet_read_number(const char *&p, const char *end,
+    int min, int max, int32_t& value, int& count)
+{
+    value = 0;
+    for (count = 0; p != end && count < max &&
+        (unsigned)(*p - '0') <= 9; ++p, ++count)
+        value = value * 10 + (*p - '0');
+    return count >= min && (p == end || (unsigned)(*p - '0') > 9);
+}
+
+/* Parses a date-time like `Sun, 30 Aug 2020 18:43:00 +0200`, occupying the
+   whole range [p; end), with the obsolete syntax of RFC 2822 accepted too:
+   comments and whitespace between any of the parts, no seconds, two- and
+   three-digit years, and the zone names `UT`, `GMT`, `EST`, `EDT`, `CST`,
+   `CDT`, `MST`, `MDT`, `PST` and `PDT`. The single-letter military zones
+   give the zero offset, as RFC 2822 recommends, and so does `-0000`. The day
+   of the week, if any, is checked against the date. */
+static inline bool parse_rfc2822(const char *p, const char *end,
+    iso_datetime& result)
+{
+    int weekday = 0;
+    size_t length;
+    int count;
+    if (!internet_skip_cfws(p, end))
+        return false;
+    if (p != end && (unsigned)(*p - '0') > 9) {
+        const char *begin = p;
+        internet_read_word(p, end, length);
+        weekday = internet_weekday(begin, p, false);
+        if (weekday == 0 || !internet_skip_cfws(p, end) ||
+            !iso_skip(p, end, ',') || !internet_skip_cfws(p, end))
+            return false;
+    }
+    int32_t day, year, hour, minute, second = 0;
+    if (!internet_read_number(p, end, 1, 2, day, count) ||
+        !internet_skip_cfws(p, end))
+        return false;
+    const int month = internet_month(internet_read_word(p, end, length));
+    if (month == 0 || !internet_skip_cfws(p, end) ||
+        !internet_read_number(p, end, 2, 4, year, count) ||
+        !internet_skip_cfws(p, end))
+        return false;
+    if (count == 2)
+        year += year < 50 ? 2000 : 1900;
+    else if (count == 3)
+        year += 1900;
+    if (!internet_read_number(p, end, 2, 2, hour, count) ||
+        !internet_skip_cfws(p, end) || !iso_skip(p, end, ':') ||
+        !internet_skip_cfws(p, end) ||
+        !internet_read_number(p, end, 2, 2, minute, count) ||
+        !internet_skip_cfws(p, end))
+        return false;
+    if (iso_skip(p, end, ':') && (!internet_skip_cfws(p, end) ||
+        !internet_read_number(p, end, 2, 2, second, count) ||
+        !internet_skip_cfws(p, end)))
+        return false;
+    if (p == end)
+        return false;
+    if (*p == '+' || *p == '-') {
+        const bool negative = *p++ == '-';
+        int32_t offset;
+        if (!internet_read_number(p, end, 4, 4, offset, count) ||
+            offset % 100 > 59 || offset > 1800)
+            return false;
+        result.offset_sec = (offset / 100 * 60 + offset % 100) * 60;
+        if (negative)
+            result.offset_sec = -result.offset_sec;
+    } else {
+        const char *begin = p;
+        const uint32_t key = internet_read_word(p, end, length);
+        if (length == 1 && (*begin | 0x20) != 'j') {
+            result.offset_sec = 0;
+        } else {
+            const int index = internet_lookup<4>(key, INTERNET_ZONE_HASH,
+                internet_zone_slots, internet_zone_names,
+                internet_zone_name_of);
+            if (key == 0 || index < 0)
+                return false;
+            result.offset_sec = internet_zone_names[index].offset_sec;
+        }
+    }
+    if (!internet_skip_cfws(p, end) || p != end)
+        return false;
+    if (month < 1 || day < 1 || day > civil::days_in_month(year, month) ||
+        hour > 23 || minute > 59 || second > 60)
+        return false;
+    const int64_t epoch_day = civil::days_from_civil(year, month, day);
+    if (weekday != 0 && civil::iso_day_of_week(epoch_day) != weekday)
+        return false;
+    // A leap second can't be represented, so it becomes the last second.
+    result.local_sec = epoch_day * SECS_PER_DAY + hour * 3600 +
+        minute * 60 + (second == 60 ? 59 : second);
+    result.nanosecond = 0;
+    return true;
+}
+
+/* Parses `HH:MM:SS` at `p`, advancing it, into the seconds of the day. */
+static inline bool internet_parse_time(const char *&p, const char *end,
+    int32_t& second_of_day)
+{
+    int32_t hour, minute, second;
+    if (!iso_parse_digits(p, end, 2, hour) || !iso_skip(p, end, ':') ||
+        !iso_parse_digits(p, end, 2, minute) || !iso_skip(p, end, ':') ||
+        !iso_parse_digits(p, end, 2, second) ||
+        hour > 23 || minute > 59 || second > 60)
+        return false;
+    second_of_day = hour * 3600 + minute * 60 + (second == 60 ? 59 : second);
+    return true;
+}
+
+/* Parses an HTTP date occupying the whole range [p; end), in any of the
+   three formats that RFC 7231 requires the recipients to accept:
+   IMF-fixdate, `Sun, 06 Nov 1994 08:49:37 GMT`; the obsolete RFC 850 one,
+   `Sunday, 06-Nov-94 08:49:37 GMT`, where the years 50 and later are in the
+   1900s; and that of `asctime`, `Sun Nov  6 08:49:37 1994`. Only the UTC
+   date-times are valid, so the result is the number of seconds since
+   1970-01-01T00:00Z. The day of the week is checked against the date. */
+static inline bool parse_http_date(const char *p, const char *end,
+    int64_t& epoch_sec)
+{
+    const char *word = p;
+    size_t length;
+    internet_read_word(p, end, length);
+    const char *word_end = p;
+    int32_t day, year, second_of_day;
+    int month, weekday;
+    if (iso_skip(p, end, ',')) {
+        const bool fixdate = length == 3;
+        weekday = internet_weekday(word, word_end, !fixdate);
+        if (!iso_skip(p, end, ' ') || !iso_parse_digits(p, end, 2, day) ||
+            !iso_skip(p, end, fixdate ? ' ' : '-'))
+            return false;
+        month = internet_month(internet_read_word(p, end, length));
+        if (length != 3 || !iso_skip(p, end, fixdate ? ' ' : '-') ||
+            !iso_parse_digits(p, end, fixdate ? 4 : 2, year) ||
+            !iso_skip(p, end, ' ') ||
+            !internet_parse_time(p, end, second_of_day) ||
+            !iso_skip(p, end, ' ') || end - p != 3 ||
+            p[0] != 'G' || p[1] != 'M' || p[2] != 'T')
+            return false;
+        if (!fixdate)
+            year += year < 50 ? 2000 : 1900;
+    } else {
+        weekday = internet_weekday(word, word_end, false);
+        if (!iso_skip(p, end, ' '))
+            return false;
+        month = internet_month(internet_read_word(p, end, length));
+        if (length != 3 || !iso_skip(p, end, ' '))
+            return false;
+        // The day is padded with a space.
+        if (!(iso_skip(p, end, ' ') ? iso_parse_digits(p, end, 1, day) :
+            iso_parse_digits(p, end, 2, day)) || !iso_skip(p, end, ' ') ||
+            !internet_parse_time(p, end, second_of_day) ||
+            !iso_skip(p, end, ' ') || !iso_parse_digits(p, end, 4, year) ||
+            p != end)
+            return false;
+    }
+    if (weekday == 0 || month == 0 || day < 1 ||
+        day > civil::days_in_month(year, month))
+        return false;
+    const int64_t epoch_day = civil::days_from_civil(year, month, day);
+    if (civil::iso_day_of_week(epoch_day) != weekday)
+        return false;
+    epoch_sec = epoch_day * SECS_PER_DAY + second_of_day;
+    return true;
+}
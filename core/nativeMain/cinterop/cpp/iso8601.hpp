@@ -0,0 +1,219 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file contains the parsing and formatting of the ISO 8601 date-times,
+   in the same extended format that the `toString` and `parse` functions of
+   the library use. Nothing here allocates: the input is a range of
+   characters, and the output goes to a buffer provided by the caller, so
+   both can be used directly on the memory of large files. */
+#pragma once
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include "civil.hpp"
+
+#define ISO_YEAR_MAX 999999
+#define ISO_MAX_OFFSET_SECS (18 * 3600)
+// "+999999-12-31T23:59:59.999999999+18:00:00" is the longest output.
+#define ISO_DATETIME_MAX_LENGTH 48
+
+/* A parsed date-time: the local date-time in seconds since
+   1970-01-01T00:00, and the offset, or INT_MAX if it wasn't given. */
+struct iso_datetime {
+    int64_t local_sec;
+    int32_t nanosecond;
+    int32_t offset_sec;
+};
+
+// Parses exactly `count` digits at `p`, advancing it.
+static inline bool iso_parse_digits(const char *&p, const char *end,
+    int count, int32_t& value)
+{
+    if (end - p < count)
+        return false;
+    value = 0;
+    for (int i = 0; i < count; ++i) {
+        const unsigned digit = (unsigned)(p[i] - '0');
+        if (digit > 9)
+            return false;
+        value = value * 10 + (int32_t)digit;
+    }
+    p += count;
+    return true;
+}
+
+static inline bool iso_skip(const char *&p, const char *end, char c) {
+    if (p == end || *p != c)
+        return false;
+    ++p;
+    return true;
+}
+
+/* Parses `Z`, `+HH`, `+HHMM`, `+HH:MM` or `+HH:MM:SS`, or the same with
+   `-`, until `end`. */
+static inline bool iso_parse_offset(const char *p, const char *end,
+    int32_t& offset_sec)
+{
+    if (end - p == 1 && (*p == 'Z' || *p == 'z')) {
+        offset_sec = 0;
+        return true;
+    }
+    if (p == end || (*p != '+' && *p != '-'))
+        return false;
+    const bool negative = *p++ == '-';
+    int32_t hours, minutes = 0, seconds = 0;
+    if (!iso_parse_digits(p, end, 2, hours))
+        return false;
+    if (p != end) {
+        const bool colon = iso_skip(p, end, ':');
+        if (!iso_parse_digits(p, end, 2, minutes))
+            return false;
+        if (colon && p != end &&
+            (!iso_skip(p, end, ':') || !iso_parse_digits(p, end, 2, seconds)))
+            return false;
+    }
+    if (p != end || minutes > 59 || seconds > 59)
+        return false;
+    offset_sec = hours * 3600 + minutes * 60 + seconds;
+    if (offset_sec > ISO_MAX_OFFSET_SECS)
+        return false;
+    if (negative)
+        offset_sec = -offset_sec;
+    return true;
+}
+
+/* Parses a date-time like `2020-08-30T18:43:00.123+02:00` occupying the whole
+   range [p; end). The seconds, the fraction of a second and the offset are
+   optional, and so is the whole time, which then is the start of the day.
+   The date and the time may be separated by `T` or by a space. Years outside
+   [0; 9999] have a sign and more than four digits. */
+static inline bool parse_iso_datetime(const char *p, const char *end,
+    iso_datetime& result)
+{
+    bool negative_year = false;
+    int year_digits = 4;
+    if (p != end && (*p == '+' || *p == '-')) {
+        negative_year = *p++ == '-';
+        year_digits = 0;
+        while (p + year_digits != end &&
+            (unsigned)(p[year_digits] - '0') <= 9)
+            ++year_digits;
+        if (year_digits < 4 || year_digits > 6)
+            return false;
+    }
+    int32_t year, month, day;
+    if (!iso_parse_digits(p, end, year_digits, year) ||
+        !iso_skip(p, end, '-') || !iso_parse_digits(p, end, 2, month) ||
+        !iso_skip(p, end, '-') || !iso_parse_digits(p, end, 2, day))
+        return false;
+    if (negative_year)
+        year = -year;
+    if (month < 1 || month > 12 || day < 1 ||
+        day > civil::days_in_month(year, month))
+        return false;
+    int32_t hour = 0, minute = 0, second = 0, nanosecond = 0;
+    result.offset_sec = INT_MAX;
+    if (p != end) {
+        if (*p != 'T' && *p != 't' && *p != ' ')
+            return false;
+        ++p;
+        if (!iso_parse_digits(p, end, 2, hour) || !iso_skip(p, end, ':') ||
+            !iso_parse_digits(p, end, 2, minute))
+            return false;
+        if (iso_skip(p, end, ':')) {
+            if (!iso_parse_digits(p, end, 2, second))
+                return false;
+            if (p != end && (*p == '.' || *p == ',')) {
+                ++p;
+                int digits = 0;
+                for (; p != end && (unsigned)(*p - '0') <= 9; ++p, ++digits) {
+                    if (digits == 9)
+                        return false;
+                    nanosecond = nanosecond * 10 + (*p - '0');
+                }
+                if (digits == 0)
+                    return false;
+                for (; digits < 9; ++digits)
+                    nanosecond *= 10;
+            }
+        }
+        if (hour > 23 || minute > 59 || second > 59)
+            return false;
+        if (p != end && !iso_parse_offset(p, end, result.offset_sec))
+            return false;
+    }
+    result.local_sec =
+        civil::days_from_civil(year, month, day) * SECS_PER_DAY +
+        hour * 3600 + minute * 60 + second;
+    result.nanosecond = nanosecond;
+    return true;
+}
+
+// Writes exactly `count` digits of `value`, which has to fit into them.
+static inline char * iso_write_digits(char *out, int count, uint32_t value) {
+    for (int i = count - 1; i >= 0; --i) {
+        out[i] = (char)('0' + value % 10);
+        value /= 10;
+    }
+    return out + count;
+}
+
+/* Writes the local date-time and, unless `offset_sec` is INT_MAX, the
+   offset, using `Z` for the zero one. The fraction of a second takes three,
+   six or nine digits, whichever is enough, and is omitted if it is zero.
+   Returns the number of the characters written, at most
+   ISO_DATETIME_MAX_LENGTH, or 0 if the year is out of range. */
+static inline size_t format_iso_datetime(int64_t local_sec, int32_t nanosecond,
+    int32_t offset_sec, char *out)
+{
+    const int64_t epoch_day = civil::floor_div(local_sec, SECS_PER_DAY);
+    const int64_t second_of_day = local_sec - epoch_day * SECS_PER_DAY;
+    int64_t year;
+    int month, day;
+    civil::civil_from_days(epoch_day, year, month, day);
+    if (year < -ISO_YEAR_MAX || year > ISO_YEAR_MAX)
+        return 0;
+    char *p = out;
+    if (year >= 0 && year <= 9999) {
+        p = iso_write_digits(p, 4, (uint32_t)year);
+    } else {
+        *p++ = year < 0 ? '-' : '+';
+        const uint32_t absolute = (uint32_t)(year < 0 ? -year : year);
+        p = iso_write_digits(p,
+            absolute > 99999 ? 6 : absolute > 9999 ? 5 : 4, absolute);
+    }
+    *p++ = '-';
+    p = iso_write_digits(p, 2, month);
+    *p++ = '-';
+    p = iso_write_digits(p, 2, day);
+    *p++ = 'T';
+    p = iso_write_digits(p, 2, (uint32_t)(second_of_day / 3600));
+    *p++ = ':';
+    p = iso_write_digits(p, 2, (uint32_t)(second_of_day / 60 % 60));
+    *p++ = ':';
+    p = iso_write_digits(p, 2, (uint32_t)(second_of_day % 60));
+    if (nanosecond != 0) {
+        *p++ = '.';
+        if (nanosecond % 1000000 == 0)
+            p = iso_write_digits(p, 3, nanosecond / 1000000);
+        else if (nanosecond % 1000 == 0)
+            p = iso_write_digits(p, 6, nanosecond / 1000);
+        else
+            p = iso_write_digits(p, 9, nanosecond);
+    }
+    if (offset_sec == 0) {
+        *p++ = 'Z';
+    } else if (offset_sec != INT_MAX) {
+        *p++ = offset_sec < 0 ? '-' : '+';
+        const uint32_t absolute = offset_sec < 0 ? -offset_sec : offset_sec;
+        p = iso_write_digits(p, 2, absolute / 3600);
+        *p++ = ':';
+        p = iso_write_digits(p, 2, absolute / 60 % 60);
+        if (absolute % 60 != 0) {
+            *p++ = ':';
+            p = iso_write_digits(p, 2, absolute % 60);
+        }
+    }
+    return (size_t)(p - out);
+}
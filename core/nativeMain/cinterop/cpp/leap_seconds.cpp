@@ -0,0 +1,230 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file implements the conversions between the time scales specified in
+   `cdate.h`. All of them are defined in terms of the UTC with leap seconds,
+   the same way the `date` library defines `utc_clock`, `tai_clock` and
+   `gps_clock`, and the conversion goes through it.
+
+   The list of leap seconds is compiled in instead of being read from the
+   time zone database, as not every platform ships it, and it only changes
+   when a new leap second is announced, at least half a year in advance.
+   The table is small enough that counting the entries not exceeding a
+   timestamp is a branchless loop, which the compiler vectorizes. */
+#include <cstdint>
+#include <cstring>
+#include "civil.hpp"
+#include "probes.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+#define NANOS_PER_SEC 1000000000LL
+// The half of the window over which a leap second is smeared.
+#define SMEAR_HALF_WINDOW (43200 * NANOS_PER_SEC)
+// The difference between the TAI and the UTC since 1970 counting leap seconds.
+#define TAI_MINUS_UTC ((4383 * 86400LL + 10) * NANOS_PER_SEC)
+// The difference between the UTC since 1970 counting leap seconds and GPS.
+#define UTC_MINUS_GPS ((3657 * 86400LL + 9) * NANOS_PER_SEC)
+
+/* The Unix times of the midnights right after the leap seconds, as given in
+   the IERS `leap-seconds.list`. */
+static constexpr int64_t leap_seconds[] = {
+    78796800, // 1972-07-01
+    94694400, // 1973-01-01
+    126230400, // 1974-01-01
+    157766400, // 1975-01-01
+    189302400, // 1976-01-01
+    220924800, // 1977-01-01
+    252460800, // 1978-01-01
+    283996800, // 1979-01-01
+    315532800, // 1980-01-01
+    362793600, // 1981-07-01
+    394329600, // 1982-07-01
+    425865600, // 1983-07-01
+    489024000, // 1985-07-01
+    567993600, // 1988-01-01
+    631152000, // 1990-01-01
+    662688000, // 1991-01-01
+    709948800, // 1992-07-01
+    741484800, // 1993-07-01
+    773020800, // 1994-07-01
+    820454400, // 1996-01-01
+    867715200, // 1997-07-01
+    915148800, // 1999-01-01
+    1136073600, // 2006-01-01
+    1230768000, // 2009-01-01
+    1341100800, // 2012-07-01
+    1435708800, // 2015-07-01
+    1483228800, // 2017-01-01
+};
+
+#define LEAP_SECOND_COUNT (sizeof(leap_seconds) / sizeof(leap_seconds[0]))
+
+struct leap_table {
+    // the Unix times right after the leap seconds, in nanoseconds.
+    int64_t unix_nanos[LEAP_SECOND_COUNT];
+    // the UTC times of the starts of the leap seconds, in nanoseconds.
+    int64_t utc_nanos[LEAP_SECOND_COUNT];
+};
+
+static constexpr leap_table make_leap_table() {
+    leap_table table{};
+    for (size_t i = 0; i < LEAP_SECOND_COUNT; ++i) {
+        table.unix_nanos[i] = leap_seconds[i] * NANOS_PER_SEC;
+        table.utc_nanos[i] = (leap_seconds[i] + (int64_t)i) * NANOS_PER_SEC;
+    }
+    return table;
+}
+
+static constexpr leap_table leaps = make_leap_table();
+
+// The number of entries of the table, shifted by `shift`, that are <= `time`.
+static inline int64_t count_up_to(
+    const int64_t (&table)[LEAP_SECOND_COUNT], int64_t time, int64_t shift)
+{
+    int64_t result = 0;
+    for (size_t i = 0; i < LEAP_SECOND_COUNT; ++i) {
+        result += time >= table[i] + shift;
+    }
+    return result;
+}
+
+using civil::saturating_add;
+
+/* The conversions saturate like the constant shifts of TAI and GPS do, as
+   the timestamps near the ends of `int64_t` would overflow. */
+static inline int64_t unix_to_utc(int64_t time) {
+    return saturating_add(time,
+        count_up_to(leaps.unix_nanos, time, 0) * NANOS_PER_SEC);
+}
+
+static inline int64_t utc_to_unix(int64_t time) {
+    const int64_t started = count_up_to(leaps.utc_nanos, time, 0);
+    const int64_t finished = count_up_to(leaps.utc_nanos, time, NANOS_PER_SEC);
+    if (started != finished) {
+        // during a leap second.
+        return leaps.unix_nanos[started - 1] - 1;
+    }
+    return saturating_add(time, -finished * NANOS_PER_SEC);
+}
+
+/* During a smear, the smeared clock passes 86400 seconds while the UTC clock
+   passes 86401 of them. The multiplications don't overflow, as the elapsed
+   time is below 86401 seconds. */
+static inline int64_t smeared_to_utc(int64_t time) {
+    const int64_t started =
+        count_up_to(leaps.unix_nanos, time, -SMEAR_HALF_WINDOW);
+    if (started != 0) {
+        const int64_t smear_start =
+            leaps.unix_nanos[started - 1] - SMEAR_HALF_WINDOW;
+        const int64_t elapsed = time - smear_start;
+        if (elapsed < 2 * SMEAR_HALF_WINDOW) {
+            return leaps.utc_nanos[started - 1] - SMEAR_HALF_WINDOW +
+                elapsed * 86401 / 86400;
+        }
+    }
+    return saturating_add(time, started * NANOS_PER_SEC);
+}
+
+static inline int64_t utc_to_smeared(int64_t time) {
+    const int64_t started =
+        count_up_to(leaps.utc_nanos, time, -SMEAR_HALF_WINDOW);
+    if (started != 0) {
+        const int64_t smear_start =
+            leaps.utc_nanos[started - 1] - SMEAR_HALF_WINDOW;
+        const int64_t elapsed = time - smear_start;
+        if (elapsed < 2 * SMEAR_HALF_WINDOW + NANOS_PER_SEC) {
+            return leaps.unix_nanos[started - 1] - SMEAR_HALF_WINDOW +
+                elapsed * 86400 / 86401;
+        }
+    }
+    return saturating_add(time, -started * NANOS_PER_SEC);
+}
+
+static bool is_time_scale(TIME_SCALE scale) {
+    switch (scale) {
+        case TIME_SCALE_UNIX:
+        case TIME_SCALE_UNIX_SMEARED:
+        case TIME_SCALE_UTC:
+        case TIME_SCALE_TAI:
+        case TIME_SCALE_GPS:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* Each conversion is a separate loop, so that there are no branches on the
+   time scale inside the loops. */
+static void convert_to_utc(TIME_SCALE from, const int64_t *in, int64_t *out,
+    size_t count)
+{
+    switch (from) {
+        case TIME_SCALE_UNIX:
+            for (size_t i = 0; i < count; ++i)
+                out[i] = unix_to_utc(in[i]);
+            break;
+        case TIME_SCALE_UNIX_SMEARED:
+            for (size_t i = 0; i < count; ++i)
+                out[i] = smeared_to_utc(in[i]);
+            break;
+        case TIME_SCALE_UTC:
+            if (in != out)
+                memmove(out, in, count * sizeof(int64_t));
+            break;
+        case TIME_SCALE_TAI:
+            for (size_t i = 0; i < count; ++i)
+                out[i] = saturating_add(in[i], -TAI_MINUS_UTC);
+            break;
+        case TIME_SCALE_GPS:
+            for (size_t i = 0; i < count; ++i)
+                out[i] = saturating_add(in[i], UTC_MINUS_GPS);
+            break;
+    }
+}
+
+static void convert_from_utc(TIME_SCALE to, int64_t *values, size_t count)
+{
+    switch (to) {
+        case TIME_SCALE_UNIX:
+            for (size_t i = 0; i < count; ++i)
+                values[i] = utc_to_unix(values[i]);
+            break;
+        case TIME_SCALE_UNIX_SMEARED:
+            for (size_t i = 0; i < count; ++i)
+                values[i] = utc_to_smeared(values[i]);
+            break;
+        case TIME_SCALE_UTC:
+            break;
+        case TIME_SCALE_TAI:
+            for (size_t i = 0; i < count; ++i)
+                values[i] = saturating_add(values[i], TAI_MINUS_UTC);
+            break;
+        case TIME_SCALE_GPS:
+            for (size_t i = 0; i < count; ++i)
+                values[i] = saturating_add(values[i], -UTC_MINUS_GPS);
+            break;
+    }
+}
+
+extern "C" {
+
+int convert_time_scale(enum TIME_SCALE from, enum TIME_SCALE to,
+    const int64_t *from_nanos, int64_t *to_nanos, size_t count)
+{
+    probes::call probe(__func__, probes::no_zone, count);
+    if (!is_time_scale(from) || !is_time_scale(to))
+        return probe.returns(-1);
+    if (from == to) {
+        if (from_nanos != to_nanos)
+            memmove(to_nanos, from_nanos, count * sizeof(int64_t));
+        return probe.returns(0);
+    }
+    convert_to_utc(from, from_nanos, to_nanos, count);
+    convert_from_utc(to, to_nanos, count);
+    return probe.returns(0);
+}
+
+}
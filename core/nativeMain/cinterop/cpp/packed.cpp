@@ -0,0 +1,183 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file implements the packed date-times specified in `cdate.h`.
+
+   Unpacking is just shifts and masks, which the compiler vectorizes. The
+   range of years is that of `LocalDate`, which is wider than what the `date`
+   library supports, so the conversions between the dates and the epoch days
+   are those from `civil.hpp`. */
+#include <climits>
+#include "civil.hpp"
+#include "time_zone.hpp"
+#include "probes.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+#define YEAR_MIN (-999999)
+#define YEAR_MAX 999999
+#define MAX_OFFSET_SECS (18 * 3600)
+
+#define OFFSET_SHIFT 0
+#define SECOND_SHIFT 17
+#define MINUTE_SHIFT 23
+#define HOUR_SHIFT 29
+#define DAY_SHIFT 34
+#define MONTH_SHIFT 39
+#define YEAR_SHIFT 43
+#define OFFSET_UNKNOWN 0x1ffff
+
+static void civil_from_days(int64_t epoch_day, LOCAL_DATETIME_FIELDS& fields) {
+    int64_t year;
+    int month, day;
+    civil::civil_from_days(epoch_day, year, month, day);
+    fields.year = (int32_t)year;
+    fields.month = (int8_t)month;
+    fields.day = (int8_t)day;
+}
+
+static bool is_valid(const LOCAL_DATETIME_FIELDS& f) {
+    return f.year >= YEAR_MIN && f.year <= YEAR_MAX &&
+        f.month >= 1 && f.month <= 12 &&
+        f.day >= 1 && f.day <= civil::days_in_month(f.year, f.month) &&
+        f.hour >= 0 && f.hour < 24 && f.minute >= 0 && f.minute < 60 &&
+        f.second >= 0 && f.second < 60 &&
+        f.nanosecond >= 0 && f.nanosecond < 1000000000 &&
+        (f.offset_sec == INT_MAX ||
+         (f.offset_sec >= -MAX_OFFSET_SECS && f.offset_sec <= MAX_OFFSET_SECS));
+}
+
+static PACKED_DATETIME pack(const LOCAL_DATETIME_FIELDS& f) {
+    const uint64_t offset = f.offset_sec == INT_MAX ?
+        OFFSET_UNKNOWN : (uint64_t)(f.offset_sec + MAX_OFFSET_SECS);
+    // the year is shifted as unsigned, as shifting negative values is UB.
+    return (PACKED_DATETIME)(((uint64_t)(int64_t)f.year << YEAR_SHIFT) |
+        ((uint64_t)f.month << MONTH_SHIFT) |
+        ((uint64_t)f.day << DAY_SHIFT) |
+        ((uint64_t)f.hour << HOUR_SHIFT) |
+        ((uint64_t)f.minute << MINUTE_SHIFT) |
+        ((uint64_t)f.second << SECOND_SHIFT) |
+        (offset << OFFSET_SHIFT));
+}
+
+static void unpack(PACKED_DATETIME packed, LOCAL_DATETIME_FIELDS& f) {
+    const uint64_t bits = (uint64_t)packed;
+    // the arithmetic shift restores the sign of the year.
+    f.year = (int32_t)(packed >> YEAR_SHIFT);
+    f.month = (int8_t)((bits >> MONTH_SHIFT) & 0xf);
+    f.day = (int8_t)((bits >> DAY_SHIFT) & 0x1f);
+    f.hour = (int8_t)((bits >> HOUR_SHIFT) & 0x1f);
+    f.minute = (int8_t)((bits >> MINUTE_SHIFT) & 0x3f);
+    f.second = (int8_t)((bits >> SECOND_SHIFT) & 0x3f);
+    const int32_t offset = (int32_t)((bits >> OFFSET_SHIFT) & 0x1ffff);
+    f.offset_sec = offset == OFFSET_UNKNOWN ?
+        INT_MAX : offset - MAX_OFFSET_SECS;
+}
+
+static int64_t local_epoch_sec(const LOCAL_DATETIME_FIELDS& f) {
+    return civil::days_from_civil(f.year, f.month, f.day) * SECS_PER_DAY +
+        f.hour * 3600 + f.minute * 60 + f.second;
+}
+
+extern "C" {
+
+int pack_datetimes(const struct LOCAL_DATETIME_FIELDS *fields,
+    PACKED_DATETIME *packed, int32_t *nanoseconds, size_t count)
+{
+    probes::call probe(__func__, probes::no_zone, count);
+    int result = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (is_valid(fields[i])) {
+            packed[i] = pack(fields[i]);
+        } else {
+            packed[i] = INT64_MIN;
+            result = -1;
+        }
+        if (nanoseconds != nullptr)
+            nanoseconds[i] = fields[i].nanosecond;
+    }
+    return probe.returns(result);
+}
+
+void unpack_datetimes(const PACKED_DATETIME *packed,
+    const int32_t *nanoseconds, struct LOCAL_DATETIME_FIELDS *fields,
+    size_t count)
+{
+    probes::call probe(__func__, probes::no_zone, count);
+    for (size_t i = 0; i < count; ++i) {
+        unpack(packed[i], fields[i]);
+        fields[i].nanosecond = nanoseconds == nullptr ? 0 : nanoseconds[i];
+    }
+}
+
+int pack_instants(TZID zone, const int64_t *epoch_secs,
+    PACKED_DATETIME *packed, size_t count)
+{
+    probes::call probe(__func__, zone, count);
+    const int64_t min_local =
+        civil::days_from_civil(YEAR_MIN, 1, 1) * SECS_PER_DAY;
+    const int64_t max_local =
+        civil::days_from_civil(YEAR_MAX + 1, 1, 1) * SECS_PER_DAY - 1;
+    zones::cursor cursor(zones::zone::region(zone));
+    int result = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const int64_t epoch_sec = epoch_secs[i];
+        const int offset = cursor.offset_at(epoch_sec);
+        if (offset == INT_MAX) {
+            packed[i] = INT64_MIN;
+            result = -1;
+            continue;
+        }
+        if (epoch_sec < min_local - offset || epoch_sec > max_local - offset) {
+            packed[i] = INT64_MIN;
+            result = -1;
+            continue;
+        }
+        const int64_t local = epoch_sec + offset;
+        const int64_t epoch_day = civil::floor_div(local, SECS_PER_DAY);
+        const int64_t second_of_day = local - epoch_day * SECS_PER_DAY;
+        LOCAL_DATETIME_FIELDS f;
+        civil_from_days(epoch_day, f);
+        f.hour = (int8_t)(second_of_day / 3600);
+        f.minute = (int8_t)(second_of_day / 60 % 60);
+        f.second = (int8_t)(second_of_day % 60);
+        f.offset_sec = offset;
+        packed[i] = pack(f);
+    }
+    return probe.returns(result);
+}
+
+int packed_datetimes_to_instants(TZID zone, const PACKED_DATETIME *packed,
+    int64_t *epoch_secs, size_t count)
+{
+    probes::call probe(__func__, zone, count);
+    zones::cursor cursor(zones::zone::region(zone));
+    int result = 0;
+    for (size_t i = 0; i < count; ++i) {
+        LOCAL_DATETIME_FIELDS f;
+        unpack(packed[i], f);
+        /* Any bits unpack into some fields, but only the ones that `pack`
+           could have written are a date-time, and INT64_MIN, which it
+           writes for the invalid fields, is not. */
+        f.nanosecond = 0;
+        if (!is_valid(f)) {
+            epoch_secs[i] = INT64_MAX;
+            result = -1;
+            continue;
+        }
+        const int64_t local = local_epoch_sec(f);
+        if (f.offset_sec != INT_MAX) {
+            epoch_secs[i] = local - f.offset_sec;
+            continue;
+        }
+        if (!cursor.to_instant(local, epoch_secs[i])) {
+            epoch_secs[i] = INT64_MAX;
+            result = -1;
+        }
+    }
+    return probe.returns(result);
+}
+
+}
@@ -0,0 +1,296 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file implements the parsing and formatting of the ISO 8601 periods
+   specified in `cdate.h`. Nothing here allocates. */
+#include <climits>
+#include <cstring>
+#include "probes.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+#define NANOS_PER_SEC 1000000000
+
+// Writes the decimal digits of `value` backwards, ending just before `end`.
+static char * write_backwards(char *end, uint64_t value) {
+    do {
+        *--end = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    return end;
+}
+
+static char * write_unsigned(char *p, uint64_t value) {
+    char digits[20];
+    char *end = digits + sizeof digits;
+    char *begin = write_backwards(end, value);
+    memcpy(p, begin, (size_t)(end - begin));
+    return p + (end - begin);
+}
+
+static char * write_number(char *p, int64_t value) {
+    if (value < 0)
+        *p++ = '-';
+    return write_unsigned(p, value < 0 ? 0 - (uint64_t)value : value);
+}
+
+static bool all_not_positive(const DATETIME_PERIOD& period) {
+    return period.years <= 0 && period.months <= 0 && period.days <= 0 &&
+        period.hours <= 0 && period.minutes <= 0 && period.seconds <= 0 &&
+        period.nanoseconds <= 0;
+}
+
+/* Writes the period like `DateTimePeriod.toString` does. Returns the end
+   of the text, or null if the seconds and the nanoseconds together don't
+   fit into the range of `int64_t` seconds. */
+static char * format(const DATETIME_PERIOD& period, char *p) {
+    const bool negative = all_not_positive(period);
+    const int sign = negative ? -1 : 1;
+    char *begin = p;
+    if (negative)
+        *p++ = '-';
+    *p++ = 'P';
+    const char *start = p;
+    if (period.years != 0) {
+        p = write_number(p, (int64_t)period.years * sign);
+        *p++ = 'Y';
+    }
+    if (period.months != 0) {
+        p = write_number(p, (int64_t)period.months * sign);
+        *p++ = 'M';
+    }
+    if (period.days != 0) {
+        p = write_number(p, (int64_t)period.days * sign);
+        *p++ = 'D';
+    }
+    const char *date_end = p;
+    if (period.hours != 0) {
+        *p++ = 'T';
+        p = write_number(p, (int64_t)period.hours * sign);
+        *p++ = 'H';
+    }
+    if (period.minutes != 0) {
+        if (p == date_end)
+            *p++ = 'T';
+        p = write_number(p, (int64_t)period.minutes * sign);
+        *p++ = 'M';
+    }
+    if (period.seconds != 0 || period.nanoseconds != 0) {
+        if (p == date_end)
+            *p++ = 'T';
+        /* The nanoseconds may be outside [0; 999999999] or have a sign
+           different from that of the seconds, so they are normalized. */
+        int64_t seconds;
+        if (__builtin_add_overflow(period.seconds,
+            period.nanoseconds / NANOS_PER_SEC, &seconds))
+            return nullptr;
+        int64_t nanos = period.nanoseconds % NANOS_PER_SEC;
+        if (seconds > 0 && nanos < 0) {
+            --seconds;
+            nanos += NANOS_PER_SEC;
+        } else if (seconds < 0 && nanos > 0) {
+            ++seconds;
+            nanos -= NANOS_PER_SEC;
+        }
+        if ((seconds < 0 || nanos < 0) != negative)
+            *p++ = '-';
+        p = write_unsigned(p,
+            seconds < 0 ? 0 - (uint64_t)seconds : (uint64_t)seconds);
+        if (nanos != 0) {
+            *p++ = '.';
+            memset(p, '0', 9);
+            p += 9;
+            write_backwards(p, (uint64_t)(nanos < 0 ? -nanos : nanos));
+        }
+        *p++ = 'S';
+    }
+    if (p == start) {
+        p = begin;
+        *p++ = 'P';
+        *p++ = '0';
+        *p++ = 'D';
+    }
+    return p;
+}
+
+/* Parses an optionally signed number of at most 19 digits at `p`,
+   advancing it, and negates it if `negate` is set. The negation is applied
+   here, so that the magnitude of INT64_MIN, which `format` writes for it in
+   a negated period, is valid. */
+static bool parse_number(const char *&p, const char *end, bool negate,
+    int64_t& value)
+{
+    const bool negative = (p != end && *p == '-') != negate;
+    if (p != end && (*p == '-' || *p == '+'))
+        ++p;
+    uint64_t absolute = 0;
+    const char *digits = p;
+    for (; p != end && (unsigned)(*p - '0') <= 9; ++p) {
+        if (p - digits == 19)
+            return false;
+        absolute = absolute * 10 + (uint64_t)(*p - '0');
+    }
+    if (p == digits || absolute > (uint64_t)INT64_MAX + negative)
+        return false;
+    value = negative ? (int64_t)(0 - absolute) : (int64_t)absolute;
+    return true;
+}
+
+static bool add_to(int32_t& field, int64_t value) {
+    const int64_t sum = field + value;
+    if (value < INT32_MIN || value > INT32_MAX || sum < INT32_MIN ||
+        sum > INT32_MAX)
+        return false;
+    field = (int32_t)sum;
+    return true;
+}
+
+/* Parses `PnYnMnWnDTnHnMn.nS`, where every component is optional, but at
+   least one is required, and `T` is only present if a time component
+   follows. Each number may have its own sign, and the whole period may be
+   preceded by `-` negating it, before the components are checked to fit.
+   The weeks are added to the days. Only the seconds may have a fraction, of
+   at most nine digits. */
+static bool parse(const char *p, const char *end, DATETIME_PERIOD& period) {
+    period = DATETIME_PERIOD();
+    bool negative = false;
+    if (p != end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+    if (p == end || (*p != 'P' && *p != 'p'))
+        return false;
+    ++p;
+    // The designators that may still follow, in their order.
+    static const char date_designators[] = "YMWD";
+    static const char time_designators[] = "HMS";
+    const char *designators = date_designators;
+    bool time = false, any = false;
+    while (p != end) {
+        if (!time && (*p == 'T' || *p == 't')) {
+            time = true;
+            designators = time_designators;
+            if (++p == end)
+                return false;
+            continue;
+        }
+        int64_t value;
+        const char *number = p;
+        if (!parse_number(p, end, negative, value) || p == end)
+            return false;
+        int64_t nanos = 0;
+        if (time && (*p == '.' || *p == ',')) {
+            ++p;
+            int digits = 0;
+            for (; p != end && (unsigned)(*p - '0') <= 9; ++p, ++digits) {
+                if (digits == 9)
+                    return false;
+                nanos = nanos * 10 + (*p - '0');
+            }
+            if (digits == 0 || p == end || (*p != 'S' && *p != 's'))
+                return false;
+            for (; digits < 9; ++digits)
+                nanos *= 10;
+            if ((*number == '-') != negative)
+                nanos = -nanos;
+        }
+        const char designator = (char)(*p++ & ~0x20);
+        const char *found = strchr(designators, designator);
+        if (designator == 0 || found == nullptr)
+            return false;
+        designators = found + 1;
+        bool fits = true;
+        switch (designator) {
+            case 'Y':
+                fits = add_to(period.years, value);
+                break;
+            case 'W':
+                fits = value >= INT32_MIN / 7 && value <= INT32_MAX / 7 &&
+                    add_to(period.days, value * 7);
+                break;
+            case 'D':
+                fits = add_to(period.days, value);
+                break;
+            case 'H':
+                fits = add_to(period.hours, value);
+                break;
+            case 'M':
+                fits = time ? add_to(period.minutes, value) :
+                    add_to(period.months, value);
+                break;
+            case 'S':
+                period.seconds = value;
+                period.nanoseconds = nanos;
+                break;
+        }
+        if (!fits)
+            return false;
+        any = true;
+    }
+    return any && !(time && designators == time_designators);
+}
+
+extern "C" {
+
+int format_period(const struct DATETIME_PERIOD *period,
+    char *buffer, size_t size)
+{
+    probes::call probe(__func__, probes::no_zone, 0);
+    char text[DATETIME_PERIOD_MAX_LENGTH];
+    const char *end = format(*period, text);
+    if (end == nullptr || size <= (size_t)(end - text))
+        return probe.returns(-1);
+    const size_t length = (size_t)(end - text);
+    memcpy(buffer, text, length);
+    buffer[length] = 0;
+    return probe.returns((int)length);
+}
+
+int parse_period(const char *text, size_t length,
+    struct DATETIME_PERIOD *period)
+{
+    probes::call probe(__func__, probes::no_zone, length);
+    return probe.returns(parse(text, text + length, *period) ? 0 : -1);
+}
+
+int format_periods(const struct DATETIME_PERIOD *periods, size_t count,
+    char *buffer, size_t size, int32_t *offsets)
+{
+    probes::call probe(__func__, probes::no_zone, count);
+    size_t position = 0;
+    offsets[0] = 0;
+    for (size_t i = 0; i < count; ++i) {
+        char *end;
+        if (size - position >= DATETIME_PERIOD_MAX_LENGTH) {
+            end = format(periods[i], buffer + position);
+        } else {
+            char text[DATETIME_PERIOD_MAX_LENGTH];
+            end = format(periods[i], text);
+            if (end == nullptr || (size_t)(end - text) > size - position)
+                return probe.returns(-1);
+            memcpy(buffer + position, text, (size_t)(end - text));
+            end = buffer + position + (end - text);
+        }
+        if (end == nullptr || end - buffer > INT32_MAX)
+            return probe.returns(-1);
+        position = (size_t)(end - buffer);
+        offsets[i + 1] = (int32_t)position;
+    }
+    return probe.returns(0);
+}
+
+int parse_periods(const char *buffer, const int32_t *offsets, size_t count,
+    struct DATETIME_PERIOD *periods)
+{
+    probes::call probe(__func__, probes::no_zone, count);
+    int result = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (!parse(buffer + offsets[i], buffer + offsets[i + 1], periods[i])) {
+            periods[i] = DATETIME_PERIOD();
+            result = -1;
+        }
+    }
+    return probe.returns(result);
+}
+
+}
@@ -0,0 +1,279 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file implements the weekly schedules specified in `cdate.h`.
+
+   The schedule itself is a function of the local time. Between two time zone
+   transitions, the local time grows uniformly with the instant, so the
+   instants at which the schedule changes its state are found by searching
+   the local boundaries of the opening intervals, and the transitions
+   themselves are the only other instants when the state may change, as the
+   local time jumps then. */
+#include <cstdio>
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <new>
+#include <vector>
+#include "civil.hpp"
+#include "helper_macros.hpp"
+#include "probes.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+#define SECS_PER_WEEK (7 * SECS_PER_DAY)
+// How far to look for the next transition of a schedule before giving up.
+#define TRANSITION_HORIZON (366 * (int64_t)SECS_PER_DAY)
+
+// The range [open; close), in seconds.
+struct interval {
+    int32_t open;
+    int32_t close;
+};
+
+struct WEEKLY_SCHEDULE {
+    TZID zone;
+    /* Sorted non-adjacent intervals in seconds since the local midnight of
+       Monday, all within a week. */
+    std::vector<interval> weekly;
+    /* Sorted non-adjacent intervals in seconds since the local midnight,
+       keyed by the epoch day of the date they replace. */
+    std::map<int64_t, std::vector<interval>> exceptions;
+};
+
+// ISO day of week minus one, so that Monday is 0.
+static int32_t weekday_index(int64_t epoch_day) {
+    return civil::iso_day_of_week(epoch_day) - 1;
+}
+
+// Sorts the intervals and merges the ones that overlap or touch.
+static void normalize(std::vector<interval>& intervals) {
+    std::sort(intervals.begin(), intervals.end(),
+        [](const interval& a, const interval& b) { return a.open < b.open; });
+    size_t merged = 0;
+    for (size_t i = 0; i < intervals.size(); ++i) {
+        if (merged != 0 && intervals[i].open <= intervals[merged - 1].close) {
+            intervals[merged - 1].close =
+                std::max(intervals[merged - 1].close, intervals[i].close);
+        } else {
+            intervals[merged++] = intervals[i];
+        }
+    }
+    intervals.resize(merged);
+}
+
+static bool contains(const std::vector<interval>& intervals, int32_t second) {
+    auto it = std::upper_bound(intervals.begin(), intervals.end(), second,
+        [](int32_t second, const interval& i) { return second < i.open; });
+    return it != intervals.begin() && second < (it - 1)->close;
+}
+
+static bool is_open_locally(const WEEKLY_SCHEDULE& schedule, int64_t local) {
+    const int64_t day = civil::floor_div(local, SECS_PER_DAY);
+    const int32_t second_of_day =
+        (int32_t)civil::floor_mod(local, SECS_PER_DAY);
+    if (!schedule.exceptions.empty()) {
+        auto it = schedule.exceptions.find(day);
+        if (it != schedule.exceptions.end())
+            return contains(it->second, second_of_day);
+    }
+    return contains(schedule.weekly,
+        weekday_index(day) * SECS_PER_DAY + second_of_day);
+}
+
+/* Calls `visit` with the local times during the given day at which the
+   schedule could change its state, in ascending order, until it returns
+   true. Returns true if it did. Nothing is collected, so that looking for a
+   transition doesn't allocate. */
+template <typename VISIT>
+static bool visit_day_boundaries(const WEEKLY_SCHEDULE& schedule, int64_t day,
+    VISIT visit)
+{
+    /* The midnight of the day of INT64_MIN doesn't fit into `int64_t`, so
+       the local times are counted from the next one, and saturated. */
+    const int64_t next_midnight = (day + 1) * SECS_PER_DAY;
+    auto at = [next_midnight](int64_t second_of_day) {
+        return civil::saturating_add(next_midnight,
+            second_of_day - SECS_PER_DAY);
+    };
+    // an exception may start or end at midnight.
+    if (visit(at(0)))
+        return true;
+    auto exception = schedule.exceptions.find(day);
+    if (exception != schedule.exceptions.end()) {
+        for (auto& i : exception->second) {
+            if (visit(at(i.open)) || visit(at(i.close)))
+                return true;
+        }
+        return false;
+    }
+    const int32_t day_start = weekday_index(day) * SECS_PER_DAY;
+    const int32_t day_end = day_start + SECS_PER_DAY;
+    for (auto& i : schedule.weekly) {
+        if (i.close <= day_start || i.open >= day_end)
+            continue;
+        if (i.open >= day_start && visit(at(i.open - day_start)))
+            return true;
+        if (i.close <= day_end && visit(at(i.close - day_start)))
+            return true;
+    }
+    return false;
+}
+
+/* Returns the first local time in (after; before) at which the schedule
+   changes its state, or INT64_MAX if there is none. */
+static int64_t next_local_boundary(const WEEKLY_SCHEDULE& schedule,
+    int64_t after, int64_t before)
+{
+    int64_t result = INT64_MAX;
+    auto check = [&](int64_t boundary) {
+        if (boundary <= after)
+            return false;
+        if (boundary >= before)
+            return true;
+        if (is_open_locally(schedule, boundary) !=
+            is_open_locally(schedule, boundary - 1))
+        {
+            result = boundary;
+            return true;
+        }
+        return false;
+    };
+    const int64_t last_day = civil::floor_div(before, SECS_PER_DAY);
+    for (int64_t day = civil::floor_div(after, SECS_PER_DAY); day <= last_day;
+        ++day)
+    {
+        if (visit_day_boundaries(schedule, day, check))
+            return result;
+    }
+    return INT64_MAX;
+}
+
+extern "C" {
+
+WEEKLY_SCHEDULE * weekly_schedule_create(TZID zone)
+{
+    probes::call probe(__func__, zone, 0);
+    auto schedule = check_allocation(new (std::nothrow) WEEKLY_SCHEDULE());
+    schedule->zone = zone;
+    return probe.returns(schedule);
+}
+
+void weekly_schedule_free(WEEKLY_SCHEDULE *schedule)
+{
+    probes::call probe(__func__, probes::no_zone, 0);
+    delete schedule;
+}
+
+int weekly_schedule_add_interval(WEEKLY_SCHEDULE *schedule,
+    int iso_day_of_week, int open_sec, int close_sec)
+{
+    probes::call probe(__func__, schedule->zone, 0);
+    if (iso_day_of_week < 1 || iso_day_of_week > 7 || open_sec < 0 ||
+        open_sec >= SECS_PER_DAY || close_sec <= open_sec ||
+        close_sec - open_sec > SECS_PER_DAY)
+        return probe.returns(-1);
+    const int32_t open = (iso_day_of_week - 1) * SECS_PER_DAY + open_sec;
+    const int32_t close = open + (close_sec - open_sec);
+    if (close <= SECS_PER_WEEK) {
+        schedule->weekly.push_back(interval{open, close});
+    } else {
+        // from Sunday to Monday.
+        schedule->weekly.push_back(interval{open, SECS_PER_WEEK});
+        schedule->weekly.push_back(interval{0, close - SECS_PER_WEEK});
+    }
+    normalize(schedule->weekly);
+    return probe.returns(0);
+}
+
+int weekly_schedule_set_exception(WEEKLY_SCHEDULE *schedule,
+    int64_t epoch_day, const int *open_close_secs, size_t count)
+{
+    probes::call probe(__func__, schedule->zone, epoch_day);
+    std::vector<interval> intervals;
+    for (size_t i = 0; i < count; ++i) {
+        const int open = open_close_secs[2 * i];
+        const int close = open_close_secs[2 * i + 1];
+        if (open < 0 || close <= open || close > SECS_PER_DAY)
+            return probe.returns(-1);
+        intervals.push_back(interval{open, close});
+    }
+    normalize(intervals);
+    schedule->exceptions[epoch_day] = std::move(intervals);
+    return probe.returns(0);
+}
+
+int weekly_schedule_is_open(const WEEKLY_SCHEDULE *schedule, int64_t epoch_sec)
+{
+    probes::call probe(__func__, schedule->zone, epoch_sec);
+    const int offset = offset_at_instant(schedule->zone, epoch_sec);
+    if (offset == INT_MAX)
+        return probe.returns(-1);
+    return probe.returns(is_open_locally(*schedule,
+        civil::saturating_add(epoch_sec, offset)));
+}
+
+int64_t weekly_schedule_next_transition(const WEEKLY_SCHEDULE *schedule,
+    int64_t epoch_sec, int *opens)
+{
+    probes::call probe(__func__, schedule->zone, epoch_sec);
+    int64_t begin, end;
+    int offset = offset_interval_at_instant(
+        schedule->zone, epoch_sec, &begin, &end);
+    if (offset == INT_MAX)
+        return probe.returns(INT64_MAX);
+    const bool was_open =
+        is_open_locally(*schedule, civil::saturating_add(epoch_sec, offset));
+    const int64_t horizon = epoch_sec > INT64_MAX / 2 - TRANSITION_HORIZON ?
+        INT64_MAX / 2 : epoch_sec + TRANSITION_HORIZON;
+    int64_t instant = epoch_sec;
+    while (true) {
+        // Until `end`, the local time is just `instant + offset`.
+        const int64_t limit = std::min(end, horizon);
+        const int64_t boundary = next_local_boundary(*schedule,
+            civil::saturating_add(instant, offset),
+            civil::saturating_add(limit, offset));
+        if (boundary != INT64_MAX) {
+            *opens = !was_open;
+            return probe.returns(civil::saturating_add(boundary, -offset));
+        }
+        if (end >= horizon)
+            return probe.returns(INT64_MAX);
+        // At `end`, the offset changes, and the local time jumps.
+        instant = end;
+        offset = offset_interval_at_instant(
+            schedule->zone, instant, &begin, &end);
+        if (offset == INT_MAX)
+            return probe.returns(INT64_MAX);
+        if (is_open_locally(*schedule,
+            civil::saturating_add(instant, offset)) != was_open)
+        {
+            *opens = !was_open;
+            return probe.returns(instant);
+        }
+    }
+}
+
+int weekly_schedule_is_open_batch(const WEEKLY_SCHEDULE *schedule,
+    const int64_t *epoch_secs, uint8_t *is_open, size_t count)
+{
+    probes::call probe(__func__, schedule->zone, count);
+    int64_t begin = 0, end = 0;
+    int offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const int64_t epoch_sec = epoch_secs[i];
+        if (epoch_sec < begin || epoch_sec >= end) {
+            offset = offset_interval_at_instant(
+                schedule->zone, epoch_sec, &begin, &end);
+            if (offset == INT_MAX)
+                return probe.returns(-1);
+        }
+        is_open[i] = is_open_locally(*schedule,
+            civil::saturating_add(epoch_sec, offset));
+    }
+    return probe.returns(0);
+}
+
+}
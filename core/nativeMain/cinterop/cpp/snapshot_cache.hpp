@@ -0,0 +1,228 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file contains a cache of data that is read on every call and changes
+   rarely, like the time zones of Windows: a `provider` loads the data, and
+   the `cache` publishes it as an immutable snapshot, reloading it
+   periodically on a thread of its own.
+
+       snapshots::cache<data> cache(std::move(provider), interval);
+       ...
+       snapshots::cache<data>::reader snapshot(cache);
+       if (snapshot)
+           use(*snapshot);
+
+   The readers never wait for each other or for the reloading: a `reader`
+   only writes to a slot of its own thread, where it stores the current
+   epoch, and reads the global epoch and the pointer to the snapshot. A
+   replaced snapshot is deleted once no slot holds an epoch from before the
+   replacement, so a `reader` may use it for as long as it lives. The
+   readers may be nested, also across caches of different types.
+
+   Nothing here is specific to Windows, and `tools/snapshot_cache_check.cpp`
+   checks it on other platforms with a fake provider. */
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace snapshots {
+
+template <typename T>
+class provider {
+public:
+    virtual ~provider() = default;
+    /* Returns the new data, or `nullptr` if it can't be loaded now. Must not
+       throw, as it is called on the thread of the cache. */
+    virtual std::unique_ptr<const T> load() = 0;
+};
+
+namespace detail {
+
+struct reader_slot {
+    // The epoch pinned by the thread that owns the slot, or 0.
+    std::atomic<uint64_t> epoch{0};
+    std::atomic<bool> used{false};
+    reader_slot *next = nullptr;
+};
+
+// Incremented every time some snapshot is replaced.
+inline std::atomic<uint64_t> global_epoch{1};
+/* The slots are never freed, but the slot of a thread is given to another
+   one after it exits. */
+inline std::atomic<reader_slot *> slots{nullptr};
+
+inline reader_slot *acquire_slot() {
+    for (reader_slot *slot = slots.load(); slot != nullptr; slot = slot->next) {
+        bool used = false;
+        if (!slot->used.load(std::memory_order_relaxed) &&
+            slot->used.compare_exchange_strong(used, true))
+            return slot;
+    }
+    reader_slot *slot = new reader_slot;
+    slot->used.store(true, std::memory_order_relaxed);
+    slot->next = slots.load();
+    while (!slots.compare_exchange_weak(slot->next, slot)) {}
+    return slot;
+}
+
+struct thread_state {
+    reader_slot *slot = nullptr;
+    // The number of the readers of the thread that are alive.
+    int readers = 0;
+
+    ~thread_state() {
+        if (slot != nullptr) {
+            slot->epoch.store(0, std::memory_order_release);
+            slot->used.store(false, std::memory_order_release);
+        }
+    }
+};
+
+inline thread_local thread_state this_thread;
+
+// The earliest epoch pinned by any thread, or UINT64_MAX.
+inline uint64_t earliest_pinned_epoch() {
+    uint64_t result = UINT64_MAX;
+    for (reader_slot *slot = slots.load(); slot != nullptr; slot = slot->next) {
+        const uint64_t epoch = slot->epoch.load();
+        if (epoch != 0 && epoch < result)
+            result = epoch;
+    }
+    return result;
+}
+
+}
+
+template <typename T>
+class cache {
+public:
+    /* Loads the data, and then reloads it every `interval`, unless it is
+       zero: then, only `refresh` does. */
+    cache(std::unique_ptr<provider<T>> source,
+        std::chrono::steady_clock::duration interval):
+        provider_(std::move(source))
+    {
+        refresh();
+        if (interval > std::chrono::steady_clock::duration::zero())
+            refresher_ = std::thread([this, interval] { run(interval); });
+    }
+
+    cache(const cache&) = delete;
+    cache& operator=(const cache&) = delete;
+
+    // There must be no readers left.
+    ~cache() {
+        {
+            const std::lock_guard<std::mutex> lock(refresher_mutex_);
+            stopping_ = true;
+        }
+        refresher_condition_.notify_all();
+        if (refresher_.joinable())
+            refresher_.join();
+        delete current_.load();
+        for (const auto& snapshot : retired_)
+            delete snapshot.second;
+    }
+
+    /* Loads the data and publishes it, unless it couldn't be loaded. Returns
+       whether it was published. */
+    bool refresh() {
+        const std::lock_guard<std::mutex> lock(writer_mutex_);
+        std::unique_ptr<const T> loaded = provider_->load();
+        if (!loaded)
+            return false;
+        const T *replaced = current_.exchange(loaded.release());
+        /* Any reader that still uses `replaced` has pinned an epoch not
+           later than this one. */
+        const uint64_t epoch = detail::global_epoch.fetch_add(1);
+        if (replaced != nullptr)
+            retired_.emplace_back(epoch, replaced);
+        reclaim();
+        return true;
+    }
+
+    // The number of the replaced snapshots that are not deleted yet.
+    size_t retired() const {
+        const std::lock_guard<std::mutex> lock(writer_mutex_);
+        return retired_.size();
+    }
+
+    // The snapshot that was current when the reader was created.
+    class reader {
+    public:
+        explicit reader(const cache& source) noexcept {
+            detail::thread_state& state = detail::this_thread;
+            if (state.readers++ == 0) {
+                if (state.slot == nullptr)
+                    state.slot = detail::acquire_slot();
+                state.slot->epoch.store(
+                    detail::global_epoch.load(std::memory_order_acquire));
+            }
+            snapshot_ = source.current_.load();
+        }
+
+        reader(const reader&) = delete;
+        reader& operator=(const reader&) = delete;
+
+        ~reader() {
+            detail::thread_state& state = detail::this_thread;
+            if (--state.readers == 0)
+                state.slot->epoch.store(0, std::memory_order_release);
+        }
+
+        // `nullptr` if the data has never been loaded.
+        const T *get() const noexcept { return snapshot_; }
+        explicit operator bool() const noexcept { return snapshot_ != nullptr; }
+        const T& operator*() const noexcept { return *snapshot_; }
+        const T *operator->() const noexcept { return snapshot_; }
+
+    private:
+        const T *snapshot_;
+    };
+
+private:
+    void reclaim() {
+        const uint64_t earliest = detail::earliest_pinned_epoch();
+        const auto kept = std::remove_if(retired_.begin(), retired_.end(),
+            [earliest](const std::pair<uint64_t, const T *>& snapshot) {
+                if (snapshot.first >= earliest)
+                    return false;
+                delete snapshot.second;
+                return true;
+            });
+        retired_.erase(kept, retired_.end());
+    }
+
+    void run(std::chrono::steady_clock::duration interval) {
+        std::unique_lock<std::mutex> lock(refresher_mutex_);
+        while (!refresher_condition_.wait_for(lock, interval,
+            [this] { return stopping_; }))
+        {
+            lock.unlock();
+            refresh();
+            lock.lock();
+        }
+    }
+
+    std::unique_ptr<provider<T>> provider_;
+    std::atomic<const T *> current_{nullptr};
+    // Guards `retired_` and the calls to `provider_`.
+    mutable std::mutex writer_mutex_;
+    // The replaced snapshots with the epochs of their replacement.
+    std::vector<std::pair<uint64_t, const T *>> retired_;
+    std::thread refresher_;
+    std::mutex refresher_mutex_;
+    std::condition_variable refresher_condition_;
+    bool stopping_ = false;
+};
+
+}
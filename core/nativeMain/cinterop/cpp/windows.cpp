@@ -16,17 +16,16 @@
 #include <Timezoneapi.h>
 #include <stdexcept>
 #include <string>
+#include <cstdio>
 #include <cstring>
-#include <set>
-#ifdef DEBUG
-#include <iostream>
-#endif
 #include <chrono>
-#include <shared_mutex>
-#include <mutex>
-#include "date/date.h"
+#include <memory>
+#include <vector>
 #include "helper_macros.hpp"
+#include "snapshot_cache.hpp"
+#include "windows_rules.hpp"
 #include "windows_zones.hpp"
+#include "probes.hpp"
 extern "C" {
 #include "cdate.h"
 }
@@ -36,7 +35,7 @@ extern "C" {
    */
 #define MAX_KEY_LENGTH 128
 
-// The amount of time the cache is considered up-to-date.
+// The amount of time after which the cache is reloaded.
 #define CACHE_INVALIDATION_TIMEOUT std::chrono::minutes(5)
 
 /* Taken from the `date` library, function `getTimeZoneKeyName()`.
@@ -57,14 +56,12 @@ static std::string key_to_string(const DYNAMIC_TIME_ZONE_INFORMATION& dtzi) {
     return buf;
 }
 
-/* Finds the unique number assigned to each standard name. */
-static TZID id_by_name(const std::string& name)
+/* Finds the unique number assigned to each standard name: its index in
+   `windows_zones::regions`. */
+static TZID id_by_name(const char *name)
 {
-    try {
-        return zone_ids.at(name);
-    } catch (std::out_of_range e) {
-        return TZID_INVALID;
-    }
+    const size_t id = windows_zones::regions.find(name);
+    return id == perfect_hash::not_found ? TZID_INVALID : id;
 }
 
 /* Returns a standard timezone name given a Windows registry key name.
@@ -75,331 +72,269 @@ static const char *native_name_to_standard_name(const std::string& native) {
         // string literals have static lifetime.
         return "Etc/UTC";
     }
-    try {
-        /* `windows_to_standard` is immutable, so its contents can't
-           become invalidated. */
-        return windows_to_standard.at(native).c_str();
-    } catch (std::out_of_range e) {
+    const size_t windows_name =
+        windows_zones::windows_names.find(native.data(), native.size());
+    if (windows_name == perfect_hash::not_found)
         return nullptr;
-    }
+    /* The names in the tables are string literals, so they are
+       null-terminated. */
+    return windows_zones::regions.names[
+        windows_zones::region_of_windows_name[windows_name]].data();
 }
 
-// The next time the timezone cache should be flushed.
-static auto next_flush = std::chrono::time_point<std::chrono::steady_clock>::min();
-// The timezone cache. Access to it should be guarded with `cache_rwlock`.
-static std::unordered_map<
-    TZID, DYNAMIC_TIME_ZONE_INFORMATION> cache;
-// The read-write lock guarding access to the cache.
-static std::shared_mutex cache_rwlock;
-
-// Updates the timezone cache if it's time to do so.
-static void repopulate_timezone_cache(
-    std::chrono::time_point<std::chrono::steady_clock> current_time)
+static windows_rules::system_time rule_date(const SYSTEMTIME& date)
 {
-    const std::lock_guard<std::shared_mutex> lock(cache_rwlock);
-    if (current_time < next_flush) {
-        return;
-    }
-    cache.clear();
-    std::unordered_map<std::string, DYNAMIC_TIME_ZONE_INFORMATION>
-        native_to_zones;
-    DYNAMIC_TIME_ZONE_INFORMATION dtzi{};
-    next_flush = current_time + CACHE_INVALIDATION_TIMEOUT;
-    for (DWORD dwResult = 0, i = 0; dwResult != ERROR_NO_MORE_ITEMS; ++i) {
-        dwResult = EnumDynamicTimeZoneInformation(i, &dtzi);
-        if (dwResult == ERROR_SUCCESS) {
-            native_to_zones[key_to_string(dtzi)] = dtzi;
-        }
-    }
-    for (auto it = standard_to_windows.begin();
-        it != standard_to_windows.end(); ++it)
-    {
-        try {
-            auto& dtzi = native_to_zones.at(it->second);
-            auto id = id_by_name(it->first);
-            cache[id] = dtzi;
-        } catch (std::out_of_range e) {
-        }
-    }
+    return windows_rules::system_time{date.wYear, date.wMonth,
+        date.wDayOfWeek, date.wDay, date.wHour, date.wMinute, date.wSecond,
+        date.wMilliseconds};
 }
 
-/* Populates `dtzi` with the time zone information for standard timezone name
-   `name`. Returns `false` if the name is invalid. */
-static bool time_zone_by_id(
-    TZID id, DYNAMIC_TIME_ZONE_INFORMATION& dtzi)
+/* `TIME_ZONE_INFORMATION` and `DYNAMIC_TIME_ZONE_INFORMATION` both have
+   these fields. */
+template <typename INFORMATION>
+static windows_rules::year_rules rules_of(const INFORMATION& info)
 {
-    try {
-        const auto current_time = std::chrono::steady_clock::now();
-        if (current_time > next_flush) {
-            repopulate_timezone_cache(current_time);
-        }
-        const std::shared_lock<std::shared_mutex> lock(cache_rwlock);
-        dtzi = cache.at(id);
-        return true;
-    } catch (std::out_of_range e) {
-        return false;
-    }
+    return windows_rules::year_rules{info.Bias, info.StandardBias,
+        info.DaylightBias, rule_date(info.StandardDate),
+        rule_date(info.DaylightDate)};
 }
 
-/* this code is explained at
-https://docs.microsoft.com/en-us/windows/win32/api/timezoneapi/ns-timezoneapi-time_zone_information
-in the section about `StandardDate`.
-In short, the `StandardDate` structure uses `SYSTEMTIME` in a...
-non-conventional way. This function translates that representation to one
-representing a proper date at a given year.
-*/
-static void get_transition_date(int year, const SYSTEMTIME& src, SYSTEMTIME& dst)
+/* Reads the rules of all the years of the time zone, so that the offsets can
+   be computed without calling into Windows. Returns `nullptr` if they can't
+   be read. */
+static std::shared_ptr<const windows_rules::zone> read_rules(
+    DYNAMIC_TIME_ZONE_INFORMATION& dtzi)
 {
-    dst = src;
-    // if the year is not 0, this is the absolute time.
-    if (src.wYear != 0) {
-        return;
+    DWORD first_year = 0, last_year = 0;
+    std::vector<windows_rules::year_rules> years;
+    /* Fails if the time zone has the same rules for all the years, that is,
+       no `Dynamic DST` key. */
+    if (!dtzi.DynamicDaylightTimeDisabled &&
+        GetDynamicTimeZoneInformationEffectiveYears(
+            &dtzi, &first_year, &last_year) == ERROR_SUCCESS)
+    {
+        for (DWORD year = first_year; year <= last_year; ++year) {
+            TIME_ZONE_INFORMATION tzi{};
+            if (!GetTimeZoneInformationForYear((USHORT)year, &dtzi, &tzi))
+                return nullptr;
+            years.push_back(rules_of(tzi));
+        }
     }
-    /* otherwise, the transition happens yearly at the specified month, hour,
-       and minute at the specified day of the week. */
-    dst.wYear = year;
-    // The number of the occurrence of the specified day of week in the month,
-    // or the special value "5" to denote the last such occurrence.
-    unsigned int dowOccurrenceNumber = src.wDay;
-    // lastly, we find the real date that corresponds to the nth occurrence.
-    date::sys_days days = dowOccurrenceNumber == 5 ?
-        date::sys_days(
-        date::year_month_weekday_last(date::year(year), date::month(src.wMonth),
-            date::weekday_last{date::weekday{src.wDayOfWeek}})) :
-        date::sys_days(
-        date::year_month_weekday(date::year(year), date::month(src.wMonth),
-            date::weekday_indexed{
-                date::weekday{src.wDayOfWeek}, dowOccurrenceNumber}));
-    auto date = date::year_month_day(days);
-    dst.wDay = (unsigned int)date.day();
+    return std::make_shared<const windows_rules::zone>(rules_of(dtzi),
+        (int)first_year, std::move(years));
 }
 
-#ifdef DEBUG
-static void printSystime(const SYSTEMTIME& time)
-{
-    std::cout << time.wYear << "/" << time.wMonth << "/" <<
-        time.wDay << " (" << time.wDayOfWeek << ") " <<
-        time.wHour << ":" << time.wMinute << ":" << time.wSecond;
-}
-#endif
-
-#define SECS_BETWEEN_1601_1970 11644473600LL
-#define WINDOWS_TICKS_PER_SEC 10000000
-
-static void unix_time_to_systemtime(int64_t epoch_sec, SYSTEMTIME& systime)
-{
-    int64_t windows_ticks = (epoch_sec + SECS_BETWEEN_1601_1970)
-        * WINDOWS_TICKS_PER_SEC;
-    ULARGE_INTEGER li;
-    li.QuadPart = windows_ticks;
-    FILETIME ft { li.LowPart, li.HighPart };
-    FileTimeToSystemTime(&ft, &systime);
-}
+/* The time zones known to the system at some moment. The regions that share
+   a Windows time zone share its rules. */
+struct zone_snapshot {
+    // Indexed by the TZIDs; `nullptr` for the unknown ones.
+    std::vector<std::shared_ptr<const windows_rules::zone>> zones;
+};
 
-static int64_t systemtime_to_ticks(const SYSTEMTIME& systime)
-{
-    FILETIME ft {0, 0};
-    SystemTimeToFileTime(&systime, &ft);
-    ULARGE_INTEGER li;
-    li.LowPart = ft.dwLowDateTime;
-    li.HighPart = ft.dwHighDateTime;
-    return li.QuadPart;
-}
+class registry_provider: public snapshots::provider<zone_snapshot> {
+public:
+    std::unique_ptr<const zone_snapshot> load() override {
+        const int reload = loads_++ != 0;
+        DATETIME_PROBE1(tzdb__load__start, reload);
+        std::unique_ptr<const zone_snapshot> snapshot;
+        try {
+            snapshot = load_zones();
+        } catch (std::exception& e) {
+            return nullptr;
+        }
+        DATETIME_PROBE2(tzdb__load__done, reload, snapshot->zones.size());
+        return snapshot;
+    }
 
-static int64_t systemtime_to_unix_time(const SYSTEMTIME& systime)
-{
-    return systemtime_to_ticks(systime) / WINDOWS_TICKS_PER_SEC -
-        SECS_BETWEEN_1601_1970;
-}
+private:
+    // Only used on the thread that loads the snapshots.
+    uint64_t loads_ = 0;
 
-struct TRANSITIONS_INFO {
-    TIME_ZONE_INFORMATION tzi;
-    SYSTEMTIME standard_local;
-    SYSTEMTIME daylight_local;
+    static std::unique_ptr<const zone_snapshot> load_zones() {
+        // Indexed like `windows_zones::windows_names`.
+        std::vector<std::shared_ptr<const windows_rules::zone>> rules(
+            windows_zones::windows_names.size());
+        DYNAMIC_TIME_ZONE_INFORMATION dtzi{};
+        for (DWORD dwResult = 0, i = 0; dwResult != ERROR_NO_MORE_ITEMS; ++i) {
+            dwResult = EnumDynamicTimeZoneInformation(i, &dtzi);
+            if (dwResult == ERROR_SUCCESS) {
+                const std::string key = key_to_string(dtzi);
+                const size_t windows_name =
+                    windows_zones::windows_names.find(key.c_str());
+                if (windows_name != perfect_hash::not_found)
+                    rules[windows_name] = read_rules(dtzi);
+            }
+        }
+        std::unique_ptr<zone_snapshot> snapshot(new zone_snapshot);
+        snapshot->zones.resize(windows_zones::regions.size());
+        for (size_t id = 0; id < snapshot->zones.size(); ++id) {
+            snapshot->zones[id] =
+                rules[windows_zones::windows_name_of_region[id]];
+        }
+        return std::move(snapshot);
+    }
 };
 
-/* Checks whether the daylight saving time is in effect at the given time.
-   `tzi` could be calculated here, but is passed along to avoid recomputing
-   it. */
-static bool is_daylight_time(
-    const DYNAMIC_TIME_ZONE_INFORMATION& dtzi,
-    TRANSITIONS_INFO& trans,
-    const SYSTEMTIME& time)
+typedef snapshots::cache<zone_snapshot> zone_cache;
+
+/* The time zones are loaded on the first call that needs them, and then
+   reloaded on the thread of the cache, so the calls never wait for the
+   registry. The cache is never destroyed, as that thread may still be
+   running when the process exits. */
+static const zone_cache& time_zones()
 {
-    // it means that daylight saving time is not supported at all
-    if (trans.tzi.StandardDate.wMonth == 0) {
-        return false;
-    }
-    /* translate the "date" values stored in `tzi` into real dates of
-       transitions to and from the daylight saving time. */
-    get_transition_date(time.wYear, trans.tzi.StandardDate, trans.standard_local);
-    get_transition_date(time.wYear, trans.tzi.DaylightDate, trans.daylight_local);
-    /* Two things happen here:
-        * All the relevant dates are converted to a number of ticks an some
-          unified scale, counted in seconds. This is done so that we are able
-          to easily add to and compare between dates.
-        * `standard_local` and `daylight_local` are represented as dates in the
-          local time that was active *just before* the transition. For example,
-          `standard_local` contains the date of the transition to the standard
-          time, as seen by a person that is currently on the daylight saving
-          time. So, in order for the dates to be on the same scale, the biases
-          that are assumed to be currently active are negated. */
-    int64_t standard = systemtime_to_ticks(trans.standard_local) /
-        WINDOWS_TICKS_PER_SEC + (trans.tzi.Bias + trans.tzi.DaylightBias) * 60;
-    int64_t daylight = systemtime_to_ticks(trans.daylight_local) /
-        WINDOWS_TICKS_PER_SEC + (trans.tzi.Bias + trans.tzi.StandardBias) * 60;
-    int64_t time_secs = systemtime_to_ticks(time) /
-        WINDOWS_TICKS_PER_SEC;
-    /* Maybe `else` is never hit, but I've seen no indication of that assumption
-       in the documentation. */
-    if (daylight < standard) {
-        // The year is |STANDARD|DAYLIGHT|STANDARD|
-        return time_secs < standard && time_secs >= daylight;
-    } else {
-        // The year is |DAYLIGHT|STANDARD|DAYLIGHT|
-        return time_secs < standard || time_secs >= daylight;
-    }
+    static const zone_cache *cache = new zone_cache(
+        std::unique_ptr<registry_provider>(new registry_provider),
+        CACHE_INVALIDATION_TIMEOUT);
+    return *cache;
 }
 
-// Get the UTC offset for a given timezone at a given time.
-static int offset_at_systime(DYNAMIC_TIME_ZONE_INFORMATION& dtzi,
-    TRANSITIONS_INFO& ts,
-    const SYSTEMTIME& systime)
+/* Returns the rules of the time zone with the given id, or `nullptr` if the
+   id is invalid. They stay valid while `snapshot` exists. */
+static const windows_rules::zone *time_zone_by_id(
+    const zone_cache::reader& snapshot, TZID id)
 {
-    bool result = GetTimeZoneInformationForYear(systime.wYear, &dtzi, &ts.tzi);
-    if (!result) {
-        return INT_MAX;
-    }
-    auto bias = ts.tzi.Bias;
-    if (is_daylight_time(dtzi, ts, systime)) {
-        bias += ts.tzi.DaylightBias;
-    } else {
-        bias += ts.tzi.StandardBias;
-    }
-    return -bias * 60;
+    if (!snapshot || id >= snapshot->zones.size())
+        return nullptr;
+    return snapshot->zones[id].get();
 }
 
 extern "C" {
 
 char * get_system_timezone(TZID* id)
 {
+    probes::call probe(__func__, probes::no_zone, 0);
     DYNAMIC_TIME_ZONE_INFORMATION dtzi{};
     auto result = GetDynamicTimeZoneInformation(&dtzi);
     if (result == TIME_ZONE_ID_INVALID)
-        return nullptr;
+        return probe.returns(nullptr);
     auto key = key_to_string(dtzi);
     auto name = native_name_to_standard_name(key);
     if (name == nullptr) {
         *id = TZID_INVALID;
-        return nullptr;
+        return probe.returns(nullptr);
     } else {
         *id = id_by_name(name);
-        return check_allocation(strdup(name));
+        return probe.returns(check_allocation(strdup(name)));
     }
 }
 
 char ** available_zone_ids()
 {
-    std::set<std::string> known_native_names, known_ids;
+    probes::call probe(__func__, probes::no_zone, 0);
+    std::vector<bool> known_windows_names(windows_zones::windows_names.size());
     DYNAMIC_TIME_ZONE_INFORMATION dtzi{};
     for (DWORD dwResult = 0, i = 0; dwResult != ERROR_NO_MORE_ITEMS; ++i) {
         dwResult = EnumDynamicTimeZoneInformation(i, &dtzi);
         if (dwResult == ERROR_SUCCESS) {
-            known_native_names.insert(key_to_string(dtzi));
+            const size_t windows_name =
+                windows_zones::windows_names.find(key_to_string(dtzi).c_str());
+            if (windows_name != perfect_hash::not_found)
+                known_windows_names[windows_name] = true;
         }
     }
-    for (auto it = standard_to_windows.begin();
-        it != standard_to_windows.end(); ++it)
-    {
-        if (known_native_names.count(it->second)) {
-            known_ids.insert(it->first);
-        }
+    // The regions are sorted by their names.
+    std::vector<const char *> known_ids;
+    for (size_t id = 0; id < windows_zones::regions.size(); ++id) {
+        if (known_windows_names[windows_zones::windows_name_of_region[id]])
+            known_ids.push_back(windows_zones::regions.names[id].data());
     }
     char ** zones = check_allocation(
         (char **)malloc(sizeof(char *) * (known_ids.size() + 1)));
     zones[known_ids.size()] = nullptr;
-    unsigned int i = 0;
-    for (auto it = known_ids.begin(); it != known_ids.end(); ++it) {
-        zones[i] = check_allocation(strdup(it->c_str()));
-        ++i;
-    }
-    return zones;
+    for (size_t i = 0; i < known_ids.size(); ++i)
+        zones[i] = check_allocation(strdup(known_ids[i]));
+    return probe.returns(zones);
 }
 
 int offset_at_instant(TZID zone_id, int64_t epoch_sec)
 {
-    DYNAMIC_TIME_ZONE_INFORMATION dtzi{};
-    bool result = time_zone_by_id(zone_id, dtzi);
-    if (!result) {
-        return INT_MAX;
+    probes::call probe(__func__, zone_id, epoch_sec);
+    const zone_cache::reader snapshot(time_zones());
+    const windows_rules::zone *zone = time_zone_by_id(snapshot, zone_id);
+    if (!zone) {
+        return probe.returns(INT_MAX);
     }
-    SYSTEMTIME systime;
-    unix_time_to_systemtime(epoch_sec, systime);
-    TRANSITIONS_INFO ts{};
-    return offset_at_systime(dtzi, ts, systime);
+    return probe.returns(zone->offset_at(epoch_sec));
+}
+
+int offset_interval_at_instant(TZID zone_id, int64_t epoch_sec,
+    int64_t *begin, int64_t *end)
+{
+    probes::call probe(__func__, zone_id, epoch_sec);
+    const zone_cache::reader snapshot(time_zones());
+    const windows_rules::zone *zone = time_zone_by_id(snapshot, zone_id);
+    if (!zone) {
+        return probe.returns(INT_MAX);
+    }
+    /* The rules are only known for the given year, so the interval never
+       crosses its boundaries. */
+    return probe.returns(zone->offset_at(epoch_sec, *begin, *end));
+}
+
+int abbreviation_at_instant(TZID zone_id, int64_t epoch_sec,
+    char *abbreviation, size_t size)
+{
+    probes::call probe(__func__, zone_id, epoch_sec);
+    int offset = offset_at_instant(zone_id, epoch_sec);
+    if (offset == INT_MAX) {
+        return probe.returns(INT_MAX);
+    }
+    /* Windows only knows the full names, like "Pacific Standard Time", so
+       the offset is used, like the time zone database does for the zones
+       that have no established abbreviation. */
+    int minutes = (offset < 0 ? -offset : offset) / 60;
+    if (size != 0) {
+        if (minutes % 60 == 0) {
+            snprintf(abbreviation, size, "%c%02d",
+                offset < 0 ? '-' : '+', minutes / 60);
+        } else {
+            snprintf(abbreviation, size, "%c%02d%02d",
+                offset < 0 ? '-' : '+', minutes / 60, minutes % 60);
+        }
+    }
+    return probe.returns(offset);
 }
 
 TZID timezone_by_name(const char *zone_name)
 {
-    DYNAMIC_TIME_ZONE_INFORMATION dtzi{};
+    probes::call probe(__func__, probes::no_zone, 0);
     TZID id = id_by_name(zone_name);
-    if (time_zone_by_id(id, dtzi)) {
-        return id;
+    const zone_cache::reader snapshot(time_zones());
+    if (time_zone_by_id(snapshot, id)) {
+        return probe.returns(id);
     } else {
-        return TZID_INVALID;
+        return probe.returns(TZID_INVALID);
     }
 }
 
 static int offset_at_datetime_impl(TZID zone_id, int64_t epoch_sec, int *offset,
 GAP_HANDLING gap_handling)
 {
-    DYNAMIC_TIME_ZONE_INFORMATION dtzi{};
-    bool result = time_zone_by_id(zone_id, dtzi);
-    if (!result) {
-        return INT_MAX;
+    const zone_cache::reader snapshot(time_zones());
+    const windows_rules::zone *zone = time_zone_by_id(snapshot, zone_id);
+    if (!zone) {
+        *offset = INT_MAX;
+        return 0;
     }
-    SYSTEMTIME localtime, utctime, adjusted;
-    unix_time_to_systemtime(epoch_sec, localtime);
-    TzSpecificLocalTimeToSystemTimeEx(&dtzi, &localtime, &utctime);
-    TRANSITIONS_INFO trans{};
-    *offset = offset_at_systime(dtzi, trans, utctime);
-    SystemTimeToTzSpecificLocalTimeEx(&dtzi, &utctime, &adjusted);
-    /* We don't use `epoch_sec` instead of `systemtime_to_unix_time(localtime)
-    because `unix_time_to_systemtime(epoch_sec, localtime)` above could
-    overflow the range of instants representable in WinAPI, and then the
-    difference from `epoch_sec` would be large, potentially causing problems.
-    If it happened, we don't return an error as we don't really care which
-    result to return: timezone database information outside of [1970; current
-    time) is not accurate anyway, and WinAPI supports dates in years [1601;
-    30827], which should be enough for all practical purposes. */
-    const auto transition_duration = (int)(systemtime_to_unix_time(adjusted) -
-        systemtime_to_unix_time(localtime));
-    if (transition_duration == 0)
+    const windows_rules::local_offsets offsets =
+        zone->offsets_at_local(epoch_sec);
+    if (offsets.before == offsets.after) {
+        *offset = offsets.before;
         return 0;
+    }
+    if (!offsets.gap) {
+        // The preferred offset is kept if it is one of the two.
+        if (*offset != offsets.after)
+            *offset = offsets.before;
+        return 0;
+    }
+    *offset = offsets.after;
     switch (gap_handling) {
         case GAP_HANDLING_MOVE_FORWARD:
-            return transition_duration;
+            return offsets.after - offsets.before;
         case GAP_HANDLING_NEXT_CORRECT:
-        /* Let x, y in {daylight, standard}
-           If a gap happened, then
-               xEnd + xOffset < utctime < yBegin + yOffset
-           What we need to return is
-               yBegin + yOffset - epoch_sec
-           To learn whether we crossed from daylight to standard or vice versa:
-               xEnd = yBegin - epsilon => yOffset + epsilon > xOffset
-           Thus, we crossed from the lower offset to the bigger one. So,
-           return (daylight.offset > standard.offset ?
-                   daylight.begin + daylight.offset :
-                   standard.begin + standard.offset) - epoch_sec */
-            if (trans.tzi.DaylightBias < trans.tzi.StandardBias) {
-                return systemtime_to_unix_time(trans.daylight_local)
-                    + trans.tzi.StandardBias - trans.tzi.DaylightBias
-                    - epoch_sec + 1;
-            } else {
-                return systemtime_to_unix_time(trans.standard_local)
-                    + trans.tzi.DaylightBias - trans.tzi.StandardBias
-                    - epoch_sec + 1;
-            }
+            return (int)(offsets.transition + offsets.after - epoch_sec);
         default:
             // impossible
             *offset = INT_MAX;
@@ -409,18 +344,20 @@ GAP_HANDLING gap_handling)
 
 int offset_at_datetime(TZID zone_id, int64_t epoch_sec, int *offset)
 {
-    return offset_at_datetime_impl(zone_id, epoch_sec, offset,
-        GAP_HANDLING_MOVE_FORWARD);
+    probes::call probe(__func__, zone_id, epoch_sec);
+    return probe.returns(offset_at_datetime_impl(zone_id, epoch_sec, offset,
+        GAP_HANDLING_MOVE_FORWARD));
 }
 
 int64_t at_start_of_day(TZID zone_id, int64_t epoch_sec)
 {
+    probes::call probe(__func__, zone_id, epoch_sec);
     int offset = 0;
     int trans = offset_at_datetime_impl(zone_id, epoch_sec, &offset,
         GAP_HANDLING_NEXT_CORRECT);
     if (offset == INT_MAX)
-        return LONG_MAX;
-    return epoch_sec - offset + trans;
+        return probe.returns(LONG_MAX);
+    return probe.returns(epoch_sec - offset + trans);
 }
 
 }
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file implements the lookups of the Windows time zone names specified
+   in `cdate.h`.
+
+   A name is found with the perfect hash of `windows_zones.hpp`, and then
+   converted to a TZID with a table that is built once, with
+   `zone_tables.hpp`, so a lookup allocates nothing and doesn't consult the
+   time zone database. */
+#include <cstdint>
+#include <vector>
+#include "windows_zones.hpp"
+#include "zone_tables.hpp"
+#include "probes.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+static const uint16_t no_windows_name = UINT16_MAX;
+
+static_assert(windows_zones::windows_names.size() < no_windows_name,
+    "the indices of the Windows names have 16 bits");
+
+struct windows_name_tables {
+    // Indexed like `windows_zones::windows_names`.
+    std::vector<TZID> zones;
+    zone_tables::table<uint16_t, no_windows_name> names;
+};
+
+static TZID region_by_index(size_t region) {
+    // The names in the tables are string literals, so they are null-terminated.
+    return timezone_by_name(windows_zones::regions.names[region].data());
+}
+
+static void set_name(windows_name_tables& tables, TZID zone, size_t name) {
+    if (tables.names[zone] == no_windows_name)
+        tables.names.set(zone, (uint16_t)name);
+}
+
+static windows_name_tables build_tables() {
+    windows_name_tables tables;
+    const size_t name_count = windows_zones::windows_names.size();
+    tables.zones.assign(name_count, TZID_INVALID);
+    for (size_t name = 0; name < name_count; ++name) {
+        tables.zones[name] =
+            region_by_index(windows_zones::region_of_windows_name[name]);
+        set_name(tables, tables.zones[name], name);
+    }
+    /* Then, the other regions of the Windows time zones get their names
+       too, unless they are the same time zones as the regions above, like
+       the links to them. */
+    for (size_t region = 0; region < windows_zones::regions.size(); ++region) {
+        set_name(tables, region_by_index(region),
+            windows_zones::windows_name_of_region[region]);
+    }
+    return tables;
+}
+
+static const windows_name_tables& tables() {
+    return zone_tables::built_once<windows_name_tables, build_tables>();
+}
+
+extern "C" {
+
+TZID timezone_by_windows_name(const char *windows_name)
+{
+    probes::call probe(__func__, probes::no_zone, 0);
+    const size_t name = windows_zones::windows_names.find(windows_name);
+    if (name == perfect_hash::not_found)
+        return probe.returns(TZID_INVALID);
+    return probe.returns(tables().zones[name]);
+}
+
+const char * windows_name_of_timezone(TZID zone)
+{
+    probes::call probe(__func__, zone, 0);
+    const uint16_t name = tables().names[zone];
+    if (name == no_windows_name)
+        return probe.returns(nullptr);
+    return probe.returns(windows_zones::windows_names.names[name].data());
+}
+
+}
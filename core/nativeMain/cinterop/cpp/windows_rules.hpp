@@ -0,0 +1,240 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file contains the evaluation of the time zone rules of Windows, as
+   stored in the registry and returned by `GetTimeZoneInformationForYear`,
+   without calling into Windows, so that it can also be built and checked
+   on other platforms: see `tools/windows_rules_check.cpp`.
+
+   A Windows time zone has a standard offset and, optionally, a daylight
+   saving time that starts and ends at the same local date-times every year,
+   like on the second Sunday of March at 2:00. Some zones also have
+   different rules for some years, under the `Dynamic DST` key. A `zone`
+   computes the two instants of the transitions of every year once, when it
+   is created, so that finding an offset takes a couple of comparisons.
+
+   Like WinAPI, the rules of a year apply to the instants of that year in
+   UTC, and the years are limited to [1601; 30827]: the instants outside of
+   them have the offsets of the earliest or the latest one. */
+#pragma once
+#include <climits>
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+#include "civil.hpp"
+
+namespace windows_rules {
+
+/* `SYSTEMTIME`, the way `TIME_ZONE_INFORMATION` uses it for the dates of
+   the transitions: if `year` is 0, the transition happens every year on the
+   `day`-th `day_of_week` of the month, where 5 is the last one; otherwise,
+   it happens once, on the given date. `month` is 0 if there is no daylight
+   saving time. */
+struct system_time {
+    uint16_t year;
+    uint16_t month;
+    // From 0 for Sunday.
+    uint16_t day_of_week;
+    uint16_t day;
+    uint16_t hour;
+    uint16_t minute;
+    uint16_t second;
+    uint16_t milliseconds;
+};
+
+/* The rules of a year: the part of `TIME_ZONE_INFORMATION` without the
+   names, which is also the layout of the `TZI` values in the registry. The
+   biases are in minutes, and are subtracted from the local time to get UTC:
+   the offset is `-(bias + standard_bias)` minutes, or `-(bias +
+   daylight_bias)` during the daylight saving time. The dates are local
+   date-times before the transitions: `standard_date` in the daylight saving
+   time, `daylight_date` in the standard time. */
+struct year_rules {
+    int32_t bias;
+    int32_t standard_bias;
+    int32_t daylight_bias;
+    system_time standard_date;
+    system_time daylight_date;
+};
+
+// The transitions of a year, in seconds since the epoch.
+struct year_transitions {
+    // INT64_MIN if there is no daylight saving time.
+    int64_t standard_begin;
+    int64_t daylight_begin;
+    int standard_offset;
+    int daylight_offset;
+};
+
+// The offsets of a local date-time, in seconds.
+struct local_offsets {
+    // The offset, or the one before the transition in a gap or an overlap.
+    int before;
+    // The offset after the transition, or the same as `before`.
+    int after;
+    // The instant of the transition, if `before` is not `after`.
+    int64_t transition;
+    // Whether the date-time falls into a gap rather than an overlap.
+    bool gap;
+};
+
+const int min_year = 1601;
+const int max_year = 30827;
+// No bias exceeds this, in seconds.
+const int max_offset_sec = 18 * 3600;
+
+// The local date-time of the transition in the year, as if it were UTC.
+inline int64_t transition_date(int64_t year, const system_time& date) {
+    int64_t day = 0;
+    if (date.year != 0) {
+        day = civil::days_from_civil(date.year, date.month, date.day);
+    } else {
+        // The ISO day of the week, from 1 for Monday.
+        const int day_of_week = date.day_of_week == 0 ? 7 : date.day_of_week;
+        if (date.day >= 5) {
+            day = civil::days_from_civil(year, date.month,
+                civil::days_in_month(year, date.month));
+            day -= (civil::iso_day_of_week(day) - day_of_week + 7) % 7;
+        } else {
+            day = civil::days_from_civil(year, date.month, 1);
+            day += (day_of_week - civil::iso_day_of_week(day) + 7) % 7 +
+                7 * (date.day - 1);
+        }
+    }
+    return day * SECS_PER_DAY + date.hour * 3600 + date.minute * 60 +
+        date.second;
+}
+
+inline year_transitions transitions_of(const year_rules& rules,
+    int64_t year)
+{
+    year_transitions result;
+    result.standard_offset = -(rules.bias + rules.standard_bias) * 60;
+    result.daylight_offset = -(rules.bias + rules.daylight_bias) * 60;
+    if (rules.standard_date.month == 0) {
+        result.standard_begin = result.daylight_begin = INT64_MIN;
+    } else {
+        result.standard_begin = transition_date(year, rules.standard_date) -
+            result.daylight_offset;
+        result.daylight_begin = transition_date(year, rules.daylight_date) -
+            result.standard_offset;
+    }
+    return result;
+}
+
+class zone {
+public:
+    /* `rules` apply to all the years, except for [first_year; first_year +
+       years.size()), which have their own rules, like the ones under the
+       `Dynamic DST` key; then, the first and the last of them also apply to
+       the years before and after. */
+    explicit zone(const year_rules& rules, int first_year = 0,
+        std::vector<year_rules> years = {}):
+        rules_(rules), first_year_(first_year), years_(std::move(years))
+    {
+        cached_.reserve(cached_year_count);
+        for (int year = cached_first_year;
+            year < cached_first_year + cached_year_count; ++year)
+        {
+            cached_.push_back(transitions_of(rules_for(year), year));
+        }
+    }
+
+    const year_rules& rules_for(int64_t year) const {
+        if (years_.empty())
+            return rules_;
+        if (year <= first_year_)
+            return years_.front();
+        if (year - first_year_ >= (int64_t)years_.size())
+            return years_.back();
+        return years_[year - first_year_];
+    }
+
+    year_transitions transitions(int64_t year) const {
+        if (year >= cached_first_year &&
+            year < cached_first_year + cached_year_count)
+            return cached_[year - cached_first_year];
+        return transitions_of(rules_for(year), year);
+    }
+
+    int offset_at(int64_t epoch_sec) const {
+        int64_t begin = 0, end = 0;
+        return offset_at(epoch_sec, begin, end);
+    }
+
+    /* Returns the offset, also setting [begin; end) to a range of instants
+       that contains `epoch_sec` and where the offset stays the same. The
+       range doesn't cross the boundaries of the years in UTC. */
+    int offset_at(int64_t epoch_sec, int64_t& begin, int64_t& end) const {
+        const int64_t instant = epoch_sec < min_instant ? min_instant :
+            epoch_sec > max_instant ? max_instant : epoch_sec;
+        int64_t year = 0;
+        int month = 0, day = 0;
+        civil::civil_from_days(civil::floor_div(instant, SECS_PER_DAY), year,
+            month, day);
+        begin = year == min_year ? INT64_MIN :
+            civil::days_from_civil(year, 1, 1) * SECS_PER_DAY;
+        end = year == max_year ? INT64_MAX :
+            civil::days_from_civil(year + 1, 1, 1) * SECS_PER_DAY;
+        const year_transitions t = transitions(year);
+        if (t.standard_begin == INT64_MIN)
+            return t.standard_offset;
+        for (const int64_t transition : {t.standard_begin, t.daylight_begin}) {
+            if (transition <= instant && transition > begin)
+                begin = transition;
+            if (transition > instant && transition < end)
+                end = transition;
+        }
+        bool daylight;
+        if (t.daylight_begin < t.standard_begin) {
+            // The year is |STANDARD|DAYLIGHT|STANDARD|.
+            daylight = instant < t.standard_begin &&
+                instant >= t.daylight_begin;
+        } else {
+            // The year is |DAYLIGHT|STANDARD|DAYLIGHT|.
+            daylight = instant < t.standard_begin ||
+                instant >= t.daylight_begin;
+        }
+        return daylight ? t.daylight_offset : t.standard_offset;
+    }
+
+    local_offsets offsets_at_local(int64_t local_sec) const {
+        /* No instant before this one has the local date-time, so the ranges
+           from here on are checked in order until one of them has it. */
+        int64_t begin = 0, end = 0;
+        int offset = offset_at(local_sec - max_offset_sec, begin, end);
+        int previous = offset;
+        while (end != INT64_MAX && local_sec >= end + offset) {
+            previous = offset;
+            offset = offset_at(end, begin, end);
+        }
+        if (offset != previous && local_sec < begin + offset)
+            return local_offsets{previous, offset, begin, true};
+        if (end != INT64_MAX) {
+            // The local date-time can also happen after the next transition.
+            int64_t next_begin = 0, next_end = 0;
+            const int next = offset_at(end, next_begin, next_end);
+            if (next != offset && local_sec >= end + next)
+                return local_offsets{offset, next, end, false};
+        }
+        return local_offsets{offset, offset, begin, false};
+    }
+
+private:
+    static const int cached_first_year = 1970;
+    static const int cached_year_count = 130;
+    static constexpr int64_t min_instant =
+        civil::days_from_civil(min_year, 1, 1) * SECS_PER_DAY;
+    static constexpr int64_t max_instant =
+        civil::days_from_civil(max_year + 1, 1, 1) * SECS_PER_DAY - 1;
+
+    year_rules rules_;
+    int first_year_;
+    std::vector<year_rules> years_;
+    // The transitions of the years from `cached_first_year`.
+    std::vector<year_transitions> cached_;
+};
+
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file implements the permanent zone codes specified in `cdate.h`.
+
+   The codes are the indices of the names in `zone_codes.hpp`. The tables
+   that convert between them and TZIDs are built once, with
+   `zone_tables.hpp`, and after that, both conversions are a single access
+   to an array. */
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "zone_codes.hpp"
+#include "zone_tables.hpp"
+#include "probes.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+static const size_t zone_code_count =
+    sizeof(zone_code_names) / sizeof(zone_code_names[0]);
+
+static_assert(zone_code_count <= 65536, "the zone codes have 16 bits");
+
+// The codes sorted by their names, for the lookups by name.
+static const std::vector<ZONE_CODE>& codes_by_name() {
+    static const std::vector<ZONE_CODE> codes = [] {
+        std::vector<ZONE_CODE> result;
+        for (size_t code = 1; code < zone_code_count; ++code)
+            result.push_back((ZONE_CODE)code);
+        std::sort(result.begin(), result.end(), [](ZONE_CODE a, ZONE_CODE b) {
+            return strcmp(zone_code_names[a], zone_code_names[b]) < 0;
+        });
+        return result;
+    }();
+    return codes;
+}
+
+struct zone_code_tables {
+    // Indexed by the codes.
+    std::vector<TZID> zones;
+    zone_tables::table<ZONE_CODE, ZONE_CODE_INVALID> codes;
+};
+
+static TZID zone_by_code(const zone_code_tables& tables, ZONE_CODE code) {
+    return code < tables.zones.size() ? tables.zones[code] : TZID_INVALID;
+}
+
+static zone_code_tables build_tables() {
+    zone_code_tables tables;
+    tables.zones.assign(zone_code_count, TZID_INVALID);
+    for (size_t code = 1; code < zone_code_count; ++code) {
+        const TZID zone = timezone_by_name(zone_code_names[code]);
+        tables.zones[code] = zone;
+        /* Until the names of the time zones themselves are known, any name
+           of a time zone will do. */
+        if (tables.codes[zone] == ZONE_CODE_INVALID)
+            tables.codes.set(zone, (ZONE_CODE)code);
+    }
+    // The links get the codes of the names of the time zones they link to.
+    if (char **names = available_zone_ids()) {
+        for (char **name = names; *name != nullptr; ++name) {
+            const ZONE_CODE code = zone_code_by_name(*name);
+            if (code != ZONE_CODE_INVALID)
+                tables.codes.set(tables.zones[code], code);
+            free(*name);
+        }
+        free(names);
+    }
+    return tables;
+}
+
+static const zone_code_tables& tables() {
+    return zone_tables::built_once<zone_code_tables, build_tables>();
+}
+
+extern "C" {
+
+ZONE_CODE zone_code_by_name(const char *zone_name)
+{
+    probes::call probe(__func__, probes::no_zone, 0);
+    const std::vector<ZONE_CODE>& codes = codes_by_name();
+    const auto found = std::lower_bound(codes.begin(), codes.end(), zone_name,
+        [](ZONE_CODE code, const char *name) {
+            return strcmp(zone_code_names[code], name) < 0;
+        });
+    if (found == codes.end() ||
+        strcmp(zone_code_names[*found], zone_name) != 0)
+        return probe.returns(ZONE_CODE_INVALID);
+    return probe.returns(*found);
+}
+
+const char * zone_name_by_code(ZONE_CODE code)
+{
+    probes::call probe(__func__, probes::no_zone, 0);
+    return probe.returns(
+        code < zone_code_count ? zone_code_names[code] : nullptr);
+}
+
+TZID timezone_by_zone_code(ZONE_CODE code)
+{
+    probes::call probe(__func__, probes::no_zone, 0);
+    return probe.returns(zone_by_code(tables(), code));
+}
+
+ZONE_CODE zone_code_of_timezone(TZID zone)
+{
+    probes::call probe(__func__, zone, 0);
+    return probe.returns(tables().codes[zone]);
+}
+
+int zone_codes_to_timezones(const ZONE_CODE *codes, TZID *zones,
+    size_t count)
+{
+    probes::call probe(__func__, probes::no_zone, count);
+    const zone_code_tables& t = tables();
+    int result = 0;
+    for (size_t i = 0; i < count; ++i) {
+        zones[i] = zone_by_code(t, codes[i]);
+        if (zones[i] == TZID_INVALID)
+            result = -1;
+    }
+    return probe.returns(result);
+}
+
+int timezones_to_zone_codes(const TZID *zones, ZONE_CODE *codes,
+    size_t count)
+{
+    probes::call probe(__func__, probes::no_zone, count);
+    const zone_code_tables& t = tables();
+    int result = 0;
+    for (size_t i = 0; i < count; ++i) {
+        codes[i] = t.codes[zones[i]];
+        if (codes[i] == ZONE_CODE_INVALID)
+            result = -1;
+    }
+    return probe.returns(result);
+}
+
+}
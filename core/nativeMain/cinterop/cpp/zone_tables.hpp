@@ -0,0 +1,58 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file contains the tables that give the time zones some values, like
+   their zone codes or their Windows names, built once from the names of the
+   time zones:
+
+       static tables build_tables() { ... codes.set(zone, code); ... }
+       ...
+       const tables& t = zone_tables::built_once<tables, build_tables>();
+       return t.codes[zone];
+
+   The TZIDs are small indices on every platform, so a table is an array
+   indexed by them, and a lookup is a single access to it. Building the
+   tables calls into the platform implementation, so it is only done on the
+   first call that needs them. */
+#pragma once
+#include <vector>
+extern "C" {
+#include "cdate.h"
+}
+
+namespace zone_tables {
+
+/* TZIDs larger than this are not expected from any platform, and are not
+   given values, so that the tables stay small. */
+constexpr TZID max_zone = 1 << 20;
+
+// The values of the time zones, or `none` for those that have no value.
+template <typename T, T none>
+class table {
+public:
+    T operator[](TZID zone) const noexcept {
+        return zone < values_.size() ? values_[zone] : none;
+    }
+
+    // Does nothing for TZID_INVALID and the TZIDs above `max_zone`.
+    void set(TZID zone, T value) {
+        if (zone == TZID_INVALID || zone > max_zone)
+            return;
+        if (zone >= values_.size())
+            values_.resize(zone + 1, none);
+        values_[zone] = value;
+    }
+
+private:
+    std::vector<T> values_;
+};
+
+// The result of `build`, which is called once, by the first caller.
+template <typename Tables, Tables (*build)()>
+const Tables& built_once() {
+    static const Tables tables = build();
+    return tables;
+}
+
+}
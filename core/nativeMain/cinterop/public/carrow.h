@@ -0,0 +1,115 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file specifies the native interface for processing whole columns of
+   timestamps and dates passed through the Arrow C data interface:
+   https://arrow.apache.org/docs/format/CDataInterface.html */
+#pragma once
+#include <stdint.h>
+
+/* The structures are copied verbatim from the specification, so that no
+   Arrow library is needed. */
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    // Array type description
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowSchema*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+struct ArrowArray {
+    // Array data description
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowArray*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+#endif  // ARROW_C_DATA_INTERFACE
+
+/* The supported columns are `timestamp` in any unit, with or without a time
+   zone (formats `tss:`, `tsm:`, `tsu:` and `tsn:`), `date32` (`tdD`) and
+   `date64` (`tdm`). The time zone of a timestamp column is either a name
+   from the time zone database or a fixed offset like `+05:30`; timestamps
+   without a time zone are local date-times.
+
+   The functions below read the input columns in place and don't take
+   ownership of them. On success, they return 0 and move a new column into
+   `out_schema` and `out_array`, which have to be released by the caller with
+   their `release` callbacks. The output columns have the same length and
+   nulls as the input ones, and their own buffers, so they outlive the input.
+   On failure, they return -1 and leave the output untouched. The failure
+   means that the column type or the time zone is not supported, or that
+   there was a problem with the time zone database. */
+
+// The fields of local date-times.
+enum CIVIL_FIELD {
+    CIVIL_FIELD_YEAR,
+    CIVIL_FIELD_MONTH,
+    CIVIL_FIELD_DAY,
+    CIVIL_FIELD_HOUR,
+    CIVIL_FIELD_MINUTE,
+    CIVIL_FIELD_SECOND,
+    // From 1 for Monday to 7 for Sunday.
+    CIVIL_FIELD_ISO_DAY_OF_WEEK,
+    // From 1 for January 1.
+    CIVIL_FIELD_DAY_OF_YEAR,
+};
+
+/* Converts a timestamp column with a time zone to a timestamp column without
+   one, holding the local date-times in that time zone, in the same unit. */
+int arrow_timestamps_to_local(
+    const struct ArrowSchema *schema, const struct ArrowArray *array,
+    struct ArrowSchema *out_schema, struct ArrowArray *out_array);
+
+/* Converts a timestamp column without a time zone to a timestamp column with
+   the given time zone, holding the instants of those local date-times there.
+   Local date-times in a time gap are moved forward by the length of the gap,
+   and the ones that happen twice get the earlier offset. */
+int arrow_timestamps_from_local(
+    const struct ArrowSchema *schema, const struct ArrowArray *array,
+    const char *timezone,
+    struct ArrowSchema *out_schema, struct ArrowArray *out_array);
+
+/* Rounds the timestamps or dates down to the start of their year, month,
+   day, hour, minute or second, as observed in the time zone of the column, if
+   any. The result is a column of the same type. If the start of a period is
+   in a time gap, the first instant after the gap is used, and if it happens
+   twice, the earlier one is. */
+int arrow_truncate_timestamps(
+    const struct ArrowSchema *schema, const struct ArrowArray *array,
+    enum CIVIL_FIELD field,
+    struct ArrowSchema *out_schema, struct ArrowArray *out_array);
+
+/* Extracts a field of the local date-times of a timestamp column, as
+   observed in its time zone, if any, or of the dates of a date column, into
+   an `int32` column. The time fields of the dates are zero. */
+int arrow_extract_field(
+    const struct ArrowSchema *schema, const struct ArrowArray *array,
+    enum CIVIL_FIELD field,
+    struct ArrowSchema *out_schema, struct ArrowArray *out_array);
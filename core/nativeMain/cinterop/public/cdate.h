@@ -2,7 +2,10 @@
  * Copyright 2016-2020 JetBrains s.r.o.
  * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
  */
-// This file specifies the native interface for datetime information queries.
+/* This file specifies the native interface for datetime information queries.
+   The functions up to `at_start_of_day` are implemented for each platform
+   separately. All the others are platform-independent: they only get the
+   time zone information through those. */
 #pragma once
 #include <stdint.h>
 #include <stddef.h>
@@ -27,6 +30,23 @@ char ** available_zone_ids();
 // returns the offset, or INT_MAX if there's a problem with the time zone.
 int offset_at_instant(TZID zone, int64_t epoch_sec);
 
+/* Returns the offset, or INT_MAX if there's a problem with the time zone.
+   Also sets [*begin; *end) to a range of instants that contains `epoch_sec`
+   and where the offset stays the same. The range is not necessarily the
+   largest such one, but it ends on a time zone transition whenever the
+   platform can tell, so that the callers can reuse the offset for the
+   neighboring instants. */
+int offset_interval_at_instant(TZID zone, int64_t epoch_sec,
+    int64_t *begin, int64_t *end);
+
+/* Returns the offset, or INT_MAX if there's a problem with the time zone.
+   Also writes the abbreviation of the time zone name at `epoch_sec`, like
+   `CEST`, into `abbreviation`, truncated to `size - 1` characters and
+   followed by a zero. Where the platform knows no abbreviations, the offset
+   in the form `+HH` or `+HHMM` is written instead. */
+int abbreviation_at_instant(TZID zone, int64_t epoch_sec,
+    char *abbreviation, size_t size);
+
 // returns the id of the timezone or TZID_INVALID in case of an error.
 TZID timezone_by_name(const char *zone_name);
 
@@ -38,3 +58,543 @@ TZID timezone_by_name(const char *zone_name);
 int offset_at_datetime(TZID zone, int64_t epoch_sec, int *offset);
 
 int64_t at_start_of_day(TZID zone, int64_t midnight_epoch_sec);
+
+/* A permanent code of a time zone or link name, which, unlike TZID, is the
+   same in every process and every version of the library and the time zone
+   database, so it can be stored: the names are only ever appended to the
+   list in `zone_codes.hpp`. */
+typedef uint16_t ZONE_CODE;
+const ZONE_CODE ZONE_CODE_INVALID = 0;
+
+// Returns the code of the name, or ZONE_CODE_INVALID if it has none.
+ZONE_CODE zone_code_by_name(const char *zone_name);
+
+/* Returns the name with the code, which must not be freed, or NULL if there
+   is no such code. */
+const char * zone_name_by_code(ZONE_CODE code);
+
+/* Returns the time zone with the name that has the code, or TZID_INVALID if
+   there is no such code or the time zone database doesn't have the name. */
+TZID timezone_by_zone_code(ZONE_CODE code);
+
+/* Returns the code of the name of the time zone, or ZONE_CODE_INVALID. Since
+   a link is the same time zone as the one it links to, this is the code of
+   the name of the latter. */
+ZONE_CODE zone_code_of_timezone(TZID zone);
+
+/* The versions of the two functions above for `count` values. Return 0 on
+   success, or -1 if some values could not be converted, in which case the
+   corresponding results are TZID_INVALID or ZONE_CODE_INVALID. */
+int zone_codes_to_timezones(const ZONE_CODE *codes, TZID *zones,
+    size_t count);
+int timezones_to_zone_codes(const TZID *zones, ZONE_CODE *codes,
+    size_t count);
+
+/* Returns the time zone that CLDR maps the Windows time zone name, like
+   "Pacific Standard Time", to, or TZID_INVALID if the name is unknown or the
+   time zone database doesn't have that time zone. Available on every
+   platform, for the names that come from Windows systems. */
+TZID timezone_by_windows_name(const char *windows_name);
+
+/* Returns the name of the Windows time zone that CLDR maps the time zone to,
+   which must not be freed, or NULL if there is none. */
+const char * windows_name_of_timezone(TZID zone);
+
+/* A calendar of business days: a fixed set of weekend days of the week, a set
+   of holidays, and the business hours, in seconds since the local midnight,
+   that every business day has. Days are given as the number of days since
+   1970-01-01. Lookups are thread-safe as long as the calendar is not being
+   modified concurrently. */
+typedef struct BUSINESS_CALENDAR BUSINESS_CALENDAR;
+
+/* Returns a new calendar without holidays, with business hours spanning the
+   whole day, or null if every day of the week is a weekend.
+   Bit `n` in `weekend_mask` denotes the ISO day of week `n + 1`, so Saturday
+   and Sunday are `0x60`. The calendar must be freed with
+   `business_calendar_free`. */
+BUSINESS_CALENDAR * business_calendar_create(unsigned int weekend_mask);
+
+void business_calendar_free(BUSINESS_CALENDAR *calendar);
+
+/* Marks the given days as holidays. Returns 0 on success, or -1 if a day is
+   outside the years [-32767; 32767]; the preceding days are still added. */
+int business_calendar_add_holidays(BUSINESS_CALENDAR *calendar,
+    const int64_t *epoch_days, size_t count);
+
+/* Returns 0 on success, or -1 unless 0 <= open_sec < close_sec <= 86400. */
+int business_calendar_set_hours(BUSINESS_CALENDAR *calendar,
+    int open_sec, int close_sec);
+
+// returns 1 for business days and 0 for weekends and holidays.
+int is_business_day(const BUSINESS_CALENDAR *calendar, int64_t epoch_day);
+
+/* Returns the number of business days in [from_day; to_day), or the negated
+   number of business days in [to_day; from_day) if `to_day < from_day`. */
+int64_t business_days_between(const BUSINESS_CALENDAR *calendar,
+    int64_t from_day, int64_t to_day);
+
+/* Returns the `n`-th business day after `epoch_day` (before it, if `n` is
+   negative), or `epoch_day` itself if `n` is zero. The days that don't fit
+   into `int64_t` are saturated to INT64_MAX or INT64_MIN. */
+int64_t add_business_days(const BUSINESS_CALENDAR *calendar,
+    int64_t epoch_day, int64_t n);
+
+/* Returns 1 if the instant falls into the business hours of a business day
+   in the given time zone, 0 if it doesn't, or -1 if there's a problem with
+   the time zone. */
+int is_business_instant(const BUSINESS_CALENDAR *calendar, TZID zone,
+    int64_t epoch_sec);
+
+/* Returns the business time between two instants, measured in seconds on
+   the local wall clock of the given time zone, so a business day always
+   contributes exactly its business hours, regardless of the time zone
+   transitions during that day. Negative if `to_sec < from_sec`.
+   In case of an error, INT64_MAX is returned. */
+int64_t business_seconds_between(const BUSINESS_CALENDAR *calendar,
+    TZID zone, int64_t from_sec, int64_t to_sec);
+
+/* A compiled weekly schedule of opening hours in a given time zone. The
+   opening hours are given in the local time: for each day of the week, as
+   well as for specific dates that are exceptions to the weekly routine.
+   Lookups are thread-safe as long as the schedule is not being modified
+   concurrently. */
+typedef struct WEEKLY_SCHEDULE WEEKLY_SCHEDULE;
+
+/* Returns a new schedule that is never open. The schedule must be freed with
+   `weekly_schedule_free`. */
+WEEKLY_SCHEDULE * weekly_schedule_create(TZID zone);
+
+void weekly_schedule_free(WEEKLY_SCHEDULE *schedule);
+
+/* Adds an interval [open_sec; close_sec), in seconds since the local midnight
+   of the given ISO day of week, during which the schedule is open. The
+   interval may extend into the next day, but may not be longer than a day.
+   Returns 0 on success, or -1 if the arguments are out of range. */
+int weekly_schedule_add_interval(WEEKLY_SCHEDULE *schedule,
+    int iso_day_of_week, int open_sec, int close_sec);
+
+/* Replaces the opening hours of the local date `epoch_day` with `count`
+   intervals [open_sec; close_sec), given as consecutive pairs in
+   `open_close_secs`, so `count` of zero means that the schedule is closed for
+   the whole date. The intervals must lie within [0; 86400].
+   Returns 0 on success, or -1 if the arguments are out of range. */
+int weekly_schedule_set_exception(WEEKLY_SCHEDULE *schedule,
+    int64_t epoch_day, const int *open_close_secs, size_t count);
+
+/* Returns 1 if the schedule is open at the given instant, 0 if it's closed,
+   or -1 if there's a problem with the time zone. */
+int weekly_schedule_is_open(const WEEKLY_SCHEDULE *schedule, int64_t epoch_sec);
+
+/* Returns the first instant after `epoch_sec` at which the schedule opens or
+   closes, setting `*opens` to 1 or 0 respectively, taking into account that
+   local times can be skipped or repeated due to the time zone transitions.
+   If the schedule doesn't change its state for a year, or in case of an
+   error, INT64_MAX is returned. */
+int64_t weekly_schedule_next_transition(const WEEKLY_SCHEDULE *schedule,
+    int64_t epoch_sec, int *opens);
+
+/* Sets `is_open[i]` to 1 or 0 depending on whether the schedule is open at
+   `epoch_secs[i]`. The offsets are reused between the neighboring instants,
+   so sorted input is processed the fastest.
+   Returns 0 on success, or -1 if there's a problem with the time zone. */
+int weekly_schedule_is_open_batch(const WEEKLY_SCHEDULE *schedule,
+    const int64_t *epoch_secs, uint8_t *is_open, size_t count);
+
+/* The time scales between which timestamps can be converted. All timestamps
+   are counted in nanoseconds. */
+enum TIME_SCALE {
+    // The Unix time, where every day has exactly 86400 seconds.
+    TIME_SCALE_UNIX,
+    /* The Unix time on a system that smears every leap second linearly over
+       the 24 hours from noon to noon around it, so that the clock never
+       repeats nor skips a second. */
+    TIME_SCALE_UNIX_SMEARED,
+    // The number of seconds since 1970-01-01, counting the leap seconds.
+    TIME_SCALE_UTC,
+    // The International Atomic Time, counted since 1958-01-01 00:00:00 TAI.
+    TIME_SCALE_TAI,
+    // The GPS time, counted since 1980-01-06 00:00:00 UTC.
+    TIME_SCALE_GPS,
+};
+
+/* Converts `count` timestamps from one time scale to another. `from_nanos`
+   and `to_nanos` may point to the same array. A timestamp during a leap
+   second is converted to the Unix time as the last nanosecond before it.
+   The results that don't fit into 64 bits are saturated. Returns 0 on
+   success, or -1 if a time scale is unknown. */
+int convert_time_scale(enum TIME_SCALE from, enum TIME_SCALE to,
+    const int64_t *from_nanos, int64_t *to_nanos, size_t count);
+
+// The systems of counting fractional days that can be converted to instants.
+enum DAY_NUMBER_SYSTEM {
+    // The Julian Day, counted since -4713-11-24 12:00:00 UT (Gregorian).
+    DAY_NUMBER_JULIAN,
+    // The Modified Julian Date, counted since 1858-11-17 00:00:00 UT.
+    DAY_NUMBER_MODIFIED_JULIAN,
+    /* The spreadsheet serial date of Lotus 1-2-3 and Excel, where 1 is
+       1900-01-01 and 60 is the nonexistent 1900-02-29. */
+    DAY_NUMBER_SERIAL_1900,
+    // The spreadsheet serial date where 0 is 1904-01-01.
+    DAY_NUMBER_SERIAL_1904,
+};
+
+/* Converts `count` day numbers to instants, rounding to a microsecond, as
+   that's beyond the precision of a `double` day number for the usual dates.
+   The serial dates are local date-times in `zone`, or in UTC if `zone` is
+   TZID_INVALID, with the serial date 60 and the local date-times in a time
+   gap moved forward; the Julian days ignore `zone`. `nanos` may be null.
+   Returns 0 on success, or -1 if some day number is not finite or too large,
+   or there's a problem with the time zone, in which case the corresponding
+   seconds are set to INT64_MAX. */
+int day_numbers_to_instants(enum DAY_NUMBER_SYSTEM system, TZID zone,
+    const double *day_numbers, int64_t *epoch_secs, int32_t *nanos,
+    size_t count);
+
+/* Converts `count` instants to day numbers, with the same rules as in
+   `day_numbers_to_instants`. `nanos` may be null. Returns 0 on success, or
+   -1 if there's a problem with the time zone, in which case the
+   corresponding day numbers are NaN. */
+int instants_to_day_numbers(enum DAY_NUMBER_SYSTEM system, TZID zone,
+    const int64_t *epoch_secs, const int32_t *nanos, double *day_numbers,
+    size_t count);
+
+// The units of the timestamps accepted and returned by the batch functions.
+enum TIME_UNIT {
+    TIME_UNIT_SECOND,
+    TIME_UNIT_MILLISECOND,
+    TIME_UNIT_MICROSECOND,
+    TIME_UNIT_NANOSECOND,
+};
+
+/* The batch functions below process `count` timestamps in the given unit,
+   counted since 1970-01-01T00:00Z for instants, or since 1970-01-01T00:00
+   for local date-times. Like in the functions above, the instants outside
+   the range that the time zone database recognizes get the offsets of its
+   boundaries, and the results that don't fit into `int64_t` are saturated.
+   The offsets are reused between the neighboring timestamps, so sorted
+   input is processed the fastest. Each function returns 0 on success, or -1
+   if the unit is unknown or there's a problem with the time zone. */
+
+// Sets `offsets[i]` to the offset at `instants[i]`.
+int offsets_at_instants(TZID zone, enum TIME_UNIT unit,
+    const int64_t *instants, int *offsets, size_t count);
+
+// Sets `local_times[i]` to the local date-time at `instants[i]`.
+int instants_to_local_times(TZID zone, enum TIME_UNIT unit,
+    const int64_t *instants, int64_t *local_times, size_t count);
+
+/* Sets `instants[i]` to the instant of `local_times[i]`. Local date-times in
+   a time gap are moved forward by the length of the gap, and the ones that
+   happen twice get the earlier offset, like in `offset_at_datetime`. */
+int local_times_to_instants(TZID zone, enum TIME_UNIT unit,
+    const int64_t *local_times, int64_t *instants, size_t count);
+
+/* The fields of a local date-time, along with the offset at which it was
+   observed, or INT_MAX if the offset is unknown. */
+struct LOCAL_DATETIME_FIELDS {
+    int32_t year;
+    int8_t month;
+    int8_t day;
+    int8_t hour;
+    int8_t minute;
+    int8_t second;
+    int32_t nanosecond;
+    int32_t offset_sec;
+};
+
+/* A local date-time, up to a second, with an optional offset packed into 64
+   bits. From the most significant bits, these are the year in two's
+   complement (21 bits, for years in [-999999; 999999]), the month (4), the
+   day (5), the hour (5), the minute (6), the second (6), and the offset
+   (17), biased by 64800 seconds, or all ones if it is unknown. So, comparing
+   the packed values as signed integers orders them by the local date-time,
+   then by the offset. The nanoseconds, if needed, are stored separately,
+   making it 96 bits in total. */
+typedef int64_t PACKED_DATETIME;
+
+/* Packs `count` date-times. `nanoseconds` may be null if they are not needed.
+   Returns 0 on success, or -1 if some fields are invalid, in which case the
+   corresponding packed values are INT64_MIN. */
+int pack_datetimes(const struct LOCAL_DATETIME_FIELDS *fields,
+    PACKED_DATETIME *packed, int32_t *nanoseconds, size_t count);
+
+/* Unpacks `count` date-times. `nanoseconds` may be null, in which case they
+   are assumed to be zero. */
+void unpack_datetimes(const PACKED_DATETIME *packed,
+    const int32_t *nanoseconds, struct LOCAL_DATETIME_FIELDS *fields,
+    size_t count);
+
+/* Packs the local date-times of `count` instants in the given time zone,
+   along with the offsets. Returns 0 on success, or -1 if there's a problem
+   with the time zone or if a local date-time is out of range, in which case
+   the corresponding packed values are INT64_MIN. */
+int pack_instants(TZID zone, const int64_t *epoch_secs,
+    PACKED_DATETIME *packed, size_t count);
+
+/* Converts `count` packed date-times to instants, using the packed offsets or,
+   when they are unknown, the offsets in the given time zone, as chosen by
+   `offset_at_datetime`. Returns 0 on success, or -1 if some values are not
+   valid packed date-times, like INT64_MIN written for the invalid fields, or
+   if there's a problem with the time zone, in which case the corresponding
+   instants are INT64_MAX. */
+int packed_datetimes_to_instants(TZID zone, const PACKED_DATETIME *packed,
+    int64_t *epoch_secs, size_t count);
+
+/* The conversions between the days since 1970-01-01 and the dates of the
+   proleptic Gregorian calendar, for the years of `LocalDate`,
+   [-999999; 999999]. The arrays are separate for each field, so that the
+   loops over them are vectorized. */
+
+/* Converts `count` epoch days to dates. Returns 0 on success, or -1 if some
+   days are out of range, in which case the corresponding fields are 0. */
+int epoch_days_to_dates(const int64_t *epoch_days, int32_t *years,
+    int8_t *months, int8_t *days, size_t count);
+
+/* Converts `count` dates to epoch days. Returns 0 on success, or -1 if some
+   dates are invalid, in which case the corresponding days are INT64_MAX. */
+int dates_to_epoch_days(const int32_t *years, const int8_t *months,
+    const int8_t *days, int64_t *epoch_days, size_t count);
+
+/* Converts `count` epoch days to the ISO 8601 week dates: the week-based
+   year, the week from 1 to 53, and the ISO day of the week from 1 for
+   Monday. Returns 0 on success, or -1 if some days are out of range, in
+   which case the corresponding fields are 0. */
+int epoch_days_to_iso_week_dates(const int64_t *epoch_days,
+    int32_t *week_years, int8_t *weeks, int8_t *days_of_week, size_t count);
+
+/* A pattern for formatting and parsing instants, compiled once and then
+   usable from any number of threads. The pattern consists of the following
+   conversions, like for `strftime`, and of the characters that are copied
+   as is:
+     %Y  the year, at least four digits, with a sign outside [0; 9999]
+     %y  the last two digits of the year; in [1969; 2068] when parsing
+     %m  the month, %d the day, %j the day of the year
+     %H  the hour, %I the hour on a 12-hour clock, %p AM or PM
+     %M  the minute, %S the second
+     %N  the nanoseconds, nine digits; %3N and %6N give fewer of them
+     %b, %h  the English name of the month, abbreviated, %B in full
+     %a  the English name of the day of the week, abbreviated, %A in full
+     %u  the ISO day of the week, 1 to 7; %w from 0 for Sunday to 6
+     %z  the offset like `+0530`; %:z like `+05:30`
+     %Z  the abbreviation of the time zone name, like `CEST`
+     %s  the seconds since 1970-01-01T00:00Z
+     %F  the same as %Y-%m-%d, %T as %H:%M:%S, %R as %H:%M, %D as %m/%d/%y
+     %e  the same as %_d, %k as %_H, %l as %_I
+     %%  `%`, %n a line break, %t a tab
+   The numbers are padded with zeros; with the `-` flag, as in `%-d`, they
+   are not padded, and with the `_` flag, they are padded with spaces.
+   The date-times are formatted in the time zone of the pattern, which may
+   be TZID_INVALID for the UTC. When parsing, a space in the pattern matches
+   any amount of whitespace, the names are matched ignoring the case, and
+   the missing fields are taken from 1970-01-01T00:00. Unless the text has
+   an offset or the number of seconds since the epoch, the date-time is
+   resolved in the time zone of the pattern like by `offset_at_datetime`. A
+   parsed abbreviation of the time zone name is checked to be a sequence of
+   letters, but is otherwise ignored, unless it is `UTC`, `GMT` or `Z`, which
+   give the zero offset, or a numeric one like `+03`. */
+typedef struct DATETIME_PATTERN DATETIME_PATTERN;
+
+/* The most characters that formatting with a pattern may produce. */
+#define DATETIME_PATTERN_MAX_LENGTH 1024
+
+/* Compiles the pattern for the given time zone. Returns null if the pattern
+   is invalid or could produce more than `DATETIME_PATTERN_MAX_LENGTH`
+   characters. The result must be freed with `datetime_pattern_free`. */
+DATETIME_PATTERN * datetime_pattern_compile(const char *pattern, TZID zone);
+
+void datetime_pattern_free(DATETIME_PATTERN *pattern);
+
+/* Returns the maximum number of characters that formatting an instant with
+   the pattern can produce. */
+size_t datetime_pattern_max_length(const DATETIME_PATTERN *pattern);
+
+/* Formats the instant into `buffer` of `size` characters, followed by a zero.
+   Returns the number of characters written, without the zero, or -1 if
+   there's a problem with the time zone, the nanoseconds are not in
+   [0; 999999999], the local date-time of the instant doesn't fit into 64
+   bits of seconds, or the buffer is too small. */
+int datetime_pattern_format(const DATETIME_PATTERN *pattern,
+    int64_t epoch_sec, int32_t nanos, char *buffer, size_t size);
+
+/* Parses `length` characters of `text`. Returns 0 on success, or -1 if the
+   text doesn't match the pattern or there's a problem with the time zone. */
+int datetime_pattern_parse(const DATETIME_PATTERN *pattern,
+    const char *text, size_t length, int64_t *epoch_sec, int32_t *nanos);
+
+/* Formats `count` instants into `buffer` of `size` characters one after
+   another, with no separators, and sets `offsets`, which has `count + 1`
+   elements, so that the string number `i` is in
+   [offsets[i]; offsets[i + 1]), like in the string columns of Arrow.
+   `nanos` may be null, in which case they are assumed to be zero. Returns 0
+   on success, or -1 if `datetime_pattern_format` would fail for some
+   instant or the buffer is too small. */
+int datetime_pattern_format_batch(const DATETIME_PATTERN *pattern,
+    const int64_t *epoch_secs, const int32_t *nanos, size_t count,
+    char *buffer, size_t size, int32_t *offsets);
+
+/* Parses `count` strings stored like the output of
+   `datetime_pattern_format_batch`. `nanos` may be null. Returns 0 on
+   success, or -1 if some strings could not be parsed, in which case the
+   corresponding instants are INT64_MAX. */
+int datetime_pattern_parse_batch(const DATETIME_PATTERN *pattern,
+    const char *buffer, const int32_t *offsets, size_t count,
+    int64_t *epoch_secs, int32_t *nanos);
+
+/* The date-times of the Internet protocols. None of these functions
+   allocate or need the time zone database: the offsets are given by the
+   callers, for example, from `offset_at_instant`, and are written in whole
+   minutes, truncating the seconds, if any, which doesn't change the instant.
+   The years have to be in [0; 9999]. The formatting functions write the
+   string, followed by a zero, into `buffer` of `size` characters, and
+   return the number of characters written, without the zero, or -1 if the
+   arguments are out of range or the buffer is too small. The parsing
+   functions read `length` characters of `text` and return 0 on success, or
+   -1 if the text is not valid. */
+
+// `2020-08-30T18:43:00.123+02:00`, the longest one having nine digits.
+#define RFC3339_MAX_LENGTH 35
+// `Sun, 30 Aug 2020 18:43:00 +0200`.
+#define RFC2822_MAX_LENGTH 31
+// `Sun, 30 Aug 2020 16:43:00 GMT`.
+#define IMF_FIXDATE_LENGTH 29
+
+/* Formats an instant as RFC 3339 with the given offset, using `Z` for the
+   zero one. The fraction of a second takes three, six or nine digits,
+   whichever is enough, and is omitted if it is zero. */
+int format_rfc3339(int64_t epoch_sec, int32_t nanos, int offset_sec,
+    char *buffer, size_t size);
+
+// Formats an instant as RFC 2822 with the given offset.
+int format_rfc2822(int64_t epoch_sec, int offset_sec,
+    char *buffer, size_t size);
+
+// Formats an instant as IMF-fixdate, the preferred format of HTTP.
+int format_imf_fixdate(int64_t epoch_sec, char *buffer, size_t size);
+
+/* Formats the current time as IMF-fixdate. The string is cached per thread
+   and only rebuilt when the second changes. */
+int format_imf_fixdate_now(char *buffer, size_t size);
+
+/* Parses RFC 3339, `T` being allowed to be `t` or a space, and `Z` to be
+   `z`. Sets the instant and the offset that was in the text. The digits of
+   the fraction of a second after the ninth are ignored, and leap seconds
+   are not valid. */
+int parse_rfc3339(const char *text, size_t length,
+    int64_t *epoch_sec, int32_t *nanos, int *offset_sec);
+
+/* Parses RFC 2822, including the obsolete syntax: comments, two- and
+   three-digit years, optional seconds, the zone names like `GMT` and `EST`,
+   and the military ones, which give the zero offset, like `-0000` does.
+   The day of the week, if any, has to match the date. A leap second becomes
+   the second before it. */
+int parse_rfc2822(const char *text, size_t length,
+    int64_t *epoch_sec, int *offset_sec);
+
+/* Parses an HTTP date in any of the formats that the recipients have to
+   accept: IMF-fixdate, the obsolete RFC 850 format, like
+   `Sunday, 06-Nov-94 08:49:37 GMT`, or that of `asctime`, like
+   `Sun Nov  6 08:49:37 1994`. */
+int parse_http_date(const char *text, size_t length, int64_t *epoch_sec);
+
+// The formats of the timestamps that `parse_timestamps` recognizes.
+enum TIMESTAMP_FORMAT {
+    TIMESTAMP_FORMAT_NONE,
+    // `2020-08-30T18:43:00.123+02:00`, the offset and the time optional.
+    TIMESTAMP_FORMAT_ISO8601,
+    // The numbers of units since 1970-01-01T00:00Z, maybe with a fraction.
+    TIMESTAMP_FORMAT_EPOCH_SECONDS,
+    TIMESTAMP_FORMAT_EPOCH_MILLISECONDS,
+    TIMESTAMP_FORMAT_EPOCH_MICROSECONDS,
+    TIMESTAMP_FORMAT_EPOCH_NANOSECONDS,
+    // RFC 2822 and the HTTP dates, as parsed by `parse_rfc2822` and
+    // `parse_http_date`.
+    TIMESTAMP_FORMAT_RFC2822,
+    // `2020/08/30 18:43:00`, the seconds and the time optional.
+    TIMESTAMP_FORMAT_SLASHED,
+};
+
+// Why a timestamp could not be parsed.
+enum TIMESTAMP_ERROR {
+    TIMESTAMP_ERROR_NONE,
+    // The string is empty or consists of whitespace.
+    TIMESTAMP_ERROR_EMPTY,
+    TIMESTAMP_ERROR_SYNTAX,
+    // The instant doesn't fit into 64 bits of nanoseconds.
+    TIMESTAMP_ERROR_RANGE,
+    TIMESTAMP_ERROR_TIME_ZONE,
+};
+
+/* Parses `count` strings stored like the output of
+   `datetime_pattern_format_batch`, each in any of the formats above,
+   surrounded by any whitespace, into the numbers of nanoseconds since
+   1970-01-01T00:00Z. The format is detected from a sample of the strings,
+   and only the strings not in that format have theirs detected separately.
+   So, a column of numbers is read in the unit that suits most of them, with
+   the current date-times having 10 digits in seconds, 13 in milliseconds,
+   16 in microseconds and 19 in nanoseconds. The date-times without an
+   offset are in the given time zone, which may be TZID_INVALID for the UTC,
+   and are resolved like by `offset_at_datetime`. `formats` and `errors`,
+   which receive the format and the error of each string, may be null.
+   Returns 0 on success, or -1 if some strings could not be parsed, in which
+   case the corresponding instants are INT64_MAX and the formats are
+   TIMESTAMP_FORMAT_NONE. */
+int parse_timestamps(TZID zone, const char *buffer, const int32_t *offsets,
+    size_t count, int64_t *epoch_nanos, uint8_t *formats, uint8_t *errors);
+
+/* A period like `DateTimePeriod`, the components of which may have
+   different signs. */
+struct DATETIME_PERIOD {
+    int32_t years;
+    int32_t months;
+    int32_t days;
+    int32_t hours;
+    int32_t minutes;
+    int64_t seconds;
+    int64_t nanoseconds;
+};
+
+/* Enough for the longest periods, with the components of the largest
+   magnitude, some of them negative. */
+#define DATETIME_PERIOD_MAX_LENGTH 94
+
+/* Formats the period like `DateTimePeriod.toString`, as in
+   `P1Y2M3DT4H5M6.789000000S`, into `buffer` of `size` characters, followed
+   by a zero. If no component is positive, the period is written negated,
+   preceded by `-`. The nanoseconds are added to the seconds, so they don't
+   have to be in [0; 999999999]. This is where the two differ: the text is
+   the same only if the nanoseconds are zero, or if they are less than a
+   second in magnitude and neither they nor the seconds have the sign
+   opposite to that of the period. Otherwise, `toString` writes them after
+   the point as they are, which is not a valid period: for 1 second and -5
+   nanoseconds, it gives `PT1.0000000-5S` where this gives `PT0.999999995S`,
+   and for 1 second and 1500000000 nanoseconds, `PT1.1500000000S` where
+   this gives `PT2.500000000S`. Also, the negated INT32_MIN or INT64_MIN is
+   written as a positive number, while `toString` overflows and keeps its
+   sign. Returns the number of characters written, without the zero, or -1
+   if the buffer is too small or the seconds with the nanoseconds don't fit
+   into 64 bits. */
+int format_period(const struct DATETIME_PERIOD *period,
+    char *buffer, size_t size);
+
+/* Parses `length` characters of `text` as an ISO 8601 period, like
+   `P1Y2M3DT4H5M6.789S`. Every number may have a sign of its own, and the
+   whole period may be preceded by `-`, which negates it, so everything that
+   `format_period` writes can be parsed back. The weeks, as in `P2W`, are
+   added to the days. Only the seconds may have a fraction. Returns 0 on
+   success, or -1 if the text is not valid or a component doesn't fit into
+   its field. */
+int parse_period(const char *text, size_t length,
+    struct DATETIME_PERIOD *period);
+
+/* Formats `count` periods into `buffer` of `size` characters one after
+   another, with no separators, and sets `offsets` like
+   `datetime_pattern_format_batch`. Returns 0 on success, or -1 if a period
+   can't be formatted or the buffer is too small. */
+int format_periods(const struct DATETIME_PERIOD *periods, size_t count,
+    char *buffer, size_t size, int32_t *offsets);
+
+/* Parses `count` strings stored like the output of `format_periods`.
+   Returns 0 on success, or -1 if some strings could not be parsed, in which
+   case the corresponding periods are zero. */
+int parse_periods(const char *buffer, const int32_t *offsets, size_t count,
+    struct DATETIME_PERIOD *periods);
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file contains the conversions between the proleptic Gregorian dates
+   and the epoch days. They are valid for a much wider range of years than
+   the one supported by the `date` library, and, being `constexpr`, can also
+   be evaluated at compile time.
+
+   For the years of `LocalDate`, [-999999; 999999], the algorithms by Neri
+   and Schneider are used, which only need unsigned 32-bit arithmetic and no
+   branches, so the loops over them can be vectorized; outside of it, those
+   by Howard Hinnant, the same as in the `date` library. Both are checked
+   against each other at compile time in `civil.cpp`, where the versions of
+   these functions for arrays, declared in `cdate.h`, are implemented. */
+#pragma once
+#include <cstdint>
+
+#define SECS_PER_DAY 86400
+
+namespace civil {
+
+// The range of years where the conversions are the fastest.
+constexpr int64_t min_year = -999999;
+constexpr int64_t max_year = 999999;
+
+constexpr int64_t floor_div(int64_t a, int64_t b) {
+    return a / b - ((a % b != 0) && ((a < 0) != (b < 0)));
+}
+
+// The remainder of `floor_div`, which never overflows. `b` is positive.
+constexpr int64_t floor_mod(int64_t a, int64_t b) {
+    return a % b < 0 ? a % b + b : a % b;
+}
+
+// `a + b`, saturated to the range of `int64_t`.
+constexpr int64_t saturating_add(int64_t a, int64_t b) {
+    int64_t result = 0;
+    if (__builtin_add_overflow(a, b, &result))
+        return b < 0 ? INT64_MIN : INT64_MAX;
+    return result;
+}
+
+constexpr bool is_leap_year(int64_t year) {
+    // Divisible by 4, or, for the centuries, by 16, and so by 400.
+    return (year & (year % 25 != 0 ? 3 : 15)) == 0;
+}
+
+constexpr int days_in_month(int64_t year, int month) {
+    return month == 2 ? (is_leap_year(year) ? 29 : 28) :
+        30 + ((month + (month >> 3)) & 1);
+}
+
+// The day of the year, from 1 for January 1.
+constexpr int day_of_year(int64_t year, int month, int day) {
+    /* The days before the month, counting from March 1 like below, then
+       shifted back to January 1. */
+    const int january_or_february = month <= 2;
+    const int leap = is_leap_year(year);
+    return (979 * (month + 12 * january_or_february) - 2919) / 32 + day +
+        59 + leap - january_or_february * (365 + leap);
+}
+
+namespace detail {
+
+/* The algorithms by Howard Hinnant:
+   http://howardhinnant.github.io/date_algorithms.html */
+constexpr int64_t wide_days_from_civil(int64_t year, int month, int day) {
+    year -= month <= 2;
+    const int64_t era = floor_div(year, 400);
+    const int64_t year_of_era = year - era * 400;
+    const int64_t day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2)
+        / 5 + day - 1;
+    const int64_t day_of_era = year_of_era * 365 + year_of_era / 4 -
+        year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+constexpr void wide_civil_from_days(int64_t epoch_day,
+    int64_t& year, int& month, int& day)
+{
+    const int64_t z = epoch_day + 719468;
+    const int64_t era = floor_div(z, 146097);
+    const int64_t day_of_era = z - era * 146097;
+    const int64_t year_of_era = (day_of_era - day_of_era / 1460 +
+        day_of_era / 36524 - day_of_era / 146096) / 365;
+    const int64_t day_of_year = day_of_era -
+        (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    const int64_t shifted_month = (5 * day_of_year + 2) / 153;
+    month = (int)(shifted_month < 10 ? shifted_month + 3 : shifted_month - 9);
+    year = year_of_era + era * 400 + (month <= 2);
+    day = (int)(day_of_year - (153 * shifted_month + 2) / 5 + 1);
+}
+
+/* C. Neri and L. Schneider, "Euclidean affine functions and their
+   application to calendar algorithms", 2022. The years start on March 1,
+   so that the leap day is the last one of a year, and are shifted by a
+   whole number of 400-year cycles, which have the same days of the week,
+   for all of them in [min_year - 1; max_year + 1] to be positive, while
+   the intermediate results still fit. */
+constexpr uint32_t year_shift = 2501 * 400;
+// The epoch day of March 1 of the year `-year_shift`, negated.
+constexpr uint32_t day_shift = 2501 * 146097 + 719468;
+
+/* Only valid for the years in [min_year - 1; max_year + 1], and for the
+   month 13, which is January of the next year. */
+constexpr int64_t fast_days_from_civil(int64_t year, int month, int day) {
+    const uint32_t january_or_february = month <= 2;
+    const uint32_t y = (uint32_t)(year + year_shift) - january_or_february;
+    const uint32_t m = (uint32_t)month + 12 * january_or_february;
+    const uint32_t century = y / 100;
+    const uint32_t days_before_year = 1461 * y / 4 - century + century / 4;
+    const uint32_t days_before_month = (979 * m - 2919) / 32;
+    return (int64_t)(days_before_year + days_before_month) + day - 1 -
+        day_shift;
+}
+
+/* Only valid for the epoch days of the years in
+   [min_year - 1; max_year + 1]. */
+constexpr void fast_civil_from_days(int64_t epoch_day,
+    int64_t& year, int& month, int& day)
+{
+    const uint32_t n = (uint32_t)(epoch_day + day_shift);
+    const uint32_t n1 = 4 * n + 3;
+    const uint32_t century = n1 / 146097;
+    const uint32_t n2 = n1 % 146097 | 3;
+    const uint64_t p2 = (uint64_t)2939745 * n2;
+    const uint32_t year_of_century = (uint32_t)(p2 >> 32);
+    const uint32_t day_of_year = (uint32_t)p2 / 2939745 / 4;
+    const uint32_t n3 = 2141 * day_of_year + 197913;
+    const uint32_t january_or_february = day_of_year >= 306;
+    year = (int64_t)(100 * century + year_of_century + january_or_february) -
+        year_shift;
+    month = (int)((n3 >> 16) - 12 * january_or_february);
+    day = (int)((n3 & 0xffff) / 2141 + 1);
+}
+
+// A multiple of 7, shifted so that 1970-01-01 is a Thursday.
+constexpr uint32_t weekday_shift = 7 * 60000000 + 3;
+
+/* Only valid for the epoch days of the years in
+   [min_year - 1; max_year + 1]. */
+constexpr int fast_iso_day_of_week(int64_t epoch_day) {
+    return (int)((uint32_t)(epoch_day + weekday_shift) % 7) + 1;
+}
+
+}
+
+constexpr int64_t min_epoch_day = detail::wide_days_from_civil(min_year, 1, 1);
+constexpr int64_t max_epoch_day =
+    detail::wide_days_from_civil(max_year, 12, 31);
+
+constexpr int64_t days_from_civil(int64_t year, int month, int day) {
+    if (year >= min_year && year <= max_year)
+        return detail::fast_days_from_civil(year, month, day);
+    return detail::wide_days_from_civil(year, month, day);
+}
+
+constexpr void civil_from_days(int64_t epoch_day,
+    int64_t& year, int& month, int& day)
+{
+    if (epoch_day >= min_epoch_day && epoch_day <= max_epoch_day)
+        detail::fast_civil_from_days(epoch_day, year, month, day);
+    else
+        detail::wide_civil_from_days(epoch_day, year, month, day);
+}
+
+// The ISO day of the week, from 1 for Monday; 1970-01-01 was a Thursday.
+constexpr int iso_day_of_week(int64_t epoch_day) {
+    if (epoch_day >= min_epoch_day && epoch_day <= max_epoch_day)
+        return detail::fast_iso_day_of_week(epoch_day);
+    return (int)((epoch_day % 7 + 7 + 3) % 7) + 1;
+}
+
+/* The ISO 8601 week-based year and week of the day. The weeks start on
+   Monday, and the first week of a year is the one with its first Thursday,
+   so the week-based year is that of the Thursday of the week. */
+constexpr void iso_week_date(int64_t epoch_day, int64_t& week_year,
+    int& week)
+{
+    const int64_t thursday = epoch_day - iso_day_of_week(epoch_day) + 4;
+    int month = 0, day = 0;
+    civil_from_days(thursday, week_year, month, day);
+    week = (day_of_year(week_year, month, day) - 1) / 7 + 1;
+}
+
+}
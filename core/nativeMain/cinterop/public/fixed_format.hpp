@@ -0,0 +1,467 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file contains the formatting and parsing of date-times for a pattern
+   known at compile time, for the C++ code that would otherwise use the
+   compiled patterns from `cdate.h` with a constant pattern. The pattern is
+   checked and split into fields while compiling, and each field becomes its
+   own piece of code writing or reading the characters at a fixed position,
+   so nothing is interpreted at run time. Requires C++17:
+
+       static constexpr char iso[] = "%FT%T.%3N%:z";
+       char buffer[fixed_format::pattern<iso>::length];
+       fixed_format::pattern<iso>::format(epoch_sec, nanos, offset, buffer);
+
+   Only the conversions that always produce the same number of characters
+   are supported, so every formatted date-time has the same length:
+     %Y  the year, four digits
+     %y  the last two digits of the year; in [1969; 2068] when parsing
+     %m  the month, %d the day, %j the day of the year
+     %H  the hour, %M the minute, %S the second
+     %N  the nanoseconds, nine digits; %3N and %6N give fewer of them
+     %b, %h  the English name of the month, abbreviated
+     %a  the English name of the day of the week, abbreviated
+     %u  the ISO day of the week, 1 to 7
+     %z  the offset like `+0530`; %:z like `+05:30`
+     %F  the same as %Y-%m-%d, %T as %H:%M:%S, %R as %H:%M
+     %%  `%`, %n a line break, %t a tab
+   Any other conversion is a compilation error. The time zone abbreviations
+   need the time zone database, and are available through `cdate.h` only. */
+#pragma once
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include "civil.hpp"
+
+namespace fixed_format {
+
+/* A parsed date-time: the local date-time in seconds since
+   1970-01-01T00:00, and the offset, or INT_MAX if the pattern has none. */
+struct parsed {
+    int64_t local_sec;
+    int32_t nanosecond;
+    int32_t offset_sec;
+};
+
+namespace detail {
+
+enum kind : uint8_t {
+    LITERAL,
+    YEAR,
+    YEAR_OF_CENTURY,
+    MONTH,
+    DAY,
+    DAY_OF_YEAR,
+    HOUR,
+    MINUTE,
+    SECOND,
+    FRACTION,
+    OFFSET,
+    OFFSET_WITH_COLON,
+    MONTH_ABBREVIATION,
+    WEEKDAY_ABBREVIATION,
+    ISO_WEEKDAY,
+};
+
+// A field or a literal character at a fixed position of the text.
+struct token {
+    kind field;
+    uint8_t width;
+    char literal;
+    size_t position;
+};
+
+template <size_t N>
+struct token_list {
+    token items[N];
+};
+
+/* Splits the pattern into tokens, writing them to `out` unless it is null.
+   Returns the number of the tokens, or -1 if the pattern is not supported. */
+constexpr int tokenize(const char *p, token *out) {
+    int count = 0;
+    size_t position = 0;
+    auto add = [&](kind field, int width, char literal) {
+        if (out != nullptr)
+            out[count] = token{field, (uint8_t)width, literal, position};
+        ++count;
+        position += width;
+    };
+    while (*p != 0) {
+        if (*p != '%') {
+            add(LITERAL, 1, *p++);
+            continue;
+        }
+        ++p;
+        int digits = 0;
+        if (*p >= '1' && *p <= '9')
+            digits = *p++ - '0';
+        const bool colon = *p == ':';
+        if (colon)
+            ++p;
+        const char conversion = *p;
+        if (conversion == 0 || (digits != 0 && conversion != 'N') ||
+            (colon && conversion != 'z'))
+            return -1;
+        ++p;
+        switch (conversion) {
+            case 'Y': add(YEAR, 4, 0); break;
+            case 'y': add(YEAR_OF_CENTURY, 2, 0); break;
+            case 'm': add(MONTH, 2, 0); break;
+            case 'd': add(DAY, 2, 0); break;
+            case 'j': add(DAY_OF_YEAR, 3, 0); break;
+            case 'H': add(HOUR, 2, 0); break;
+            case 'M': add(MINUTE, 2, 0); break;
+            case 'S': add(SECOND, 2, 0); break;
+            case 'N':
+                if (digits == 0)
+                    digits = 9;
+                if (digits % 3 != 0)
+                    return -1;
+                add(FRACTION, digits, 0);
+                break;
+            case 'z':
+                if (colon)
+                    add(OFFSET_WITH_COLON, 6, 0);
+                else
+                    add(OFFSET, 5, 0);
+                break;
+            case 'b':
+            case 'h':
+                add(MONTH_ABBREVIATION, 3, 0);
+                break;
+            case 'a': add(WEEKDAY_ABBREVIATION, 3, 0); break;
+            case 'u': add(ISO_WEEKDAY, 1, 0); break;
+            case 'F':
+                add(YEAR, 4, 0);
+                add(LITERAL, 1, '-');
+                add(MONTH, 2, 0);
+                add(LITERAL, 1, '-');
+                add(DAY, 2, 0);
+                break;
+            case 'T':
+            case 'R':
+                add(HOUR, 2, 0);
+                add(LITERAL, 1, ':');
+                add(MINUTE, 2, 0);
+                if (conversion == 'T') {
+                    add(LITERAL, 1, ':');
+                    add(SECOND, 2, 0);
+                }
+                break;
+            case '%': add(LITERAL, 1, '%'); break;
+            case 'n': add(LITERAL, 1, '\n'); break;
+            case 't': add(LITERAL, 1, '\t'); break;
+            default:
+                return -1;
+        }
+    }
+    return count;
+}
+
+/* `std::index_sequence`, which the library doesn't declare when `defines.hpp`
+   sets `__cplusplus` to that of C++11. */
+template <size_t... I>
+struct indices {};
+
+template <size_t N, size_t... I>
+struct make_indices : make_indices<N - 1, N - 1, I...> {};
+
+template <size_t... I>
+struct make_indices<0, I...> {
+    using type = indices<I...>;
+};
+
+template <size_t N>
+constexpr token_list<N> make_tokens(const char *pattern, bool valid) {
+    token_list<N> result{};
+    if (valid)
+        tokenize(pattern, result.items);
+    return result;
+}
+
+constexpr const char *month_abbreviations =
+    "JanFebMarAprMayJunJulAugSepOctNovDec";
+// From Monday.
+constexpr const char *weekday_abbreviations = "MonTueWedThuFriSatSun";
+
+/* The fields of a date-time, with zeros for the absent day of year and
+   day of the week, and -1 for the absent last two digits of the year. */
+struct fields {
+    int64_t year;
+    int year_of_century;
+    int month;
+    int day;
+    int day_of_year;
+    int weekday;
+    int hour;
+    int minute;
+    int second;
+    int32_t nanosecond;
+    int32_t offset_sec;
+};
+
+constexpr uint32_t power_of_ten(int exponent) {
+    uint32_t result = 1;
+    for (int i = 0; i < exponent; ++i)
+        result *= 10;
+    return result;
+}
+
+template <int Width>
+constexpr void write_digits(char *out, uint32_t value) {
+    for (int i = Width - 1; i >= 0; --i) {
+        out[i] = (char)('0' + value % 10);
+        value /= 10;
+    }
+}
+
+template <int Width>
+constexpr bool read_digits(const char *in, int32_t& value) {
+    value = 0;
+    for (int i = 0; i < Width; ++i) {
+        const unsigned digit = (unsigned)(in[i] - '0');
+        if (digit > 9)
+            return false;
+        value = value * 10 + (int32_t)digit;
+    }
+    return true;
+}
+
+// Finds the three letters at `in` among `count` names, ignoring the case.
+constexpr int read_name(const char *in, const char *names, int count) {
+    for (int i = 0; i < count; ++i) {
+        const char *name = names + i * 3;
+        if ((in[0] | 0x20) == (name[0] | 0x20) &&
+            (in[1] | 0x20) == (name[1] | 0x20) &&
+            (in[2] | 0x20) == (name[2] | 0x20))
+            return i + 1;
+    }
+    return 0;
+}
+
+template <kind Field, int Width, char Literal>
+constexpr void write(const fields& f, char *out) {
+    if constexpr (Field == LITERAL) {
+        out[0] = Literal;
+    } else if constexpr (Field == YEAR) {
+        write_digits<4>(out, (uint32_t)f.year);
+    } else if constexpr (Field == YEAR_OF_CENTURY) {
+        write_digits<2>(out, (uint32_t)(f.year % 100));
+    } else if constexpr (Field == MONTH) {
+        write_digits<2>(out, f.month);
+    } else if constexpr (Field == DAY) {
+        write_digits<2>(out, f.day);
+    } else if constexpr (Field == DAY_OF_YEAR) {
+        write_digits<3>(out, f.day_of_year);
+    } else if constexpr (Field == HOUR) {
+        write_digits<2>(out, f.hour);
+    } else if constexpr (Field == MINUTE) {
+        write_digits<2>(out, f.minute);
+    } else if constexpr (Field == SECOND) {
+        write_digits<2>(out, f.second);
+    } else if constexpr (Field == FRACTION) {
+        write_digits<Width>(out, f.nanosecond / power_of_ten(9 - Width));
+    } else if constexpr (Field == OFFSET || Field == OFFSET_WITH_COLON) {
+        const uint32_t absolute =
+            f.offset_sec < 0 ? -f.offset_sec : f.offset_sec;
+        out[0] = f.offset_sec < 0 ? '-' : '+';
+        write_digits<2>(out + 1, absolute / 3600);
+        if constexpr (Field == OFFSET_WITH_COLON)
+            out[3] = ':';
+        write_digits<2>(out + Width - 2, absolute / 60 % 60);
+    } else if constexpr (Field == MONTH_ABBREVIATION) {
+        for (int i = 0; i < 3; ++i)
+            out[i] = month_abbreviations[(f.month - 1) * 3 + i];
+    } else if constexpr (Field == WEEKDAY_ABBREVIATION) {
+        for (int i = 0; i < 3; ++i)
+            out[i] = weekday_abbreviations[(f.weekday - 1) * 3 + i];
+    } else if constexpr (Field == ISO_WEEKDAY) {
+        out[0] = (char)('0' + f.weekday);
+    }
+}
+
+template <kind Field, int Width, char Literal>
+constexpr bool read(fields& f, const char *in) {
+    int32_t value = 0;
+    if constexpr (Field == LITERAL) {
+        return in[0] == Literal;
+    } else if constexpr (Field == YEAR) {
+        if (!read_digits<4>(in, value))
+            return false;
+        f.year = value;
+    } else if constexpr (Field == YEAR_OF_CENTURY) {
+        return read_digits<2>(in, f.year_of_century);
+    } else if constexpr (Field == MONTH) {
+        return read_digits<2>(in, f.month);
+    } else if constexpr (Field == DAY) {
+        return read_digits<2>(in, f.day);
+    } else if constexpr (Field == DAY_OF_YEAR) {
+        return read_digits<3>(in, f.day_of_year) && f.day_of_year != 0;
+    } else if constexpr (Field == HOUR) {
+        return read_digits<2>(in, f.hour) && f.hour <= 23;
+    } else if constexpr (Field == MINUTE) {
+        return read_digits<2>(in, f.minute) && f.minute <= 59;
+    } else if constexpr (Field == SECOND) {
+        return read_digits<2>(in, f.second) && f.second <= 59;
+    } else if constexpr (Field == FRACTION) {
+        if (!read_digits<Width>(in, value))
+            return false;
+        f.nanosecond = value * (int32_t)power_of_ten(9 - Width);
+    } else if constexpr (Field == OFFSET || Field == OFFSET_WITH_COLON) {
+        int32_t hours = 0, minutes = 0;
+        if ((in[0] != '+' && in[0] != '-') ||
+            !read_digits<2>(in + 1, hours) ||
+            (Field == OFFSET_WITH_COLON && in[3] != ':') ||
+            !read_digits<2>(in + Width - 2, minutes) ||
+            minutes > 59 || hours * 60 + minutes > 18 * 60)
+            return false;
+        f.offset_sec = (hours * 3600 + minutes * 60) * (in[0] == '-' ? -1 : 1);
+    } else if constexpr (Field == MONTH_ABBREVIATION) {
+        f.month = read_name(in, month_abbreviations, 12);
+        return f.month != 0;
+    } else if constexpr (Field == WEEKDAY_ABBREVIATION) {
+        value = read_name(in, weekday_abbreviations, 7);
+        if (value == 0 || (f.weekday != 0 && f.weekday != value))
+            return false;
+        f.weekday = value;
+    } else if constexpr (Field == ISO_WEEKDAY) {
+        value = in[0] - '0';
+        if (value < 1 || value > 7 || (f.weekday != 0 && f.weekday != value))
+            return false;
+        f.weekday = value;
+    }
+    return true;
+}
+
+}
+
+/* The pattern, a string with static storage duration, like a `static
+   constexpr char[]`. Everything here is `constexpr`, so it can also be used
+   at compile time. */
+template <const char *Pattern>
+class pattern {
+    static constexpr int count = detail::tokenize(Pattern, nullptr);
+    static_assert(count >= 0, "unsupported conversion in the pattern");
+    static constexpr size_t token_count = count > 0 ? count : 0;
+    // An array can't be empty, so there is always at least one token.
+    static constexpr size_t capacity = count > 0 ? count : 1;
+    static constexpr detail::token_list<capacity> tokens =
+        detail::make_tokens<capacity>(Pattern, count >= 0);
+
+    static constexpr bool has(detail::kind field) {
+        for (size_t i = 0; i < token_count; ++i) {
+            if (tokens.items[i].field == field)
+                return true;
+        }
+        return false;
+    }
+
+    template <size_t... I>
+    static constexpr void write_all(const detail::fields& f, char *out,
+        detail::indices<I...>)
+    {
+        (detail::write<tokens.items[I].field, tokens.items[I].width,
+            tokens.items[I].literal>(f, out + tokens.items[I].position), ...);
+    }
+
+    template <size_t... I>
+    static constexpr bool read_all(detail::fields& f, const char *in,
+        detail::indices<I...>)
+    {
+        return (detail::read<tokens.items[I].field, tokens.items[I].width,
+            tokens.items[I].literal>(f, in + tokens.items[I].position) && ...);
+    }
+
+public:
+    // The number of the characters in every formatted date-time.
+    static constexpr size_t length = token_count == 0 ? 0 :
+        tokens.items[token_count - 1].position +
+        tokens.items[token_count - 1].width;
+
+    /* Writes the date-time at the instant `epoch_sec` seconds and
+       `nanosecond` nanoseconds after 1970-01-01T00:00Z, observed with the
+       given offset. Returns `length`, or 0 if the year is outside
+       [0; 9999]. */
+    static constexpr size_t format(int64_t epoch_sec, int32_t nanosecond,
+        int32_t offset_sec, char *out)
+    {
+        const int64_t local_sec = epoch_sec + offset_sec;
+        const int64_t epoch_day = civil::floor_div(local_sec, SECS_PER_DAY);
+        const int second_of_day = (int)(local_sec - epoch_day * SECS_PER_DAY);
+        detail::fields f{};
+        civil::civil_from_days(epoch_day, f.year, f.month, f.day);
+        if (f.year < 0 || f.year > 9999)
+            return 0;
+        if constexpr (has(detail::DAY_OF_YEAR)) {
+            f.day_of_year =
+                (int)(epoch_day - civil::days_from_civil(f.year, 1, 1)) + 1;
+        }
+        f.weekday = civil::iso_day_of_week(epoch_day);
+        f.hour = second_of_day / 3600;
+        f.minute = second_of_day / 60 % 60;
+        f.second = second_of_day % 60;
+        f.nanosecond = nanosecond;
+        f.offset_sec = offset_sec;
+        write_all(f, out,
+            typename detail::make_indices<token_count>::type());
+        return length;
+    }
+
+    /* Parses the date-time occupying the whole range [begin; end). The
+       missing fields are taken from 1970-01-01T00:00. A day of the year
+       and a day of the week, if any, are checked against the date. */
+    static constexpr bool parse(const char *begin, const char *end,
+        parsed& result)
+    {
+        if (end - begin != (ptrdiff_t)length)
+            return false;
+        detail::fields f{1970, -1, 1, 1, 0, 0, 0, 0, 0, 0, INT_MAX};
+        if (!read_all(f, begin,
+            typename detail::make_indices<token_count>::type()))
+            return false;
+        if constexpr (has(detail::YEAR_OF_CENTURY)) {
+            if constexpr (has(detail::YEAR)) {
+                if (f.year % 100 != f.year_of_century)
+                    return false;
+            } else {
+                f.year = f.year_of_century < 69 ?
+                    2000 + f.year_of_century : 1900 + f.year_of_century;
+            }
+        }
+        int64_t epoch_day = 0;
+        if (f.day_of_year != 0) {
+            if (f.day_of_year > 365 + civil::is_leap_year(f.year))
+                return false;
+            epoch_day =
+                civil::days_from_civil(f.year, 1, 1) + f.day_of_year - 1;
+            if constexpr (has(detail::MONTH) || has(detail::DAY) ||
+                has(detail::MONTH_ABBREVIATION))
+            {
+                int64_t year = 0;
+                int month = 0, day = 0;
+                civil::civil_from_days(epoch_day, year, month, day);
+                const bool has_month = has(detail::MONTH) ||
+                    has(detail::MONTH_ABBREVIATION);
+                if ((has(detail::DAY) && day != f.day) ||
+                    (has_month && month != f.month))
+                    return false;
+            }
+        } else {
+            if (f.month < 1 || f.month > 12 || f.day < 1 ||
+                f.day > civil::days_in_month(f.year, f.month))
+                return false;
+            epoch_day = civil::days_from_civil(f.year, f.month, f.day);
+        }
+        if (f.weekday != 0 && civil::iso_day_of_week(epoch_day) != f.weekday)
+            return false;
+        result.local_sec = epoch_day * SECS_PER_DAY + f.hour * 3600 +
+            f.minute * 60 + f.second;
+        result.nanosecond = f.nanosecond;
+        result.offset_sec = f.offset_sec;
+        return true;
+    }
+};
+
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file contains the lookups in the tables of names that are generated
+   with a minimal perfect hash, like the ones of `windows_zones.hpp`. The
+   tables are `constexpr`, so they need no initialization when the program
+   starts, and a lookup computes two hashes of the name, compares it with a
+   single entry and allocates nothing.
+
+   The names are sorted, and their indices are used as their IDs. They are
+   distributed into buckets by `hash(name, 0)`, and the names of each bucket
+   are placed into the slots of the hash by `hash(name, displacement)`, with
+   a displacement that the generator has chosen for the bucket so that no
+   two names share a slot. A bucket with a single name may instead have the
+   slot itself, as a negative displacement: `-1 - slot`. The generator, the
+   gradle task `downloadWindowsZonesMapping`, computes the same hash.
+
+   The tables are also used by the sources built by cinterop, where
+   `defines.hpp` makes the standard library think it's C++11, so the names
+   are not `std::string_view`, but `key`. */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace perfect_hash {
+
+constexpr size_t not_found = SIZE_MAX;
+
+// A name in a table: a string literal, so `data()` is null-terminated.
+class key {
+public:
+    template <size_t N>
+    constexpr key(const char (&literal)[N]) noexcept:
+        data_(literal), size_(N - 1) {}
+
+    constexpr const char *data() const noexcept { return data_; }
+    constexpr size_t size() const noexcept { return size_; }
+
+private:
+    const char *data_;
+    size_t size_;
+};
+
+// FNV-1a with a seed, followed by the finalizer of MurmurHash3.
+constexpr uint32_t hash(const char *name, size_t size, uint32_t seed) {
+    uint32_t result = 2166136261u ^ seed;
+    for (size_t i = 0; i < size; ++i)
+        result = (result ^ (unsigned char)name[i]) * 16777619u;
+    result ^= result >> 16;
+    result *= 0x85ebca6bu;
+    result ^= result >> 13;
+    result *= 0xc2b2ae35u;
+    result ^= result >> 16;
+    return result;
+}
+
+constexpr bool equal(key a, const char *b, size_t b_size) {
+    if (a.size() != b_size)
+        return false;
+    for (size_t i = 0; i < b_size; ++i) {
+        if (a.data()[i] != b[i])
+            return false;
+    }
+    return true;
+}
+
+// Like `strcmp(a, b) < 0`.
+constexpr bool less(key a, key b) {
+    for (size_t i = 0; i < a.size() && i < b.size(); ++i) {
+        if (a.data()[i] != b.data()[i])
+            return (unsigned char)a.data()[i] < (unsigned char)b.data()[i];
+    }
+    return a.size() < b.size();
+}
+
+constexpr size_t length(const char *name) {
+    size_t result = 0;
+    while (name[result] != '\0')
+        ++result;
+    return result;
+}
+
+template <size_t NAMES, size_t BUCKETS>
+struct table {
+    // Sorted.
+    key names[NAMES];
+    // The index in `names` of the name in each slot.
+    uint16_t indices[NAMES];
+    int32_t displacements[BUCKETS];
+
+    static constexpr size_t size() { return NAMES; }
+
+    // Returns the index of the name, or `not_found`.
+    constexpr size_t find(const char *name, size_t size) const {
+        const int32_t displacement =
+            displacements[hash(name, size, 0) % BUCKETS];
+        const size_t slot = displacement < 0 ? (size_t)(-1 - displacement) :
+            hash(name, size, (uint32_t)displacement) % NAMES;
+        const size_t index = indices[slot];
+        return equal(names[index], name, size) ? index : not_found;
+    }
+
+    constexpr size_t find(const char *name) const {
+        return find(name, length(name));
+    }
+
+    // For `static_assert`: whether the tables are consistent.
+    constexpr bool is_valid() const {
+        for (size_t i = 0; i < NAMES; ++i) {
+            if (find(names[i].data(), names[i].size()) != i ||
+                (i != 0 && !less(names[i - 1], names[i])))
+                return false;
+        }
+        return true;
+    }
+};
+
+}
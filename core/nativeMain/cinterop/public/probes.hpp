@@ -0,0 +1,106 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file contains the static tracepoints of the native code: USDT probes
+   of the provider `kotlinx_datetime`, which `perf` and `bpftrace` can attach
+   to without rebuilding or restarting the program, for example:
+
+       bpftrace -e 'usdt:./program:kotlinx_datetime:function__return
+           { @[str(arg0)] = count(); }'
+
+   They are compiled in on Linux when `<sys/sdt.h>` from SystemTap is
+   available, unless `DATETIME_USDT` is defined as 0, and are a single `nop`
+   each while nothing is attached to them; otherwise, they compile to
+   nothing. The probes are:
+
+   * `function__entry(function, zone, argument)` and
+     `function__return(function, zone, argument, result)` for every call of
+     a function from `cdate.h`, where `function` is its name, `zone` is the
+     TZID or TZID_INVALID, `argument` is the instant, the local date-time or
+     the number of the values that it gets, or 0, and `result` is the value
+     that it returns, with the pointers as addresses and `void` as 0;
+   * `tzdb__load__start(reload)` and `tzdb__load__done(reload, zones)`
+     around the loading of the time zone database, where `reload` is 0 for
+     the first one;
+   * `zone__init(zone, name)` when a time zone of the `date` library or
+     <chrono> is used for the first time, and they read its rules; the other
+     backends read all of them while loading the database;
+   * `cache__miss(zone, seconds)` when a cursor from `time_zone.hpp` looks
+     up an offset in the platform implementation, for an instant or a local
+     date-time. */
+#pragma once
+#include <cstdint>
+
+#if !defined(DATETIME_USDT) && defined(__linux__) && defined(__has_include)
+    #if __has_include(<sys/sdt.h>)
+        #define DATETIME_USDT 1
+    #endif
+#endif
+
+#if defined(DATETIME_USDT) && DATETIME_USDT
+    #include <sys/sdt.h>
+    #define DATETIME_PROBES 1
+    #define DATETIME_PROBE1(name, a) DTRACE_PROBE1(kotlinx_datetime, name, a)
+    #define DATETIME_PROBE2(name, a, b) \
+        DTRACE_PROBE2(kotlinx_datetime, name, a, b)
+    #define DATETIME_PROBE3(name, a, b, c) \
+        DTRACE_PROBE3(kotlinx_datetime, name, a, b, c)
+    #define DATETIME_PROBE4(name, a, b, c, d) \
+        DTRACE_PROBE4(kotlinx_datetime, name, a, b, c, d)
+#else
+    #define DATETIME_PROBES 0
+    #define DATETIME_PROBE1(name, a) ((void)0)
+    #define DATETIME_PROBE2(name, a, b) ((void)0)
+    #define DATETIME_PROBE3(name, a, b, c) ((void)0)
+    #define DATETIME_PROBE4(name, a, b, c, d) ((void)0)
+#endif
+
+namespace probes {
+
+// TZID_INVALID, for the functions that have no time zone.
+constexpr uint64_t no_zone = SIZE_MAX;
+
+/* Fires `function__entry` when it is created at the start of a function,
+   and `function__return` when it is destroyed, with the result that is
+   passed through `returns`:
+
+       int f(TZID zone, int64_t epoch_sec)
+       {
+           probes::call probe(__func__, zone, epoch_sec);
+           ...
+           return probe.returns(result);
+       } */
+struct call {
+    const char *function;
+    uint64_t zone;
+    int64_t argument;
+    int64_t result = 0;
+
+    call(const char *function, uint64_t zone, int64_t argument) noexcept:
+        function(function), zone(zone), argument(argument)
+    {
+        DATETIME_PROBE3(function__entry, function, zone, argument);
+    }
+
+    call(const call&) = delete;
+    call& operator=(const call&) = delete;
+
+    ~call() {
+        DATETIME_PROBE4(function__return, function, zone, argument, result);
+    }
+
+    template <typename T>
+    T returns(T value) noexcept {
+        result = (int64_t)value;
+        return value;
+    }
+
+    template <typename T>
+    T *returns(T *value) noexcept {
+        result = (int64_t)(intptr_t)value;
+        return value;
+    }
+};
+
+}
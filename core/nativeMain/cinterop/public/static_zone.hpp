@@ -0,0 +1,164 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file contains a template for the time zones whose rules are compiled
+   into the program, for the deployments that only ever need one or two of
+   them. The rules come from a header generated by the gradle task
+   `generateStaticZones` for each of the zones:
+
+       ./gradlew generateStaticZones -PstaticZones=Europe/Berlin
+
+       #include "static_zones.hpp"
+       using berlin = zones::static_zone<zones::data::europe_berlin>;
+       const int offset = berlin::offset_at(epoch_sec);
+
+   All the functions are `constexpr` and inline: there is no TZID to look
+   up, no time zone database to load and no state shared between threads.
+   The results are those of `java.time.ZoneRules` of the JVM that ran
+   gradle, so, unlike the `zone` from `time_zone.hpp`, they don't change
+   when the time zone database of the system is updated; the tool
+   `static_zone_check.cpp` compares them with the ones of `cdate.h`.
+
+   Requires C++17. A generated header contains a struct with
+
+       static constexpr const char name[];
+       // The instants where the offset changes, sorted.
+       static constexpr std::array<int64_t, N> transitions;
+       // The offset before each transition, and then after the last one.
+       static constexpr std::array<int, N + 1> offsets;
+       // The rules for the transitions after the last one.
+       static constexpr std::array<zones::transition_rule, M> rules; */
+#pragma once
+#include <array>
+#include <climits>
+#include <cstdint>
+#include "civil.hpp"
+#include "time_zone.hpp"
+
+namespace zones {
+
+/* The rule of a yearly transition, like `java.time.ZoneOffsetTransitionRule`:
+   the transition happens on the day of the month, or, if `day_of_week` isn't
+   0, on the first such day of the week on or after it; a negative day of
+   the month counts from the end of the month, with -1 for the last day, and
+   the day of the week is then searched on or before it. */
+struct transition_rule {
+    int month;
+    int day_of_month;
+    // From 1 for Monday, or 0.
+    int day_of_week;
+    // Can be 86400 for the midnight at the end of the day.
+    int second_of_day;
+    /* The offset of the time of day from UTC: 0, the standard offset or the
+       offset before the transition. */
+    int time_offset_sec;
+    int offset_before_sec;
+    int offset_after_sec;
+
+    constexpr int64_t instant_in(int64_t year) const {
+        int64_t day = 0;
+        if (day_of_month < 0) {
+            day = civil::days_from_civil(year, month,
+                civil::days_in_month(year, month) + 1 + day_of_month);
+            if (day_of_week != 0)
+                day -= (civil::iso_day_of_week(day) - day_of_week + 7) % 7;
+        } else {
+            day = civil::days_from_civil(year, month, day_of_month);
+            if (day_of_week != 0)
+                day += (day_of_week - civil::iso_day_of_week(day) + 7) % 7;
+        }
+        return day * SECS_PER_DAY + second_of_day - time_offset_sec;
+    }
+};
+
+template <typename Data>
+class static_zone {
+public:
+    static constexpr const char *name() noexcept { return Data::name; }
+
+    static constexpr int offset_at(int64_t epoch_sec) noexcept {
+        int64_t begin = 0, end = 0;
+        return offset_at(epoch_sec, begin, end);
+    }
+
+    /* Returns the offset, also setting [begin; end) to a range of instants
+       that contains `epoch_sec` and where the offset stays the same. */
+    static constexpr int offset_at(int64_t epoch_sec, int64_t& begin,
+        int64_t& end) noexcept
+    {
+        constexpr auto& transitions = Data::transitions;
+        constexpr size_t count = transitions.size();
+        if (count == 0 || epoch_sec < transitions[count - 1]) {
+            // The first transition after the instant.
+            size_t low = 0, high = count;
+            while (low < high) {
+                const size_t middle = low + (high - low) / 2;
+                if (transitions[middle] <= epoch_sec)
+                    low = middle + 1;
+                else
+                    high = middle;
+            }
+            begin = low == 0 ? INT64_MIN : transitions[low - 1];
+            end = low == count ? INT64_MAX : transitions[low];
+            return Data::offsets[low];
+        }
+        /* After the last transition, the rules are applied to the local year
+           of the instant and to the neighboring ones, which is enough to
+           find the transitions on both sides of it. */
+        begin = transitions[count - 1];
+        end = INT64_MAX;
+        int offset = Data::offsets[count];
+        int64_t year = 0;
+        int month = 0, day = 0;
+        civil::civil_from_days(civil::floor_div(epoch_sec + offset,
+            SECS_PER_DAY), year, month, day);
+        for (int64_t y = year - 1; y <= year + 1; ++y) {
+            for (const transition_rule& rule : Data::rules) {
+                const int64_t instant = rule.instant_in(y);
+                if (instant <= begin)
+                    continue;
+                if (instant <= epoch_sec) {
+                    begin = instant;
+                    offset = rule.offset_after_sec;
+                } else if (instant < end) {
+                    end = instant;
+                }
+            }
+        }
+        return offset;
+    }
+
+    // The local date-time at the instant, in seconds since 1970-01-01T00:00.
+    static constexpr int64_t to_local(int64_t epoch_sec) noexcept {
+        return epoch_sec + offset_at(epoch_sec);
+    }
+
+    /* Like `zone::resolve` from `time_zone.hpp`: the local date-times in a
+       time gap are moved forward by the length of the gap, and the ones that
+       happen twice get the earlier offset. */
+    static constexpr resolved resolve(int64_t local_sec) noexcept {
+        /* No instant before this one has the local date-time, so the ranges
+           of the offsets from here on are checked in order, and the first
+           one whose local date-times reach `local_sec` is the answer. */
+        int64_t begin = 0, end = 0;
+        int offset = offset_at(local_sec - max_offset_sec, begin, end);
+        int previous = offset;
+        while (end != INT64_MAX && local_sec >= end + offset) {
+            previous = offset;
+            offset = offset_at(end, begin, end);
+        }
+        if (offset != previous && local_sec < begin + offset) {
+            const int gap = offset - previous;
+            return resolved{local_sec + gap - offset, offset, gap};
+        }
+        return resolved{local_sec - offset, offset, 0};
+    }
+
+    // Like `resolve`, but only returns the instant.
+    static constexpr int64_t to_instant(int64_t local_sec) noexcept {
+        return resolve(local_sec).epoch_sec;
+    }
+};
+
+}
@@ -0,0 +1,244 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* This file contains a C++ interface to the time zones from `cdate.h`, for
+   the C++ code that converts many timestamps:
+
+       zones::cursor cursor(zones::zone::region(id));
+       for (...) {
+           int64_t local_sec;
+           if (cursor.to_local(epoch_sec, local_sec))
+               ...
+       }
+
+   A `zone` is a value that is either a fixed offset, which needs no time
+   zone database at all, or a region from `cdate.h`. A `cursor` remembers
+   the range of instants where the offset it has last looked up applies, as
+   well as the range of local date-times that happen exactly once with that
+   offset, and only calls into the platform implementation when a timestamp
+   falls outside of them. The checks against these ranges are inline, so the
+   usual case of the neighboring timestamps sharing an offset costs a couple
+   of comparisons.
+
+   The instants and local date-times near the ends of the range of
+   `int64_t` are saturated when the offsets are applied to them.
+
+   Nothing here throws. A lookup that fails because of a problem with the
+   time zone returns `false` or, for the offsets, INT_MAX, like in `cdate.h`.
+   It is included into the sources built by cinterop, where `defines.hpp`
+   makes the standard library think it's C++11, so it only uses that. */
+#pragma once
+#include <climits>
+#include <cstdint>
+#include "civil.hpp"
+#include "probes.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+namespace zones {
+
+/* No offset exceeds this, so the local date-times of the instants before
+   some moment are all earlier than that moment plus this. */
+constexpr int max_offset_sec = 18 * 3600;
+
+// A local date-time resolved to an instant.
+struct resolved {
+    int64_t epoch_sec;
+    int offset_sec;
+    /* The number of seconds by which the local date-time was moved forward
+       because it fell into a time gap, or 0. */
+    int gap_sec;
+};
+
+class zone {
+public:
+    // The UTC.
+    constexpr zone() noexcept: id_(TZID_INVALID), offset_(0) {}
+
+    static constexpr zone fixed(int offset_sec) noexcept {
+        return zone(TZID_INVALID, offset_sec);
+    }
+
+    /* A region from `cdate.h`. The lookups in TZID_INVALID fail, like those
+       of the functions from `cdate.h`. */
+    static constexpr zone region(TZID id) noexcept {
+        return zone(id, INT_MAX);
+    }
+
+    // TZID_INVALID if the name is unknown.
+    static zone by_name(const char *name) noexcept {
+        return region(timezone_by_name(name));
+    }
+
+    constexpr bool is_fixed() const noexcept { return offset_ != INT_MAX; }
+
+    // Whether the lookups can succeed: false for the region TZID_INVALID.
+    constexpr bool is_valid() const noexcept {
+        return is_fixed() || id_ != TZID_INVALID;
+    }
+
+    // TZID_INVALID for the fixed offsets.
+    constexpr TZID id() const noexcept { return id_; }
+
+    int offset_at(int64_t epoch_sec) const noexcept {
+        if (is_fixed())
+            return offset_;
+        return offset_at_instant(id_, epoch_sec);
+    }
+
+    /* Returns the offset, also setting [begin; end) to a range of instants
+       that contains `epoch_sec` and where the offset stays the same, like
+       `offset_interval_at_instant` does. */
+    int offset_at(int64_t epoch_sec, int64_t& begin, int64_t& end) const
+        noexcept
+    {
+        if (is_fixed()) {
+            begin = INT64_MIN;
+            end = INT64_MAX;
+            return offset_;
+        }
+        return offset_interval_at_instant(id_, epoch_sec, &begin, &end);
+    }
+
+    /* The local date-times in a time gap are moved forward by the length of
+       the gap, and the ones that happen twice get the earlier offset, like
+       in `offset_at_datetime`. */
+    bool resolve(int64_t local_sec, resolved& result) const noexcept {
+        if (is_fixed()) {
+            result = resolved{civil::saturating_add(local_sec, -offset_),
+                offset_, 0};
+            return true;
+        }
+        int offset = INT_MAX;
+        const int gap = offset_at_datetime(id_, local_sec, &offset);
+        if (offset == INT_MAX)
+            return false;
+        result = resolved{civil::saturating_add(local_sec, gap - offset),
+            offset, gap};
+        return true;
+    }
+
+    constexpr bool operator==(const zone& other) const noexcept {
+        return id_ == other.id_ && offset_ == other.offset_;
+    }
+
+    constexpr bool operator!=(const zone& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    constexpr zone(TZID id, int offset) noexcept: id_(id), offset_(offset) {}
+
+    TZID id_;
+    // INT_MAX for the regions.
+    int offset_;
+};
+
+/* Converts the timestamps of a time zone, reusing the offsets between the
+   neighboring ones, so sorted input is processed the fastest. Not
+   thread-safe: each thread needs its own cursor. */
+class cursor {
+public:
+    explicit cursor(zones::zone z) noexcept: zone_(z) {
+        if (z.is_fixed()) {
+            const int offset = z.offset_at(0);
+            begin_ = safe_begin_ = INT64_MIN;
+            end_ = safe_end_ = INT64_MAX;
+            offset_ = safe_offset_ = offset;
+        }
+    }
+
+    const zones::zone& zone() const noexcept { return zone_; }
+
+    // INT_MAX if the lookup fails.
+    int offset_at(int64_t epoch_sec) noexcept {
+        if (epoch_sec >= begin_ && epoch_sec < end_)
+            return offset_;
+        return lookup(epoch_sec);
+    }
+
+    /* Sets `local_sec` to the local date-time at the instant, in seconds
+       since 1970-01-01T00:00. */
+    bool to_local(int64_t epoch_sec, int64_t& local_sec) noexcept {
+        if (epoch_sec >= begin_ && epoch_sec < end_) {
+            local_sec = civil::saturating_add(epoch_sec, offset_);
+            return true;
+        }
+        const int offset = lookup(epoch_sec);
+        if (offset == INT_MAX)
+            return false;
+        local_sec = civil::saturating_add(epoch_sec, offset);
+        return true;
+    }
+
+    // Like `zone::resolve`.
+    bool resolve(int64_t local_sec, resolved& result) noexcept {
+        if (local_sec >= safe_begin_ && local_sec < safe_end_) {
+            result = resolved{civil::saturating_add(local_sec, -safe_offset_),
+                safe_offset_, 0};
+            return true;
+        }
+        return resolve_outside(local_sec, result);
+    }
+
+    // Like `resolve`, but only sets the instant.
+    bool to_instant(int64_t local_sec, int64_t& epoch_sec) noexcept {
+        if (local_sec >= safe_begin_ && local_sec < safe_end_) {
+            epoch_sec = civil::saturating_add(local_sec, -safe_offset_);
+            return true;
+        }
+        resolved result;
+        if (!resolve_outside(local_sec, result))
+            return false;
+        epoch_sec = result.epoch_sec;
+        return true;
+    }
+
+private:
+    int lookup(int64_t epoch_sec) noexcept {
+        DATETIME_PROBE2(cache__miss, zone_.id(), epoch_sec);
+        const int offset = zone_.offset_at(epoch_sec, begin_, end_);
+        if (offset != INT_MAX)
+            offset_ = offset;
+        else
+            begin_ = end_ = 0; // don't reuse the failed lookup.
+        return offset;
+    }
+
+    bool resolve_outside(int64_t local_sec, resolved& result) noexcept {
+        DATETIME_PROBE2(cache__miss, zone_.id(), local_sec);
+        if (!zone_.resolve(local_sec, result))
+            return false;
+        if (result.gap_sec != 0)
+            return true;
+        /* The local date-times of the instants where this offset applies
+           happen exactly once, with this offset, unless they are early
+           enough for some earlier instant to have the same local
+           date-time; those that happen twice get the earlier offset anyway,
+           so the end doesn't need such a margin. */
+        int64_t begin, end;
+        if (zone_.offset_at(result.epoch_sec, begin, end) != result.offset_sec)
+            return true;
+        safe_begin_ = begin == INT64_MIN ? INT64_MIN :
+            civil::saturating_add(begin, max_offset_sec);
+        safe_end_ = end == INT64_MAX ? INT64_MAX :
+            civil::saturating_add(end, result.offset_sec);
+        safe_offset_ = result.offset_sec;
+        return true;
+    }
+
+    zones::zone zone_;
+    // The offset at the instants in [begin_; end_).
+    int64_t begin_ = 0;
+    int64_t end_ = 0;
+    int offset_ = 0;
+    /* The local date-times in [safe_begin_; safe_end_) happen exactly once,
+       with the offset `safe_offset_`. */
+    int64_t safe_begin_ = 0;
+    int64_t safe_end_ = 0;
+    int safe_offset_ = 0;
+};
+
+}
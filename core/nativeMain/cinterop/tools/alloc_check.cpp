@@ -0,0 +1,347 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that checks that the hot paths of `cdate.h` allocate
+   no memory once they are warmed up, so that a regression, like a string in
+   the `sys_info` or `local_info` of the `date` library that stops fitting
+   into the small string buffer, fails the build. It is built with the
+   gradle task `buildAllocCheck` and run by `checkNativeAllocations`:
+
+       alloc_check [-n calls] [zone...]
+
+   The tool replaces `operator new` and, with glibc, `malloc` and the
+   functions related to it, counting the allocations made through them; on
+   other platforms, the allocations made by the C library itself, like in
+   `strdup`, are not counted. For each of the zones, which by default are a
+   few with different kinds of rules, every hot path is called `calls` times
+   at random instants from 1900 to 2100, once to warm it up and then once
+   more while counting: `offset_at_instant`, `offset_interval_at_instant`,
+   `offset_at_datetime`, `at_start_of_day`, `timezone_by_name`, the batch
+   functions from `batch.cpp` and the cursors from `time_zone.hpp`. Any
+   allocation there is an error. The allocations of the functions that are
+   not expected to be fast, like `available_zone_ids`, are only reported, per
+   call. The exit code is 1 if a hot path allocates or a zone is unknown.
+
+   The `date` library must be configured as in the cinterop build, where
+   `defines.hpp` makes it see C++11: the gradle task does that with its
+   macros, like `HAS_STRING_VIEW=0`. */
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include <getopt.h>
+#include "civil.hpp"
+#include "time_zone.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+static std::atomic<long> allocations{0};
+
+#if defined(__GLIBC__)
+/* glibc allows replacing `malloc` in the program; the replacements forward
+   to its own implementation. */
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *pointer);
+
+void *malloc(size_t size) {
+    ++allocations;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    ++allocations;
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) {
+    ++allocations;
+    return __libc_realloc(pointer, size);
+}
+
+void *memalign(size_t alignment, size_t size) {
+    ++allocations;
+    return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    ++allocations;
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **pointer, size_t alignment, size_t size) {
+    ++allocations;
+    *pointer = __libc_memalign(alignment, size);
+    return *pointer == nullptr ? ENOMEM : 0;
+}
+
+void free(void *pointer) {
+    __libc_free(pointer);
+}
+}
+
+static void *allocate(size_t size, size_t alignment) {
+    return __libc_memalign(alignment, size == 0 ? 1 : size);
+}
+
+static void deallocate(void *pointer) {
+    __libc_free(pointer);
+}
+#else
+static void *allocate(size_t size, size_t alignment) {
+    void *result = nullptr;
+    if (alignment <= alignof(std::max_align_t))
+        return malloc(size == 0 ? 1 : size);
+    return posix_memalign(&result, alignment, size == 0 ? 1 : size) == 0 ?
+        result : nullptr;
+}
+
+static void deallocate(void *pointer) {
+    free(pointer);
+}
+#endif
+
+/* `operator new` counts the allocations itself, as `malloc` isn't replaced
+   everywhere. */
+static void *counted_new(size_t size, size_t alignment) {
+    ++allocations;
+    return allocate(size, alignment);
+}
+
+static void *throwing_new(size_t size, size_t alignment) {
+    if (void *result = counted_new(size, alignment))
+        return result;
+    throw std::bad_alloc();
+}
+
+static const size_t default_alignment = alignof(std::max_align_t);
+
+void *operator new(size_t size) {
+    return throwing_new(size, default_alignment);
+}
+
+void *operator new[](size_t size) {
+    return throwing_new(size, default_alignment);
+}
+
+void *operator new(size_t size, std::align_val_t alignment) {
+    return throwing_new(size, (size_t)alignment);
+}
+
+void *operator new[](size_t size, std::align_val_t alignment) {
+    return throwing_new(size, (size_t)alignment);
+}
+
+void *operator new(size_t size, const std::nothrow_t&) noexcept {
+    return counted_new(size, default_alignment);
+}
+
+void *operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return counted_new(size, default_alignment);
+}
+
+void operator delete(void *pointer) noexcept { deallocate(pointer); }
+void operator delete[](void *pointer) noexcept { deallocate(pointer); }
+void operator delete(void *pointer, size_t) noexcept { deallocate(pointer); }
+void operator delete[](void *pointer, size_t) noexcept { deallocate(pointer); }
+
+void operator delete(void *pointer, std::align_val_t) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete(void *pointer, size_t, std::align_val_t) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete[](void *pointer, size_t, std::align_val_t) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t&) noexcept {
+    deallocate(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t&) noexcept {
+    deallocate(pointer);
+}
+
+// So that the calls are not optimized away.
+static volatile int64_t checksum = 0;
+
+static int failures = 0;
+
+template <typename CALLS>
+static long allocations_of(CALLS calls) {
+    const long before = allocations.load();
+    checksum = checksum + calls();
+    return allocations.load() - before;
+}
+
+// Fails if `calls` allocates anything after being called once.
+template <typename CALLS>
+static void expect_none(const char *function, const char *zone, CALLS calls) {
+    allocations_of(calls);
+    const long count = allocations_of(calls);
+    printf("%-28s %-24s %8ld allocations%s\n", function, zone, count,
+        count == 0 ? "" : ", expected none");
+    if (count != 0)
+        ++failures;
+}
+
+static void check_zone(const char *name, const std::vector<int64_t>& instants)
+{
+    const TZID zone = timezone_by_name(name);
+    if (zone == TZID_INVALID) {
+        fprintf(stderr, "%s: unknown to the library\n", name);
+        ++failures;
+        return;
+    }
+    const size_t count = instants.size();
+    std::vector<int> offsets(count);
+    std::vector<int64_t> results(count);
+    expect_none("offset_at_instant", name, [&] {
+        int64_t sum = 0;
+        for (int64_t instant : instants)
+            sum += offset_at_instant(zone, instant);
+        return sum;
+    });
+    expect_none("offset_interval_at_instant", name, [&] {
+        int64_t sum = 0;
+        for (int64_t instant : instants) {
+            int64_t begin = 0, end = 0;
+            sum += offset_interval_at_instant(zone, instant, &begin, &end);
+        }
+        return sum;
+    });
+    expect_none("offset_at_datetime", name, [&] {
+        int64_t sum = 0;
+        for (int64_t local : instants) {
+            int offset = INT_MAX;
+            sum += offset_at_datetime(zone, local, &offset) + offset;
+        }
+        return sum;
+    });
+    expect_none("at_start_of_day", name, [&] {
+        int64_t sum = 0;
+        for (int64_t local : instants) {
+            const int64_t midnight = civil::floor_div(local, 86400) * 86400;
+            sum += at_start_of_day(zone, midnight);
+        }
+        return sum;
+    });
+    expect_none("timezone_by_name", name, [&] {
+        int64_t sum = 0;
+        for (size_t i = 0; i < count / 16; ++i)
+            sum += timezone_by_name(name);
+        return sum;
+    });
+    expect_none("offsets_at_instants", name, [&] {
+        return (int64_t)offsets_at_instants(zone, TIME_UNIT_SECOND,
+            instants.data(), offsets.data(), count);
+    });
+    expect_none("instants_to_local_times", name, [&] {
+        return (int64_t)instants_to_local_times(zone, TIME_UNIT_NANOSECOND,
+            instants.data(), results.data(), count);
+    });
+    expect_none("local_times_to_instants", name, [&] {
+        return (int64_t)local_times_to_instants(zone, TIME_UNIT_SECOND,
+            instants.data(), results.data(), count);
+    });
+    expect_none("zones::cursor", name, [&] {
+        zones::cursor cursor(zones::zone::region(zone));
+        int64_t sum = 0;
+        for (int64_t instant : instants) {
+            int64_t local_sec = 0, epoch_sec = 0;
+            zones::resolved resolved{0, 0, 0};
+            cursor.to_local(instant, local_sec);
+            cursor.to_instant(instant, epoch_sec);
+            cursor.resolve(instant, resolved);
+            sum += cursor.offset_at(instant) + local_sec + epoch_sec +
+                resolved.gap_sec;
+        }
+        return sum;
+    });
+}
+
+// Only reports how much `calls` allocates per call.
+template <typename CALLS>
+static void report(const char *function, int calls_per_run, CALLS calls) {
+    allocations_of(calls);
+    const long count = allocations_of(calls);
+    printf("%-28s %-24s %8.1f allocations per call\n", function, "",
+        (double)count / calls_per_run);
+}
+
+static void report_others() {
+    report("available_zone_ids", 1, [] {
+        char **ids = available_zone_ids();
+        int64_t count = 0;
+        for (char **id = ids; id != nullptr && *id != nullptr; ++id) {
+            free(*id);
+            ++count;
+        }
+        free(ids);
+        return count;
+    });
+    report("get_system_timezone", 1, [] {
+        TZID id = TZID_INVALID;
+        char *name = get_system_timezone(&id);
+        free(name);
+        return (int64_t)id;
+    });
+}
+
+int main(int argc, char **argv) {
+    size_t calls = 100000;
+    int option;
+    while ((option = getopt(argc, argv, "n:")) != -1) {
+        switch (option) {
+            case 'n':
+                calls = (size_t)atol(optarg);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n calls] [zone...]\n", argv[0]);
+                return 2;
+        }
+    }
+    std::vector<std::string> zones(argv + optind, argv + argc);
+    if (zones.empty()) {
+        zones = {"UTC", "Europe/Berlin", "America/New_York",
+            "Australia/Lord_Howe", "Africa/Casablanca", "Asia/Kolkata"};
+    }
+    if (timezone_by_name("UTC") == TZID_INVALID) {
+        fprintf(stderr, "the time zone database is unavailable\n");
+        return 2;
+    }
+    std::mt19937_64 random(42);
+    std::uniform_int_distribution<int64_t> distribution(-2208988800,
+        4102444800);
+    std::vector<int64_t> instants(calls);
+    for (int64_t& instant : instants)
+        instant = distribution(random);
+    for (const std::string& zone : zones)
+        check_zone(zone.c_str(), instants);
+    report_others();
+    if (failures != 0) {
+        fflush(stdout);
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,373 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that checks the processing of Arrow columns from
+   `arrow_bridge.cpp`. It is built with the gradle task
+   `buildArrowBridgeCheck` and run by `checkNativeArrowBridge`.
+
+   Each function of `carrow.h` gets columns that start at an offset into
+   their buffers which is not a multiple of 8, so that the validity bitmap is
+   copied bit by bit, with the number of nulls either known or -1, and with
+   the timestamps in Europe/Berlin and at fixed offsets. The `date32`
+   columns are longer than the chunks that they are truncated in. The
+   unsupported columns and time zones must fail without touching the
+   output. */
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "civil.hpp"
+#include "check.hpp"
+extern "C" {
+#include "cdate.h"
+#include "carrow.h"
+}
+
+// The offset of the input columns into their buffers.
+#define OFFSET 3
+
+static void release_nothing(ArrowArray *) {}
+
+// An input column over the values that start at `OFFSET`.
+struct input {
+    ArrowSchema schema;
+    ArrowArray array;
+    const void *buffers[2];
+    std::vector<uint8_t> validity;
+
+    input(const char *format, const void *values, int64_t length,
+        bool known_null_count) : schema(), array()
+    {
+        // Every fifth value is null.
+        validity.resize((size_t)(OFFSET + length + 7) / 8);
+        int64_t nulls = 0;
+        for (int64_t i = 0; i < length; ++i) {
+            if (is_valid(i))
+                validity[(OFFSET + i) / 8] |= (uint8_t)(1 << (OFFSET + i) % 8);
+            else
+                ++nulls;
+        }
+        buffers[0] = validity.data();
+        buffers[1] = values;
+        schema.format = format;
+        schema.name = "";
+        array.length = length;
+        array.null_count = known_null_count ? nulls : -1;
+        array.offset = OFFSET;
+        array.n_buffers = 2;
+        array.buffers = buffers;
+        array.release = release_nothing;
+    }
+
+    input(const input&) = delete;
+
+    static bool is_valid(int64_t i) {
+        return i % 5 != 2;
+    }
+};
+
+// An output column, released when it goes out of scope.
+struct output {
+    ArrowSchema schema;
+    ArrowArray array;
+
+    output() : schema(), array() {}
+
+    output(const output&) = delete;
+
+    ~output() {
+        if (schema.release != nullptr)
+            schema.release(&schema);
+        if (array.release != nullptr)
+            array.release(&array);
+    }
+
+    // Checks the format, the length and the nulls against the input.
+    bool check(const input& from, const char *format) const {
+        if (!CHECK(schema.release != nullptr && array.release != nullptr) ||
+            !CHECK(strcmp(schema.format, format) == 0) ||
+            !CHECK_EQUAL(array.length, from.array.length) ||
+            !CHECK_EQUAL(array.null_count, from.array.null_count) ||
+            !CHECK_EQUAL(array.offset, 0) ||
+            !CHECK_EQUAL(array.n_buffers, 2))
+            return false;
+        // Without the nulls, the bitmap may be omitted.
+        auto validity = (const uint8_t *)array.buffers[0];
+        for (int64_t i = 0; i < array.length; ++i) {
+            if (!CHECK_EQUAL(validity == nullptr ? 1 :
+                validity[i / 8] >> (i % 8) & 1, input::is_valid(i)))
+                return false;
+        }
+        return true;
+    }
+
+    template <typename T>
+    const T *values() const {
+        return (const T *)array.buffers[1];
+    }
+};
+
+static int64_t local_sec(int64_t year, int month, int day, int hour = 0,
+    int minute = 0)
+{
+    return civil::days_from_civil(year, month, day) * SECS_PER_DAY +
+        hour * 3600 + minute * 60;
+}
+
+/* The instants, in milliseconds, every 599 seconds over the days of both
+   transitions of 2021 in Europe/Berlin, after the `OFFSET` values that are
+   not a part of the column. */
+static std::vector<int64_t> instants_in_2021() {
+    std::vector<int64_t> result(OFFSET, INT64_MIN);
+    for (int64_t day : {local_sec(2021, 3, 27), local_sec(2021, 10, 30)}) {
+        for (int64_t t = day; t < day + 2 * SECS_PER_DAY; t += 599)
+            result.push_back(t * 1000 + t % 1000);
+    }
+    return result;
+}
+
+static void check_to_local(TZID berlin) {
+    const std::vector<int64_t> instants = instants_in_2021();
+    const int64_t length = (int64_t)instants.size() - OFFSET;
+    for (bool known_null_count : {true, false}) {
+        input column("tsm:Europe/Berlin", instants.data(), length,
+            known_null_count);
+        output local;
+        if (!CHECK_EQUAL(arrow_timestamps_to_local(&column.schema,
+            &column.array, &local.schema, &local.array), 0) ||
+            !local.check(column, "tsm:"))
+            continue;
+        for (int64_t i = 0; i < length; ++i) {
+            const int64_t instant = instants[OFFSET + i];
+            const int64_t offset =
+                offset_at_instant(berlin, civil::floor_div(instant, 1000));
+            if (!CHECK_EQUAL(local.values<int64_t>()[i],
+                instant + offset * 1000))
+                break;
+        }
+    }
+    // The fixed offsets, and their local date-times back.
+    const struct {
+        const char *format;
+        const char *timezone;
+        int64_t offset;
+    } fixed[] = {
+        {"tsm:+05:30", "+05:30", 5 * 3600 + 30 * 60},
+        {"tsm:-03:00", "-03:00", -3 * 3600},
+        {"tsm:UTC", "UTC", 0},
+    };
+    for (const auto& zone : fixed) {
+        input column(zone.format, instants.data(), length, true);
+        output local;
+        if (!CHECK_EQUAL(arrow_timestamps_to_local(&column.schema,
+            &column.array, &local.schema, &local.array), 0) ||
+            !local.check(column, "tsm:"))
+            continue;
+        for (int64_t i = 0; i < length; ++i) {
+            if (!CHECK_EQUAL(local.values<int64_t>()[i],
+                instants[OFFSET + i] + zone.offset * 1000))
+                break;
+        }
+        std::vector<int64_t> locals(OFFSET, 0);
+        locals.insert(locals.end(), local.values<int64_t>(),
+            local.values<int64_t>() + length);
+        input back_column("tsm:", locals.data(), length, true);
+        output back;
+        if (!CHECK_EQUAL(arrow_timestamps_from_local(&back_column.schema,
+            &back_column.array, zone.timezone, &back.schema, &back.array), 0))
+            continue;
+        const std::string format = std::string("tsm:") + zone.timezone;
+        if (back.check(back_column, format.c_str()))
+            CHECK(memcmp(back.values<int64_t>(), instants.data() + OFFSET,
+                length * sizeof(int64_t)) == 0);
+    }
+}
+
+static void check_from_local() {
+    const int64_t spring = local_sec(2021, 3, 28, 2, 30);
+    const int64_t autumn = local_sec(2021, 10, 31, 2, 30);
+    const int64_t summer = local_sec(2021, 7, 1, 12);
+    const int64_t locals[] = {
+        0, 0, 0,
+        spring - 3600, spring, summer, spring + 3600,
+        autumn - 3600, autumn, autumn + 3600,
+    };
+    // The gap is skipped forward, and the repeated hour gets CEST.
+    const int64_t expected[] = {
+        spring - 3600 - 3600, spring - 3600, summer - 7200,
+        spring + 3600 - 7200, autumn - 3600 - 7200, autumn - 7200,
+        autumn + 3600 - 3600,
+    };
+    const int64_t length = sizeof expected / sizeof expected[0];
+    input column("tss:", locals, length, false);
+    output instants;
+    if (!CHECK_EQUAL(arrow_timestamps_from_local(&column.schema,
+        &column.array, "Europe/Berlin", &instants.schema, &instants.array),
+        0) || !instants.check(column, "tss:Europe/Berlin"))
+        return;
+    for (int64_t i = 0; i < length; ++i)
+        CHECK_EQUAL(instants.values<int64_t>()[i], expected[i]);
+}
+
+static void check_truncate(TZID berlin) {
+    // The dates around the epoch, over several chunks.
+    std::vector<int32_t> days(OFFSET, 0);
+    for (int32_t day = -1500; day < 1500; ++day)
+        days.push_back(day * 7 + 3);
+    const int64_t length = (int64_t)days.size() - OFFSET;
+    for (CIVIL_FIELD field : {CIVIL_FIELD_YEAR, CIVIL_FIELD_MONTH,
+        CIVIL_FIELD_DAY})
+    {
+        input column("tdD", days.data(), length, false);
+        output truncated;
+        if (!CHECK_EQUAL(arrow_truncate_timestamps(&column.schema,
+            &column.array, field, &truncated.schema, &truncated.array), 0) ||
+            !truncated.check(column, "tdD"))
+            continue;
+        for (int64_t i = 0; i < length; ++i) {
+            int64_t year;
+            int month, day;
+            civil::civil_from_days(days[OFFSET + i], year, month, day);
+            const int64_t expected = civil::days_from_civil(year,
+                field == CIVIL_FIELD_YEAR ? 1 : month,
+                field == CIVIL_FIELD_DAY ? day : 1);
+            if (!CHECK_EQUAL(truncated.values<int32_t>()[i], expected))
+                break;
+        }
+    }
+    // The days in Berlin start at different offsets around the transitions.
+    const std::vector<int64_t> instants = instants_in_2021();
+    const int64_t count = (int64_t)instants.size() - OFFSET;
+    input column("tsm:Europe/Berlin", instants.data(), count, true);
+    output truncated;
+    if (!CHECK_EQUAL(arrow_truncate_timestamps(&column.schema, &column.array,
+        CIVIL_FIELD_DAY, &truncated.schema, &truncated.array), 0) ||
+        !truncated.check(column, "tsm:Europe/Berlin"))
+        return;
+    for (int64_t i = 0; i < count; ++i) {
+        const int64_t instant = civil::floor_div(instants[OFFSET + i], 1000);
+        const int64_t local = instant + offset_at_instant(berlin, instant);
+        const int64_t midnight =
+            civil::floor_div(local, SECS_PER_DAY) * SECS_PER_DAY;
+        int offset = INT_MAX;
+        const int transition = offset_at_datetime(berlin, midnight, &offset);
+        if (!CHECK_EQUAL(truncated.values<int64_t>()[i],
+            (midnight + transition - offset) * 1000))
+            break;
+    }
+}
+
+static void check_extract() {
+    /* 2020-08-30T16:43:00.5Z, a Sunday, the 243rd day of a leap year, and
+       its date, along with the millisecond before the epoch. */
+    const int64_t instant = 1598805780;
+    const int64_t micros[] = {0, 0, 0, instant * 1000000 + 500000};
+    const int32_t days[] = {0, 0, 0, 18504, -1};
+    const int64_t millis[] = {0, 0, 0, 18504 * SECS_PER_DAY * 1000LL, -1};
+    const struct {
+        CIVIL_FIELD field;
+        int32_t in_india;
+        int32_t of_date;
+        int32_t before_epoch;
+    } fields[] = {
+        {CIVIL_FIELD_YEAR, 2020, 2020, 1969},
+        {CIVIL_FIELD_MONTH, 8, 8, 12},
+        {CIVIL_FIELD_DAY, 30, 30, 31},
+        {CIVIL_FIELD_HOUR, 22, 0, 23},
+        {CIVIL_FIELD_MINUTE, 13, 0, 59},
+        {CIVIL_FIELD_SECOND, 0, 0, 59},
+        {CIVIL_FIELD_ISO_DAY_OF_WEEK, 7, 7, 3},
+        {CIVIL_FIELD_DAY_OF_YEAR, 243, 243, 365},
+    };
+    for (const auto& f : fields) {
+        input timestamps("tsu:+05:30", micros, 1, true);
+        input date64("tdm", millis, 2, true);
+        input date32("tdD", days, 2, false);
+        output from_timestamps, from_date64, from_date32;
+        if (CHECK_EQUAL(arrow_extract_field(&timestamps.schema,
+            &timestamps.array, f.field, &from_timestamps.schema,
+            &from_timestamps.array), 0) &&
+            from_timestamps.check(timestamps, "i"))
+            CHECK_EQUAL(from_timestamps.values<int32_t>()[0], f.in_india);
+        if (CHECK_EQUAL(arrow_extract_field(&date64.schema, &date64.array,
+            f.field, &from_date64.schema, &from_date64.array), 0) &&
+            from_date64.check(date64, "i"))
+        {
+            CHECK_EQUAL(from_date64.values<int32_t>()[0], f.of_date);
+            CHECK_EQUAL(from_date64.values<int32_t>()[1], f.before_epoch);
+        }
+        if (CHECK_EQUAL(arrow_extract_field(&date32.schema, &date32.array,
+            f.field, &from_date32.schema, &from_date32.array), 0) &&
+            from_date32.check(date32, "i"))
+            CHECK_EQUAL(from_date32.values<int32_t>()[0], f.of_date);
+    }
+}
+
+// The columns and the time zones that are not supported.
+static void check_rejected() {
+    const int64_t values[OFFSET + 1] = {};
+    for (const char *format : {"tsx:", "ts", "tsm", "tdX", "i", "l",
+        "tss:+5:30", "tss:+05:3", "tss:+18:01", "tss:+05:60",
+        "tss:Nowhere/City"})
+    {
+        input column(format, values, 1, true);
+        output result;
+        CHECK_EQUAL(arrow_truncate_timestamps(&column.schema, &column.array,
+            CIVIL_FIELD_DAY, &result.schema, &result.array), -1);
+        CHECK_EQUAL(arrow_extract_field(&column.schema, &column.array,
+            CIVIL_FIELD_DAY, &result.schema, &result.array), -1);
+        CHECK_EQUAL(arrow_timestamps_to_local(&column.schema, &column.array,
+            &result.schema, &result.array), -1);
+        CHECK(result.schema.release == nullptr &&
+            result.array.release == nullptr);
+    }
+    output result;
+    input dates("tdm", values, 1, true);
+    input instants("tss:UTC", values, 1, true);
+    input locals("tss:", values, 1, true);
+    // Only timestamps with a time zone have local date-times.
+    CHECK_EQUAL(arrow_timestamps_to_local(&dates.schema, &dates.array,
+        &result.schema, &result.array), -1);
+    CHECK_EQUAL(arrow_timestamps_to_local(&locals.schema, &locals.array,
+        &result.schema, &result.array), -1);
+    // Only timestamps without one are given one.
+    CHECK_EQUAL(arrow_timestamps_from_local(&instants.schema, &instants.array,
+        "UTC", &result.schema, &result.array), -1);
+    CHECK_EQUAL(arrow_timestamps_from_local(&dates.schema, &dates.array,
+        "UTC", &result.schema, &result.array), -1);
+    for (const char *timezone : {(const char *)nullptr, "Nowhere/City",
+        "+0530", "05:30"})
+        CHECK_EQUAL(arrow_timestamps_from_local(&locals.schema, &locals.array,
+            timezone, &result.schema, &result.array), -1);
+    // The weekdays and the days of the year can't be truncated to.
+    CHECK_EQUAL(arrow_truncate_timestamps(&instants.schema, &instants.array,
+        CIVIL_FIELD_ISO_DAY_OF_WEEK, &result.schema, &result.array), -1);
+    CHECK_EQUAL(arrow_extract_field(&instants.schema, &instants.array,
+        (CIVIL_FIELD)(CIVIL_FIELD_DAY_OF_YEAR + 1), &result.schema,
+        &result.array), -1);
+    // The arrays that are released or don't have the values.
+    instants.array.release = nullptr;
+    CHECK_EQUAL(arrow_extract_field(&instants.schema, &instants.array,
+        CIVIL_FIELD_DAY, &result.schema, &result.array), -1);
+    locals.array.n_buffers = 3;
+    CHECK_EQUAL(arrow_extract_field(&locals.schema, &locals.array,
+        CIVIL_FIELD_DAY, &result.schema, &result.array), -1);
+    dates.buffers[1] = nullptr;
+    CHECK_EQUAL(arrow_extract_field(&dates.schema, &dates.array,
+        CIVIL_FIELD_DAY, &result.schema, &result.array), -1);
+    CHECK(result.schema.release == nullptr && result.array.release == nullptr);
+}
+
+int main() {
+    const TZID berlin = timezone_by_name("Europe/Berlin");
+    if (!CHECK(berlin != TZID_INVALID))
+        return check::exit_code();
+    check_to_local(berlin);
+    check_from_local();
+    check_truncate(berlin);
+    check_extract();
+    check_rejected();
+    return check::exit_code();
+}
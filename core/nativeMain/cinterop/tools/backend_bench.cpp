@@ -0,0 +1,119 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that measures the functions of `cdate.h` built with
+   one of the backends from `backend.hpp`. The functions of the backends
+   have the same names, so there is a build of the tool for each of them,
+   with the gradle tasks `buildBackendBenchDate` and
+   `buildBackendBenchChrono`, and their results are compared by running both
+   with the same arguments:
+
+       backend_bench_date [-n calls] [zone...]
+
+   The first lookup of a zone, which loads the time zone database, is
+   measured separately; then, for each of the zones, which by default are a
+   few with different kinds of rules, the lookups of the offsets at random
+   instants from 1900 to 2100 and of the local date-times of the same
+   instants, and the lookups by name. The output has a line for each of the
+   measurements, with the nanoseconds per call. */
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <getopt.h>
+#include "backend.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+typedef std::chrono::steady_clock benchmark_clock;
+
+static double nanoseconds_since(benchmark_clock::time_point start,
+    size_t calls)
+{
+    const std::chrono::duration<double, std::nano> elapsed =
+        benchmark_clock::now() - start;
+    return elapsed.count() / (double)(calls == 0 ? 1 : calls);
+}
+
+static void print(const char *measurement, const char *zone, double ns) {
+    printf("%-12s %-24s %-32s %10.1f ns\n", DATETIME_BACKEND_NAME,
+        measurement, zone, ns);
+}
+
+// So that the calls are not optimized away.
+static volatile int64_t checksum = 0;
+
+static void measure_zone(const char *name, const std::vector<int64_t>& instants)
+{
+    const TZID zone = timezone_by_name(name);
+    if (zone == TZID_INVALID) {
+        fprintf(stderr, "%s: unknown to the library\n", name);
+        return;
+    }
+    const size_t count = instants.size();
+    int64_t sum = 0;
+    auto start = benchmark_clock::now();
+    for (int64_t instant : instants)
+        sum += offset_at_instant(zone, instant);
+    print("offset_at_instant", name, nanoseconds_since(start, count));
+    start = benchmark_clock::now();
+    for (int64_t instant : instants) {
+        int64_t begin = 0, end = 0;
+        sum += offset_interval_at_instant(zone, instant, &begin, &end);
+    }
+    print("offset_interval", name, nanoseconds_since(start, count));
+    start = benchmark_clock::now();
+    for (int64_t local : instants) {
+        int offset = INT_MAX;
+        sum += offset_at_datetime(zone, local, &offset) + offset;
+    }
+    print("offset_at_datetime", name, nanoseconds_since(start, count));
+    const size_t lookups = count / 16;
+    start = benchmark_clock::now();
+    for (size_t i = 0; i < lookups; ++i)
+        sum += timezone_by_name(name);
+    print("timezone_by_name", name, nanoseconds_since(start, lookups));
+    checksum = checksum + sum;
+}
+
+int main(int argc, char **argv) {
+    size_t calls = 1000000;
+    int option;
+    while ((option = getopt(argc, argv, "n:")) != -1) {
+        switch (option) {
+            case 'n':
+                calls = (size_t)atol(optarg);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n calls] [zone...]\n", argv[0]);
+                return 2;
+        }
+    }
+    std::vector<std::string> zones(argv + optind, argv + argc);
+    if (zones.empty()) {
+        zones = {"UTC", "Europe/Berlin", "America/New_York",
+            "Australia/Lord_Howe", "Africa/Casablanca", "Asia/Kolkata"};
+    }
+    auto start = benchmark_clock::now();
+    if (timezone_by_name("UTC") == TZID_INVALID) {
+        fprintf(stderr, "the time zone database is unavailable\n");
+        return 2;
+    }
+    print("load", "", nanoseconds_since(start, 1));
+    // The same instants for every backend and zone.
+    std::mt19937_64 random(42);
+    std::uniform_int_distribution<int64_t> distribution(-2208988800,
+        4102444800);
+    std::vector<int64_t> instants(calls);
+    for (int64_t& instant : instants)
+        instant = distribution(random);
+    for (const std::string& zone : zones)
+        measure_zone(zone.c_str(), instants);
+    return 0;
+}
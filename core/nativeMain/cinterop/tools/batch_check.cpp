@@ -0,0 +1,177 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that checks the batch functions from `batch.cpp`. It
+   is built with the gradle task `buildBatchCheck` and run by
+   `checkNativeBatch`.
+
+   For each unit, the timestamps around both transitions of 2021 in
+   Europe/Berlin and around the epoch, with the sub-second parts that are
+   zero, positive and negative, are converted in one batch and compared to
+   `offset_at_instant` and `offset_at_datetime` applied to their seconds.
+   The local date-time of an instant is the instant plus the offset, and the
+   instant of a local date-time is the local date-time moved by the gap and
+   the offset, both saturated to the range of `int64_t`, which the extreme
+   timestamps in the zones with the largest offsets of both signs reach. */
+#include <climits>
+#include <cstdint>
+#include <vector>
+#include "civil.hpp"
+#include "check.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+static const struct {
+    TIME_UNIT unit;
+    int64_t per_second;
+} units[] = {
+    {TIME_UNIT_SECOND, 1},
+    {TIME_UNIT_MILLISECOND, 1000},
+    {TIME_UNIT_MICROSECOND, 1000000},
+    {TIME_UNIT_NANOSECOND, 1000000000},
+};
+
+// Returns `timestamp + sec * per_second`, saturated.
+static int64_t shifted(int64_t timestamp, int64_t sec, int64_t per_second) {
+    int64_t result;
+    if (__builtin_add_overflow(timestamp, sec * per_second, &result))
+        return sec < 0 ? INT64_MIN : INT64_MAX;
+    return result;
+}
+
+static void check_zone(TZID zone, TIME_UNIT unit, int64_t per_second,
+    const std::vector<int64_t>& timestamps)
+{
+    const size_t count = timestamps.size();
+    std::vector<int> offsets(count);
+    std::vector<int64_t> local_times(count);
+    std::vector<int64_t> instants(count);
+    if (!CHECK_EQUAL(offsets_at_instants(zone, unit, timestamps.data(),
+            offsets.data(), count), 0) ||
+        !CHECK_EQUAL(instants_to_local_times(zone, unit, timestamps.data(),
+            local_times.data(), count), 0) ||
+        !CHECK_EQUAL(local_times_to_instants(zone, unit, timestamps.data(),
+            instants.data(), count), 0))
+        return;
+    for (size_t i = 0; i < count; ++i) {
+        const int64_t sec = civil::floor_div(timestamps[i], per_second);
+        const int offset = offset_at_instant(zone, sec);
+        int local_offset = INT_MAX;
+        const int gap = offset_at_datetime(zone, sec, &local_offset);
+        if (!CHECK_EQUAL(offsets[i], offset) ||
+            !CHECK_EQUAL(local_times[i],
+                shifted(timestamps[i], offset, per_second)) ||
+            !CHECK_EQUAL(instants[i],
+                shifted(timestamps[i], gap - local_offset, per_second)))
+        {
+            fprintf(stderr, "%lld in units of 1/%lld s\n",
+                (long long)timestamps[i], (long long)per_second);
+            return;
+        }
+    }
+}
+
+static int64_t local_time(TZID zone, TIME_UNIT unit, int64_t instant) {
+    int64_t local = 0;
+    CHECK_EQUAL(instants_to_local_times(zone, unit, &instant, &local, 1), 0);
+    return local;
+}
+
+static int64_t instant_of(TZID zone, TIME_UNIT unit, int64_t local) {
+    int64_t instant = 0;
+    CHECK_EQUAL(local_times_to_instants(zone, unit, &local, &instant, 1), 0);
+    return instant;
+}
+
+// The values that don't depend on the comparison above being right.
+static void check_known(TZID utc, TZID berlin, TZID east, TZID west) {
+    const int64_t hour = 3600;
+    for (const auto& u : units) {
+        const int64_t per = u.per_second;
+        // The last unit of 1969 is 00:59:59 of 1970 in Berlin.
+        CHECK_EQUAL(local_time(berlin, u.unit, -1), hour * per - 1);
+        CHECK_EQUAL(instant_of(berlin, u.unit, hour * per - 1), -1);
+        CHECK_EQUAL(local_time(utc, u.unit, -per - 1), -per - 1);
+        int offset = 0;
+        const int64_t minus_one = -1;
+        CHECK_EQUAL(offsets_at_instants(berlin, u.unit, &minus_one, &offset,
+            1), 0);
+        CHECK_EQUAL(offset, hour);
+        // The ends of `int64_t` fit in the UTC, and saturate away from it.
+        for (int64_t timestamp : {INT64_MIN, INT64_MIN + 1, INT64_MAX - 1,
+            INT64_MAX})
+        {
+            CHECK_EQUAL(local_time(utc, u.unit, timestamp), timestamp);
+            CHECK_EQUAL(instant_of(utc, u.unit, timestamp), timestamp);
+        }
+        CHECK_EQUAL(local_time(east, u.unit, INT64_MAX - 1), INT64_MAX);
+        CHECK_EQUAL(local_time(east, u.unit, INT64_MIN),
+            INT64_MIN + 14 * hour * per);
+        CHECK_EQUAL(instant_of(east, u.unit, INT64_MIN + 1), INT64_MIN);
+        CHECK_EQUAL(local_time(west, u.unit, INT64_MIN + 1), INT64_MIN);
+        CHECK_EQUAL(instant_of(west, u.unit, INT64_MAX), INT64_MAX);
+        CHECK_EQUAL(instant_of(west, u.unit, INT64_MIN),
+            INT64_MIN + 12 * hour * per);
+        // 02:30 in the gap of 2021-03-28 is moved forward to 03:30 CEST.
+        const int64_t gap_day = civil::days_from_civil(2021, 3, 28);
+        CHECK_EQUAL(instant_of(berlin, u.unit,
+            (gap_day * SECS_PER_DAY + 5 * hour / 2) * per + 1),
+            (gap_day * SECS_PER_DAY + 3 * hour / 2) * per + 1);
+        // 02:30 of 2021-10-31 happens twice, and the CEST comes first.
+        const int64_t overlap_day = civil::days_from_civil(2021, 10, 31);
+        CHECK_EQUAL(instant_of(berlin, u.unit,
+            (overlap_day * SECS_PER_DAY + 5 * hour / 2) * per - 1),
+            (overlap_day * SECS_PER_DAY + hour / 2) * per - 1);
+    }
+}
+
+static void check_failures(TZID berlin) {
+    int64_t timestamps[] = {0, 1};
+    int offsets[2];
+    CHECK_EQUAL(offsets_at_instants(berlin, (TIME_UNIT)4, timestamps, offsets,
+        2), -1);
+    CHECK_EQUAL(instants_to_local_times(berlin, (TIME_UNIT)-1, timestamps,
+        timestamps, 2), -1);
+    CHECK_EQUAL(local_times_to_instants(TZID_INVALID, TIME_UNIT_SECOND,
+        timestamps, timestamps, 2), -1);
+    CHECK_EQUAL(offsets_at_instants(TZID_INVALID, TIME_UNIT_NANOSECOND,
+        timestamps, offsets, 2), -1);
+}
+
+int main() {
+    const TZID utc = timezone_by_name("UTC");
+    const TZID berlin = timezone_by_name("Europe/Berlin");
+    const TZID east = timezone_by_name("Etc/GMT-14");
+    const TZID west = timezone_by_name("Etc/GMT+12");
+    if (!CHECK(utc != TZID_INVALID) || !CHECK(berlin != TZID_INVALID) ||
+        !CHECK(east != TZID_INVALID) || !CHECK(west != TZID_INVALID))
+        return check::exit_code();
+    std::vector<int64_t> seconds;
+    for (int64_t t = -2 * SECS_PER_DAY; t < 2 * SECS_PER_DAY; t += 599)
+        seconds.push_back(t);
+    for (int64_t day : {civil::days_from_civil(2021, 3, 27),
+        civil::days_from_civil(2021, 10, 30)})
+    {
+        for (int64_t t = 0; t < 3 * SECS_PER_DAY; t += 599)
+            seconds.push_back(day * SECS_PER_DAY + t);
+    }
+    for (const auto& u : units) {
+        std::vector<int64_t> timestamps;
+        for (int64_t t : seconds) {
+            for (int64_t part : {(int64_t)0, (int64_t)1, u.per_second / 2,
+                u.per_second - 1, -u.per_second / 3, (int64_t)-1})
+                timestamps.push_back(t * u.per_second + part);
+        }
+        for (int64_t timestamp : {INT64_MIN, INT64_MIN + 1,
+            INT64_MIN + u.per_second, INT64_MAX - u.per_second,
+            INT64_MAX - 1, INT64_MAX})
+            timestamps.push_back(timestamp);
+        for (TZID zone : {utc, berlin, east, west})
+            check_zone(zone, u.unit, u.per_second, timestamps);
+    }
+    check_known(utc, berlin, east, west);
+    check_failures(berlin);
+    return check::exit_code();
+}
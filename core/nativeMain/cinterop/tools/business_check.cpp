@@ -0,0 +1,226 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that checks the business-day calendars from
+   `business.cpp`. It is built with the gradle task `buildBusinessCheck` and
+   run by `checkNativeBusiness`.
+
+   The counts of business days and `add_business_days`, in both directions,
+   are compared with walking over the days one by one, for holidays around
+   the ends of the years, where they move to another bitset, and around the
+   ends of the supported years. The business hours are checked in the UTC
+   and in Europe/Berlin, including the days of its transitions, which still
+   contribute exactly their business hours. The days and the local times
+   beyond the range of `int64_t` are saturated. */
+#include <climits>
+#include <cstdint>
+#include <vector>
+#include "civil.hpp"
+#include "check.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+static int64_t day_of(int64_t year, int month, int day) {
+    return civil::days_from_civil(year, month, day);
+}
+
+// `business_days_between`, by walking over the days.
+static int64_t walk_between(const BUSINESS_CALENDAR *calendar, int64_t from,
+    int64_t to)
+{
+    int64_t result = 0;
+    for (int64_t day = from; day < to; ++day)
+        result += is_business_day(calendar, day);
+    for (int64_t day = to; day < from; ++day)
+        result -= is_business_day(calendar, day);
+    return result;
+}
+
+// `add_business_days`, by walking over the days.
+static int64_t walk_add(const BUSINESS_CALENDAR *calendar, int64_t day,
+    int64_t n)
+{
+    const int64_t step = n > 0 ? 1 : -1;
+    while (n != 0) {
+        day += step;
+        if (is_business_day(calendar, day))
+            n -= step;
+    }
+    return day;
+}
+
+// Compares the calendar with walking over the days in [first; last].
+static void check_days(const BUSINESS_CALENDAR *calendar, int64_t first,
+    int64_t last)
+{
+    for (int64_t from = first; from <= last; from += 3) {
+        for (int64_t to = first; to <= last; to += 5) {
+            CHECK_EQUAL(business_days_between(calendar, from, to),
+                walk_between(calendar, from, to));
+        }
+        for (int64_t n = -30; n <= 30; ++n)
+            CHECK_EQUAL(add_business_days(calendar, from, n),
+                walk_add(calendar, from, n));
+    }
+}
+
+static void check_holidays() {
+    BUSINESS_CALENDAR *calendar = business_calendar_create(0x60);
+    const int64_t holidays[] = {
+        // Thursday and Friday, in two bitsets.
+        day_of(2020, 12, 31), day_of(2021, 1, 1),
+        // the last days of a leap year and of the next one.
+        day_of(2024, 12, 31), day_of(2025, 12, 31), day_of(2026, 1, 1),
+        // a Saturday, which changes nothing.
+        day_of(2022, 1, 1),
+        // the ends of the supported years.
+        day_of(-32767, 1, 1), day_of(32767, 12, 31),
+    };
+    CHECK_EQUAL(business_calendar_add_holidays(calendar, holidays,
+        sizeof(holidays) / sizeof(holidays[0])), 0);
+    CHECK(!is_business_day(calendar, day_of(2020, 12, 31)));
+    CHECK(!is_business_day(calendar, day_of(2021, 1, 1)));
+    CHECK(is_business_day(calendar, day_of(2020, 12, 30)));
+    CHECK(is_business_day(calendar, day_of(2021, 1, 4)));
+    CHECK(!is_business_day(calendar, day_of(2024, 12, 31)));
+    CHECK(is_business_day(calendar, day_of(2024, 12, 30)));
+    // From Wednesday, the next business day is the Monday after New Year.
+    CHECK_EQUAL(add_business_days(calendar, day_of(2020, 12, 30), 1),
+        day_of(2021, 1, 4));
+    CHECK_EQUAL(add_business_days(calendar, day_of(2021, 1, 4), -1),
+        day_of(2020, 12, 30));
+    CHECK_EQUAL(add_business_days(calendar, day_of(2021, 1, 4), 0),
+        day_of(2021, 1, 4));
+    CHECK_EQUAL(business_days_between(calendar, day_of(2020, 12, 28),
+        day_of(2021, 1, 11)), 8);
+    CHECK_EQUAL(business_days_between(calendar, day_of(2021, 1, 11),
+        day_of(2020, 12, 28)), -8);
+    check_days(calendar, day_of(2020, 11, 1), day_of(2021, 3, 1));
+    check_days(calendar, day_of(2024, 11, 1), day_of(2026, 3, 1));
+    check_days(calendar, day_of(-32767, 1, 1), day_of(-32767, 3, 1));
+    check_days(calendar, day_of(32767, 10, 1), day_of(32767, 12, 31));
+    // Far from the holidays, a week has five business days.
+    CHECK_EQUAL(business_days_between(calendar, day_of(2000, 1, 3),
+        day_of(2000, 1, 3) + 7 * 1000), 5 * 1000);
+    // The days before the one out of range are still added.
+    const int64_t invalid[] = {day_of(2021, 1, 5), day_of(32768, 1, 3),
+        day_of(2021, 1, 6)};
+    CHECK_EQUAL(business_calendar_add_holidays(calendar, invalid, 3), -1);
+    CHECK(!is_business_day(calendar, day_of(2021, 1, 5)));
+    CHECK(is_business_day(calendar, day_of(2021, 1, 6)));
+    business_calendar_free(calendar);
+    CHECK(business_calendar_create(0x7f) == nullptr);
+}
+
+// Every other day is a holiday, and only Wednesday is a weekend.
+static void check_dense_holidays() {
+    BUSINESS_CALENDAR *calendar = business_calendar_create(0x04);
+    std::vector<int64_t> holidays;
+    for (int64_t day = day_of(2019, 6, 1); day < day_of(2021, 6, 1); day += 2)
+        holidays.push_back(day);
+    CHECK_EQUAL(business_calendar_add_holidays(calendar, holidays.data(),
+        holidays.size()), 0);
+    check_days(calendar, day_of(2019, 5, 1), day_of(2021, 7, 1));
+    business_calendar_free(calendar);
+}
+
+static void check_hours() {
+    const TZID utc = timezone_by_name("UTC");
+    const TZID berlin = timezone_by_name("Europe/Berlin");
+    if (!CHECK(utc != TZID_INVALID && berlin != TZID_INVALID))
+        return;
+    BUSINESS_CALENDAR *calendar = business_calendar_create(0x60);
+    CHECK_EQUAL(business_calendar_set_hours(calendar, -1, 3600), -1);
+    CHECK_EQUAL(business_calendar_set_hours(calendar, 3600, 3600), -1);
+    CHECK_EQUAL(business_calendar_set_hours(calendar, 0, 86401), -1);
+    CHECK_EQUAL(business_calendar_set_hours(calendar, 9 * 3600, 17 * 3600),
+        0);
+    // Friday, 2020-01-03.
+    const int64_t friday = day_of(2020, 1, 3) * 86400;
+    CHECK_EQUAL(is_business_instant(calendar, utc, friday + 9 * 3600 - 1), 0);
+    CHECK_EQUAL(is_business_instant(calendar, utc, friday + 9 * 3600), 1);
+    CHECK_EQUAL(is_business_instant(calendar, utc, friday + 17 * 3600 - 1), 1);
+    CHECK_EQUAL(is_business_instant(calendar, utc, friday + 17 * 3600), 0);
+    CHECK_EQUAL(is_business_instant(calendar, utc, friday + 86400 + 43200), 0);
+    // 09:00 in Berlin is 08:00 in the UTC in winter.
+    CHECK_EQUAL(is_business_instant(calendar, berlin, friday + 8 * 3600), 1);
+    CHECK_EQUAL(is_business_instant(calendar, berlin, friday + 16 * 3600), 0);
+    CHECK_EQUAL(is_business_instant(calendar, TZID_INVALID, friday), -1);
+    // From Friday 16:00 to Monday 10:00, two hours.
+    const int64_t monday = friday + 3 * 86400;
+    CHECK_EQUAL(business_seconds_between(calendar, utc, friday + 16 * 3600,
+        monday + 10 * 3600), 2 * 3600);
+    CHECK_EQUAL(business_seconds_between(calendar, utc, monday + 10 * 3600,
+        friday + 16 * 3600), -2 * 3600);
+    CHECK_EQUAL(business_seconds_between(calendar, utc, friday,
+        friday + 14 * 86400), 10 * 8 * 3600);
+    CHECK_EQUAL(business_seconds_between(calendar, TZID_INVALID, friday,
+        monday), INT64_MAX);
+    // A holiday takes its hours away.
+    const int64_t holiday = day_of(2020, 1, 6);
+    business_calendar_add_holidays(calendar, &holiday, 1);
+    CHECK_EQUAL(business_seconds_between(calendar, utc, friday + 16 * 3600,
+        monday + 86400 + 10 * 3600), 2 * 3600);
+    business_calendar_free(calendar);
+    /* With no weekends and the whole days, each day of the transitions of
+       Berlin, of 23 and of 25 hours, still has 86400 business seconds. */
+    calendar = business_calendar_create(0);
+    for (int month : {3, 10}) {
+        const int64_t sunday = day_of(2021, month, month == 3 ? 28 : 31);
+        const int64_t midnight = sunday * 86400 - 3600 * (month == 3 ? 1 : 2);
+        const int64_t next_midnight =
+            (sunday + 1) * 86400 - 3600 * (month == 3 ? 2 : 1);
+        CHECK_EQUAL(business_seconds_between(calendar, berlin, midnight,
+            next_midnight), 86400);
+        CHECK_EQUAL(is_business_instant(calendar, berlin, midnight), 1);
+    }
+    business_calendar_free(calendar);
+}
+
+// The days and the local times that don't fit into `int64_t` are saturated.
+static void check_extremes() {
+    BUSINESS_CALENDAR *calendar = business_calendar_create(0x60);
+    // Every 5 business days from a Friday, 1970-01-02, are a week.
+    const int64_t weeks = 100000000000000000;
+    CHECK_EQUAL(add_business_days(calendar, 1, 5 * weeks), 1 + 7 * weeks);
+    CHECK_EQUAL(add_business_days(calendar, 1, -5 * weeks), 1 - 7 * weeks);
+    CHECK_EQUAL(add_business_days(calendar, 0, INT64_MAX), INT64_MAX);
+    CHECK_EQUAL(add_business_days(calendar, 0, INT64_MIN), INT64_MIN);
+    CHECK_EQUAL(add_business_days(calendar, 0, INT64_MAX / 4 * 3), INT64_MAX);
+    CHECK_EQUAL(add_business_days(calendar, 0, -(INT64_MAX / 4 * 3)),
+        INT64_MIN);
+    CHECK_EQUAL(add_business_days(calendar, INT64_MAX, 1), INT64_MAX);
+    CHECK_EQUAL(add_business_days(calendar, INT64_MIN, -1), INT64_MIN);
+    CHECK_EQUAL(add_business_days(calendar, INT64_MAX, 0), INT64_MAX);
+    // Only 3 days are left, so there can't be 5 business days in them.
+    CHECK_EQUAL(add_business_days(calendar, INT64_MAX - 3, 5), INT64_MAX);
+    CHECK_EQUAL(add_business_days(calendar, INT64_MIN + 3, -5), INT64_MIN);
+    for (int64_t n = -10; n <= 10; ++n) {
+        CHECK_EQUAL(add_business_days(calendar, INT64_MAX - 20, n),
+            walk_add(calendar, INT64_MAX - 20, n));
+        CHECK_EQUAL(add_business_days(calendar, INT64_MIN + 20, n),
+            walk_add(calendar, INT64_MIN + 20, n));
+    }
+    const TZID west = timezone_by_name("Etc/GMT+12");
+    const TZID east = timezone_by_name("Etc/GMT-14");
+    if (CHECK(west != TZID_INVALID && east != TZID_INVALID)) {
+        business_calendar_set_hours(calendar, 9 * 3600, 17 * 3600);
+        // INT64_MIN is at 08:29:52 of its day, and INT64_MAX at 15:30:07.
+        CHECK_EQUAL(is_business_instant(calendar, west, INT64_MIN), 0);
+        CHECK_EQUAL(is_business_instant(calendar, east, INT64_MAX),
+            is_business_day(calendar, civil::floor_div(INT64_MAX, 86400)));
+        CHECK_EQUAL(business_seconds_between(calendar, east, INT64_MAX - 60,
+            INT64_MAX), 0);
+    }
+    business_calendar_free(calendar);
+}
+
+int main() {
+    check_holidays();
+    check_dense_holidays();
+    check_hours();
+    check_extremes();
+    return check::exit_code();
+}
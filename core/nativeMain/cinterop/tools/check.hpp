@@ -0,0 +1,51 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* The expectations of the command-line tools that check the functions of
+   `cdate.h` against known results, like `leap_seconds_check.cpp`. A failed
+   expectation is reported with its line and doesn't stop the tool, which
+   returns `check::exit_code()` from `main`. */
+#pragma once
+#include <cstdint>
+#include <cstdio>
+
+namespace check {
+
+inline int failures = 0;
+
+inline bool expect(bool condition, const char *expression, int line) {
+    if (!condition) {
+        fprintf(stderr, "line %d: %s is false\n", line, expression);
+        ++failures;
+    }
+    return condition;
+}
+
+inline bool expect_equal(int64_t actual, int64_t expected,
+    const char *expression, int line)
+{
+    if (actual != expected) {
+        fprintf(stderr, "line %d: %s is %lld instead of %lld\n", line,
+            expression, (long long)actual, (long long)expected);
+        ++failures;
+    }
+    return actual == expected;
+}
+
+// Prints the number of the failures, if any, and returns the exit code.
+inline int exit_code() {
+    if (failures != 0) {
+        fflush(stdout);
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
+
+}
+
+#define CHECK(condition) check::expect(condition, #condition, __LINE__)
+
+#define CHECK_EQUAL(actual, expected) \
+    check::expect_equal(actual, expected, #actual, __LINE__)
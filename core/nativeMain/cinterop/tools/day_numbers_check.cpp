@@ -0,0 +1,195 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that checks the conversions of the day numbers from
+   `day_numbers.cpp`. It is built with the gradle task
+   `buildDayNumbersCheck` and run by `checkNativeDayNumbers`.
+
+   The epochs of the Julian Day and of the Modified Julian Date, and of both
+   spreadsheet serial dates, are pinned, along with the serial dates around
+   the fictional 1900-02-29 of the 1900 system. A fraction of a day that
+   rounds to a whole microsecond at its end must give the next day, and the
+   day numbers that are not finite or are too large must be rejected. */
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include "civil.hpp"
+#include "check.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+// The same as in `day_numbers.cpp`.
+#define MAX_DAY_NUMBER 1e11
+#define SERIAL_1900_MARCH_FIRST (-25508)
+
+static int64_t utc(int64_t year, int month, int day, int hour = 0,
+    int minute = 0)
+{
+    return civil::days_from_civil(year, month, day) * SECS_PER_DAY +
+        hour * 3600 + minute * 60;
+}
+
+/* Converts the day number to an instant, expecting `epoch_sec` and
+   `nanos`, or a failure if `epoch_sec` is INT64_MAX. */
+static bool check_instant(DAY_NUMBER_SYSTEM system, TZID zone, double number,
+    int64_t epoch_sec, int32_t nanos = 0)
+{
+    int64_t sec = 0;
+    int32_t nano = -1;
+    const int result =
+        day_numbers_to_instants(system, zone, &number, &sec, &nano, 1);
+    if (CHECK_EQUAL(result, epoch_sec == INT64_MAX ? -1 : 0) &&
+        CHECK_EQUAL(sec, epoch_sec) && CHECK_EQUAL(nano, nanos))
+        return true;
+    fprintf(stderr, "%d: %.17g\n", (int)system, number);
+    return false;
+}
+
+static double day_number_of(DAY_NUMBER_SYSTEM system, TZID zone,
+    int64_t epoch_sec, int32_t nanos = 0)
+{
+    double number = 0;
+    CHECK_EQUAL(instants_to_day_numbers(system, zone, &epoch_sec, &nanos,
+        &number, 1), 0);
+    return number;
+}
+
+static void check_epochs() {
+    // The epochs, and the day numbers of 1970-01-01T00:00Z.
+    check_instant(DAY_NUMBER_JULIAN, TZID_INVALID, 0,
+        utc(-4713, 11, 24, 12));
+    check_instant(DAY_NUMBER_JULIAN, TZID_INVALID, 2440587.5, 0);
+    check_instant(DAY_NUMBER_JULIAN, TZID_INVALID, 2451545,
+        utc(2000, 1, 1, 12));
+    check_instant(DAY_NUMBER_MODIFIED_JULIAN, TZID_INVALID, 0,
+        utc(1858, 11, 17));
+    check_instant(DAY_NUMBER_MODIFIED_JULIAN, TZID_INVALID, 40587, 0);
+    check_instant(DAY_NUMBER_MODIFIED_JULIAN, TZID_INVALID, 40587.25,
+        6 * 3600);
+    check_instant(DAY_NUMBER_SERIAL_1904, TZID_INVALID, 0, utc(1904, 1, 1));
+    check_instant(DAY_NUMBER_SERIAL_1904, TZID_INVALID, 24107, 0);
+    check_instant(DAY_NUMBER_SERIAL_1904, TZID_INVALID, -1.5,
+        utc(1903, 12, 30, 12));
+    check_instant(DAY_NUMBER_SERIAL_1900, TZID_INVALID, 25569, 0);
+    CHECK(day_number_of(DAY_NUMBER_JULIAN, TZID_INVALID, 0) == 2440587.5);
+    CHECK(day_number_of(DAY_NUMBER_MODIFIED_JULIAN, TZID_INVALID,
+        utc(1858, 11, 17)) == 0);
+    CHECK(day_number_of(DAY_NUMBER_SERIAL_1904, TZID_INVALID,
+        utc(1904, 1, 1, 18)) == 0.75);
+    CHECK(day_number_of(DAY_NUMBER_SERIAL_1900, TZID_INVALID, 0) == 25569);
+}
+
+// The serial date 60 is the nonexistent 1900-02-29.
+static void check_serial_1900() {
+    const int64_t march_first = SERIAL_1900_MARCH_FIRST * (int64_t)SECS_PER_DAY;
+    CHECK_EQUAL(march_first, utc(1900, 3, 1));
+    check_instant(DAY_NUMBER_SERIAL_1900, TZID_INVALID, 1, utc(1900, 1, 1));
+    check_instant(DAY_NUMBER_SERIAL_1900, TZID_INVALID, 59, utc(1900, 2, 28));
+    check_instant(DAY_NUMBER_SERIAL_1900, TZID_INVALID, 59.5,
+        utc(1900, 2, 28, 12));
+    // The whole fictional day is the first moment after it.
+    check_instant(DAY_NUMBER_SERIAL_1900, TZID_INVALID, 60, march_first);
+    check_instant(DAY_NUMBER_SERIAL_1900, TZID_INVALID, 60.75, march_first);
+    check_instant(DAY_NUMBER_SERIAL_1900, TZID_INVALID, 61, march_first);
+    check_instant(DAY_NUMBER_SERIAL_1900, TZID_INVALID, 61.5,
+        march_first + 12 * 3600);
+    check_instant(DAY_NUMBER_SERIAL_1900, TZID_INVALID, 0, utc(1899, 12, 31));
+    // And back, skipping 60.
+    CHECK(day_number_of(DAY_NUMBER_SERIAL_1900, TZID_INVALID,
+        utc(1900, 2, 28, 12)) == 59.5);
+    CHECK(day_number_of(DAY_NUMBER_SERIAL_1900, TZID_INVALID,
+        march_first - 1) < 60);
+    CHECK(day_number_of(DAY_NUMBER_SERIAL_1900, TZID_INVALID,
+        march_first) == 61);
+    CHECK(day_number_of(DAY_NUMBER_SERIAL_1900, TZID_INVALID,
+        utc(1900, 1, 1)) == 1);
+}
+
+static void check_rounding() {
+    /* The largest day number before the start of 1904-01-02: its fraction
+       is within half a microsecond of the end of the day. */
+    const double before_day = std::nextafter(-24106.0, -INFINITY) + 24107;
+    CHECK(before_day < 1);
+    check_instant(DAY_NUMBER_SERIAL_1904, TZID_INVALID, before_day,
+        utc(1904, 1, 2));
+    // More than half a microsecond before the end, the day is kept.
+    check_instant(DAY_NUMBER_MODIFIED_JULIAN, TZID_INVALID,
+        std::nextafter(40588.0, 0.0), SECS_PER_DAY - 1, 999999000);
+    // The microseconds are rounded to the nearest one.
+    check_instant(DAY_NUMBER_SERIAL_1904, TZID_INVALID,
+        0.5 + 1.4e-6 / SECS_PER_DAY, utc(1904, 1, 1, 12), 1000);
+    check_instant(DAY_NUMBER_SERIAL_1904, TZID_INVALID,
+        0.5 - 1.4e-6 / SECS_PER_DAY, utc(1904, 1, 1, 12) - 1, 999999000);
+    // The nanoseconds are kept in the day numbers, as far as they can be.
+    CHECK(std::fabs(day_number_of(DAY_NUMBER_SERIAL_1904, TZID_INVALID,
+        utc(1904, 1, 1, 12), 500000000) - (0.5 + 0.5 / SECS_PER_DAY)) < 1e-12);
+}
+
+static void check_out_of_range() {
+    for (DAY_NUMBER_SYSTEM system : {DAY_NUMBER_JULIAN,
+        DAY_NUMBER_MODIFIED_JULIAN, DAY_NUMBER_SERIAL_1900,
+        DAY_NUMBER_SERIAL_1904})
+    {
+        for (double number : {(double)NAN, (double)INFINITY, -(double)INFINITY,
+            MAX_DAY_NUMBER, -MAX_DAY_NUMBER, 1e300, -1e300})
+            check_instant(system, TZID_INVALID, number, INT64_MAX);
+        // The day numbers just below the limit are still converted.
+        const double largest = std::nextafter(MAX_DAY_NUMBER, 0.0);
+        int64_t sec = 0;
+        CHECK_EQUAL(day_numbers_to_instants(system, TZID_INVALID, &largest,
+            &sec, nullptr, 1), 0);
+        CHECK(sec > 0 && sec != INT64_MAX);
+        const double smallest = -largest;
+        CHECK_EQUAL(day_numbers_to_instants(system, TZID_INVALID, &smallest,
+            &sec, nullptr, 1), 0);
+        CHECK(sec < 0);
+    }
+    // A failure doesn't stop the rest of the batch.
+    const double numbers[] = {40587, NAN, 40588};
+    int64_t secs[3] = {0, 0, 0};
+    int32_t nanos[3] = {-1, -1, -1};
+    CHECK_EQUAL(day_numbers_to_instants(DAY_NUMBER_MODIFIED_JULIAN,
+        TZID_INVALID, numbers, secs, nanos, 3), -1);
+    CHECK(secs[0] == 0 && secs[1] == INT64_MAX && secs[2] == SECS_PER_DAY);
+    CHECK(nanos[0] == 0 && nanos[1] == 0 && nanos[2] == 0);
+    // The unknown systems.
+    int64_t sec = 0;
+    double number = 0;
+    CHECK_EQUAL(day_numbers_to_instants((DAY_NUMBER_SYSTEM)4, TZID_INVALID,
+        &number, &sec, nullptr, 1), -1);
+    CHECK_EQUAL(instants_to_day_numbers((DAY_NUMBER_SYSTEM)-1, TZID_INVALID,
+        &sec, nullptr, &number, 1), -1);
+}
+
+// The serial dates are local date-times, unlike the Julian days.
+static void check_zones(TZID berlin) {
+    const double serial = (double)(civil::days_from_civil(2021, 7, 1) + 25569);
+    check_instant(DAY_NUMBER_SERIAL_1900, berlin, serial + 0.5,
+        utc(2021, 7, 1, 10));
+    check_instant(DAY_NUMBER_SERIAL_1904, berlin, serial - 1462 + 0.5,
+        utc(2021, 7, 1, 10));
+    check_instant(DAY_NUMBER_MODIFIED_JULIAN, berlin,
+        serial - 25569 + 40587 + 0.5, utc(2021, 7, 1, 12));
+    // 02:30 in the gap of 2021-03-28 is moved forward to 03:30 CEST.
+    const double gap = (double)(civil::days_from_civil(2021, 3, 28) + 25569) +
+        2.5 / 24;
+    check_instant(DAY_NUMBER_SERIAL_1900, berlin, gap, utc(2021, 3, 28, 1, 30));
+    CHECK(day_number_of(DAY_NUMBER_SERIAL_1900, berlin, utc(2021, 7, 1, 10)) ==
+        serial + 0.5);
+    CHECK(day_number_of(DAY_NUMBER_JULIAN, berlin, utc(2000, 1, 1, 12)) ==
+        2451545);
+}
+
+int main() {
+    check_epochs();
+    check_serial_1900();
+    check_rounding();
+    check_out_of_range();
+    const TZID berlin = timezone_by_name("Europe/Berlin");
+    if (CHECK(berlin != TZID_INVALID))
+        check_zones(berlin);
+    return check::exit_code();
+}
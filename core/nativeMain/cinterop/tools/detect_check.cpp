@@ -0,0 +1,162 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that checks `parse_timestamps` from `detect.cpp`
+   against the columns of a fixture. It is built with the gradle task
+   `buildDetectCheck` and run by `checkNativeDetect`:
+
+       detect_check detect_fixtures.txt
+
+   `detect_fixtures.txt` in this directory, which describes its format, has
+   the columns of every format, where the unit of the numbers is chosen by
+   their digits, the rows in other formats are detected separately, and the
+   local date-times are resolved in the time zone of the column. Every row
+   must get the expected instant, format and error. */
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "check.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+static const char *const format_names[] = {
+    "NONE", "ISO8601", "EPOCH_SECONDS", "EPOCH_MILLISECONDS",
+    "EPOCH_MICROSECONDS", "EPOCH_NANOSECONDS", "RFC2822", "SLASHED",
+};
+
+static const char *const error_names[] = {
+    "NONE", "EMPTY", "SYNTAX", "RANGE", "TIME_ZONE",
+};
+
+template <size_t N>
+static int index_of(const char *const (&names)[N], const std::string& name) {
+    for (size_t i = 0; i < N; ++i) {
+        if (name == names[i])
+            return (int)i;
+    }
+    return -1;
+}
+
+struct row {
+    int line;
+    std::string text;
+    int64_t epoch_nanos;
+    int format;
+    int error;
+};
+
+struct column {
+    TZID zone;
+    std::vector<row> rows;
+};
+
+// Parses `expected format error |text|`. Returns false if it is malformed.
+static bool parse_row(const std::string& line, row& result) {
+    const size_t open = line.find('|');
+    const size_t close = line.rfind('|');
+    if (open == std::string::npos || close == open)
+        return false;
+    result.text = line.substr(open + 1, close - open - 1);
+    char expected[32], format[32], error[32];
+    if (sscanf(line.substr(0, open).c_str(), "%31s %31s %31s", expected,
+        format, error) != 3)
+        return false;
+    result.epoch_nanos = strcmp(expected, "-") == 0 ?
+        INT64_MAX : strtoll(expected, nullptr, 10);
+    result.format = index_of(format_names, format);
+    result.error = index_of(error_names, error);
+    return result.format >= 0 && result.error >= 0;
+}
+
+static bool read_fixture(const char *path, std::vector<column>& columns) {
+    std::ifstream in(path);
+    if (!in) {
+        fprintf(stderr, "%s: can't be read\n", path);
+        return false;
+    }
+    std::string line;
+    for (int number = 1; std::getline(in, line); ++number) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        if (line.compare(0, 5, "zone ") == 0) {
+            const std::string name = line.substr(5);
+            TZID zone = TZID_INVALID;
+            if (name == "unknown") {
+                zone = TZID_INVALID - 1;
+            } else if (name != "-") {
+                zone = timezone_by_name(name.c_str());
+                if (zone == TZID_INVALID) {
+                    fprintf(stderr, "%s:%d: unknown time zone %s\n", path,
+                        number, name.c_str());
+                    return false;
+                }
+            }
+            columns.push_back(column{zone, {}});
+            continue;
+        }
+        row parsed{number, "", 0, 0, 0};
+        if (columns.empty() || !parse_row(line, parsed)) {
+            fprintf(stderr, "%s:%d: malformed\n", path, number);
+            return false;
+        }
+        columns.back().rows.push_back(parsed);
+    }
+    return true;
+}
+
+static void check_column(const char *path, const column& c) {
+    std::string buffer;
+    std::vector<int32_t> offsets{0};
+    int expected_result = 0;
+    for (const row& r : c.rows) {
+        buffer += r.text;
+        offsets.push_back((int32_t)buffer.size());
+        if (r.error != TIMESTAMP_ERROR_NONE)
+            expected_result = -1;
+    }
+    const size_t count = c.rows.size();
+    std::vector<int64_t> epoch_nanos(count);
+    std::vector<uint8_t> formats(count), errors(count);
+    CHECK_EQUAL(parse_timestamps(c.zone, buffer.data(), offsets.data(), count,
+        epoch_nanos.data(), formats.data(), errors.data()), expected_result);
+    for (size_t i = 0; i < count; ++i) {
+        const row& r = c.rows[i];
+        if (epoch_nanos[i] == r.epoch_nanos && formats[i] == r.format &&
+            errors[i] == r.error)
+            continue;
+        fprintf(stderr, "%s:%d: |%s| is %lld %s %s\n", path, r.line,
+            r.text.c_str(), (long long)epoch_nanos[i],
+            formats[i] < 8 ? format_names[formats[i]] : "?",
+            errors[i] < 5 ? error_names[errors[i]] : "?");
+        ++check::failures;
+    }
+    // Without `formats` and `errors`, the instants are the same.
+    std::vector<int64_t> alone(count);
+    parse_timestamps(c.zone, buffer.data(), offsets.data(), count,
+        alone.data(), nullptr, nullptr);
+    CHECK(alone == epoch_nanos);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s detect_fixtures.txt\n", argv[0]);
+        return 2;
+    }
+    std::vector<column> columns;
+    if (!read_fixture(argv[1], columns))
+        return 2;
+    size_t rows = 0;
+    for (const column& c : columns) {
+        check_column(argv[1], c);
+        rows += c.rows.size();
+    }
+    printf("%zu columns, %zu rows\n", columns.size(), rows);
+    return check::exit_code();
+}
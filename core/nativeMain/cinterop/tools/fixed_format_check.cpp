@@ -0,0 +1,178 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that checks the patterns of `fixed_format.hpp`. It is
+   built with the gradle task `buildFixedFormatCheck` and run by
+   `checkNativeFixedFormat`.
+
+   Everything in `fixed_format.hpp` is `constexpr`, so most of the checks
+   are `static_assert`s, which fail the build: the known texts of some
+   instants in several patterns, and the texts that the patterns parse and
+   reject. At run time, every day from year 0 to year 9999, at some time of
+   the day and with some offset, is formatted and parsed back. */
+#include <climits>
+#include <cstdint>
+#include "civil.hpp"
+#include "fixed_format.hpp"
+#include "check.hpp"
+
+static constexpr char iso[] = "%FT%T.%3N%:z";
+static constexpr char ordinal[] = "%Y-%j %u";
+static constexpr char http[] = "%a, %d %b %Y %T";
+static constexpr char compact[] = "%y%m%d%H%M%z";
+static constexpr char nanos[] = "%R:%S.%N%%%t";
+
+template <const char *Pattern>
+struct formatted {
+    size_t length;
+    char text[fixed_format::pattern<Pattern>::length + 1];
+};
+
+template <const char *Pattern>
+constexpr formatted<Pattern> format(int64_t epoch_sec, int32_t nanosecond,
+    int32_t offset_sec)
+{
+    formatted<Pattern> result{};
+    result.length = fixed_format::pattern<Pattern>::format(epoch_sec,
+        nanosecond, offset_sec, result.text);
+    return result;
+}
+
+constexpr size_t length_of(const char *text) {
+    size_t length = 0;
+    while (text[length] != 0)
+        ++length;
+    return length;
+}
+
+constexpr bool equal(const char *a, const char *b) {
+    for (; *a != 0 && *a == *b; ++a, ++b) {}
+    return *a == *b;
+}
+
+// Whether the instant is formatted as `expected`, or not at all if empty.
+template <const char *Pattern>
+constexpr bool formats(int64_t epoch_sec, int32_t nanosecond,
+    int32_t offset_sec, const char *expected)
+{
+    const formatted<Pattern> result =
+        format<Pattern>(epoch_sec, nanosecond, offset_sec);
+    return result.length == length_of(expected) &&
+        equal(result.text, expected);
+}
+
+template <const char *Pattern>
+constexpr bool parses(const char *text, int64_t local_sec,
+    int32_t nanosecond, int32_t offset_sec)
+{
+    fixed_format::parsed result{};
+    return fixed_format::pattern<Pattern>::parse(text,
+        text + length_of(text), result) && result.local_sec == local_sec &&
+        result.nanosecond == nanosecond && result.offset_sec == offset_sec;
+}
+
+template <const char *Pattern>
+constexpr bool rejects(const char *text) {
+    fixed_format::parsed result{};
+    return !fixed_format::pattern<Pattern>::parse(text,
+        text + length_of(text), result);
+}
+
+// 2020-08-30T16:43:00Z, a Sunday, the 243rd day of a leap year.
+constexpr int64_t instant = 1598805780;
+constexpr int64_t day = 1598745600;
+constexpr int32_t india = -(5 * 3600 + 30 * 60);
+
+static_assert(fixed_format::pattern<iso>::length == 29, "");
+static_assert(fixed_format::pattern<ordinal>::length == 10, "");
+static_assert(fixed_format::pattern<http>::length == 25, "");
+
+static_assert(formats<iso>(instant, 123456789, 7200,
+    "2020-08-30T18:43:00.123+02:00"), "");
+static_assert(formats<iso>(instant, 0, india,
+    "2020-08-30T11:13:00.000-05:30"), "");
+static_assert(formats<iso>(-1, 999999999, 0,
+    "1969-12-31T23:59:59.999+00:00"), "");
+static_assert(formats<ordinal>(instant, 0, 0, "2020-243 7"), "");
+static_assert(formats<ordinal>(instant, 0, 8 * 3600, "2020-244 1"), "");
+static_assert(formats<ordinal>(1609459199, 0, 0, "2020-366 4"), "");
+static_assert(formats<http>(instant, 0, 0, "Sun, 30 Aug 2020 16:43:00"), "");
+static_assert(formats<compact>(instant, 0, -3600, "2008301543-0100"), "");
+static_assert(formats<nanos>(instant, 5, 0, "16:43:00.000000005%\t"), "");
+// The years outside [0; 9999] are not formatted.
+static_assert(formats<iso>(-62167219200, 0, 0,
+    "0000-01-01T00:00:00.000+00:00"), "");
+static_assert(formats<iso>(-62167219201, 0, 0, ""), "");
+static_assert(formats<iso>(253402300799, 0, 0,
+    "9999-12-31T23:59:59.000+00:00"), "");
+static_assert(formats<iso>(253402300799, 0, 1, ""), "");
+
+static_assert(parses<iso>("2020-08-30T18:43:00.123+02:00", instant + 7200,
+    123000000, 7200), "");
+static_assert(parses<iso>("2020-08-30T11:13:00.000-05:30", instant + india,
+    0, india), "");
+static_assert(parses<iso>("2020-02-29T00:00:00.000+18:00", 1582934400, 0,
+    18 * 3600), "");
+static_assert(rejects<iso>("2020-08-30T18:43:00.123+02:0"), "");
+static_assert(rejects<iso>("2020-08-30T18:43:00.123+0200 "), "");
+static_assert(rejects<iso>("2020-08-30 18:43:00.123+02:00"), "");
+static_assert(rejects<iso>("2021-02-29T00:00:00.000+00:00"), "");
+static_assert(rejects<iso>("2020-13-01T00:00:00.000+00:00"), "");
+static_assert(rejects<iso>("2020-08-30T24:00:00.000+00:00"), "");
+static_assert(rejects<iso>("2020-08-30T18:43:60.000+00:00"), "");
+static_assert(rejects<iso>("2020-08-30T18:43:00.000+18:01"), "");
+static_assert(rejects<iso>("2020-08-30T18:43:00.000*02:00"), "");
+static_assert(rejects<iso>("2020-08-30T18:43:00.1x3+02:00"), "");
+// Without an offset in the pattern, it is INT_MAX.
+static_assert(parses<ordinal>("2020-243 7", day, 0, INT_MAX), "");
+static_assert(parses<ordinal>("2020-366 4", day + 123 * 86400, 0, INT_MAX),
+    "");
+static_assert(rejects<ordinal>("2020-243 1"), "");
+static_assert(rejects<ordinal>("2020-243 8"), "");
+static_assert(rejects<ordinal>("2021-366 5"), "");
+static_assert(rejects<ordinal>("2020-000 7"), "");
+static_assert(parses<http>("sun, 30 AUG 2020 16:43:00", instant, 0, INT_MAX),
+    "");
+static_assert(rejects<http>("Mon, 30 Aug 2020 16:43:00"), "");
+static_assert(rejects<http>("Sun, 30 Auh 2020 16:43:00"), "");
+// The two digits of the year are in [1969; 2068].
+static_assert(parses<compact>("6901010000+0000", -31536000, 0, 0), "");
+static_assert(parses<compact>("6812312359+0000", 3124223940, 0, 0), "");
+static_assert(parses<nanos>("16:43:00.000000005%\t", 60180, 5, INT_MAX), "");
+static_assert(rejects<nanos>("16:43:00.000000005%%"), "");
+
+/* Every day from year 0 to year 9999, at `second_of_day` and with
+   `offset_sec`, is formatted and parsed back. */
+static void check_round_trips(int64_t second_of_day, int32_t offset_sec) {
+    using iso_pattern = fixed_format::pattern<iso>;
+    using ordinal_pattern = fixed_format::pattern<ordinal>;
+    const int64_t first = civil::days_from_civil(0, 1, 1);
+    const int64_t last = civil::days_from_civil(9999, 12, 31);
+    for (int64_t epoch_day = first; epoch_day <= last; ++epoch_day) {
+        const int64_t local_sec = epoch_day * SECS_PER_DAY + second_of_day;
+        char text[iso_pattern::length];
+        fixed_format::parsed result{};
+        if (!CHECK_EQUAL(iso_pattern::format(local_sec - offset_sec,
+            987000000, offset_sec, text), iso_pattern::length) ||
+            !CHECK(iso_pattern::parse(text, text + sizeof text, result)) ||
+            !CHECK_EQUAL(result.local_sec, local_sec) ||
+            !CHECK_EQUAL(result.nanosecond, 987000000) ||
+            !CHECK_EQUAL(result.offset_sec, offset_sec))
+            return;
+        char ordinal_text[ordinal_pattern::length];
+        if (!CHECK_EQUAL(ordinal_pattern::format(local_sec, 0, 0,
+            ordinal_text), ordinal_pattern::length) ||
+            !CHECK(ordinal_pattern::parse(ordinal_text,
+                ordinal_text + sizeof ordinal_text, result)) ||
+            !CHECK_EQUAL(result.local_sec, epoch_day * SECS_PER_DAY))
+            return;
+    }
+}
+
+int main() {
+    check_round_trips(0, 0);
+    check_round_trips(SECS_PER_DAY - 1, india);
+    check_round_trips(12 * 3600 + 34 * 60 + 56, 14 * 3600);
+    return check::exit_code();
+}
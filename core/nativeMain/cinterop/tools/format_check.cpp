@@ -0,0 +1,253 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that checks the compiled patterns from `format.cpp`.
+   It is built with the gradle task `buildFormatCheck` and run by
+   `checkNativeFormat`.
+
+   Every conversion of `cdate.h` is in some pattern below, and each pattern
+   has enough of them to identify the second. The instants from 1970 to
+   2068, and every 7001 seconds of 2021, around both transitions of
+   Europe/Berlin, are formatted in the UTC and in Berlin and parsed back,
+   one by one and in the batches. Without an offset, a repeated local
+   date-time is parsed as the earlier of its instants. The extreme instants
+   are formatted with `%Y` and `%s` and parsed back too. */
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "civil.hpp"
+#include "check.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+static const struct {
+    const char *text;
+    // the digits of the nanoseconds that are kept.
+    int fraction;
+    // whether the instant is parsed back regardless of the time zone.
+    bool absolute;
+} patterns[] = {
+    {"%Y-%m-%dT%H:%M:%S.%N%z", 9, true},
+    {"%F %T.%6N %:z", 6, true},
+    {"%Y-%j %k:%M:%S.%3N", 3, false},
+    {"%A, %e %B %Y %l:%M:%S %p %Z", 0, false},
+    {"%a %b %-d %-I:%M:%S %p %y %u", 0, false},
+    {"%D %R:%S %w", 0, false},
+    {"%h %_d %Y%n%H%t%M%%%0S", 0, false},
+    {"%s.%N", 9, true},
+    {"%Y%m%d%H%M%S%z", 0, true},
+};
+
+static int32_t truncate(int32_t nanos, int fraction) {
+    int32_t unit = 1;
+    for (int digits = fraction; digits < 9; ++digits)
+        unit *= 10;
+    return nanos / unit * unit;
+}
+
+static bool round_trip(const DATETIME_PATTERN *pattern, int64_t epoch_sec,
+    int32_t nanos, int64_t& parsed_sec, int32_t& parsed_nanos)
+{
+    char text[DATETIME_PATTERN_MAX_LENGTH + 1];
+    const int length = datetime_pattern_format(pattern, epoch_sec, nanos, text,
+        sizeof text);
+    if (!CHECK(length > 0) ||
+        !CHECK((size_t)length <= datetime_pattern_max_length(pattern)) ||
+        !CHECK_EQUAL(strlen(text), length))
+        return false;
+    if (!CHECK_EQUAL(datetime_pattern_parse(pattern, text, (size_t)length,
+        &parsed_sec, &parsed_nanos), 0))
+    {
+        fprintf(stderr, "%lld: %s\n", (long long)epoch_sec, text);
+        return false;
+    }
+    return true;
+}
+
+static void check_pattern(TZID zone, const char *text, int fraction,
+    bool absolute, const std::vector<int64_t>& instants)
+{
+    DATETIME_PATTERN *pattern = datetime_pattern_compile(text, zone);
+    if (!CHECK(pattern != nullptr))
+        return;
+    std::vector<int32_t> nanos(instants.size());
+    for (size_t i = 0; i < instants.size(); ++i) {
+        nanos[i] = (int32_t)(i * 987654321 % 1000000000);
+        int64_t sec = 0;
+        int32_t nano = 0;
+        if (!round_trip(pattern, instants[i], nanos[i], sec, nano))
+            break;
+        CHECK_EQUAL(nano, truncate(nanos[i], fraction));
+        if (sec == instants[i])
+            continue;
+        // The earlier of the instants with the same local date-time.
+        if (absolute || zone == TZID_INVALID || sec > instants[i] ||
+            (int64_t)offset_at_instant(zone, sec) + sec !=
+                (int64_t)offset_at_instant(zone, instants[i]) + instants[i])
+        {
+            fprintf(stderr, "%s: %lld is parsed as %lld\n", text,
+                (long long)instants[i], (long long)sec);
+            ++check::failures;
+            break;
+        }
+    }
+    // The batches give the same as the single instants.
+    const size_t count = instants.size();
+    std::vector<char> buffer(count * datetime_pattern_max_length(pattern));
+    std::vector<int32_t> offsets(count + 1);
+    std::vector<int64_t> secs(count);
+    std::vector<int32_t> parsed_nanos(count);
+    if (CHECK_EQUAL(datetime_pattern_format_batch(pattern, instants.data(),
+        nanos.data(), count, buffer.data(), buffer.size(), offsets.data()),
+        0) &&
+        CHECK_EQUAL(datetime_pattern_parse_batch(pattern, buffer.data(),
+            offsets.data(), count, secs.data(), parsed_nanos.data()), 0))
+    {
+        for (size_t i = 0; i < count; ++i) {
+            int64_t sec = 0;
+            int32_t nano = 0;
+            datetime_pattern_parse(pattern, buffer.data() + offsets[i],
+                (size_t)(offsets[i + 1] - offsets[i]), &sec, &nano);
+            if (!CHECK_EQUAL(secs[i], sec) ||
+                !CHECK_EQUAL(parsed_nanos[i], nano))
+                break;
+        }
+    }
+    // The batch fails on the buffer that is one character too small.
+    CHECK_EQUAL(datetime_pattern_format_batch(pattern, instants.data(),
+        nanos.data(), count, buffer.data(), (size_t)offsets[count] - 1,
+        offsets.data()), -1);
+    datetime_pattern_free(pattern);
+}
+
+static void check_formatted(TZID zone, const char *text, int64_t epoch_sec,
+    int32_t nanos, const char *expected)
+{
+    DATETIME_PATTERN *pattern = datetime_pattern_compile(text, zone);
+    if (!CHECK(pattern != nullptr))
+        return;
+    char buffer[DATETIME_PATTERN_MAX_LENGTH + 1];
+    const int length = datetime_pattern_format(pattern, epoch_sec, nanos,
+        buffer, sizeof buffer);
+    if (!CHECK(length >= 0 && strcmp(buffer, expected) == 0))
+        fprintf(stderr, "%s: %s instead of %s\n", text,
+            length >= 0 ? buffer : "nothing", expected);
+    datetime_pattern_free(pattern);
+}
+
+// The ends of the years, and of `int64_t`, in the UTC.
+static void check_extremes() {
+    const int64_t instants[] = {
+        INT64_MIN, INT64_MIN + 1, -62167219201, -62167219200, 253402300800,
+        INT64_MAX - SECS_PER_DAY, INT64_MAX - 1, INT64_MAX,
+    };
+    for (const char *text : {"%Y-%m-%dT%H:%M:%S%z", "%s", "%Y-%j %T"}) {
+        DATETIME_PATTERN *pattern =
+            datetime_pattern_compile(text, TZID_INVALID);
+        if (!CHECK(pattern != nullptr))
+            continue;
+        for (int64_t instant : instants) {
+            int64_t sec = 0;
+            int32_t nano = 0;
+            if (round_trip(pattern, instant, 0, sec, nano))
+                CHECK_EQUAL(sec, instant);
+        }
+        datetime_pattern_free(pattern);
+    }
+    check_formatted(TZID_INVALID, "%Y-%m-%d", INT64_MAX,
+        0, "+292277026596-12-04");
+    check_formatted(TZID_INVALID, "%Y-%m-%d", INT64_MIN,
+        0, "-292277022657-01-27");
+    check_formatted(TZID_INVALID, "%Y", -62167219201, 0, "-0001");
+    check_formatted(TZID_INVALID, "%Y", 253402300800, 0, "+10000");
+    check_formatted(TZID_INVALID, "%s", INT64_MIN, 0, "-9223372036854775808");
+    // The local date-time of INT64_MAX at +01:00 doesn't fit into `int64_t`.
+    const TZID plus_one = timezone_by_name("Etc/GMT-1");
+    if (CHECK(plus_one != TZID_INVALID)) {
+        DATETIME_PATTERN *pattern = datetime_pattern_compile("%s", plus_one);
+        char buffer[64];
+        CHECK_EQUAL(datetime_pattern_format(pattern, INT64_MAX, 0, buffer,
+            sizeof buffer), -1);
+        datetime_pattern_free(pattern);
+    }
+    // The numbers out of the range of `int64_t` are not parsed.
+    DATETIME_PATTERN *pattern = datetime_pattern_compile("%s", TZID_INVALID);
+    for (const char *text : {"9223372036854775808", "-9223372036854775809",
+        "99999999999999999999", "", "-"})
+    {
+        int64_t sec = 0;
+        int32_t nano = 0;
+        CHECK_EQUAL(datetime_pattern_parse(pattern, text, strlen(text), &sec,
+            &nano), -1);
+    }
+    datetime_pattern_free(pattern);
+}
+
+static void check_texts(TZID berlin) {
+    // 2020-08-30T16:43:00.123456789Z, a Sunday.
+    const int64_t instant = 1598805780;
+    check_formatted(berlin, "%A, %e %B %Y %l:%M:%S %p %Z", instant, 0,
+        "Sunday, 30 August 2020  6:43:00 PM CEST");
+    check_formatted(berlin, "%F %T.%6N %:z", instant, 123456789,
+        "2020-08-30 18:43:00.123456 +02:00");
+    check_formatted(TZID_INVALID, "%a %b %-d %-I:%M:%S %p %y %u", instant, 0,
+        "Sun Aug 30 4:43:00 PM 20 7");
+    check_formatted(TZID_INVALID, "%D %R:%S %w|%_m|%-j|%k", instant, 0,
+        "08/30/20 16:43:00 0| 8|243|16");
+    // The invalid patterns.
+    for (const char *text : {"%", "%q", "%4N", "%:Y", "%-", "%3Y", "%:"})
+        CHECK(datetime_pattern_compile(text, TZID_INVALID) == nullptr);
+    DATETIME_PATTERN *pattern = datetime_pattern_compile(
+        "%a %Y-%m-%d %H:%M %p", TZID_INVALID);
+    for (const char *text : {"Sun 2020-08-30 16:43 AM",
+        "Mon 2020-08-30 16:43 PM", "Sun 2021-02-29 16:43 PM",
+        "Sun 2020-08-30 16:43 PM ", "Sun 2020-08-30 24:43 PM"})
+    {
+        int64_t sec = 0;
+        int32_t nano = 0;
+        CHECK_EQUAL(datetime_pattern_parse(pattern, text, strlen(text), &sec,
+            &nano), -1);
+    }
+    datetime_pattern_free(pattern);
+}
+
+int main() {
+    const TZID berlin = timezone_by_name("Europe/Berlin");
+    if (!CHECK(berlin != TZID_INVALID))
+        return check::exit_code();
+    std::vector<int64_t> instants;
+    // `%y` is only parsed back in [1969; 2068].
+    const int64_t end = civil::days_from_civil(2068, 1, 1) * SECS_PER_DAY;
+    for (int64_t t = 0; t < end; t += 1000003)
+        instants.push_back(t);
+    const int64_t year_2021 = civil::days_from_civil(2021, 1, 1) * SECS_PER_DAY;
+    for (int64_t t = year_2021; t < year_2021 + 365 * SECS_PER_DAY; t += 7001)
+        instants.push_back(t);
+    for (const auto& pattern : patterns) {
+        check_pattern(TZID_INVALID, pattern.text, pattern.fraction,
+            pattern.absolute, instants);
+        check_pattern(berlin, pattern.text, pattern.fraction,
+            pattern.absolute, instants);
+    }
+    // The repeated hour of 2021-10-31 in Berlin, without the offset.
+    DATETIME_PATTERN *pattern = datetime_pattern_compile("%F %T", berlin);
+    int64_t sec = 0;
+    int32_t nano = 0;
+    const int64_t repeated =
+        civil::days_from_civil(2021, 10, 31) * SECS_PER_DAY;
+    if (round_trip(pattern, repeated + 3600, 0, sec, nano))
+        CHECK_EQUAL(sec, repeated);
+    // The skipped hour of 2021-03-28 is shifted forward.
+    const char skipped[] = "2021-03-28 02:30:00";
+    CHECK_EQUAL(datetime_pattern_parse(pattern, skipped, strlen(skipped), &sec,
+        &nano), 0);
+    CHECK_EQUAL(sec, civil::days_from_civil(2021, 3, 28) * SECS_PER_DAY + 3600 +
+        1800);
+    datetime_pattern_free(pattern);
+    check_texts(berlin);
+    check_extremes();
+    return check::exit_code();
+}
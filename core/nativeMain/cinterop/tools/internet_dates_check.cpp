@@ -0,0 +1,208 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that checks the date-times of the Internet protocols
+   from `internet_dates.cpp`. It is built with the gradle task
+   `buildInternetDatesCheck` and run by `checkNativeInternetDates`.
+
+   The examples of RFC 5322, appendix A, and the three forms of an HTTP date
+   of RFC 7231, section 7.1.1.1, are parsed into their known instants, along
+   with the military zones, `-0000`, and the days of the week that don't
+   match the dates, which are rejected. Then, every day of the years
+   [0; 9999] is formatted with each function and parsed back. */
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include "civil.hpp"
+#include "check.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+static int64_t utc(int64_t year, int month, int day, int hour, int minute,
+    int second)
+{
+    return civil::days_from_civil(year, month, day) * SECS_PER_DAY +
+        hour * 3600 + minute * 60 + second;
+}
+
+// Parses RFC 2822, expecting the local date-time and the offset.
+static void check_rfc2822(const char *text, int64_t local_sec,
+    int offset_sec)
+{
+    int64_t epoch_sec = 0;
+    int offset = INT_MAX;
+    if (!CHECK_EQUAL(parse_rfc2822(text, strlen(text), &epoch_sec, &offset),
+        0) || !CHECK_EQUAL(epoch_sec, local_sec - offset_sec) ||
+        !CHECK_EQUAL(offset, offset_sec))
+        fprintf(stderr, "%s\n", text);
+}
+
+static void check_rejected(const char *text) {
+    int64_t epoch_sec = 0;
+    int offset = 0;
+    if (!CHECK_EQUAL(parse_rfc2822(text, strlen(text), &epoch_sec, &offset),
+        -1))
+        fprintf(stderr, "%s\n", text);
+}
+
+static void check_http(const char *text, int64_t expected) {
+    int64_t epoch_sec = 0;
+    const int result = parse_http_date(text, strlen(text), &epoch_sec);
+    if (expected == INT64_MAX ? !CHECK_EQUAL(result, -1) :
+        !CHECK_EQUAL(result, 0) || !CHECK_EQUAL(epoch_sec, expected))
+        fprintf(stderr, "%s\n", text);
+}
+
+// RFC 5322, appendix A.
+static void check_rfc5322_examples() {
+    const int newfoundland = -(3 * 3600 + 30 * 60);
+    check_rfc2822("Fri, 21 Nov 1997 09:55:06 -0600",
+        utc(1997, 11, 21, 9, 55, 6), -6 * 3600);
+    check_rfc2822("Fri, 21 Nov 1997 10:01:10 -0600",
+        utc(1997, 11, 21, 10, 1, 10), -6 * 3600);
+    check_rfc2822("Tue, 1 Jul 2003 10:52:37 +0200",
+        utc(2003, 7, 1, 10, 52, 37), 2 * 3600);
+    check_rfc2822("Thu, 13 Feb 1969 23:32:54 -0330",
+        utc(1969, 2, 13, 23, 32, 54), newfoundland);
+    // A.5, with the folding whitespace and the comments.
+    check_rfc2822("Thu,\r\n      13\r\n        Feb\r\n          1969\r\n"
+        "      23:32\r\n               -0330 (Newfoundland Time)",
+        utc(1969, 2, 13, 23, 32, 0), newfoundland);
+    // A.6.2 and A.6.3, the obsolete syntax.
+    check_rfc2822("21 Nov 97 09:55:06 GMT", utc(1997, 11, 21, 9, 55, 6), 0);
+    check_rfc2822("Fri, 21 Nov 1997 09(comment):   55  :  06 -0600",
+        utc(1997, 11, 21, 9, 55, 6), -6 * 3600);
+    // The two- and three-digit years, and the zone names.
+    check_rfc2822("1 Jan 49 00:00 EST", utc(2049, 1, 1, 0, 0, 0), -5 * 3600);
+    check_rfc2822("1 Jan 50 00:00 PDT", utc(1950, 1, 1, 0, 0, 0), -7 * 3600);
+    check_rfc2822("1 Jan 100 00:00 UT", utc(2000, 1, 1, 0, 0, 0), 0);
+    // A leap second becomes the second before it.
+    check_rfc2822("Sat, 31 Dec 2016 23:59:60 +0000",
+        utc(2016, 12, 31, 23, 59, 59), 0);
+}
+
+// The single letters other than `J` and `-0000` give the zero offset.
+static void check_unknown_offsets() {
+    const int64_t local = utc(1997, 11, 21, 9, 55, 6);
+    for (const char *text : {"Fri, 21 Nov 1997 09:55:06 A",
+        "Fri, 21 Nov 1997 09:55:06 z", "Fri, 21 Nov 1997 09:55:06 M",
+        "Fri, 21 Nov 1997 09:55:06 N", "Fri, 21 Nov 1997 09:55:06 Y",
+        "Fri, 21 Nov 1997 09:55:06 -0000"})
+        check_rfc2822(text, local, 0);
+    check_rejected("Fri, 21 Nov 1997 09:55:06 J");
+    check_rejected("Fri, 21 Nov 1997 09:55:06 AB");
+    check_rejected("Fri, 21 Nov 1997 09:55:06 XYZ");
+    check_rejected("Fri, 21 Nov 1997 09:55:06 +1801");
+    check_rejected("Fri, 21 Nov 1997 09:55:06 +0060");
+    check_rejected("Fri, 21 Nov 1997 09:55:06 +060");
+    check_rejected("Fri, 21 Nov 1997 09:55:06");
+}
+
+// Syntactically valid, but with the wrong days of the week.
+static void check_weekdays() {
+    check_rejected("Sat, 21 Nov 1997 09:55:06 -0600");
+    check_rejected("Thu, 1 Jul 2003 10:52:37 +0200");
+    check_rejected("Fri, 29 Feb 2021 00:00:00 +0000");
+    check_rejected("Xyz, 21 Nov 1997 09:55:06 -0600");
+    check_rejected("Friday, 21 Nov 1997 09:55:06 -0600");
+    check_http("Mon, 06 Nov 1994 08:49:37 GMT", INT64_MAX);
+    check_http("Monday, 06-Nov-94 08:49:37 GMT", INT64_MAX);
+    check_http("Mon Nov  6 08:49:37 1994", INT64_MAX);
+    check_http("Sun, 06 Nov 1994 08:49:37 GMT", 784111777);
+}
+
+// RFC 7231, section 7.1.1.1.
+static void check_http_dates() {
+    const int64_t instant = 784111777;
+    check_http("Sun, 06 Nov 1994 08:49:37 GMT", instant);
+    check_http("Sunday, 06-Nov-94 08:49:37 GMT", instant);
+    check_http("Sun Nov  6 08:49:37 1994", instant);
+    // The years of RFC 850 from 50 are in the 1900s.
+    check_http("Friday, 01-Jan-49 00:00:00 GMT", utc(2049, 1, 1, 0, 0, 0));
+    check_http("Sunday, 01-Jan-50 00:00:00 GMT", utc(1950, 1, 1, 0, 0, 0));
+    check_http("Thu Dec 31 23:59:59 2099", utc(2099, 12, 31, 23, 59, 59));
+    // Only the exact forms, and only in GMT.
+    check_http("Sun, 06 Nov 1994 08:49:37 UTC", INT64_MAX);
+    check_http("Sun, 6 Nov 1994 08:49:37 GMT", INT64_MAX);
+    check_http("Sun, 06 Nov 94 08:49:37 GMT", INT64_MAX);
+    check_http("Sun, 06 Nov 1994 08:49 GMT", INT64_MAX);
+    check_http("Sun, 06 Nov 1994 08:49:37 GMT ", INT64_MAX);
+    check_http("Sun Nov 06 08:49:37 1994 GMT", INT64_MAX);
+    check_http("Sun, 06-Nov-94 08:49:37 GMT", INT64_MAX);
+    check_http("Sun Nov 6 08:49:37 1994", INT64_MAX);
+    check_http("", INT64_MAX);
+}
+
+/* Every day of the years [0; 9999], at `second_of_day` of the local time
+   with `offset_sec`, is formatted and parsed back. */
+static void check_round_trips(int32_t second_of_day, int offset_sec) {
+    static const int32_t fractions[] = {0, 123000000, 123456000, 123456789};
+    const int64_t first = civil::days_from_civil(0, 1, 1);
+    const int64_t last = civil::days_from_civil(9999, 12, 31);
+    for (int64_t epoch_day = first; epoch_day <= last; ++epoch_day) {
+        const int64_t local_sec = epoch_day * SECS_PER_DAY + second_of_day;
+        const int64_t instant = local_sec - offset_sec;
+        const int32_t nanos = fractions[epoch_day & 3];
+        char text[RFC3339_MAX_LENGTH + 1];
+        int64_t sec = 0;
+        int32_t nano = 0;
+        int offset = 0;
+        int length = format_rfc3339(instant, nanos, offset_sec, text,
+            sizeof text);
+        if (!CHECK(length > 0) ||
+            !CHECK_EQUAL(parse_rfc3339(text, (size_t)length, &sec, &nano,
+                &offset), 0) || !CHECK_EQUAL(sec, instant) ||
+            !CHECK_EQUAL(nano, nanos) || !CHECK_EQUAL(offset, offset_sec))
+            return;
+        length = format_rfc2822(instant, offset_sec, text, sizeof text);
+        if (!CHECK(length > 0 && length <= RFC2822_MAX_LENGTH) ||
+            !CHECK_EQUAL(parse_rfc2822(text, (size_t)length, &sec, &offset),
+                0) || !CHECK_EQUAL(sec, instant) ||
+            !CHECK_EQUAL(offset, offset_sec))
+            return;
+        // The HTTP dates are in the UTC.
+        length = format_imf_fixdate(local_sec, text, sizeof text);
+        if (!CHECK_EQUAL(length, IMF_FIXDATE_LENGTH) ||
+            !CHECK_EQUAL(parse_http_date(text, (size_t)length, &sec), 0) ||
+            !CHECK_EQUAL(sec, local_sec))
+            return;
+    }
+}
+
+static void check_range() {
+    char text[RFC3339_MAX_LENGTH + 1];
+    const int64_t first = utc(0, 1, 1, 0, 0, 0);
+    const int64_t end = utc(10000, 1, 1, 0, 0, 0);
+    // The local date-times have to be in the years [0; 9999].
+    CHECK_EQUAL(format_rfc3339(first - 1, 0, 0, text, sizeof text), -1);
+    CHECK_EQUAL(format_rfc3339(first, 0, -60, text, sizeof text), -1);
+    CHECK(format_rfc3339(first, 0, 60, text, sizeof text) > 0);
+    CHECK_EQUAL(format_rfc2822(end - 60, 60, text, sizeof text), -1);
+    CHECK_EQUAL(format_imf_fixdate(end, text, sizeof text), -1);
+    CHECK_EQUAL(format_imf_fixdate(INT64_MIN, text, sizeof text), -1);
+    CHECK_EQUAL(format_rfc3339(INT64_MAX, 0, 0, text, sizeof text), -1);
+    // The buffer has to have room for the zero.
+    CHECK_EQUAL(format_imf_fixdate(0, text, IMF_FIXDATE_LENGTH), -1);
+    CHECK_EQUAL(format_imf_fixdate(0, text, IMF_FIXDATE_LENGTH + 1),
+        IMF_FIXDATE_LENGTH);
+    CHECK(strcmp(text, "Thu, 01 Jan 1970 00:00:00 GMT") == 0);
+    CHECK_EQUAL(format_rfc3339(0, 1000000000, 0, text, sizeof text), -1);
+    CHECK_EQUAL(format_rfc3339(0, 0, 18 * 3600 + 60, text, sizeof text), -1);
+    CHECK_EQUAL(format_rfc3339(0, 0, 0, text, sizeof text), 20);
+    CHECK(strcmp(text, "1970-01-01T00:00:00Z") == 0);
+}
+
+int main() {
+    check_rfc5322_examples();
+    check_unknown_offsets();
+    check_weekdays();
+    check_http_dates();
+    check_round_trips(0, 0);
+    check_round_trips(SECS_PER_DAY - 1, -(9 * 3600 + 30 * 60));
+    check_round_trips(12 * 3600 + 34 * 60 + 56, 14 * 3600);
+    check_range();
+    return check::exit_code();
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that checks `convert_time_scale` from
+   `leap_seconds.cpp` against the leap seconds published by the IERS, with
+   the TAI - UTC after each of them. It is built with the gradle task
+   `buildLeapSecondsCheck` and run by `checkNativeLeapSeconds`.
+
+   Around every leap second, the Unix time, the UTC, the TAI and the GPS
+   time must agree with the table, the leap second itself must become the
+   last nanosecond before it in the Unix time, and the smear must start and
+   end at the noons around it. The timestamps near the ends of `int64_t`
+   must saturate instead of overflowing. */
+#include <climits>
+#include <cstdint>
+#include "civil.hpp"
+#include "check.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+#define NANOS_PER_SEC 1000000000LL
+
+struct leap_second {
+    // The date right after the leap second.
+    int year;
+    int month;
+    // TAI - UTC from that date, in seconds.
+    int tai_minus_utc;
+};
+
+// From the IERS `leap-seconds.list`.
+static const leap_second known_leap_seconds[] = {
+    {1972, 7, 11}, {1973, 1, 12}, {1974, 1, 13}, {1975, 1, 14},
+    {1976, 1, 15}, {1977, 1, 16}, {1978, 1, 17}, {1979, 1, 18},
+    {1980, 1, 19}, {1981, 7, 20}, {1982, 7, 21}, {1983, 7, 22},
+    {1985, 7, 23}, {1988, 1, 24}, {1990, 1, 25}, {1991, 1, 26},
+    {1992, 7, 27}, {1993, 7, 28}, {1994, 7, 29}, {1996, 1, 30},
+    {1997, 7, 31}, {1999, 1, 32}, {2006, 1, 33}, {2009, 1, 34},
+    {2012, 7, 35}, {2015, 7, 36}, {2017, 1, 37},
+};
+
+// TAI - UTC on 1972-01-01, when the UTC got its leap seconds.
+static const int initial_tai_minus_utc = 10;
+// The TAI counts from 1958-01-01, and the GPS time from 1980-01-06.
+static const int64_t tai_epoch_day = civil::days_from_civil(1958, 1, 1);
+static const int64_t gps_epoch_day = civil::days_from_civil(1980, 1, 6);
+// TAI - GPS, in seconds.
+static const int tai_minus_gps = 19;
+
+static int64_t convert(TIME_SCALE from, TIME_SCALE to, int64_t nanos) {
+    int64_t result = 0;
+    CHECK_EQUAL(convert_time_scale(from, to, &nanos, &result, 1), 0);
+    return result;
+}
+
+static int64_t seconds(int64_t count) {
+    return count * NANOS_PER_SEC;
+}
+
+/* Checks the time scales at `unix_sec`, when TAI - UTC is `tai_minus_utc`,
+   from the Unix time to the others and back. */
+static void check_scales(int64_t unix_sec, int tai_minus_utc) {
+    const int64_t unix_nanos = seconds(unix_sec);
+    const int64_t utc =
+        seconds(unix_sec + tai_minus_utc - initial_tai_minus_utc);
+    const int64_t tai =
+        utc + seconds(initial_tai_minus_utc - tai_epoch_day * 86400);
+    const int64_t gps = tai -
+        seconds(tai_minus_gps + (gps_epoch_day - tai_epoch_day) * 86400);
+    CHECK_EQUAL(convert(TIME_SCALE_UNIX, TIME_SCALE_UTC, unix_nanos), utc);
+    CHECK_EQUAL(convert(TIME_SCALE_UNIX, TIME_SCALE_TAI, unix_nanos), tai);
+    CHECK_EQUAL(convert(TIME_SCALE_UNIX, TIME_SCALE_GPS, unix_nanos), gps);
+    CHECK_EQUAL(convert(TIME_SCALE_UTC, TIME_SCALE_UNIX, utc), unix_nanos);
+    CHECK_EQUAL(convert(TIME_SCALE_TAI, TIME_SCALE_UNIX, tai), unix_nanos);
+    CHECK_EQUAL(convert(TIME_SCALE_GPS, TIME_SCALE_UNIX, gps), unix_nanos);
+    CHECK_EQUAL(convert(TIME_SCALE_TAI, TIME_SCALE_GPS, tai), gps);
+}
+
+static void check_leap_second(const leap_second& leap, int previous) {
+    const int64_t midnight =
+        civil::days_from_civil(leap.year, leap.month, 1) * 86400;
+    check_scales(midnight, leap.tai_minus_utc);
+    check_scales(midnight + 86400, leap.tai_minus_utc);
+    check_scales(midnight - 1, previous);
+    check_scales(midnight - 86400, previous);
+    // 23:59:60 and its last nanosecond.
+    const int64_t leap_utc =
+        seconds(midnight + previous - initial_tai_minus_utc);
+    CHECK_EQUAL(convert(TIME_SCALE_UTC, TIME_SCALE_UNIX, leap_utc),
+        seconds(midnight) - 1);
+    CHECK_EQUAL(convert(TIME_SCALE_UTC, TIME_SCALE_UNIX,
+        leap_utc + seconds(1) - 1), seconds(midnight) - 1);
+    CHECK_EQUAL(convert(TIME_SCALE_UNIX, TIME_SCALE_UTC, seconds(midnight) - 1),
+        leap_utc - 1);
+    // The smear passes the 86401 seconds from noon to noon in 86400.
+    const int64_t smear_start = seconds(midnight - 43200);
+    const int64_t smear_end = seconds(midnight + 43200);
+    const int64_t utc_start = leap_utc - seconds(43200);
+    const int64_t utc_end = leap_utc + seconds(43201);
+    CHECK_EQUAL(convert(TIME_SCALE_UTC, TIME_SCALE_UNIX_SMEARED, utc_start),
+        smear_start);
+    CHECK_EQUAL(convert(TIME_SCALE_UTC, TIME_SCALE_UNIX_SMEARED, utc_end),
+        smear_end);
+    CHECK_EQUAL(convert(TIME_SCALE_UNIX_SMEARED, TIME_SCALE_UTC, smear_start),
+        utc_start);
+    CHECK_EQUAL(convert(TIME_SCALE_UNIX_SMEARED, TIME_SCALE_UTC, smear_end),
+        utc_end);
+    CHECK_EQUAL(convert(TIME_SCALE_UNIX_SMEARED, TIME_SCALE_UNIX,
+        smear_start - 1), smear_start - 1);
+    CHECK_EQUAL(convert(TIME_SCALE_UNIX_SMEARED, TIME_SCALE_UNIX, smear_end),
+        smear_end);
+    // Halfway, the smeared clock is half a second behind the UTC.
+    CHECK_EQUAL(convert(TIME_SCALE_UTC, TIME_SCALE_UNIX_SMEARED,
+        leap_utc + seconds(1) / 2), seconds(midnight));
+}
+
+static void check_saturation() {
+    const TIME_SCALE scales[] = {TIME_SCALE_UNIX, TIME_SCALE_UNIX_SMEARED,
+        TIME_SCALE_UTC, TIME_SCALE_TAI, TIME_SCALE_GPS};
+    for (TIME_SCALE from : scales) {
+        for (TIME_SCALE to : scales) {
+            CHECK(convert(from, to, INT64_MAX) > seconds(4102444800));
+            CHECK(convert(from, to, INT64_MIN) < seconds(-2208988800));
+        }
+    }
+    CHECK_EQUAL(convert(TIME_SCALE_UNIX, TIME_SCALE_UTC, INT64_MAX), INT64_MAX);
+    CHECK_EQUAL(convert(TIME_SCALE_UNIX, TIME_SCALE_TAI, INT64_MAX), INT64_MAX);
+    CHECK_EQUAL(convert(TIME_SCALE_UNIX_SMEARED, TIME_SCALE_UTC, INT64_MAX),
+        INT64_MAX);
+    CHECK_EQUAL(convert(TIME_SCALE_UTC, TIME_SCALE_UNIX, INT64_MIN), INT64_MIN);
+    CHECK_EQUAL(convert(TIME_SCALE_TAI, TIME_SCALE_UNIX, INT64_MIN), INT64_MIN);
+    CHECK_EQUAL(convert(TIME_SCALE_GPS, TIME_SCALE_TAI, INT64_MAX), INT64_MAX);
+}
+
+int main() {
+    int previous = initial_tai_minus_utc;
+    check_scales(civil::days_from_civil(1972, 1, 1) * 86400, previous);
+    for (const leap_second& leap : known_leap_seconds) {
+        check_leap_second(leap, previous);
+        previous = leap.tai_minus_utc;
+    }
+    // No leap second has been announced since.
+    check_scales(civil::days_from_civil(2025, 1, 1) * 86400, previous);
+    check_saturation();
+    int64_t value = 0;
+    CHECK_EQUAL(convert_time_scale((TIME_SCALE)-1, TIME_SCALE_UNIX, &value,
+        &value, 1), -1);
+    return check::exit_code();
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that checks the packed date-times from `packed.cpp`.
+   It is built with the gradle task `buildPackedCheck` and run by
+   `checkNativePacked`.
+
+   The fields are packed and unpacked back, the packed values are ordered
+   like the date-times, and the instants packed in Europe/Berlin are
+   converted back, with their offsets and without them. Every value that
+   `pack_datetimes` can't have written, with any of its fields out of
+   range, must fail to convert to an instant instead of giving some. */
+#include <climits>
+#include <cstdint>
+#include <vector>
+#include "civil.hpp"
+#include "check.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+static LOCAL_DATETIME_FIELDS fields_of(int32_t year, int month, int day,
+    int hour, int minute, int second, int32_t offset_sec)
+{
+    return LOCAL_DATETIME_FIELDS{year, (int8_t)month, (int8_t)day,
+        (int8_t)hour, (int8_t)minute, (int8_t)second, 0, offset_sec};
+}
+
+/* The bits of the fields, as described in `cdate.h`, with any values that
+   fit into them. */
+static PACKED_DATETIME bits_of(int64_t year, uint64_t month, uint64_t day,
+    uint64_t hour, uint64_t minute, uint64_t second, uint64_t offset)
+{
+    return (PACKED_DATETIME)(((uint64_t)year << 43) | (month << 39) |
+        (day << 34) | (hour << 29) | (minute << 23) | (second << 17) |
+        offset);
+}
+
+// The packed bits of the unknown offset and of the zero one.
+#define UNKNOWN 0x1ffff
+#define ZERO 64800
+
+static PACKED_DATETIME pack(const LOCAL_DATETIME_FIELDS& fields) {
+    PACKED_DATETIME packed = 0;
+    pack_datetimes(&fields, &packed, nullptr, 1);
+    return packed;
+}
+
+static int64_t to_instant(TZID zone, PACKED_DATETIME packed) {
+    int64_t epoch_sec = 0;
+    packed_datetimes_to_instants(zone, &packed, &epoch_sec, 1);
+    return epoch_sec;
+}
+
+static int64_t local_sec(int64_t year, int month, int day) {
+    return civil::days_from_civil(year, month, day) * SECS_PER_DAY;
+}
+
+static void check_fields() {
+    const LOCAL_DATETIME_FIELDS valid[] = {
+        fields_of(2020, 8, 30, 18, 43, 0, 7200),
+        fields_of(2020, 2, 29, 23, 59, 59, INT_MAX),
+        fields_of(-999999, 1, 1, 0, 0, 0, -18 * 3600),
+        fields_of(999999, 12, 31, 23, 59, 59, 18 * 3600),
+        fields_of(-1, 12, 31, 12, 0, 0, 0),
+    };
+    for (const LOCAL_DATETIME_FIELDS& f : valid) {
+        PACKED_DATETIME packed = 0;
+        int32_t nanosecond = 0;
+        LOCAL_DATETIME_FIELDS unpacked{};
+        CHECK_EQUAL(pack_datetimes(&f, &packed, &nanosecond, 1), 0);
+        unpack_datetimes(&packed, &nanosecond, &unpacked, 1);
+        CHECK(unpacked.year == f.year && unpacked.month == f.month &&
+            unpacked.day == f.day && unpacked.hour == f.hour &&
+            unpacked.minute == f.minute && unpacked.second == f.second &&
+            unpacked.offset_sec == f.offset_sec);
+    }
+    const LOCAL_DATETIME_FIELDS invalid[] = {
+        fields_of(1000000, 1, 1, 0, 0, 0, 0),
+        fields_of(-1000000, 12, 31, 0, 0, 0, 0),
+        fields_of(2020, 0, 1, 0, 0, 0, 0),
+        fields_of(2020, 13, 1, 0, 0, 0, 0),
+        fields_of(2021, 2, 29, 0, 0, 0, 0),
+        fields_of(2020, 1, 1, 24, 0, 0, 0),
+        fields_of(2020, 1, 1, 0, 60, 0, 0),
+        fields_of(2020, 1, 1, 0, 0, -1, 0),
+        fields_of(2020, 1, 1, 0, 0, 0, 18 * 3600 + 1),
+    };
+    for (const LOCAL_DATETIME_FIELDS& f : invalid) {
+        PACKED_DATETIME packed = 0;
+        CHECK_EQUAL(pack_datetimes(&f, &packed, nullptr, 1), -1);
+        CHECK_EQUAL(packed, INT64_MIN);
+    }
+    // The packed values are ordered by the date-time, then by the offset.
+    CHECK(pack(fields_of(-1, 12, 31, 23, 59, 59, INT_MAX)) <
+        pack(fields_of(0, 1, 1, 0, 0, 0, -18 * 3600)));
+    CHECK(pack(fields_of(2020, 1, 31, 23, 0, 0, 0)) <
+        pack(fields_of(2020, 2, 1, 0, 0, 0, 0)));
+    CHECK(pack(fields_of(2020, 1, 1, 0, 0, 0, 3600)) <
+        pack(fields_of(2020, 1, 1, 0, 0, 0, INT_MAX)));
+}
+
+static void check_instants(TZID berlin) {
+    // Every 7001 seconds of 2021, around both transitions.
+    std::vector<int64_t> instants;
+    for (int64_t t = local_sec(2021, 1, 1); t < local_sec(2022, 1, 1);
+        t += 7001)
+        instants.push_back(t);
+    const size_t count = instants.size();
+    std::vector<PACKED_DATETIME> packed(count);
+    std::vector<int64_t> back(count);
+    CHECK_EQUAL(pack_instants(berlin, instants.data(), packed.data(), count),
+        0);
+    CHECK_EQUAL(packed_datetimes_to_instants(TZID_INVALID, packed.data(),
+        back.data(), count), 0);
+    CHECK(back == instants);
+    /* Without the offsets, the local date-times are resolved in Berlin,
+       which gives the same except in the repeated hour of 2021-10-31. */
+    const int64_t repeated = local_sec(2021, 10, 31);
+    for (size_t i = 0; i < count; ++i) {
+        packed[i] |= UNKNOWN;
+        const int64_t instant = to_instant(berlin, packed[i]);
+        if (instants[i] >= repeated + 3600 && instants[i] < repeated + 7200)
+            CHECK_EQUAL(instant, instants[i] - 3600);
+        else if (!CHECK_EQUAL(instant, instants[i]))
+            break;
+    }
+    CHECK_EQUAL(to_instant(TZID_INVALID, packed[0]), INT64_MAX);
+    // The ends of the years, with the offsets of both signs.
+    CHECK_EQUAL(to_instant(TZID_INVALID,
+        pack(fields_of(-999999, 1, 1, 0, 0, 0, 18 * 3600))),
+        local_sec(-999999, 1, 1) - 18 * 3600);
+    CHECK_EQUAL(to_instant(TZID_INVALID,
+        pack(fields_of(999999, 12, 31, 23, 59, 59, -18 * 3600))),
+        local_sec(1000000, 1, 1) - 1 + 18 * 3600);
+    PACKED_DATETIME end = 0;
+    const int64_t beyond = local_sec(1000000, 1, 1) - 3600;
+    CHECK_EQUAL(pack_instants(berlin, &beyond, &end, 1), -1);
+    CHECK_EQUAL(end, INT64_MIN);
+}
+
+// The values that `pack_datetimes` can't have written.
+static void check_invalid(TZID berlin) {
+    const PACKED_DATETIME valid = bits_of(2020, 8, 30, 16, 43, 0, ZERO);
+    const PACKED_DATETIME invalid[] = {
+        INT64_MIN, INT64_MAX, -1, 0,
+        bits_of(1000000, 1, 1, 0, 0, 0, ZERO),
+        bits_of(-1048576, 1, 1, 0, 0, 0, ZERO),
+        bits_of(2020, 0, 1, 0, 0, 0, ZERO),
+        bits_of(2020, 13, 1, 0, 0, 0, UNKNOWN),
+        bits_of(2020, 15, 1, 0, 0, 0, ZERO),
+        bits_of(2020, 1, 0, 0, 0, 0, ZERO),
+        bits_of(2020, 4, 31, 0, 0, 0, ZERO),
+        bits_of(2021, 2, 29, 0, 0, 0, UNKNOWN),
+        bits_of(2020, 1, 1, 24, 0, 0, ZERO),
+        bits_of(2020, 1, 1, 31, 0, 0, UNKNOWN),
+        bits_of(2020, 1, 1, 0, 60, 0, ZERO),
+        bits_of(2020, 1, 1, 0, 0, 63, ZERO),
+        bits_of(2020, 1, 1, 0, 0, 0, 2 * 64800 + 1),
+        bits_of(2020, 1, 1, 0, 0, 0, UNKNOWN - 1),
+    };
+    const size_t count = sizeof invalid / sizeof invalid[0];
+    for (size_t i = 0; i < count; ++i) {
+        // Between two valid values, which are still converted.
+        const PACKED_DATETIME batch[] = {valid, invalid[i], valid};
+        int64_t epoch_secs[3] = {0, 0, 0};
+        CHECK_EQUAL(packed_datetimes_to_instants(berlin, batch, epoch_secs,
+            3), -1);
+        if (!CHECK_EQUAL(epoch_secs[1], INT64_MAX))
+            fprintf(stderr, "%zu: %016llx\n", i,
+                (unsigned long long)invalid[i]);
+        CHECK_EQUAL(epoch_secs[0], 1598805780);
+        CHECK_EQUAL(epoch_secs[2], 1598805780);
+    }
+    // The largest offsets are still valid.
+    CHECK_EQUAL(to_instant(berlin, bits_of(2020, 1, 1, 0, 0, 0, 2 * 64800)),
+        local_sec(2020, 1, 1) - 64800);
+    CHECK_EQUAL(to_instant(berlin, bits_of(2020, 1, 1, 0, 0, 0, 0)),
+        local_sec(2020, 1, 1) + 64800);
+}
+
+int main() {
+    check_fields();
+    const TZID berlin = timezone_by_name("Europe/Berlin");
+    if (!CHECK(berlin != TZID_INVALID))
+        return check::exit_code();
+    check_instants(berlin);
+    check_invalid(berlin);
+    return check::exit_code();
+}
@@ -0,0 +1,310 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that checks the ISO 8601 periods from `periods.cpp`.
+   It is built with the gradle task `buildPeriodsCheck` and run by
+   `checkNativePeriods`.
+
+   `format_period` is compared with a copy of `DateTimePeriod.toString` for
+   the periods where the two must agree, and with known texts where they
+   differ, as described in `cdate.h`. Every period that can be formatted
+   must be parsed back into itself, with the nanoseconds added to the
+   seconds, including the components of INT32_MIN and INT64_MIN, which are
+   written negated. */
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "check.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+#define NANOS_PER_SEC 1000000000LL
+
+static DATETIME_PERIOD period_of(int32_t years, int32_t months, int32_t days,
+    int32_t hours, int32_t minutes, int64_t seconds, int64_t nanoseconds)
+{
+    return DATETIME_PERIOD{years, months, days, hours, minutes, seconds,
+        nanoseconds};
+}
+
+static bool operator==(const DATETIME_PERIOD& a, const DATETIME_PERIOD& b) {
+    return a.years == b.years && a.months == b.months && a.days == b.days &&
+        a.hours == b.hours && a.minutes == b.minutes &&
+        a.seconds == b.seconds && a.nanoseconds == b.nanoseconds;
+}
+
+// `format_period`, or "-1" if it fails.
+static std::string format(const DATETIME_PERIOD& period) {
+    char buffer[DATETIME_PERIOD_MAX_LENGTH];
+    const int length = format_period(&period, buffer, sizeof buffer);
+    return length < 0 ? "-1" : std::string(buffer, (size_t)length);
+}
+
+static bool parse(const std::string& text, DATETIME_PERIOD& period) {
+    return parse_period(text.data(), text.size(), &period) == 0;
+}
+
+/* `DateTimePeriod.toString` from `DateTimePeriod.kt`, with its overflows of
+   `Int` and `Long`. */
+static std::string to_string(const DATETIME_PERIOD& p) {
+    const bool all_not_positive = p.years <= 0 && p.months <= 0 &&
+        p.days <= 0 && p.hours <= 0 && p.minutes <= 0 && p.seconds <= 0 &&
+        p.nanoseconds <= 0 && !(p == DATETIME_PERIOD());
+    const int sign = all_not_positive ? -1 : 1;
+    const auto times_sign32 = [sign](int32_t value) {
+        return std::to_string((int32_t)((uint32_t)value * (uint32_t)sign));
+    };
+    const auto times_sign64 = [sign](int64_t value) {
+        return std::to_string((int64_t)((uint64_t)value * (uint64_t)sign));
+    };
+    std::string result = all_not_positive ? "-P" : "P";
+    if (p.years != 0)
+        result += times_sign32(p.years) + 'Y';
+    if (p.months != 0)
+        result += times_sign32(p.months) + 'M';
+    if (p.days != 0)
+        result += times_sign32(p.days) + 'D';
+    std::string t = "T";
+    if (p.hours != 0) {
+        result += t + times_sign32(p.hours) + 'H';
+        t = "";
+    }
+    if (p.minutes != 0) {
+        result += t + times_sign32(p.minutes) + 'M';
+        t = "";
+    }
+    if (p.seconds != 0 || p.nanoseconds != 0) {
+        result += t + times_sign64(p.seconds);
+        if (p.nanoseconds != 0) {
+            std::string nanos = times_sign64(p.nanoseconds);
+            if (nanos.size() < 9)
+                nanos.insert(0, 9 - nanos.size(), '0');
+            result += '.' + nanos;
+        }
+        result += 'S';
+    }
+    if (result.size() == 1)
+        result += "0D";
+    return result;
+}
+
+/* Whether `format_period` must give the same as `DateTimePeriod.toString`:
+   the nanoseconds are zero or less than a second with the sign of the
+   period, the seconds don't have the opposite sign, and nothing negated is
+   INT32_MIN or INT64_MIN. */
+static bool agrees_with_to_string(const DATETIME_PERIOD& p) {
+    const bool negative = to_string(p)[0] == '-';
+    const int sign = negative ? -1 : 1;
+    if (negative && (p.years == INT32_MIN || p.months == INT32_MIN ||
+        p.days == INT32_MIN || p.hours == INT32_MIN ||
+        p.minutes == INT32_MIN || p.seconds == INT64_MIN ||
+        p.nanoseconds == INT64_MIN))
+        return false;
+    return p.nanoseconds == 0 || (p.nanoseconds * sign > 0 &&
+        p.nanoseconds * sign < NANOS_PER_SEC && p.seconds * sign >= 0);
+}
+
+/* The period with the nanoseconds added to the seconds and the rest with
+   their sign, or false if the seconds don't fit. */
+static bool normalized(const DATETIME_PERIOD& p, DATETIME_PERIOD& result) {
+    const __int128 total = (__int128)p.seconds * NANOS_PER_SEC + p.nanoseconds;
+    const __int128 seconds = total / NANOS_PER_SEC;
+    if (seconds < INT64_MIN || seconds > INT64_MAX)
+        return false;
+    result = p;
+    result.seconds = (int64_t)seconds;
+    result.nanoseconds = (int64_t)(total % NANOS_PER_SEC);
+    return true;
+}
+
+static void check_period(const DATETIME_PERIOD& period) {
+    const std::string text = format(period);
+    DATETIME_PERIOD expected;
+    if (!normalized(period, expected)) {
+        CHECK(text == "-1");
+        return;
+    }
+    if (!CHECK(text != "-1"))
+        return;
+    if (agrees_with_to_string(period) && text != to_string(period)) {
+        fprintf(stderr, "%s is not %s\n", text.c_str(),
+            to_string(period).c_str());
+        ++check::failures;
+    }
+    DATETIME_PERIOD parsed;
+    if (!parse(text, parsed) || !(parsed == expected)) {
+        fprintf(stderr, "%s is not parsed back\n", text.c_str());
+        ++check::failures;
+    }
+}
+
+static void check_format() {
+    const struct {
+        DATETIME_PERIOD period;
+        const char *text;
+    } known[] = {
+        {period_of(0, 0, 0, 0, 0, 0, 0), "P0D"},
+        {period_of(1, 2, 3, 4, 5, 6, 789000000), "P1Y2M3DT4H5M6.789000000S"},
+        {period_of(-1, -2, 0, 0, 0, 0, 0), "-P1Y2M"},
+        {period_of(1, -2, 0, -4, 0, 0, 0), "P1Y-2MT-4H"},
+        {period_of(0, 0, 0, 0, 5, 0, 0), "PT5M"},
+        {period_of(0, 0, 0, 0, 0, 0, -1), "-PT0.000000001S"},
+        // Where `DateTimePeriod.toString` differs.
+        {period_of(0, 0, 0, 0, 0, 1, -5), "PT0.999999995S"},
+        {period_of(0, 0, 0, 0, 0, 1, 1500000000), "PT2.500000000S"},
+        {period_of(0, 0, 0, 0, 0, -1, 500000000), "PT-0.500000000S"},
+        {period_of(1, 0, 0, 0, 0, 0, -500000000), "P1YT-0.500000000S"},
+        {period_of(1, 0, 0, 0, 0, -1, -500000000), "P1YT-1.500000000S"},
+        {period_of(0, 0, 0, 0, 0, 0, 3 * NANOS_PER_SEC), "PT3S"},
+        {period_of(INT32_MIN, 0, 0, 0, 0, 0, 0), "-P2147483648Y"},
+        {period_of(0, 0, 0, 0, 0, INT64_MIN, 0),
+            "-PT9223372036854775808S"},
+        {period_of(0, 0, 0, 0, 0, INT64_MIN + 1, -NANOS_PER_SEC),
+            "-PT9223372036854775808S"},
+        {period_of(0, 0, 0, 0, 0, INT64_MAX, NANOS_PER_SEC), "-1"},
+        {period_of(0, 0, 0, 0, 0, INT64_MIN, -1),
+            "-PT9223372036854775808.000000001S"},
+        {period_of(0, 0, 0, 0, 0, INT64_MIN, -NANOS_PER_SEC), "-1"},
+    };
+    for (const auto& k : known) {
+        const std::string text = format(k.period);
+        if (text != k.text) {
+            fprintf(stderr, "%s instead of %s\n", text.c_str(), k.text);
+            ++check::failures;
+        }
+        check_period(k.period);
+    }
+    CHECK(to_string(period_of(0, 0, 0, 0, 0, 1, -5)) == "PT1.0000000-5S");
+    CHECK(to_string(period_of(0, 0, 0, 0, 0, 1, 1500000000)) ==
+        "PT1.1500000000S");
+    /* The longest period fits with its zero, which needs a byte more than
+       its length. */
+    const DATETIME_PERIOD longest = period_of(INT32_MIN, INT32_MAX,
+        INT32_MIN, INT32_MIN, INT32_MIN, INT64_MIN, -999999999);
+    char buffer[DATETIME_PERIOD_MAX_LENGTH];
+    const int length = format_period(&longest, buffer, sizeof buffer);
+    CHECK_EQUAL(length, 92);
+    CHECK_EQUAL(format_period(&longest, buffer, (size_t)length), -1);
+}
+
+// The components of the periods, many of them at the ends of their ranges.
+static void check_many() {
+    const int32_t fields[] = {0, 0, 1, -1, 59, -61, INT32_MAX, INT32_MIN,
+        INT32_MIN + 1};
+    const int64_t seconds[] = {0, 0, 1, -1, 3600, INT64_MAX, INT64_MIN,
+        INT64_MIN + 1};
+    const int64_t nanoseconds[] = {0, 1, -1, 999999999, -999999999,
+        NANOS_PER_SEC, -2500000000, INT64_MAX, INT64_MIN};
+    uint64_t random = 88172645463325252u;
+    const auto next = [&random](size_t count) {
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        return random % count;
+    };
+    const size_t field_count = sizeof fields / sizeof fields[0];
+    for (int i = 0; i < 200000; ++i) {
+        check_period(period_of(fields[next(field_count)],
+            fields[next(field_count)], fields[next(field_count)],
+            fields[next(field_count)], fields[next(field_count)],
+            seconds[next(sizeof seconds / sizeof seconds[0])],
+            nanoseconds[next(sizeof nanoseconds / sizeof nanoseconds[0])]));
+        if (check::failures > 20)
+            return;
+    }
+}
+
+static void check_parse() {
+    const struct {
+        const char *text;
+        DATETIME_PERIOD period;
+    } known[] = {
+        {"P2W", period_of(0, 0, 14, 0, 0, 0, 0)},
+        {"P1W3D", period_of(0, 0, 10, 0, 0, 0, 0)},
+        {"p1y2m3dt4h5m6,5s", period_of(1, 2, 3, 4, 5, 6, 500000000)},
+        {"+P1Y", period_of(1, 0, 0, 0, 0, 0, 0)},
+        {"-P1Y-2M", period_of(-1, 2, 0, 0, 0, 0, 0)},
+        {"PT-0.5S", period_of(0, 0, 0, 0, 0, 0, -500000000)},
+        {"-PT-0.5S", period_of(0, 0, 0, 0, 0, 0, 500000000)},
+        {"-PT1.000000001S", period_of(0, 0, 0, 0, 0, -1, -1)},
+        // The negation of INT32_MIN and INT64_MIN.
+        {"P-2147483648Y", period_of(INT32_MIN, 0, 0, 0, 0, 0, 0)},
+        {"-P2147483648Y", period_of(INT32_MIN, 0, 0, 0, 0, 0, 0)},
+        {"-P2147483647M", period_of(0, -INT32_MAX, 0, 0, 0, 0, 0)},
+        {"-PT2147483648H", period_of(0, 0, 0, INT32_MIN, 0, 0, 0)},
+        {"PT-9223372036854775808S", period_of(0, 0, 0, 0, 0, INT64_MIN, 0)},
+        {"-PT9223372036854775808S", period_of(0, 0, 0, 0, 0, INT64_MIN, 0)},
+        {"-PT9223372036854775807.999999999S",
+            period_of(0, 0, 0, 0, 0, -INT64_MAX, -999999999)},
+        {"-P306783378W", period_of(0, 0, -2147483646, 0, 0, 0, 0)},
+    };
+    for (const auto& k : known) {
+        DATETIME_PERIOD period;
+        if (!parse(k.text, period) || !(period == k.period)) {
+            fprintf(stderr, "%s is not parsed\n", k.text);
+            ++check::failures;
+        }
+    }
+    const char *const invalid[] = {
+        "", "P", "-P", "PT", "P1", "1Y", "P1S", "PT1Y", "P1D2Y", "P1YT",
+        "P1.5Y", "PT1.S", "PT1.1234567890S", "PT.5S", "P--1Y", "P1Y1Y",
+        // The negation doesn't fit.
+        "-P-2147483648Y", "-PT-2147483648M", "-PT-9223372036854775808S",
+        "P2147483648Y", "PT9223372036854775808S",
+        "P1W2147483647D", "P-306783379W",
+        "P99999999999999999999Y",
+    };
+    for (const char *text : invalid) {
+        DATETIME_PERIOD period;
+        if (parse(text, period)) {
+            fprintf(stderr, "%s is parsed\n", text);
+            ++check::failures;
+        }
+    }
+}
+
+static void check_batch() {
+    const DATETIME_PERIOD periods[] = {
+        period_of(1, 0, 0, 0, 0, 0, 0),
+        period_of(0, 0, 0, 0, 0, INT64_MIN, 0),
+        period_of(0, -3, 0, 0, 0, 0, 0),
+    };
+    std::vector<char> buffer(3 * DATETIME_PERIOD_MAX_LENGTH);
+    int32_t offsets[4];
+    CHECK_EQUAL(format_periods(periods, 3, buffer.data(), buffer.size(),
+        offsets), 0);
+    CHECK(std::string(buffer.data(), (size_t)offsets[3]) ==
+        "P1Y-PT9223372036854775808S-P3M");
+    DATETIME_PERIOD parsed[3];
+    CHECK_EQUAL(parse_periods(buffer.data(), offsets, 3, parsed), 0);
+    for (int i = 0; i < 3; ++i)
+        CHECK(parsed[i] == periods[i]);
+    // A buffer just large enough, and one a byte shorter.
+    CHECK_EQUAL(format_periods(periods, 3, buffer.data(), (size_t)offsets[3],
+        offsets), 0);
+    CHECK_EQUAL(format_periods(periods, 3, buffer.data(),
+        (size_t)offsets[3] - 1, offsets), -1);
+    const DATETIME_PERIOD overflow =
+        period_of(0, 0, 0, 0, 0, INT64_MAX, NANOS_PER_SEC);
+    CHECK_EQUAL(format_periods(&overflow, 1, buffer.data(), buffer.size(),
+        offsets), -1);
+    // The invalid strings become zero periods.
+    const char text[] = "P1YxP2M";
+    const int32_t text_offsets[] = {0, 3, 4, 7};
+    CHECK_EQUAL(parse_periods(text, text_offsets, 3, parsed), -1);
+    CHECK(parsed[0] == periods[0]);
+    CHECK(parsed[1] == DATETIME_PERIOD());
+    CHECK(parsed[2] == period_of(0, 2, 0, 0, 0, 0, 0));
+}
+
+int main() {
+    check_format();
+    check_many();
+    check_parse();
+    check_batch();
+    return check::exit_code();
+}
@@ -0,0 +1,257 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that checks the weekly schedules from `schedule.cpp`
+   in Europe/Berlin. It is built with the gradle task `buildScheduleCheck`
+   and run by `checkNativeSchedule`.
+
+   `weekly_schedule_next_transition` is compared with probing
+   `weekly_schedule_is_open` minute by minute, from many instants around
+   exceptions, around the intervals that cross midnight and around the
+   transitions of the time zone, where the local times in a gap are never
+   open and the ones in an overlap are open twice. A schedule that doesn't
+   change its state for 366 days has no next transition. The instants at the
+   ends of `int64_t`, in the zones with the largest offsets of both signs,
+   are looked up without overflowing. */
+#include <climits>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+#include "civil.hpp"
+#include "check.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+#define HOURS(n) ((n) * 3600)
+
+static int64_t day_of(int64_t year, int month, int day) {
+    return civil::days_from_civil(year, month, day);
+}
+
+/* `weekly_schedule_next_transition`, by probing every minute and then every
+   second of the minute where the state changes, or INT64_MAX if it doesn't
+   change within `limit` seconds. */
+static int64_t probe_next_transition(const WEEKLY_SCHEDULE *schedule,
+    int64_t epoch_sec, int64_t limit, int *opens)
+{
+    const int state = weekly_schedule_is_open(schedule, epoch_sec);
+    int64_t minute = epoch_sec;
+    while (weekly_schedule_is_open(schedule, minute + 60) == state) {
+        minute += 60;
+        if (minute - epoch_sec > limit)
+            return INT64_MAX;
+    }
+    int64_t second = minute + 1;
+    while (weekly_schedule_is_open(schedule, second) == state)
+        ++second;
+    *opens = !state;
+    return second;
+}
+
+// Follows `count` transitions from `epoch_sec`, comparing them with probing.
+static void check_transitions(const WEEKLY_SCHEDULE *schedule,
+    int64_t epoch_sec, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        int opens = -1, expected_opens = -1;
+        const int64_t next =
+            weekly_schedule_next_transition(schedule, epoch_sec, &opens);
+        const int64_t expected = probe_next_transition(schedule, epoch_sec,
+            8 * 86400, &expected_opens);
+        if (!CHECK_EQUAL(next, expected) || next == INT64_MAX)
+            return;
+        CHECK_EQUAL(opens, expected_opens);
+        epoch_sec = next;
+    }
+}
+
+static void check_weekly(TZID berlin) {
+    WEEKLY_SCHEDULE *schedule = weekly_schedule_create(berlin);
+    CHECK_EQUAL(weekly_schedule_add_interval(schedule, 0, 0, 1), -1);
+    CHECK_EQUAL(weekly_schedule_add_interval(schedule, 8, 0, 1), -1);
+    CHECK_EQUAL(weekly_schedule_add_interval(schedule, 1, 5, 5), -1);
+    CHECK_EQUAL(weekly_schedule_add_interval(schedule, 1, 86400, 86401), -1);
+    CHECK_EQUAL(weekly_schedule_add_interval(schedule, 1, 1, 86402), -1);
+    for (int day = 1; day <= 5; ++day) {
+        CHECK_EQUAL(weekly_schedule_add_interval(schedule, day, HOURS(9),
+            HOURS(17)), 0);
+    }
+    // Saturday night, from 22:00 to 02:00 on Sunday.
+    CHECK_EQUAL(weekly_schedule_add_interval(schedule, 6, HOURS(22),
+        HOURS(26)), 0);
+    // Sunday, in the hours of the transitions, and until 02:00 on Monday.
+    CHECK_EQUAL(weekly_schedule_add_interval(schedule, 7, HOURS(2) + 1800,
+        HOURS(2) + 2700), 0);
+    CHECK_EQUAL(weekly_schedule_add_interval(schedule, 7, HOURS(23),
+        HOURS(26)), 0);
+    // 2021-03-28 and 2021-10-31 are the Sundays of the transitions.
+    for (int64_t day : {day_of(2021, 3, 20), day_of(2021, 10, 23),
+        day_of(2021, 6, 1)})
+    {
+        for (int64_t hour = 0; hour < 48; hour += 5)
+            check_transitions(schedule, day * 86400 + HOURS(hour), 12);
+    }
+    /* On 2021-03-28, the hour from 02:00 is skipped: the night ends when
+       the clocks jump, and 02:30 never comes, so the next opening is at
+       23:00. */
+    const int64_t spring = day_of(2021, 3, 28) * 86400;
+    int opens = -1;
+    CHECK_EQUAL(weekly_schedule_next_transition(schedule, spring, &opens),
+        spring + HOURS(1));
+    CHECK_EQUAL(opens, 0);
+    CHECK_EQUAL(weekly_schedule_next_transition(schedule, spring + HOURS(1),
+        &opens), spring + HOURS(21));
+    CHECK_EQUAL(opens, 1);
+    // 02:30 on 2021-10-31 happens twice, so it opens twice.
+    const int64_t autumn = day_of(2021, 10, 31) * 86400;
+    CHECK_EQUAL(weekly_schedule_next_transition(schedule, autumn + 60,
+        &opens), autumn + 1800);
+    CHECK_EQUAL(opens, 1);
+    CHECK_EQUAL(weekly_schedule_next_transition(schedule, autumn + 2700,
+        &opens), autumn + HOURS(1) + 1800);
+    CHECK_EQUAL(opens, 1);
+    // The batch gives the same as single instants.
+    std::vector<int64_t> instants;
+    for (int64_t t = spring - 20 * 86400; t < autumn + 20 * 86400; t += 997)
+        instants.push_back(t);
+    std::vector<uint8_t> open(instants.size());
+    CHECK_EQUAL(weekly_schedule_is_open_batch(schedule, instants.data(),
+        open.data(), instants.size()), 0);
+    for (size_t i = 0; i < instants.size(); ++i) {
+        if (!CHECK_EQUAL(open[i], weekly_schedule_is_open(schedule,
+            instants[i])))
+            break;
+    }
+    weekly_schedule_free(schedule);
+}
+
+static void check_exceptions(TZID berlin) {
+    WEEKLY_SCHEDULE *schedule = weekly_schedule_create(berlin);
+    for (int day = 1; day <= 7; ++day)
+        weekly_schedule_add_interval(schedule, day, HOURS(20), HOURS(26));
+    const int invalid[] = {HOURS(2), HOURS(25)};
+    CHECK_EQUAL(weekly_schedule_set_exception(schedule, day_of(2021, 5, 3),
+        invalid, 1), -1);
+    // Closed on Monday, 2021-05-03, so Sunday night ends at midnight.
+    const int64_t monday = day_of(2021, 5, 3);
+    CHECK_EQUAL(weekly_schedule_set_exception(schedule, monday, nullptr, 0),
+        0);
+    // Open twice on Wednesday, but from midnight, with overlapping intervals.
+    const int wednesday_hours[] = {HOURS(10), HOURS(12), 0, HOURS(3),
+        HOURS(11), HOURS(14)};
+    CHECK_EQUAL(weekly_schedule_set_exception(schedule, monday + 2,
+        wednesday_hours, 3), 0);
+    // In May, Berlin is 2 hours ahead of the UTC.
+    const int64_t midnight = monday * 86400 - HOURS(2);
+    int opens = -1;
+    CHECK_EQUAL(weekly_schedule_next_transition(schedule, midnight - 60,
+        &opens), midnight);
+    CHECK_EQUAL(opens, 0);
+    CHECK_EQUAL(weekly_schedule_is_open(schedule, midnight + HOURS(21)), 0);
+    // The night of Monday still goes on into Tuesday, which has no exception.
+    CHECK_EQUAL(weekly_schedule_is_open(schedule, midnight + HOURS(25)), 1);
+    // Tuesday night goes on into Wednesday until 03:00.
+    CHECK_EQUAL(weekly_schedule_next_transition(schedule,
+        midnight + HOURS(45), &opens), midnight + HOURS(51));
+    CHECK_EQUAL(opens, 0);
+    CHECK_EQUAL(weekly_schedule_next_transition(schedule,
+        midnight + HOURS(51), &opens), midnight + HOURS(58));
+    CHECK_EQUAL(weekly_schedule_next_transition(schedule,
+        midnight + HOURS(58), &opens), midnight + HOURS(62));
+    CHECK_EQUAL(opens, 0);
+    for (int64_t hour = -30; hour < 100; hour += 7)
+        check_transitions(schedule, midnight + HOURS(hour), 8);
+    weekly_schedule_free(schedule);
+}
+
+static void check_horizon(TZID berlin) {
+    WEEKLY_SCHEDULE *schedule = weekly_schedule_create(berlin);
+    const int64_t start = day_of(2021, 1, 1) * 86400;
+    int opens = -1;
+    CHECK_EQUAL(weekly_schedule_next_transition(schedule, start, &opens),
+        INT64_MAX);
+    // Only open on a single date, 365 days later: still found.
+    const int hours[] = {HOURS(9), HOURS(10)};
+    const int64_t found = day_of(2022, 1, 1);
+    weekly_schedule_set_exception(schedule, found, hours, 1);
+    CHECK_EQUAL(weekly_schedule_next_transition(schedule, start, &opens),
+        found * 86400 + HOURS(8));
+    CHECK_EQUAL(opens, 1);
+    // 367 days later, beyond the horizon.
+    CHECK_EQUAL(weekly_schedule_next_transition(schedule, start - 2 * 86400,
+        &opens), INT64_MAX);
+    weekly_schedule_free(schedule);
+    // Always open: the intervals are merged, so there are no transitions.
+    schedule = weekly_schedule_create(berlin);
+    for (int day = 1; day <= 7; ++day)
+        weekly_schedule_add_interval(schedule, day, 0, 86400);
+    CHECK_EQUAL(weekly_schedule_is_open(schedule, start), 1);
+    CHECK_EQUAL(weekly_schedule_next_transition(schedule, start, &opens),
+        INT64_MAX);
+    weekly_schedule_free(schedule);
+    // The errors of the time zone.
+    schedule = weekly_schedule_create(TZID_INVALID);
+    CHECK_EQUAL(weekly_schedule_is_open(schedule, start), -1);
+    CHECK_EQUAL(weekly_schedule_next_transition(schedule, start, &opens),
+        INT64_MAX);
+    uint8_t open = 0;
+    CHECK_EQUAL(weekly_schedule_is_open_batch(schedule, &start, &open, 1), -1);
+    weekly_schedule_free(schedule);
+}
+
+/* The local times at the ends of `int64_t` are saturated, and the day of
+   INT64_MIN, whose midnight doesn't fit, still has its boundaries. */
+static void check_extremes(TZID west, TZID east) {
+    // INT64_MIN is at 08:29:52 of its day, and INT64_MAX at 15:30:07.
+    const int64_t min_second_of_day = 30592;
+    for (TZID zone : {west, east}) {
+        WEEKLY_SCHEDULE *schedule = weekly_schedule_create(zone);
+        for (int day = 1; day <= 7; ++day)
+            weekly_schedule_add_interval(schedule, day, HOURS(9), HOURS(17));
+        const int64_t instants[] = {INT64_MIN, INT64_MIN + 1, INT64_MAX - 1,
+            INT64_MAX};
+        uint8_t open[4] = {2, 2, 2, 2};
+        CHECK_EQUAL(weekly_schedule_is_open_batch(schedule, instants, open,
+            4), 0);
+        for (int i = 0; i < 4; ++i)
+            CHECK_EQUAL(open[i], weekly_schedule_is_open(schedule,
+                instants[i]));
+        // At +14:00, the local INT64_MAX is saturated.
+        if (zone == east)
+            CHECK_EQUAL(weekly_schedule_is_open(schedule, INT64_MAX), 1);
+        int opens = -1;
+        CHECK_EQUAL(weekly_schedule_next_transition(schedule, INT64_MAX,
+            &opens), INT64_MAX);
+        weekly_schedule_free(schedule);
+    }
+    // At -12:00, the first 12 hours are at the saturated local INT64_MIN.
+    WEEKLY_SCHEDULE *schedule = weekly_schedule_create(west);
+    for (int day = 1; day <= 7; ++day)
+        weekly_schedule_add_interval(schedule, day, HOURS(9), HOURS(17));
+    CHECK_EQUAL(weekly_schedule_is_open(schedule, INT64_MIN), 0);
+    const int64_t nine = INT64_MIN + HOURS(12) + HOURS(9) - min_second_of_day;
+    CHECK_EQUAL(weekly_schedule_is_open(schedule, nine - 1), 0);
+    CHECK_EQUAL(weekly_schedule_is_open(schedule, nine), 1);
+    int opens = -1;
+    CHECK_EQUAL(weekly_schedule_next_transition(schedule, INT64_MIN, &opens),
+        nine);
+    CHECK_EQUAL(opens, 1);
+    check_transitions(schedule, INT64_MIN, 4);
+    weekly_schedule_free(schedule);
+}
+
+int main() {
+    const TZID berlin = timezone_by_name("Europe/Berlin");
+    if (!CHECK(berlin != TZID_INVALID))
+        return check::exit_code();
+    check_weekly(berlin);
+    check_exceptions(berlin);
+    check_horizon(berlin);
+    const TZID west = timezone_by_name("Etc/GMT+12");
+    const TZID east = timezone_by_name("Etc/GMT-14");
+    if (CHECK(west != TZID_INVALID) && CHECK(east != TZID_INVALID))
+        check_extremes(west, east);
+    return check::exit_code();
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that checks and measures the cache of
+   `snapshot_cache.hpp` with a fake provider, without needing Windows, where
+   the cache holds the time zones. It is built with the gradle task
+   `buildSnapshotCacheCheck` and run with the defaults by
+   `checkNativeSnapshotCache`:
+
+       snapshot_cache_check [-t threads] [-s seconds]
+
+   The snapshots of the fake provider hold a generation number in each of
+   their values, and overwrite them when they are deleted. For `seconds`,
+   the readers on `threads` threads check that every snapshot they see is
+   whole and not older than the one before, while the cache reloads it every
+   100 microseconds, the main thread reloads it as well, and some of the
+   loads fail. At the end, all the snapshots must be deleted.
+
+   Then, the lookups through a reader are measured on 1 to `threads`
+   threads, in nanoseconds per lookup, along with the lookups that copy the
+   data under a `std::shared_mutex` after checking the time, like
+   `windows.cpp` did before. */
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+#include <getopt.h>
+#include "snapshot_cache.hpp"
+
+static const uint64_t deleted = UINT64_MAX;
+
+static std::atomic<long> snapshots_alive{0};
+
+struct fake_snapshot {
+    uint64_t generation;
+    std::vector<uint64_t> values;
+
+    explicit fake_snapshot(uint64_t generation):
+        generation(generation), values(64, generation)
+    {
+        ++snapshots_alive;
+    }
+
+    ~fake_snapshot() {
+        generation = deleted;
+        std::fill(values.begin(), values.end(), deleted);
+        --snapshots_alive;
+    }
+};
+
+class fake_provider: public snapshots::provider<fake_snapshot> {
+public:
+    std::unique_ptr<const fake_snapshot> load() override {
+        const uint64_t generation = ++generation_;
+        // Like the registry, it sometimes fails.
+        if (generation % 10 == 0)
+            return nullptr;
+        return std::unique_ptr<const fake_snapshot>(
+            new fake_snapshot(generation));
+    }
+
+private:
+    uint64_t generation_ = 0;
+};
+
+typedef snapshots::cache<fake_snapshot> fake_cache;
+
+static std::atomic<long> errors{0};
+
+static void error(const char *message, uint64_t generation) {
+    if (errors++ < 5) {
+        fprintf(stderr, "%s (generation %llu)\n", message,
+            (unsigned long long)generation);
+    }
+}
+
+static bool is_whole(const fake_snapshot& snapshot) {
+    for (uint64_t value : snapshot.values) {
+        if (value != snapshot.generation)
+            return false;
+    }
+    return snapshot.generation != deleted;
+}
+
+static long read_until(const fake_cache& cache,
+    const std::atomic<bool>& stop)
+{
+    uint64_t last = 0;
+    long reads = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+        const fake_cache::reader snapshot(cache);
+        if (!snapshot) {
+            error("no snapshot", 0);
+            continue;
+        }
+        const uint64_t generation = snapshot->generation;
+        if (generation < last)
+            error("an older snapshot than the one before", generation);
+        last = generation;
+        if (!is_whole(*snapshot))
+            error("a snapshot changed while being read", generation);
+        if (++reads % 16 == 0) {
+            // The nested readers keep the outer snapshot alive.
+            const fake_cache::reader nested(cache);
+            if (nested->generation < generation || !is_whole(*snapshot))
+                error("a snapshot changed while being read", generation);
+        }
+    }
+    return reads;
+}
+
+static bool check(int threads, int seconds) {
+    std::unique_ptr<fake_cache> cache(new fake_cache(
+        std::unique_ptr<fake_provider>(new fake_provider),
+        std::chrono::microseconds(100)));
+    std::atomic<bool> stop{false};
+    std::atomic<long> reads{0};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < threads; ++i) {
+        readers.emplace_back([&] {
+            reads += read_until(*cache, stop);
+        });
+    }
+    const auto end = std::chrono::steady_clock::now() +
+        std::chrono::seconds(seconds);
+    long refreshes = 0;
+    while (std::chrono::steady_clock::now() < end) {
+        cache->refresh();
+        ++refreshes;
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    stop = true;
+    for (std::thread& reader : readers)
+        reader.join();
+    // Without readers, everything but the current snapshot is deleted.
+    while (!cache->refresh()) {}
+    if (cache->retired() != 0)
+        error("replaced snapshots are not deleted", cache->retired());
+    cache.reset();
+    if (snapshots_alive != 0)
+        error("snapshots are not deleted", snapshots_alive);
+    printf("%ld reads, %ld refreshes from the main thread: %ld errors\n",
+        reads.load(), refreshes, errors.load());
+    return errors == 0;
+}
+
+// The lookups of `windows.cpp` before the snapshots.
+struct locked_data {
+    std::shared_mutex mutex;
+    std::chrono::steady_clock::time_point next_flush =
+        std::chrono::steady_clock::time_point::max();
+    // As large as `DYNAMIC_TIME_ZONE_INFORMATION`.
+    uint64_t values[54] = {};
+};
+
+// So that the lookups are not optimized away.
+static std::atomic<uint64_t> checksum{0};
+
+template <typename LOOKUP>
+static double measure(int threads, long lookups, LOOKUP lookup) {
+    std::vector<std::thread> workers;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back([&lookup, lookups] {
+            uint64_t sum = 0;
+            for (long j = 0; j < lookups; ++j)
+                sum += lookup(j);
+            checksum += sum;
+        });
+    }
+    for (std::thread& worker : workers)
+        worker.join();
+    const std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (double)lookups;
+}
+
+static void benchmark(int max_threads) {
+    const long lookups = 2000000;
+    fake_cache cache(std::unique_ptr<fake_provider>(new fake_provider),
+        std::chrono::steady_clock::duration::zero());
+    locked_data locked;
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        const double snapshot = measure(threads, lookups, [&](long i) {
+            const fake_cache::reader snapshot(cache);
+            return snapshot->values[i % 64];
+        });
+        const double mutex = measure(threads, lookups, [&](long i) {
+            if (std::chrono::steady_clock::now() > locked.next_flush)
+                return (uint64_t)0;
+            uint64_t values[54];
+            {
+                const std::shared_lock<std::shared_mutex> lock(locked.mutex);
+                memcpy(values, locked.values, sizeof(values));
+            }
+            return values[i % 54];
+        });
+        printf("%3d threads: %8.1f ns with a snapshot, %8.1f ns with a "
+            "shared_mutex\n", threads, snapshot, mutex);
+    }
+}
+
+int main(int argc, char **argv) {
+    int threads = 4, seconds = 2;
+    int option;
+    while ((option = getopt(argc, argv, "t:s:")) != -1) {
+        switch (option) {
+            case 't':
+                threads = atoi(optarg);
+                break;
+            case 's':
+                seconds = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-t threads] [-s seconds]\n",
+                    argv[0]);
+                return 2;
+        }
+    }
+    if (!check(threads, seconds))
+        return 1;
+    benchmark(threads);
+    return 0;
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that compares the zones compiled into the program
+   with `static_zone.hpp` to the same zones from `cdate.h`. It is built with
+   the gradle task `buildStaticZoneCheck` for the zones of the `staticZones`
+   property, Europe/Berlin and America/New_York by default, and is run
+   without arguments by `checkNativeStaticZones`, or for other zones:
+
+       ./gradlew checkNativeStaticZones -PstaticZones=Europe/Berlin,Asia/Tokyo
+
+   For each of the zones, the offsets are compared at regular instants from
+   1800 to 2200 and around every transition from both implementations, and
+   the local date-times around the transitions are resolved by both. The
+   ranges where the offset stays the same are also checked to have the same
+   offset at their ends.
+
+   The rules of the static zones come from the time zone database of the JVM
+   that ran gradle, so the mismatches may also mean that it differs from the
+   one of the system. */
+#include <climits>
+#include <cstdio>
+#include "static_zones.hpp"
+#include "time_zone.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+struct counters {
+    long checked = 0;
+    long mismatches = 0;
+    // Only the first few mismatches of each zone are printed.
+    int printed = 0;
+};
+
+static void compare(counters& c, const char *zone, const char *what,
+    int64_t argument, int64_t expected, int64_t actual)
+{
+    ++c.checked;
+    if (expected == actual)
+        return;
+    ++c.mismatches;
+    if (c.printed++ < 5) {
+        fprintf(stderr, "%s: %s(%lld) is %lld instead of %lld\n", zone, what,
+            (long long)argument, (long long)actual, (long long)expected);
+    }
+}
+
+template <typename Data>
+static void check_instant(counters& c, const zones::zone& runtime,
+    int64_t epoch_sec)
+{
+    using zone = zones::static_zone<Data>;
+    const int expected = runtime.offset_at(epoch_sec);
+    if (expected == INT_MAX) {
+        compare(c, Data::name, "offset_at", epoch_sec, INT_MAX, 0);
+        return;
+    }
+    int64_t begin = 0, end = 0;
+    const int offset = zone::offset_at(epoch_sec, begin, end);
+    compare(c, Data::name, "offset_at", epoch_sec, expected, offset);
+    if (begin > epoch_sec || end <= epoch_sec) {
+        compare(c, Data::name, "the range of offset_at", epoch_sec,
+            epoch_sec, begin > epoch_sec ? begin : end);
+    }
+    if (begin != INT64_MIN)
+        compare(c, Data::name, "offset_at", begin, offset,
+            zone::offset_at(begin));
+    if (end != INT64_MAX)
+        compare(c, Data::name, "offset_at", end - 1, offset,
+            zone::offset_at(end - 1));
+}
+
+template <typename Data>
+static void check_local(counters& c, const zones::zone& runtime,
+    int64_t local_sec)
+{
+    using zone = zones::static_zone<Data>;
+    zones::resolved expected;
+    if (!runtime.resolve(local_sec, expected)) {
+        compare(c, Data::name, "resolve", local_sec, INT_MAX, 0);
+        return;
+    }
+    const zones::resolved actual = zone::resolve(local_sec);
+    compare(c, Data::name, "resolve", local_sec, expected.epoch_sec,
+        actual.epoch_sec);
+    compare(c, Data::name, "the offset of resolve", local_sec,
+        expected.offset_sec, actual.offset_sec);
+    compare(c, Data::name, "the gap of resolve", local_sec,
+        expected.gap_sec, actual.gap_sec);
+}
+
+template <typename Data>
+static void check_transition(counters& c, const zones::zone& runtime,
+    int64_t transition)
+{
+    for (int64_t delta : {-3601, -1, 0, 1, 3600})
+        check_instant<Data>(c, runtime, transition + delta);
+    const int before = zones::static_zone<Data>::offset_at(transition - 1);
+    const int after = zones::static_zone<Data>::offset_at(transition);
+    for (int64_t delta : {-3601, -1, 0, 1, 3600}) {
+        check_local<Data>(c, runtime, transition + before + delta);
+        check_local<Data>(c, runtime, transition + after + delta);
+    }
+}
+
+template <typename Data>
+static counters check_zone() {
+    counters c;
+    const zones::zone runtime = zones::zone::by_name(Data::name);
+    if (!runtime.is_valid()) {
+        fprintf(stderr, "%s: unknown to the library\n", Data::name);
+        ++c.mismatches;
+        return c;
+    }
+    const int64_t from = -5364662400; // 1800-01-01
+    const int64_t to = 7258118400; // 2200-01-01
+    // In steps of about 10 days.
+    for (int64_t instant = from; instant < to; instant += 863999) {
+        check_instant<Data>(c, runtime, instant);
+        check_local<Data>(c, runtime, instant);
+    }
+    int64_t begin = INT64_MIN, end = INT64_MIN;
+    runtime.offset_at(from, begin, end);
+    while (end < to) {
+        check_transition<Data>(c, runtime, end);
+        if (runtime.offset_at(end, begin, end) == INT_MAX)
+            break;
+    }
+    begin = end = INT64_MIN;
+    zones::static_zone<Data>::offset_at(from, begin, end);
+    while (end < to) {
+        check_transition<Data>(c, runtime, end);
+        zones::static_zone<Data>::offset_at(end, begin, end);
+    }
+    return c;
+}
+
+template <typename Data>
+static void add(counters& total, int& zone_count) {
+    const counters c = check_zone<Data>();
+    if (c.mismatches != 0)
+        printf("%-32s %ld mismatches\n", Data::name, c.mismatches);
+    total.checked += c.checked;
+    total.mismatches += c.mismatches;
+    ++zone_count;
+}
+
+int main() {
+    counters total;
+    int zone_count = 0;
+#define CHECK_ZONE(id) add<zones::data::id>(total, zone_count);
+    DATETIME_STATIC_ZONES(CHECK_ZONE)
+#undef CHECK_ZONE
+    printf("%d zones, %ld results: %ld mismatches\n", zone_count,
+        total.checked, total.mismatches);
+    return total.mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,604 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that converts a column of timestamps in a CSV or TSV
+   file between formats and time zones, using the same native implementation
+   as the library. It is built with the gradle task `buildTimestampConverter`,
+   and `checkNativeTimestampConverter` converts `tsconv_sample.csv` with it.
+
+   The input file is mapped into memory and split into jobs on line
+   boundaries, which are processed by a pool of threads. A job doesn't copy
+   its lines: its output is a list of pieces that either point into the
+   mapped input or into a small buffer with the converted timestamps, and the
+   pieces are written with `writev` in the order of the jobs. The timestamps
+   of a job are converted between time zones all at once, with the batch
+   functions from `cdate.h`.
+
+   Quoted fields are supported, but the fields must not contain line breaks.
+   The fields that can't be parsed are left as they are, and the tool exits
+   with status 1 if there were any. */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <getopt.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "iso8601.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+// The approximate amount of input in a job.
+#define JOB_SIZE (4 << 20)
+#define NANOS_PER_SEC 1000000000
+
+enum timestamp_format {
+    // an ISO 8601 date-time with the offset, or a local one.
+    FORMAT_ISO,
+    /* a local ISO 8601 date-time without the offset; the date-times with
+       offsets are rejected on input. */
+    FORMAT_LOCAL,
+    FORMAT_EPOCH_SECONDS,
+    FORMAT_EPOCH_MILLIS,
+    FORMAT_EPOCH_MICROS,
+    FORMAT_EPOCH_NANOS,
+};
+
+struct options {
+    char delimiter = 0;
+    // zero-based.
+    size_t column = 0;
+    bool header = false;
+    timestamp_format input_format = FORMAT_ISO;
+    timestamp_format output_format = FORMAT_ISO;
+    // the time zone of the input date-times without offsets.
+    TZID from_zone = TZID_INVALID;
+    // the time zone of the output date-times.
+    TZID to_zone = TZID_INVALID;
+    unsigned threads = 0;
+    bool verbose = false;
+};
+
+/* A piece of the output: either `length` bytes of the mapped input at
+   `offset`, or of the converted timestamps of the job at `offset`. */
+struct piece {
+    size_t offset;
+    size_t length;
+    bool converted;
+};
+
+struct job {
+    const char *begin;
+    const char *end;
+    std::vector<piece> pieces;
+    std::vector<char> converted;
+    size_t lines = 0;
+    size_t errors = 0;
+    bool done = false;
+};
+
+static int64_t per_second(timestamp_format format) {
+    switch (format) {
+        case FORMAT_EPOCH_SECONDS:
+            return 1;
+        case FORMAT_EPOCH_MILLIS:
+            return 1000;
+        case FORMAT_EPOCH_MICROS:
+            return 1000000;
+        case FORMAT_EPOCH_NANOS:
+            return NANOS_PER_SEC;
+        default:
+            return 0;
+    }
+}
+
+static bool parse_format(const char *name, timestamp_format& format) {
+    static const struct {
+        const char *name;
+        timestamp_format format;
+    } formats[] = {
+        {"iso", FORMAT_ISO},
+        {"local", FORMAT_LOCAL},
+        {"s", FORMAT_EPOCH_SECONDS},
+        {"ms", FORMAT_EPOCH_MILLIS},
+        {"us", FORMAT_EPOCH_MICROS},
+        {"ns", FORMAT_EPOCH_NANOS},
+    };
+    for (auto& f : formats) {
+        if (strcmp(name, f.name) == 0) {
+            format = f.format;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parse_epoch(const char *p, const char *end, int64_t& value) {
+    const bool negative = p != end && *p == '-';
+    if (p != end && (*p == '-' || *p == '+'))
+        ++p;
+    if (p == end)
+        return false;
+    uint64_t result = 0;
+    for (; p != end; ++p) {
+        const unsigned digit = (unsigned)(*p - '0');
+        if (digit > 9 || result > (UINT64_MAX - digit) / 10)
+            return false;
+        result = result * 10 + digit;
+    }
+    if (result > (uint64_t)INT64_MAX + negative)
+        return false;
+    value = negative ? (int64_t)(0 - result) : (int64_t)result;
+    return true;
+}
+
+static size_t format_epoch(int64_t value, char *out) {
+    char digits[24];
+    size_t length = 0;
+    uint64_t absolute = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+    do {
+        digits[length++] = (char)('0' + absolute % 10);
+        absolute /= 10;
+    } while (absolute != 0);
+    size_t written = 0;
+    if (value < 0)
+        out[written++] = '-';
+    while (length != 0)
+        out[written++] = digits[--length];
+    return written;
+}
+
+/* Finds the field number `column` of the line [p; end), returning false if
+   there are not enough fields. The quotes around the field are excluded. */
+static bool find_field(const char *p, const char *end, char delimiter,
+    size_t column, const char *&field_begin, const char *&field_end)
+{
+    for (size_t i = 0;; ++i) {
+        const char *begin = p;
+        if (p != end && *p == '"') {
+            // "" inside quotes is an escaped quote.
+            for (++p; p != end; ++p) {
+                if (*p == '"') {
+                    if (p + 1 != end && p[1] == '"')
+                        ++p;
+                    else
+                        break;
+                }
+            }
+            if (p != end)
+                ++p;
+        }
+        while (p != end && *p != delimiter)
+            ++p;
+        if (i == column) {
+            field_begin = begin;
+            field_end = p;
+            if (field_end - field_begin >= 2 && *field_begin == '"' &&
+                field_end[-1] == '"')
+            {
+                ++field_begin;
+                --field_end;
+            }
+            return true;
+        }
+        if (p == end)
+            return false;
+        ++p;
+    }
+}
+
+static void add_input(job& job, const char *base, const char *from,
+    const char *to)
+{
+    if (from == to)
+        return;
+    const size_t offset = (size_t)(from - base);
+    if (!job.pieces.empty() && !job.pieces.back().converted &&
+        job.pieces.back().offset + job.pieces.back().length == offset)
+    {
+        job.pieces.back().length += (size_t)(to - from);
+    } else {
+        job.pieces.push_back(piece{offset, (size_t)(to - from), false});
+    }
+}
+
+static void process(const options& options, const char *base, job& job) {
+    struct field {
+        const char *begin;
+        const char *end;
+        bool valid;
+    };
+    std::vector<field> fields;
+    // the instants of the fields, or their local date-times for a while.
+    std::vector<int64_t> seconds;
+    std::vector<int32_t> nanos;
+    // the fields that were parsed as local date-times.
+    std::vector<size_t> local;
+    for (const char *line = job.begin; line != job.end;) {
+        const char *line_end = (const char *)memchr(line, '\n', job.end - line);
+        const char *next = line_end == nullptr ? job.end : line_end + 1;
+        if (line_end == nullptr)
+            line_end = job.end;
+        if (line_end != line && line_end[-1] == '\r')
+            --line_end;
+        ++job.lines;
+        field f{nullptr, nullptr, false};
+        if (line != line_end && find_field(line, line_end, options.delimiter,
+            options.column, f.begin, f.end))
+        {
+            int64_t sec = 0;
+            int32_t nano = 0;
+            if (options.input_format == FORMAT_ISO ||
+                options.input_format == FORMAT_LOCAL)
+            {
+                iso_datetime parsed;
+                if (parse_iso_datetime(f.begin, f.end, parsed) &&
+                    (options.input_format == FORMAT_ISO ||
+                        parsed.offset_sec == INT_MAX))
+                {
+                    f.valid = true;
+                    nano = parsed.nanosecond;
+                    if (parsed.offset_sec == INT_MAX) {
+                        sec = parsed.local_sec;
+                        local.push_back(fields.size());
+                    } else {
+                        sec = parsed.local_sec - parsed.offset_sec;
+                    }
+                }
+            } else {
+                int64_t value;
+                if (parse_epoch(f.begin, f.end, value)) {
+                    f.valid = true;
+                    const int64_t units = per_second(options.input_format);
+                    sec = civil::floor_div(value, units);
+                    nano = (int32_t)((value - sec * units) *
+                        (NANOS_PER_SEC / units));
+                }
+            }
+            if (!f.valid)
+                ++job.errors;
+            seconds.push_back(sec);
+            nanos.push_back(nano);
+        } else {
+            seconds.push_back(0);
+            nanos.push_back(0);
+        }
+        fields.push_back(f);
+        line = next;
+    }
+    /* If a batch function fails, it's unknown which of its timestamps were
+       converted, so none of the fields are. */
+    auto reject = [&job](field& f) {
+        if (f.valid) {
+            f.valid = false;
+            ++job.errors;
+        }
+    };
+    // resolve the local date-times in the source time zone, or UTC.
+    if (!local.empty() && options.from_zone != TZID_INVALID) {
+        std::vector<int64_t> times(local.size());
+        for (size_t i = 0; i < local.size(); ++i)
+            times[i] = seconds[local[i]];
+        if (local_times_to_instants(options.from_zone, TIME_UNIT_SECOND,
+            times.data(), times.data(), times.size()) != 0)
+        {
+            for (size_t i : local)
+                reject(fields[i]);
+        } else {
+            for (size_t i = 0; i < local.size(); ++i)
+                seconds[local[i]] = times[i];
+        }
+    }
+    std::vector<int64_t> local_seconds(seconds);
+    const bool needs_local = options.output_format == FORMAT_ISO ||
+        options.output_format == FORMAT_LOCAL;
+    if (needs_local && options.to_zone != TZID_INVALID &&
+        instants_to_local_times(options.to_zone, TIME_UNIT_SECOND,
+            seconds.data(), local_seconds.data(), seconds.size()) != 0)
+    {
+        for (field& f : fields)
+            reject(f);
+    }
+    // write the output.
+    job.converted.resize(fields.size() * ISO_DATETIME_MAX_LENGTH);
+    size_t converted = 0;
+    const char *line = job.begin;
+    for (size_t i = 0; i < fields.size(); ++i) {
+        const char *next = (const char *)memchr(line, '\n', job.end - line);
+        next = next == nullptr ? job.end : next + 1;
+        const field& f = fields[i];
+        size_t length = 0;
+        char *out = job.converted.data() + converted;
+        if (f.valid) {
+            switch (options.output_format) {
+                case FORMAT_ISO:
+                    length = format_iso_datetime(local_seconds[i], nanos[i],
+                        (int32_t)(local_seconds[i] - seconds[i]), out);
+                    break;
+                case FORMAT_LOCAL:
+                    length = format_iso_datetime(local_seconds[i], nanos[i],
+                        INT_MAX, out);
+                    break;
+                default: {
+                    const int64_t units = per_second(options.output_format);
+                    int64_t value;
+                    if (__builtin_mul_overflow(seconds[i], units, &value) ||
+                        __builtin_add_overflow(value,
+                            nanos[i] / (NANOS_PER_SEC / units), &value))
+                        length = 0;
+                    else
+                        length = format_epoch(value, out);
+                }
+            }
+            if (length == 0)
+                ++job.errors;
+        }
+        if (length == 0) {
+            add_input(job, base, line, next);
+        } else {
+            add_input(job, base, line, f.begin);
+            job.pieces.push_back(piece{converted, length, true});
+            converted += length;
+            add_input(job, base, f.end, next);
+        }
+        line = next;
+    }
+}
+
+// Writes all of the buffers, retrying after partial writes.
+static bool write_all(int fd, iovec *buffers, int count) {
+    while (count > 0) {
+        ssize_t written = writev(fd, buffers, count);
+        if (written < 0)
+            return false;
+        while (count > 0 && (size_t)written >= buffers->iov_len) {
+            written -= buffers->iov_len;
+            ++buffers;
+            --count;
+        }
+        if (count > 0) {
+            buffers->iov_base = (char *)buffers->iov_base + written;
+            buffers->iov_len -= written;
+        }
+    }
+    return true;
+}
+
+static bool write_job(int fd, const char *base, const job& job) {
+    std::vector<iovec> buffers;
+    buffers.reserve(std::min<size_t>(job.pieces.size(), IOV_MAX));
+    for (size_t i = 0; i < job.pieces.size(); i += IOV_MAX) {
+        buffers.clear();
+        const size_t last = std::min(job.pieces.size(), i + IOV_MAX);
+        for (size_t j = i; j < last; ++j) {
+            const piece& p = job.pieces[j];
+            const char *from =
+                p.converted ? job.converted.data() + p.offset : base + p.offset;
+            buffers.push_back(iovec{(void *)from, p.length});
+        }
+        if (!write_all(fd, buffers.data(), (int)buffers.size()))
+            return false;
+    }
+    return true;
+}
+
+static void usage(const char *name) {
+    fprintf(stderr,
+        "usage: %s -c COLUMN [options] INPUT\n"
+        "Converts a column of timestamps in a CSV or TSV file.\n"
+        "  -c COLUMN  the number of the column to convert, from 1\n"
+        "  -d DELIM   the field delimiter; `,` by default, or a tab for .tsv\n"
+        "  -H         copy the first line as is\n"
+        "  -i FORMAT  the input format: iso (the default), local, s, ms, us, ns\n"
+        "  -o FORMAT  the output format, the same as above\n"
+        "  -f ZONE    the time zone of the input date-times without offsets\n"
+        "  -t ZONE    the time zone of the output date-times\n"
+        "  -O FILE    the output file instead of the standard output\n"
+        "  -j THREADS the number of threads\n"
+        "  -v         print the throughput to the standard error\n"
+        "The formats s, ms, us and ns are the numbers of the units since\n"
+        "1970-01-01T00:00Z. The input in the local format must not have\n"
+        "offsets. The time zones are UTC by default.\n",
+        name);
+}
+
+static bool resolve_zone(const char *name, TZID& zone) {
+    zone = timezone_by_name(name);
+    if (zone == TZID_INVALID) {
+        fprintf(stderr, "Unknown time zone: %s\n", name);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    options options;
+    const char *output_path = nullptr;
+    long column = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "c:d:Hi:o:f:t:O:j:v")) != -1) {
+        switch (opt) {
+            case 'c':
+                column = strtol(optarg, nullptr, 10);
+                break;
+            case 'd':
+                options.delimiter = strcmp(optarg, "\\t") == 0 ? '\t' : *optarg;
+                break;
+            case 'H':
+                options.header = true;
+                break;
+            case 'i':
+            case 'o':
+                if (!parse_format(optarg, opt == 'i' ?
+                    options.input_format : options.output_format))
+                {
+                    fprintf(stderr, "Unknown format: %s\n", optarg);
+                    return 2;
+                }
+                break;
+            case 'f':
+                if (!resolve_zone(optarg, options.from_zone))
+                    return 2;
+                break;
+            case 't':
+                if (!resolve_zone(optarg, options.to_zone))
+                    return 2;
+                break;
+            case 'O':
+                output_path = optarg;
+                break;
+            case 'j':
+                options.threads = (unsigned)strtoul(optarg, nullptr, 10);
+                break;
+            case 'v':
+                options.verbose = true;
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if (column < 1 || optind != argc - 1) {
+        usage(argv[0]);
+        return 2;
+    }
+    options.column = (size_t)(column - 1);
+    const char *input_path = argv[optind];
+    if (options.delimiter == 0) {
+        const size_t length = strlen(input_path);
+        options.delimiter = length >= 4 &&
+            strcmp(input_path + length - 4, ".tsv") == 0 ? '\t' : ',';
+    }
+    if (options.threads == 0)
+        options.threads = std::max(1u, std::thread::hardware_concurrency());
+
+    const int input = open(input_path, O_RDONLY);
+    struct stat status;
+    if (input < 0 || fstat(input, &status) != 0) {
+        perror(input_path);
+        return 2;
+    }
+    const size_t size = (size_t)status.st_size;
+    const char *base = "";
+    if (size != 0) {
+        void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, input, 0);
+        if (mapped == MAP_FAILED) {
+            perror(input_path);
+            return 2;
+        }
+        madvise(mapped, size, MADV_SEQUENTIAL);
+        base = (const char *)mapped;
+    }
+    const int output = output_path == nullptr ? STDOUT_FILENO :
+        open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (output < 0) {
+        perror(output_path);
+        return 2;
+    }
+    const auto start = std::chrono::steady_clock::now();
+
+    const char *data = base;
+    const char *data_end = base + size;
+    if (options.header) {
+        const char *header_end = (const char *)memchr(data, '\n', size);
+        data = header_end == nullptr ? data_end : header_end + 1;
+        iovec header{(void *)base, (size_t)(data - base)};
+        if (!write_all(output, &header, 1)) {
+            perror("write");
+            return 2;
+        }
+    }
+    // split the input into jobs on line boundaries.
+    std::vector<job> jobs;
+    for (const char *p = data; p != data_end;) {
+        const char *end = data_end - p <= JOB_SIZE ? data_end :
+            (const char *)memchr(p + JOB_SIZE, '\n', data_end - p - JOB_SIZE);
+        end = end == nullptr || end == data_end ? data_end : end + 1;
+        job j;
+        j.begin = p;
+        j.end = end;
+        jobs.push_back(std::move(j));
+        p = end;
+    }
+
+    /* The workers take the jobs in order, but stay at most a few jobs ahead
+       of the writer, so that the memory used by the output is bounded. */
+    const size_t window = 2 * (size_t)options.threads;
+    std::atomic<size_t> next_job(0);
+    size_t written_jobs = 0;
+    std::mutex mutex;
+    std::condition_variable job_done, job_written;
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < options.threads; ++t) {
+        workers.emplace_back([&]() {
+            while (true) {
+                const size_t i = next_job++;
+                if (i >= jobs.size())
+                    return;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    job_written.wait(lock,
+                        [&]() { return i < written_jobs + window; });
+                }
+                process(options, base, jobs[i]);
+                std::lock_guard<std::mutex> lock(mutex);
+                jobs[i].done = true;
+                job_done.notify_all();
+            }
+        });
+    }
+    bool failed = false;
+    size_t lines = 0, errors = 0;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            job_done.wait(lock, [&]() { return jobs[i].done; });
+        }
+        if (!failed && !write_job(output, base, jobs[i])) {
+            perror("write");
+            failed = true;
+        }
+        lines += jobs[i].lines;
+        errors += jobs[i].errors;
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs[i].pieces = std::vector<piece>();
+        jobs[i].converted = std::vector<char>();
+        ++written_jobs;
+        job_written.notify_all();
+    }
+    for (auto& worker : workers)
+        worker.join();
+    if (output != STDOUT_FILENO && close(output) != 0) {
+        perror(output_path);
+        failed = true;
+    }
+    if (failed)
+        return 2;
+
+    if (options.verbose) {
+        const double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        fprintf(stderr, "%zu lines, %zu bytes in %.3f s: %.1f MB/s, "
+            "%.0f lines/s, %u threads\n", lines, size, seconds,
+            size / seconds / 1e6, lines / seconds, options.threads);
+    }
+    if (errors != 0) {
+        fprintf(stderr, "%zu fields could not be converted\n", errors);
+        return 1;
+    }
+    return 0;
+}
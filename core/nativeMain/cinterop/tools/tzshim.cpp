@@ -0,0 +1,335 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A shared library replacing `localtime_r`, `localtime`, `gmtime_r`,
+   `gmtime`, `mktime`, `timegm` and `tzset` of glibc with the implementation
+   of this library, for the native code in the same process that still uses
+   the C functions. It is built with the gradle task `buildTimeShim` and is
+   used either with `LD_PRELOAD` or by linking to it before the C library.
+
+   glibc takes a global lock and checks the `TZ` variable on every call to
+   `localtime_r` and `mktime`. Here, `TZ` is only read on the first call and
+   by `tzset`, and the conversions take no locks: the time zone is published
+   through an atomic pointer, and each thread remembers the range of instants
+   where the last offset it looked up applies, so most calls don't leave the
+   thread at all.
+
+   Without `TZ`, the system time zone is used. Otherwise, `TZ` has to
+   contain a name from the time zone database, optionally preceded by `:`.
+   Any other value, such as a POSIX rule like `CET-1CEST,M3.5.0,M10.5.0/3`,
+   means the UTC. The time zone database has no notion of daylight saving
+   time as such, so `tm_isdst` is set when the offset is greater than the
+   smaller of the offsets in the middle of January and of July of that
+   year. */
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <time.h>
+#include "civil.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+// The longest abbreviation of a time zone name that is kept, plus the zero.
+#define ABBREVIATION_SIZE 16
+// The number of the different abbreviations that can be kept.
+#define MAX_ABBREVIATIONS 512
+/* More than the offset can change by at a transition: the offsets are
+   within [-18:00; +18:00]. */
+#define MAX_OFFSET_CHANGE (36 * 3600)
+
+// A time zone set by `tzset`, never freed, since readers may still use it.
+struct zone_state {
+    // TZID_INVALID for the UTC.
+    TZID zone;
+    // The value of `TZ`, or null if it was absent.
+    char *tz;
+};
+
+static std::atomic<const zone_state *> current_state{nullptr};
+static std::mutex state_mutex;
+static std::mutex abbreviation_mutex;
+
+static char abbreviations[MAX_ABBREVIATIONS][ABBREVIATION_SIZE];
+static std::atomic<int> abbreviation_count{0};
+
+/* Returns a copy of the abbreviation that lives as long as the process, as
+   `tm_zone` has to. */
+static const char *intern_abbreviation(const char *abbreviation) {
+    int count = abbreviation_count.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i) {
+        if (strcmp(abbreviations[i], abbreviation) == 0)
+            return abbreviations[i];
+    }
+    std::lock_guard<std::mutex> lock(abbreviation_mutex);
+    count = abbreviation_count.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; ++i) {
+        if (strcmp(abbreviations[i], abbreviation) == 0)
+            return abbreviations[i];
+    }
+    if (count == MAX_ABBREVIATIONS)
+        return "???";
+    // The rest of the entry is still zero.
+    memcpy(abbreviations[count], abbreviation,
+        strnlen(abbreviation, ABBREVIATION_SIZE - 1));
+    abbreviation_count.store(count + 1, std::memory_order_release);
+    return abbreviations[count];
+}
+
+static bool same_tz(const char *a, const char *b) {
+    return a == b || (a != nullptr && b != nullptr && strcmp(a, b) == 0);
+}
+
+static TZID zone_by_tz(const char *tz) {
+    if (tz == nullptr) {
+        TZID id = TZID_INVALID;
+        free(get_system_timezone(&id));
+        return id;
+    }
+    return timezone_by_name(*tz == ':' ? tz + 1 : tz);
+}
+
+// The offset and its properties at a range of instants.
+struct interval {
+    const zone_state *state = nullptr;
+    int64_t begin = 0;
+    int64_t end = 0;
+    int offset = 0;
+    int isdst = 0;
+    const char *abbreviation = "UTC";
+};
+
+static thread_local interval cache;
+
+static void update_state();
+
+static const zone_state *state() {
+    const zone_state *result = current_state.load(std::memory_order_acquire);
+    if (result == nullptr) {
+        update_state();
+        result = current_state.load(std::memory_order_acquire);
+    }
+    return result;
+}
+
+// The offset in the middle of January or July of the year of the instant.
+static int seasonal_offset(TZID zone, int64_t epoch_sec, int month) {
+    int64_t year;
+    int unused_month, unused_day;
+    civil::civil_from_days(civil::floor_div(epoch_sec, SECS_PER_DAY), year,
+        unused_month, unused_day);
+    return offset_at_instant(zone,
+        civil::days_from_civil(year, month, 15) * SECS_PER_DAY);
+}
+
+// Returns false if there's a problem with the time zone.
+static bool lookup(const zone_state *zone, int64_t epoch_sec,
+    interval& result)
+{
+    if (zone == cache.state && epoch_sec >= cache.begin &&
+        epoch_sec < cache.end)
+    {
+        result = cache;
+        return true;
+    }
+    /* The intervals of the library end on every transition, including the
+       ones that only change the abbreviation, so it can be cached too. */
+    interval found;
+    found.state = zone;
+    if (zone->zone == TZID_INVALID) {
+        found.begin = INT64_MIN;
+        found.end = INT64_MAX;
+    } else {
+        char abbreviation[ABBREVIATION_SIZE];
+        found.offset = offset_interval_at_instant(zone->zone, epoch_sec,
+            &found.begin, &found.end);
+        if (found.offset == INT_MAX || abbreviation_at_instant(zone->zone,
+            epoch_sec, abbreviation, sizeof abbreviation) == INT_MAX)
+            return false;
+        const int january = seasonal_offset(zone->zone, epoch_sec, 1);
+        const int july = seasonal_offset(zone->zone, epoch_sec, 7);
+        if (january == INT_MAX || july == INT_MAX)
+            return false;
+        found.isdst = found.offset > (january < july ? january : july);
+        found.abbreviation = intern_abbreviation(abbreviation);
+    }
+    cache = found;
+    result = found;
+    return true;
+}
+
+/* Fills `tm` with the date-time at `epoch_sec` observed with the offset.
+   Returns false if the year doesn't fit. */
+static bool to_tm(int64_t epoch_sec, const interval& offset, struct tm *tm) {
+    const int64_t local_sec = epoch_sec + offset.offset;
+    const int64_t epoch_day = civil::floor_div(local_sec, SECS_PER_DAY);
+    const int64_t second_of_day = local_sec - epoch_day * SECS_PER_DAY;
+    int64_t year;
+    int month, day;
+    civil::civil_from_days(epoch_day, year, month, day);
+    if (year - 1900 < INT_MIN || year - 1900 > INT_MAX)
+        return false;
+    tm->tm_year = (int)(year - 1900);
+    tm->tm_mon = month - 1;
+    tm->tm_mday = day;
+    tm->tm_hour = (int)(second_of_day / 3600);
+    tm->tm_min = (int)(second_of_day / 60 % 60);
+    tm->tm_sec = (int)(second_of_day % 60);
+    tm->tm_wday = civil::iso_day_of_week(epoch_day) % 7;
+    tm->tm_yday = (int)(epoch_day - civil::days_from_civil(year, 1, 1));
+    tm->tm_isdst = offset.isdst;
+    tm->tm_gmtoff = offset.offset;
+    tm->tm_zone = offset.abbreviation;
+    return true;
+}
+
+/* The local date-time of `tm` in seconds since 1970-01-01T00:00, with the
+   fields outside their usual ranges carried over, like `mktime` does. */
+static int64_t from_tm(const struct tm *tm) {
+    const int64_t months = (int64_t)tm->tm_year * 12 + tm->tm_mon;
+    const int64_t year = civil::floor_div(months, 12) + 1900;
+    const int month = (int)(months - civil::floor_div(months, 12) * 12) + 1;
+    return (civil::days_from_civil(year, month, 1) + tm->tm_mday - 1) *
+        SECS_PER_DAY + (int64_t)tm->tm_hour * 3600 +
+        (int64_t)tm->tm_min * 60 + tm->tm_sec;
+}
+
+/* Reads `TZ`. Called directly rather than through `tzset`, which may be
+   bound to that of the C library if this library is loaded with `dlopen`. */
+static void update_state() {
+    std::lock_guard<std::mutex> lock(state_mutex);
+    const char *tz = getenv("TZ");
+    const zone_state *previous = current_state.load(std::memory_order_relaxed);
+    if (previous != nullptr && same_tz(previous->tz, tz))
+        return;
+    zone_state *state = new zone_state();
+    state->tz = tz == nullptr ? nullptr : strdup(tz);
+    state->zone = zone_by_tz(tz);
+    current_state.store(state, std::memory_order_release);
+    /* The variables of the C library describing the time zone, from the
+       standard and the daylight saving time of the current year. */
+    int64_t year;
+    int month, day;
+    civil::civil_from_days(
+        civil::floor_div((int64_t)time(nullptr), SECS_PER_DAY),
+        year, month, day);
+    interval january, july;
+    if (!lookup(state, civil::days_from_civil(year, 1, 15) * SECS_PER_DAY,
+        january) || !lookup(state,
+        civil::days_from_civil(year, 7, 15) * SECS_PER_DAY, july))
+        return;
+    const interval& standard = january.isdst ? july : january;
+    const interval& summer = january.isdst ? january : july;
+    tzname[0] = (char *)standard.abbreviation;
+    tzname[1] = (char *)summer.abbreviation;
+    timezone = -standard.offset;
+    daylight = summer.isdst;
+}
+
+extern "C" {
+
+void tzset() noexcept {
+    update_state();
+}
+
+struct tm *gmtime_r(const time_t *timer, struct tm *result) noexcept {
+    interval utc;
+    utc.abbreviation = "GMT";
+    if (!to_tm(*timer, utc, result)) {
+        errno = EOVERFLOW;
+        return nullptr;
+    }
+    return result;
+}
+
+struct tm *gmtime(const time_t *timer) noexcept {
+    static thread_local struct tm result;
+    return gmtime_r(timer, &result);
+}
+
+struct tm *localtime_r(const time_t *timer, struct tm *result) noexcept {
+    interval offset;
+    if (!lookup(state(), *timer, offset) || !to_tm(*timer, offset, result)) {
+        errno = EOVERFLOW;
+        return nullptr;
+    }
+    return result;
+}
+
+struct tm *localtime(const time_t *timer) noexcept {
+    static thread_local struct tm result;
+    return localtime_r(timer, &result);
+}
+
+time_t timegm(struct tm *tm) noexcept {
+    const time_t epoch_sec = from_tm(tm);
+    if (gmtime_r(&epoch_sec, tm) == nullptr)
+        return -1;
+    return epoch_sec;
+}
+
+/* The local date-times in a time gap are moved forward by the length of the
+   gap, and the ones that happen twice get the earlier offset, unless
+   `tm_isdst` asks for the other one. If `tm_isdst` doesn't match the result
+   otherwise, the date-time is taken to be in the requested kind of time, as
+   glibc does. */
+time_t mktime(struct tm *tm) noexcept {
+    const zone_state *zone = state();
+    const int64_t local_sec = from_tm(tm);
+    int64_t epoch_sec = local_sec - cache.offset;
+    interval offset;
+    if (zone == cache.state &&
+        (cache.begin == INT64_MIN ||
+            epoch_sec - cache.begin > MAX_OFFSET_CHANGE) &&
+        (cache.end == INT64_MAX || cache.end - epoch_sec > MAX_OFFSET_CHANGE))
+    {
+        /* Far enough from the transitions for the date-time to happen
+           exactly once, with the offset this thread has just seen. */
+        offset = cache;
+    } else {
+        epoch_sec = local_sec;
+        if (zone->zone != TZID_INVALID) {
+            int found = INT_MAX;
+            const int transition =
+                offset_at_datetime(zone->zone, local_sec, &found);
+            if (found == INT_MAX) {
+                errno = EOVERFLOW;
+                return -1;
+            }
+            epoch_sec = local_sec + transition - found;
+        }
+        if (!lookup(zone, epoch_sec, offset)) {
+            errno = EOVERFLOW;
+            return -1;
+        }
+    }
+    if (tm->tm_isdst >= 0 && (tm->tm_isdst > 0) != (offset.isdst != 0)) {
+        /* The offset of the requested kind nearest in time, looking at the
+           neighboring intervals, both before and after. */
+        interval other;
+        if (offset.begin != INT64_MIN &&
+            lookup(zone, offset.begin - 1, other) &&
+            other.isdst == (tm->tm_isdst > 0)) {
+            epoch_sec = local_sec - other.offset;
+        } else if (offset.end != INT64_MAX &&
+            lookup(zone, offset.end, other) &&
+            other.isdst == (tm->tm_isdst > 0)) {
+            epoch_sec = local_sec - other.offset;
+        }
+        if (!lookup(zone, epoch_sec, offset)) {
+            errno = EOVERFLOW;
+            return -1;
+        }
+    }
+    if (!to_tm(epoch_sec, offset, tm)) {
+        errno = EOVERFLOW;
+        return -1;
+    }
+    return epoch_sec;
+}
+
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that measures how many calls to `localtime_r` and
+   `mktime` a number of threads make together per second. It is built with
+   the gradle task `buildTimeShimBench` and doesn't depend on the library:
+   to compare the shim from `tzshim.cpp` with glibc, run it with and without
+   `LD_PRELOAD=path/to/libdatetime_tzshim.so`:
+
+       tzshim_bench [-t threads] [-s seconds] [-z zone]
+
+   Each thread converts instants around the current time, a few minutes
+   apart, so both implementations mostly look at the same transition. */
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <getopt.h>
+#include <time.h>
+
+// Calls the function 1024 times, advancing the time a little each time.
+static uint64_t call_localtime(time_t& instant, struct tm& tm) {
+    uint64_t checksum = 0;
+    for (int i = 0; i < 1024; ++i) {
+        instant += 317;
+        localtime_r(&instant, &tm);
+        checksum += (uint64_t)tm.tm_hour;
+    }
+    return checksum;
+}
+
+static uint64_t call_mktime(time_t&, struct tm& tm) {
+    uint64_t checksum = 0;
+    for (int i = 0; i < 1024; ++i) {
+        tm.tm_min += 5;
+        tm.tm_isdst = -1;
+        checksum += (uint64_t)mktime(&tm);
+    }
+    return checksum;
+}
+
+typedef uint64_t (*benchmark)(time_t&, struct tm&);
+
+static void run(benchmark f, const std::atomic<bool>& stop, time_t start,
+    uint64_t& calls)
+{
+    struct tm tm;
+    time_t instant = start;
+    localtime_r(&instant, &tm);
+    uint64_t checksum = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+        checksum += f(instant, tm);
+        calls += 1024;
+    }
+    // So that the calls are not optimized away.
+    if (checksum == 42)
+        puts("");
+}
+
+// Returns the number of calls per second of all the threads together.
+static double measure(benchmark f, unsigned threads, double seconds) {
+    std::atomic<bool> stop{false};
+    std::vector<uint64_t> calls(threads);
+    std::vector<std::thread> workers;
+    const time_t now = time(nullptr);
+    const auto started = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < threads; ++i)
+        workers.emplace_back(run, f, std::cref(stop), now, std::ref(calls[i]));
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop.store(true);
+    for (std::thread& worker : workers)
+        worker.join();
+    const double elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - started).count();
+    uint64_t sum = 0;
+    for (uint64_t c : calls)
+        sum += c;
+    return sum / elapsed;
+}
+
+int main(int argc, char **argv) {
+    unsigned threads = std::thread::hardware_concurrency();
+    double seconds = 2;
+    int option;
+    while ((option = getopt(argc, argv, "t:s:z:")) != -1) {
+        switch (option) {
+            case 't':
+                threads = (unsigned)atoi(optarg);
+                break;
+            case 's':
+                seconds = atof(optarg);
+                break;
+            case 'z':
+                setenv("TZ", optarg, 1);
+                break;
+            default:
+                fprintf(stderr,
+                    "usage: %s [-t threads] [-s seconds] [-z zone]\n",
+                    argv[0]);
+                return 2;
+        }
+    }
+    if (threads == 0)
+        threads = 1;
+    tzset();
+    const double localtime_rate = measure(call_localtime, threads, seconds);
+    const double mktime_rate = measure(call_mktime, threads, seconds);
+    printf("%u threads: localtime_r %.0f calls/s, mktime %.0f calls/s\n",
+        threads, localtime_rate, mktime_rate);
+    return 0;
+}
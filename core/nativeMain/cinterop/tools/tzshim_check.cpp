@@ -0,0 +1,236 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that compares the functions of the shim from
+   `tzshim.cpp` to those of glibc. It is built with the gradle task
+   `buildTimeShimCheck`, run on Linux by `checkNativeTimeShim` with the
+   shim built by `buildTimeShim`, and is run as
+
+       tzshim_check path/to/libdatetime_tzshim.so [zone...]
+
+   The shim is loaded with `dlopen`, so that both implementations are in the
+   same process, and for each of the zones, which are all the zones known to
+   the library by default, `localtime_r` is compared at every transition and
+   around it, as well as at regular instants from 1900 to 2100, and `mktime`
+   is compared for the local date-times around the transitions.
+
+   `tm_isdst` is only a guess of the shim, so its mismatches are counted
+   separately and don't make the tool fail. Everything else, including the
+   abbreviations, has to match. */
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <dlfcn.h>
+#include <time.h>
+extern "C" {
+#include "cdate.h"
+}
+
+struct shim_functions {
+    void (*tzset)();
+    struct tm *(*localtime_r)(const time_t *, struct tm *);
+    struct tm *(*gmtime_r)(const time_t *, struct tm *);
+    time_t (*mktime)(struct tm *);
+    time_t (*timegm)(struct tm *);
+};
+
+struct counters {
+    long checked = 0;
+    long mismatches = 0;
+    long isdst_mismatches = 0;
+    // Only the first few mismatches of each zone are printed.
+    int printed = 0;
+};
+
+static void print_tm(const char *label, const struct tm *tm) {
+    fprintf(stderr, "    %s: %04d-%02d-%02dT%02d:%02d:%02d wday %d yday %d "
+        "isdst %d gmtoff %ld %s\n", label, tm->tm_year + 1900, tm->tm_mon + 1,
+        tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec, tm->tm_wday,
+        tm->tm_yday, tm->tm_isdst, (long)tm->tm_gmtoff,
+        tm->tm_zone == nullptr ? "(null)" : tm->tm_zone);
+}
+
+// Everything but `tm_isdst`.
+static bool same_fields(const struct tm& a, const struct tm& b) {
+    return a.tm_year == b.tm_year && a.tm_mon == b.tm_mon &&
+        a.tm_mday == b.tm_mday && a.tm_hour == b.tm_hour &&
+        a.tm_min == b.tm_min && a.tm_sec == b.tm_sec &&
+        a.tm_wday == b.tm_wday && a.tm_yday == b.tm_yday &&
+        a.tm_gmtoff == b.tm_gmtoff && a.tm_zone != nullptr &&
+        b.tm_zone != nullptr && strcmp(a.tm_zone, b.tm_zone) == 0;
+}
+
+static void report(counters& c, const char *zone, const char *function,
+    long long argument, const struct tm& expected, const struct tm& actual)
+{
+    if (c.printed++ >= 5)
+        return;
+    fprintf(stderr, "%s: %s(%lld) differs\n", zone, function, argument);
+    print_tm("glibc", &expected);
+    print_tm("shim ", &actual);
+}
+
+static void compare(counters& c, const char *zone, const char *function,
+    long long argument, time_t expected_result, const struct tm& expected,
+    time_t actual_result, const struct tm& actual)
+{
+    ++c.checked;
+    if (expected_result != actual_result || !same_fields(expected, actual)) {
+        ++c.mismatches;
+        report(c, zone, function, argument, expected, actual);
+    } else if ((expected.tm_isdst > 0) != (actual.tm_isdst > 0)) {
+        ++c.isdst_mismatches;
+    }
+}
+
+static void check_localtime(const shim_functions& shim, counters& c,
+    const char *zone, time_t instant)
+{
+    struct tm expected, actual;
+    memset(&expected, 0, sizeof expected);
+    memset(&actual, 0, sizeof actual);
+    const bool expected_ok = localtime_r(&instant, &expected) != nullptr;
+    const bool actual_ok = shim.localtime_r(&instant, &actual) != nullptr;
+    compare(c, zone, "localtime_r", (long long)instant, expected_ok,
+        expected, actual_ok, actual);
+}
+
+/* `mktime` of the local date-time, with `tm_isdst` unknown. The date-times
+   in the gaps and the overlaps are resolved differently by glibc depending
+   on what was asked before, so only those that happen exactly once are
+   compared. */
+static void check_mktime(const shim_functions& shim, counters& c,
+    const char *zone, time_t instant)
+{
+    struct tm local;
+    if (localtime_r(&instant, &local) == nullptr)
+        return;
+    struct tm expected = local, actual = local;
+    expected.tm_isdst = actual.tm_isdst = -1;
+    const time_t expected_result = mktime(&expected);
+    const time_t actual_result = shim.mktime(&actual);
+    if (expected_result != instant)
+        return;
+    compare(c, zone, "mktime", (long long)instant, expected_result, expected,
+        actual_result, actual);
+}
+
+static void check_zone(const shim_functions& shim, counters& c,
+    const char *zone)
+{
+    setenv("TZ", zone, 1);
+    tzset();
+    shim.tzset();
+    TZID id = timezone_by_name(zone);
+    if (id == TZID_INVALID) {
+        fprintf(stderr, "%s: unknown to the library\n", zone);
+        ++c.mismatches;
+        return;
+    }
+    // From 1900 to 2100 in steps of about 10 days.
+    for (time_t instant = -2208988800; instant < 4102444800;
+        instant += 863999)
+    {
+        check_localtime(shim, c, zone, instant);
+    }
+    int64_t begin = INT64_MIN, end = INT64_MIN;
+    offset_interval_at_instant(id, -2208988800, &begin, &end);
+    while (end < 4102444800) {
+        for (int64_t delta : {-3601, -1, 0, 1, 3600}) {
+            check_localtime(shim, c, zone, (time_t)(end + delta));
+            check_mktime(shim, c, zone, (time_t)(end + delta));
+        }
+        if (offset_interval_at_instant(id, end, &begin, &end) == INT_MAX)
+            break;
+    }
+}
+
+static void check_utc(const shim_functions& shim, counters& c) {
+    for (time_t instant = -62135596800; instant < 253402300800;
+        instant += 86399 * 37)
+    {
+        struct tm expected, actual;
+        memset(&expected, 0, sizeof expected);
+        memset(&actual, 0, sizeof actual);
+        const bool expected_ok = gmtime_r(&instant, &expected) != nullptr;
+        const bool actual_ok = shim.gmtime_r(&instant, &actual) != nullptr;
+        compare(c, "UTC", "gmtime_r", (long long)instant, expected_ok,
+            expected, actual_ok, actual);
+        // Shift some fields out of their ranges to check the carrying.
+        expected.tm_mon += 25;
+        expected.tm_mday -= 40;
+        expected.tm_sec += 100000;
+        actual = expected;
+        const time_t expected_result = timegm(&expected);
+        const time_t actual_result = shim.timegm(&actual);
+        compare(c, "UTC", "timegm", (long long)instant, expected_result,
+            expected, actual_result, actual);
+    }
+}
+
+template <typename F>
+static bool resolve(void *library, const char *name, F& function) {
+    function = (F)dlsym(library, name);
+    if (function == nullptr)
+        fprintf(stderr, "%s\n", dlerror());
+    return function != nullptr;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s libdatetime_tzshim.so [zone...]\n",
+            argv[0]);
+        return 2;
+    }
+    void *library = dlopen(argv[1], RTLD_NOW | RTLD_LOCAL);
+    if (library == nullptr) {
+        fprintf(stderr, "%s\n", dlerror());
+        return 2;
+    }
+    shim_functions shim;
+    if (!resolve(library, "tzset", shim.tzset) ||
+        !resolve(library, "localtime_r", shim.localtime_r) ||
+        !resolve(library, "gmtime_r", shim.gmtime_r) ||
+        !resolve(library, "mktime", shim.mktime) ||
+        !resolve(library, "timegm", shim.timegm))
+        return 2;
+    std::vector<std::string> zones;
+    for (int i = 2; i < argc; ++i)
+        zones.emplace_back(argv[i]);
+    if (zones.empty()) {
+        char **names = available_zone_ids();
+        if (names == nullptr) {
+            fprintf(stderr, "the time zone database is unavailable\n");
+            return 2;
+        }
+        for (char **name = names; *name != nullptr; ++name) {
+            zones.emplace_back(*name);
+            free(*name);
+        }
+        free(names);
+    }
+    counters total;
+    counters utc;
+    check_utc(shim, utc);
+    total.checked += utc.checked;
+    total.mismatches += utc.mismatches;
+    for (const std::string& zone : zones) {
+        counters c;
+        check_zone(shim, c, zone.c_str());
+        if (c.mismatches != 0 || c.isdst_mismatches != 0) {
+            printf("%-32s %ld mismatches, %ld of tm_isdst\n", zone.c_str(),
+                c.mismatches, c.isdst_mismatches);
+        }
+        total.checked += c.checked;
+        total.mismatches += c.mismatches;
+        total.isdst_mismatches += c.isdst_mismatches;
+    }
+    printf("%zu zones, %ld results: %ld mismatches, %ld of tm_isdst only\n",
+        zones.size(), total.checked, total.mismatches,
+        total.isdst_mismatches);
+    return total.mismatches == 0 ? 0 : 1;
+}
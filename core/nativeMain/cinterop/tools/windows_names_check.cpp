@@ -0,0 +1,88 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that checks the lookups of the Windows time zone names
+   from `windows_names.cpp`. It is built with the gradle task
+   `buildWindowsNamesCheck` and run by `checkNativeWindowsNames`.
+
+   "Pacific Standard Time" must be America/Los_Angeles, and the other
+   regions that CLDR maps to it, as well as the links to them, must get it
+   back. The names that are unknown, even if only by their case or a space,
+   must find nothing. Then, every Windows name that the time zone database
+   knows must be found, and its time zone must have a Windows name of the
+   same time zone. */
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include "windows_zones.hpp"
+#include "check.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+static bool has_name(TZID zone, const char *expected) {
+    const char *name = windows_name_of_timezone(zone);
+    if (name != nullptr && strcmp(name, expected) == 0)
+        return true;
+    fprintf(stderr, "%s instead of %s\n", name ? name : "nothing", expected);
+    return false;
+}
+
+static void check_pacific() {
+    const TZID los_angeles = timezone_by_name("America/Los_Angeles");
+    if (!CHECK(los_angeles != TZID_INVALID))
+        return;
+    CHECK_EQUAL(timezone_by_windows_name("Pacific Standard Time"),
+        los_angeles);
+    CHECK(has_name(los_angeles, "Pacific Standard Time"));
+    // A link is the same time zone as the one it links to.
+    const TZID link = timezone_by_name("US/Pacific");
+    if (CHECK(link != TZID_INVALID))
+        CHECK(has_name(link, "Pacific Standard Time"));
+    // Another region of the same Windows time zone.
+    const TZID vancouver = timezone_by_name("America/Vancouver");
+    if (CHECK(vancouver != TZID_INVALID))
+        CHECK(has_name(vancouver, "Pacific Standard Time"));
+    const TZID tijuana = timezone_by_name("America/Tijuana");
+    if (CHECK(tijuana != TZID_INVALID)) {
+        CHECK_EQUAL(timezone_by_windows_name("Pacific Standard Time (Mexico)"),
+            tijuana);
+        CHECK(has_name(tijuana, "Pacific Standard Time (Mexico)"));
+    }
+}
+
+static void check_unknown() {
+    for (const char *name : {"", "Nowhere Standard Time",
+        "pacific standard time", "Pacific Standard Time ",
+        "Pacific Standard", "America/Los_Angeles"})
+        CHECK_EQUAL(timezone_by_windows_name(name), TZID_INVALID);
+    CHECK(windows_name_of_timezone(TZID_INVALID) == nullptr);
+    CHECK(windows_name_of_timezone(TZID_INVALID - 1) == nullptr);
+}
+
+static void check_all_names() {
+    size_t found = 0;
+    for (size_t i = 0; i < windows_zones::windows_names.size(); ++i) {
+        const char *name = windows_zones::windows_names.names[i].data();
+        const TZID zone = timezone_by_windows_name(name);
+        if (zone == TZID_INVALID)
+            continue;
+        ++found;
+        const char *back = windows_name_of_timezone(zone);
+        if (back == nullptr || timezone_by_windows_name(back) != zone) {
+            fprintf(stderr, "%s gets %s back\n", name,
+                back ? back : "nothing");
+            ++check::failures;
+        }
+    }
+    // Most time zones of Windows are known to any time zone database.
+    CHECK(found > windows_zones::windows_names.size() / 2);
+}
+
+int main() {
+    check_pacific();
+    check_unknown();
+    check_all_names();
+    return check::exit_code();
+}
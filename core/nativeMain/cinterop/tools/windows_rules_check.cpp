@@ -0,0 +1,323 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that compares the evaluation of the Windows time zone
+   rules from `windows_rules.hpp` to the time zone database of `cdate.h`,
+   without needing Windows. It is built with the gradle task
+   `buildWindowsRulesCheck`, run by `checkNativeWindowsRules` on
+   `windows_time_zones.reg`, and takes the time zones from files in the
+   format of `reg export`, saved as ASCII or UTF-8:
+
+       windows_rules_check [-n calls] [-y first,last] windows_time_zones.reg
+
+   `windows_time_zones.reg` in this directory has a few zones with different
+   kinds of rules. Each zone is compared to the region that
+   `windows_zones.hpp` maps it to, in the years from 2008 to 2037 by
+   default, because the registry only approximates the earlier rules: the
+   offsets at regular instants and around every transition, and the local
+   date-times around the transitions, resolved like `offset_at_datetime`
+   does. Then, the lookups of the offsets at the same random instants are
+   measured with both, in nanoseconds per call. */
+#include <cctype>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include <getopt.h>
+#include "windows_rules.hpp"
+#include "windows_zones.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+// The values of a time zone from the registry.
+struct registry_zone {
+    std::vector<uint8_t> tzi;
+    // The values under `Dynamic DST`, by year.
+    std::map<int, std::vector<uint8_t>> years;
+};
+
+static const char time_zones_key[] = "\\Time Zones\\";
+static const char dynamic_dst_key[] = "\\Dynamic DST";
+
+static std::vector<uint8_t> parse_hex(const std::string& value) {
+    std::vector<uint8_t> result;
+    for (size_t i = 0; i < value.size(); ++i) {
+        if (isxdigit((unsigned char)value[i]) &&
+            i + 1 < value.size() && isxdigit((unsigned char)value[i + 1]))
+        {
+            result.push_back((uint8_t)strtoul(value.substr(i, 2).c_str(),
+                nullptr, 16));
+            ++i;
+        }
+    }
+    return result;
+}
+
+static bool read_registry(const char *path,
+    std::map<std::string, registry_zone>& zones)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+    std::string line, current;
+    bool dynamic = false;
+    while (std::getline(file, line)) {
+        // The long values continue on the next lines.
+        while (!line.empty() && (line.back() == '\r' || line.back() == '\\')) {
+            const bool continued = line.back() == '\\';
+            line.pop_back();
+            std::string next;
+            if (continued && std::getline(file, next))
+                line += next;
+        }
+        if (line.empty() || line[0] == ';')
+            continue;
+        if (line[0] == '[') {
+            const size_t key = line.find(time_zones_key);
+            current.clear();
+            if (key == std::string::npos || line.back() != ']')
+                continue;
+            current = line.substr(key + sizeof(time_zones_key) - 1);
+            current.pop_back();
+            const size_t suffix_length = sizeof(dynamic_dst_key) - 1;
+            const size_t suffix = current.size() - suffix_length;
+            dynamic = current.size() > suffix_length &&
+                current.compare(suffix, suffix_length, dynamic_dst_key) == 0;
+            if (dynamic)
+                current.erase(suffix);
+            continue;
+        }
+        const size_t equals = line.find("\"=hex:");
+        if (current.empty() || line[0] != '"' || equals == std::string::npos)
+            continue;
+        const std::string name = line.substr(1, equals - 1);
+        const std::vector<uint8_t> value = parse_hex(line.substr(equals + 6));
+        if (!dynamic && name == "TZI")
+            zones[current].tzi = value;
+        else if (dynamic && isdigit((unsigned char)name[0]))
+            zones[current].years[atoi(name.c_str())] = value;
+    }
+    return true;
+}
+
+// The layout of `REG_TZI_FORMAT`: little-endian, without padding.
+static bool to_rules(const std::vector<uint8_t>& tzi,
+    windows_rules::year_rules& rules)
+{
+    if (tzi.size() != 44)
+        return false;
+    const auto word = [&](size_t i) {
+        return (uint16_t)(tzi[i] | tzi[i + 1] << 8);
+    };
+    const auto dword = [&](size_t i) {
+        return (int32_t)(word(i) | (uint32_t)word(i + 2) << 16);
+    };
+    const auto date = [&](size_t i) {
+        return windows_rules::system_time{word(i), word(i + 2), word(i + 4),
+            word(i + 6), word(i + 8), word(i + 10), word(i + 12),
+            word(i + 14)};
+    };
+    rules = windows_rules::year_rules{dword(0), dword(4), dword(8), date(12),
+        date(28)};
+    return true;
+}
+
+struct counters {
+    long checked = 0;
+    long mismatches = 0;
+    // Only the first few mismatches of each zone are printed.
+    int printed = 0;
+};
+
+static void compare(counters& c, const char *zone, const char *what,
+    int64_t argument, int64_t expected, int64_t actual)
+{
+    ++c.checked;
+    if (expected == actual)
+        return;
+    ++c.mismatches;
+    if (c.printed++ < 5) {
+        fprintf(stderr, "%s: %s(%lld) is %lld instead of %lld\n", zone, what,
+            (long long)argument, (long long)actual, (long long)expected);
+    }
+}
+
+static void check_instant(counters& c, const char *name, TZID id,
+    const windows_rules::zone& zone, int64_t epoch_sec)
+{
+    int64_t begin = 0, end = 0;
+    const int offset = zone.offset_at(epoch_sec, begin, end);
+    compare(c, name, "offset_at", epoch_sec, offset_at_instant(id, epoch_sec),
+        offset);
+    if (begin > epoch_sec || end <= epoch_sec) {
+        compare(c, name, "the range of offset_at", epoch_sec, epoch_sec,
+            begin > epoch_sec ? begin : end);
+    }
+    if (begin != INT64_MIN)
+        compare(c, name, "offset_at", begin, offset, zone.offset_at(begin));
+    if (end != INT64_MAX)
+        compare(c, name, "offset_at", end - 1, offset, zone.offset_at(end - 1));
+}
+
+static void check_local(counters& c, const char *name, TZID id,
+    const windows_rules::zone& zone, int64_t local_sec)
+{
+    int expected_offset = INT_MAX;
+    const int expected_gap = offset_at_datetime(id, local_sec,
+        &expected_offset);
+    const windows_rules::local_offsets offsets = zone.offsets_at_local(
+        local_sec);
+    compare(c, name, "the offset of offsets_at_local", local_sec,
+        expected_offset, offsets.gap ? offsets.after : offsets.before);
+    compare(c, name, "the gap of offsets_at_local", local_sec, expected_gap,
+        offsets.gap ? offsets.after - offsets.before : 0);
+}
+
+static counters check_zone(const char *name, TZID id,
+    const windows_rules::zone& zone, int first_year, int last_year)
+{
+    counters c;
+    const int64_t from = civil::days_from_civil(first_year, 1, 1) *
+        SECS_PER_DAY;
+    const int64_t to = civil::days_from_civil(last_year + 1, 1, 1) *
+        SECS_PER_DAY;
+    // In steps of about 10 days.
+    for (int64_t instant = from; instant < to; instant += 863999) {
+        check_instant(c, name, id, zone, instant);
+        check_local(c, name, id, zone, instant);
+    }
+    for (int year = first_year; year <= last_year; ++year) {
+        const windows_rules::year_transitions t = zone.transitions(year);
+        if (t.standard_begin == INT64_MIN)
+            continue;
+        for (const int64_t transition : {t.standard_begin, t.daylight_begin}) {
+            for (int64_t delta : {-3601, -1, 0, 1, 3600}) {
+                check_instant(c, name, id, zone, transition + delta);
+                check_local(c, name, id, zone,
+                    transition + t.standard_offset + delta);
+                check_local(c, name, id, zone,
+                    transition + t.daylight_offset + delta);
+            }
+        }
+    }
+    return c;
+}
+
+typedef std::chrono::steady_clock benchmark_clock;
+
+static double nanoseconds_since(benchmark_clock::time_point start,
+    size_t calls)
+{
+    const std::chrono::duration<double, std::nano> elapsed =
+        benchmark_clock::now() - start;
+    return elapsed.count() / (double)(calls == 0 ? 1 : calls);
+}
+
+// So that the calls are not optimized away.
+static volatile int64_t checksum = 0;
+
+static void measure_zone(const char *name, TZID id,
+    const windows_rules::zone& zone, const std::vector<int64_t>& instants)
+{
+    int64_t sum = 0;
+    auto start = benchmark_clock::now();
+    for (int64_t instant : instants)
+        sum += zone.offset_at(instant);
+    const double rules = nanoseconds_since(start, instants.size());
+    start = benchmark_clock::now();
+    for (int64_t instant : instants)
+        sum += offset_at_instant(id, instant);
+    const double database = nanoseconds_since(start, instants.size());
+    printf("%-32s %10.1f ns %10.1f ns in cdate.h\n", name, rules, database);
+    checksum = checksum + sum;
+}
+
+int main(int argc, char **argv) {
+    size_t calls = 1000000;
+    int first_year = 2008, last_year = 2037;
+    int option;
+    while ((option = getopt(argc, argv, "n:y:")) != -1) {
+        switch (option) {
+            case 'n':
+                calls = (size_t)atol(optarg);
+                break;
+            case 'y':
+                if (sscanf(optarg, "%d,%d", &first_year, &last_year) == 2)
+                    break;
+                // fallthrough
+            default:
+                fprintf(stderr,
+                    "usage: %s [-n calls] [-y first,last] file.reg...\n",
+                    argv[0]);
+                return 2;
+        }
+    }
+    std::map<std::string, registry_zone> registry;
+    for (int i = optind; i < argc; ++i) {
+        if (!read_registry(argv[i], registry)) {
+            fprintf(stderr, "%s: can't be read\n", argv[i]);
+            return 2;
+        }
+    }
+    std::mt19937_64 random(42);
+    std::uniform_int_distribution<int64_t> distribution(
+        civil::days_from_civil(first_year, 1, 1) * SECS_PER_DAY,
+        civil::days_from_civil(last_year + 1, 1, 1) * SECS_PER_DAY - 1);
+    std::vector<int64_t> instants(calls);
+    for (int64_t& instant : instants)
+        instant = distribution(random);
+    counters total;
+    int zone_count = 0;
+    for (const auto& entry : registry) {
+        const char *name = entry.first.c_str();
+        windows_rules::year_rules rules;
+        if (!to_rules(entry.second.tzi, rules)) {
+            fprintf(stderr, "%s: no valid TZI value\n", name);
+            ++total.mismatches;
+            continue;
+        }
+        const auto& years = entry.second.years;
+        std::vector<windows_rules::year_rules> dynamic;
+        const int first = years.empty() ? 0 : years.begin()->first;
+        for (int year = first; !years.empty() && year <= years.rbegin()->first;
+            ++year)
+        {
+            // The missing years have the rules of the previous ones.
+            const auto found = years.find(year);
+            dynamic.push_back(dynamic.empty() ? rules : dynamic.back());
+            if (found != years.end() &&
+                !to_rules(found->second, dynamic.back()))
+                fprintf(stderr, "%s: no valid rules for %d\n", name, year);
+        }
+        const windows_rules::zone zone(rules, first, std::move(dynamic));
+        const size_t windows_name =
+            windows_zones::windows_names.find(entry.first.c_str());
+        const TZID id = windows_name == perfect_hash::not_found ?
+            TZID_INVALID : timezone_by_name(windows_zones::regions.names[
+                windows_zones::region_of_windows_name[windows_name]].data());
+        if (id == TZID_INVALID) {
+            fprintf(stderr, "%s: no region of the library\n", name);
+            ++total.mismatches;
+            continue;
+        }
+        const counters c = check_zone(name, id, zone, first_year, last_year);
+        if (c.mismatches != 0)
+            printf("%-32s %ld mismatches\n", name, c.mismatches);
+        total.checked += c.checked;
+        total.mismatches += c.mismatches;
+        ++zone_count;
+        measure_zone(name, id, zone, instants);
+    }
+    printf("%d zones, %ld results: %ld mismatches\n", zone_count,
+        total.checked, total.mismatches);
+    return total.mismatches == 0 && zone_count != 0 ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2016-2020 JetBrains s.r.o.
+ * Use of this source code is governed by the Apache 2.0 License that can be found in the LICENSE.txt file.
+ */
+/* A command-line tool that checks the permanent zone codes from
+   `zone_codes.cpp`. It is built with the gradle task `buildZoneCodesCheck`
+   and run by `checkNativeZoneCodes`.
+
+   The codes are stored by the users, so the names that had codes when this
+   tool was last updated must still have the same ones: the hash of those
+   names, in the order of their codes, is pinned below, along with a few of
+   the codes themselves. When `updateZoneCodes` appends names, nothing here
+   changes; if it ever has to, the codes have been reassigned. Every name
+   must get its code back, and every code its name and the time zone with
+   that name, both one by one and in the batches. */
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "zone_codes.hpp"
+#include "check.hpp"
+extern "C" {
+#include "cdate.h"
+}
+
+static const size_t code_count =
+    sizeof(zone_code_names) / sizeof(zone_code_names[0]);
+
+// The number of the codes, with ZONE_CODE_INVALID, when this was updated.
+static const size_t pinned_code_count = 599;
+// The FNV-1a hash of their names, each followed by a zero.
+static const uint64_t pinned_hash = 0xc998a53eb4131e5eu;
+
+static const struct {
+    const char *name;
+    ZONE_CODE code;
+} pinned_codes[] = {
+    {"Africa/Abidjan", 1}, {"America/New_York", 171}, {"Asia/Kolkata", 285},
+    {"Europe/Berlin", 434}, {"US/Pacific", 592}, {"UTC", 594}, {"Zulu", 598},
+};
+
+static uint64_t hash_of_names(size_t count) {
+    uint64_t hash = 14695981039346656037u;
+    for (size_t code = 1; code < count; ++code) {
+        const char *name = zone_code_names[code];
+        for (size_t i = 0; i <= strlen(name); ++i) {
+            hash ^= (unsigned char)name[i];
+            hash *= 1099511628211u;
+        }
+    }
+    return hash;
+}
+
+static void check_pinned() {
+    if (!CHECK(code_count >= pinned_code_count))
+        return;
+    if (!CHECK(hash_of_names(pinned_code_count) == pinned_hash))
+        fprintf(stderr, "the zone codes below %zu have been reassigned\n",
+            pinned_code_count);
+    for (const auto& pinned : pinned_codes) {
+        CHECK_EQUAL(zone_code_by_name(pinned.name), pinned.code);
+        CHECK(strcmp(zone_name_by_code(pinned.code), pinned.name) == 0);
+    }
+}
+
+static void check_names() {
+    CHECK(zone_name_by_code(ZONE_CODE_INVALID) == nullptr);
+    CHECK(zone_name_by_code((ZONE_CODE)code_count) == nullptr);
+    for (const char *name : {"", "Nowhere", "Europe/Berli", "Europe/Berlin/",
+        "europe/berlin"})
+        CHECK_EQUAL(zone_code_by_name(name), ZONE_CODE_INVALID);
+    for (size_t code = 1; code < code_count; ++code) {
+        const char *name = zone_name_by_code((ZONE_CODE)code);
+        if (!CHECK(name != nullptr))
+            continue;
+        if (zone_code_by_name(name) != code) {
+            fprintf(stderr, "%s is not %zu\n", name, code);
+            ++check::failures;
+        }
+    }
+}
+
+/* The time zones of the codes, and back: a link gets the code of some name
+   of the same time zone, which need not be its own. */
+static void check_timezones() {
+    std::vector<ZONE_CODE> codes;
+    std::vector<TZID> expected;
+    size_t found = 0;
+    for (size_t code = 1; code < code_count; ++code) {
+        const TZID zone = timezone_by_name(zone_code_names[code]);
+        CHECK_EQUAL(timezone_by_zone_code((ZONE_CODE)code), zone);
+        codes.push_back((ZONE_CODE)code);
+        expected.push_back(zone);
+        if (zone == TZID_INVALID)
+            continue;
+        ++found;
+        const ZONE_CODE back = zone_code_of_timezone(zone);
+        if (timezone_by_zone_code(back) != zone) {
+            fprintf(stderr, "%s gets the code of %s\n", zone_code_names[code],
+                back == ZONE_CODE_INVALID ? "nothing" : zone_code_names[back]);
+            ++check::failures;
+        }
+    }
+    // Most names are known to any time zone database.
+    CHECK(found > code_count / 2);
+    CHECK_EQUAL(timezone_by_zone_code(ZONE_CODE_INVALID), TZID_INVALID);
+    CHECK_EQUAL(timezone_by_zone_code((ZONE_CODE)code_count), TZID_INVALID);
+    CHECK_EQUAL(zone_code_of_timezone(TZID_INVALID), ZONE_CODE_INVALID);
+    // The batches give the same as the single values.
+    std::vector<TZID> zones(codes.size());
+    CHECK_EQUAL(zone_codes_to_timezones(codes.data(), zones.data(),
+        codes.size()), found == codes.size() ? 0 : -1);
+    CHECK(zones == expected);
+    std::vector<ZONE_CODE> back(zones.size());
+    CHECK_EQUAL(timezones_to_zone_codes(zones.data(), back.data(),
+        zones.size()), found == zones.size() ? 0 : -1);
+    for (size_t i = 0; i < zones.size(); ++i)
+        CHECK_EQUAL(back[i], zone_code_of_timezone(zones[i]));
+}
+
+int main() {
+    check_pinned();
+    check_names();
+    check_timezones();
+    return check::exit_code();
+}